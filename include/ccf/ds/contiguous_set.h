@@ -439,6 +439,23 @@ namespace ccf::ds
 
     void extend(const T& from, size_t additional)
     {
+      // Ranges beyond the current end (the common case, when building a set
+      // in-order) are appended directly, rather than one value at a time
+      if (ranges.empty() || from > ranges.back().first + ranges.back().second)
+      {
+        if (
+          !ranges.empty() &&
+          from == ranges.back().first + ranges.back().second + 1)
+        {
+          ranges.back().second += additional + 1;
+        }
+        else
+        {
+          ranges.emplace_back(from, additional);
+        }
+        return;
+      }
+
       for (auto n = from; n <= from + additional; ++n)
       {
         const auto b = insert(n);
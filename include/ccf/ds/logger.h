@@ -7,14 +7,20 @@
 #include "ccf/threading/thread_ids.h"
 
 #define FMT_HEADER_ONLY
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fmt/args.h>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <type_traits>
+#include <variant>
 
 namespace ccf::logger
 {
@@ -28,6 +34,13 @@ namespace ccf::logger
     return LevelNames[static_cast<int>(l)];
   }
 
+  // Messages which may be dropped, rather than wait, when the enclave or host
+  // log pipeline is full. Failures are never dropped.
+  static constexpr bool is_droppable(LoggerLevel l)
+  {
+    return l < LoggerLevel::FAIL;
+  }
+
   static constexpr long int ns_per_s = 1'000'000'000;
 
   static constexpr auto preamble_length = 45u;
@@ -36,6 +49,255 @@ namespace ccf::logger
   static size_t logical_clock = 0;
 #endif
 
+  /// A CCF_LOG_FMT call site, identified by a process-unique id.
+  struct FormatSite
+  {
+    enum class Published : uint8_t
+    {
+      NO,
+      IN_PROGRESS,
+      YES
+    };
+
+    const uint32_t id;
+    const std::string_view format;
+
+    // Set by a logger which publishes the format of each site once, so that
+    // later messages from the site need only refer to it by id
+    std::atomic<Published> published = Published::NO;
+
+    FormatSite(std::string_view format_) : id(next_id()), format(format_) {}
+
+  private:
+    static uint32_t next_id()
+    {
+      static std::atomic<uint32_t> next = 1;
+      return next++;
+    }
+  };
+
+  /** The arguments of a CCF_LOG_FMT message, captured as raw bytes rather than
+   * formatted, so that formatting can be deferred, possibly to another
+   * process which knows the format string of the site.
+   *
+   * Only arguments which fmt formats without any CCF-defined formatter
+   * (numbers, characters and strings) can be captured. Messages with any other
+   * argument, or whose captured arguments would not fit, are formatted
+   * eagerly.
+   */
+  class DeferredFormat
+  {
+  public:
+    static constexpr size_t max_args_size = 256;
+
+    enum class ArgType : uint8_t
+    {
+      BOOL,
+      CHAR,
+      INT,
+      UINT,
+      FLOAT,
+      DOUBLE,
+      STRING
+    };
+
+    template <typename T>
+    static constexpr bool can_capture()
+    {
+      using U = std::remove_cvref_t<T>;
+      return (std::is_arithmetic_v<U> && sizeof(U) <= sizeof(uint64_t)) ||
+        std::is_same_v<U, std::string> ||
+        std::is_same_v<U, std::string_view> ||
+        std::is_same_v<std::decay_t<U>, const char*> ||
+        std::is_same_v<std::decay_t<U>, char*>;
+    }
+
+    // Null when formatted from received bytes
+    FormatSite* site = nullptr;
+    uint32_t site_id = 0;
+    std::string_view format_string;
+
+    std::array<uint8_t, max_args_size> args;
+    size_t args_size = 0;
+
+    DeferredFormat() = default;
+
+    DeferredFormat(FormatSite& site_) :
+      site(&site_),
+      site_id(site_.id),
+      format_string(site_.format)
+    {}
+
+    DeferredFormat(
+      uint32_t site_id_,
+      std::string_view format_string_,
+      std::span<const uint8_t> args_) :
+      site_id(site_id_),
+      format_string(format_string_)
+    {
+      if (args_.size() > max_args_size)
+      {
+        throw std::logic_error(fmt::format(
+          "Deferred log arguments of size {} exceed maximum of {}",
+          args_.size(),
+          max_args_size));
+      }
+      std::memcpy(args.data(), args_.data(), args_.size());
+      args_size = args_.size();
+    }
+
+    // Returns false if the argument does not fit
+    template <typename T>
+    bool capture(const T& arg)
+    {
+      using U = std::remove_cvref_t<T>;
+      if constexpr (std::is_same_v<U, bool>)
+      {
+        return put(ArgType::BOOL, arg);
+      }
+      else if constexpr (std::is_same_v<U, char>)
+      {
+        return put(ArgType::CHAR, arg);
+      }
+      else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+      {
+        return put(ArgType::INT, (int64_t)arg);
+      }
+      else if constexpr (std::is_integral_v<U>)
+      {
+        return put(ArgType::UINT, (uint64_t)arg);
+      }
+      else if constexpr (std::is_same_v<U, float>)
+      {
+        return put(ArgType::FLOAT, arg);
+      }
+      else if constexpr (std::is_floating_point_v<U>)
+      {
+        return put(ArgType::DOUBLE, (double)arg);
+      }
+      else
+      {
+        const std::string_view s(arg);
+        const uint32_t size = s.size();
+        if (!put(ArgType::STRING, size) || args_size + size > max_args_size)
+        {
+          return false;
+        }
+        std::memcpy(args.data() + args_size, s.data(), size);
+        args_size += size;
+        return true;
+      }
+    }
+
+    std::span<const uint8_t> get_args() const
+    {
+      return {args.data(), args_size};
+    }
+
+    std::string format() const
+    {
+      fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+      const uint8_t* data = args.data();
+      size_t size = args_size;
+      while (size > 0)
+      {
+        const auto type = get<ArgType>(data, size);
+        switch (type)
+        {
+          case ArgType::BOOL:
+            store.push_back(get<bool>(data, size));
+            break;
+          case ArgType::CHAR:
+            store.push_back(get<char>(data, size));
+            break;
+          case ArgType::INT:
+            store.push_back(get<int64_t>(data, size));
+            break;
+          case ArgType::UINT:
+            store.push_back(get<uint64_t>(data, size));
+            break;
+          case ArgType::FLOAT:
+            store.push_back(get<float>(data, size));
+            break;
+          case ArgType::DOUBLE:
+            store.push_back(get<double>(data, size));
+            break;
+          case ArgType::STRING:
+          {
+            const auto len = get<uint32_t>(data, size);
+            check_size(len, size);
+            store.push_back(std::string_view((const char*)data, len));
+            data += len;
+            size -= len;
+            break;
+          }
+          default:
+            throw std::logic_error(
+              fmt::format("Unknown deferred log argument type {}", (int)type));
+        }
+      }
+
+      return fmt::vformat(format_string, store);
+    }
+
+  private:
+    template <typename T>
+    bool put(ArgType type, const T& value)
+    {
+      if (args_size + 1 + sizeof(T) > max_args_size)
+      {
+        return false;
+      }
+      args[args_size++] = (uint8_t)type;
+      std::memcpy(args.data() + args_size, &value, sizeof(T));
+      args_size += sizeof(T);
+      return true;
+    }
+
+    static void check_size(size_t required, size_t size)
+    {
+      if (required > size)
+      {
+        throw std::logic_error("Truncated deferred log arguments");
+      }
+    }
+
+    template <typename T>
+    static T get(const uint8_t*& data, size_t& size)
+    {
+      check_size(sizeof(T), size);
+      T value;
+      std::memcpy(&value, data, sizeof(T));
+      data += sizeof(T);
+      size -= sizeof(T);
+      return value;
+    }
+  };
+
+  using DeferredOrFormatted = std::variant<DeferredFormat, std::string>;
+
+  /// Captures the arguments of a CCF_LOG_FMT message if possible, or formats
+  /// them otherwise
+  template <typename... Args>
+  static auto defer_format(
+    FormatSite& site, fmt::format_string<Args...> s, Args&&... args)
+  {
+    if constexpr ((DeferredFormat::can_capture<Args>() && ...))
+    {
+      DeferredOrFormatted result(std::in_place_type<DeferredFormat>, site);
+      if (!(std::get<DeferredFormat>(result).capture(args) && ...))
+      {
+        result = fmt::format(s, std::forward<Args>(args)...);
+      }
+      return result;
+    }
+    else
+    {
+      return fmt::format(s, std::forward<Args>(args)...);
+    }
+  }
+
   struct LogLine
   {
   public:
@@ -46,9 +308,14 @@ namespace ccf::logger
     size_t line_number;
     uint16_t thread_id;
 
-    std::ostringstream ss;
+    // Only constructed if items other than formatted strings are streamed
+    std::optional<std::ostringstream> ss;
     std::string msg;
 
+    // Set instead of msg for a CCF_LOG_FMT message whose arguments were
+    // captured, until it is formatted by format_deferred()
+    std::optional<DeferredFormat> deferred;
+
     LogLine(
       LoggerLevel level_,
       std::string_view tag_,
@@ -77,19 +344,79 @@ namespace ccf::logger
     template <typename T>
     LogLine& operator<<(const T& item)
     {
-      ss << item;
+      stream() << item;
       return *this;
     }
 
     LogLine& operator<<(std::ostream& (*f)(std::ostream&))
     {
-      ss << f;
+      stream() << f;
+      return *this;
+    }
+
+    LogLine& operator<<(std::string&& s)
+    {
+      format_deferred();
+      if (ss.has_value())
+      {
+        *ss << s;
+      }
+      else if (msg.empty())
+      {
+        msg = std::move(s);
+      }
+      else
+      {
+        msg += s;
+      }
+      return *this;
+    }
+
+    LogLine& operator<<(DeferredOrFormatted&& d)
+    {
+      if (std::holds_alternative<std::string>(d))
+      {
+        return *this << std::move(std::get<std::string>(d));
+      }
+
+      auto& deferred_format = std::get<DeferredFormat>(d);
+      if (ss.has_value() || !msg.empty() || deferred.has_value())
+      {
+        return *this << deferred_format.format();
+      }
+
+      deferred = std::move(deferred_format);
       return *this;
     }
 
     void finalize()
     {
-      msg = ss.str();
+      if (ss.has_value())
+      {
+        msg += ss->str();
+        ss.reset();
+      }
+    }
+
+    void format_deferred()
+    {
+      if (deferred.has_value())
+      {
+        msg = deferred->format();
+        deferred.reset();
+      }
+    }
+
+  private:
+    std::ostringstream& stream()
+    {
+      if (!ss.has_value())
+      {
+        // Anything streamed follows the deferred message
+        format_deferred();
+        ss.emplace();
+      }
+      return *ss;
     }
   };
 
@@ -118,6 +445,13 @@ namespace ccf::logger
     virtual void write(
       const LogLine& ll,
       const std::optional<double>& enclave_offset = std::nullopt) = 0;
+
+    // Loggers which return true are given lines whose message may still be
+    // deferred, and must format it themselves if needed
+    virtual bool writes_deferred() const
+    {
+      return false;
+    }
   };
 
 #ifndef INSIDE_ENCLAVE
@@ -316,6 +650,10 @@ namespace ccf::logger
 
       for (auto const& logger : config::loggers())
       {
+        if (!logger->writes_deferred())
+        {
+          line.format_deferred();
+        }
         logger->write(line);
       }
 
@@ -350,8 +688,16 @@ namespace ccf::logger
 
 // To avoid repeating the (s, ...) args for every macro, we cheat with a curried
 // macro here by ending the macro with another macro name, which then accepts
-// the trailing arguments
-#define CCF_LOG_FMT_2(s, ...) fmt::format(CCF_FMT_STRING(s), ##__VA_ARGS__)
+// the trailing arguments. Where possible, the arguments are captured and only
+// formatted when the message is written, by whichever logger needs it.
+#define CCF_LOG_FMT_2(s, ...) \
+  ccf::logger::defer_format( \
+    []() -> ccf::logger::FormatSite& { \
+      static ccf::logger::FormatSite site(s); \
+      return site; \
+    }(), \
+    CCF_FMT_STRING(s), \
+    ##__VA_ARGS__)
 #define CCF_LOG_FMT(LVL, TAG) CCF_LOG_OUT(LVL, TAG) << CCF_LOG_FMT_2
 
   enum class macro
@@ -23,6 +23,9 @@ namespace ccf
     /// Number of transaction retries caused by
     /// conflicts since node start
     size_t retries = 0;
+    /// Number of transaction executions which
+    /// conflicted since node start
+    size_t conflicts = 0;
   };
 
   struct EndpointMetrics
@@ -31,9 +34,10 @@ namespace ccf
     std::vector<EndpointMetricsEntry> metrics;
   };
 
-  DECLARE_JSON_TYPE(EndpointMetricsEntry)
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(EndpointMetricsEntry)
   DECLARE_JSON_REQUIRED_FIELDS(
     EndpointMetricsEntry, path, method, calls, errors, failures, retries)
+  DECLARE_JSON_OPTIONAL_FIELDS(EndpointMetricsEntry, conflicts)
   DECLARE_JSON_TYPE(EndpointMetrics)
   DECLARE_JSON_REQUIRED_FIELDS(EndpointMetrics, metrics)
 }
\ No newline at end of file
@@ -38,6 +38,8 @@ namespace ccf::endpoints
     PathTemplateSpec spec;
   };
 
+  class PathTemplateTrie;
+
   struct RequestCompletedEvent
   {
     std::string method = "";
@@ -48,7 +50,16 @@ namespace ccf::endpoints
     std::string dispatch_path = "";
     int status = 0;
     std::chrono::milliseconds exec_time{0};
+    // Time spent authenticating the caller, summed over all attempts. Unlike
+    // exec_time this is measured with a monotonic clock, as verifying a
+    // signature usually takes well under a millisecond
+    std::chrono::microseconds auth_time{0};
     size_t attempts = 0;
+    // Number of attempts which failed because they conflicted with other
+    // transactions, and name of the map on which the last of these conflicts
+    // occurred
+    size_t conflicts = 0;
+    std::optional<std::string> conflicting_map = std::nullopt;
   };
 
   struct DispatchFailedEvent
@@ -160,6 +171,9 @@ namespace ccf::endpoints
       std::string,
       std::map<RESTVerb, std::shared_ptr<PathTemplatedEndpoint>>>
       templated_endpoints;
+    // Index of templated_endpoints, built as they are installed, through which
+    // request paths are matched
+    std::shared_ptr<PathTemplateTrie> templated_endpoints_trie;
 
     ccf::kv::Consensus* consensus = nullptr;
     ccf::kv::TxHistory* history = nullptr;
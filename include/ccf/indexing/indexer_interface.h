@@ -49,7 +49,7 @@ namespace ccf::indexing
       strategies.erase(strategy);
     }
 
-    nlohmann::json describe() const
+    virtual nlohmann::json describe() const
     {
       auto j = nlohmann::json::array();
 
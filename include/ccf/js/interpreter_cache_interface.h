@@ -2,10 +2,15 @@
 // Licensed under the Apache 2.0 License.
 #pragma once
 
+#include "ccf/ds/json.h"
 #include "ccf/endpoint.h"
 #include "ccf/js/tx_access.h"
+#include "ccf/kv/read_only_store.h"
 #include "ccf/node_subsystem_interface.h"
 
+#include <map>
+#include <set>
+
 namespace ccf::js
 {
   namespace core
@@ -19,6 +24,54 @@ namespace ccf::js
   using InterpreterFactory =
     std::function<std::shared_ptr<js::core::Context>(js::TxAccess)>;
 
+  // The modules of an app bundle, as QuickJS bytecode, captured once for each
+  // freshness marker. Interpreters may load (but not evaluate) these ahead of
+  // demand, so that requests need only evaluate them.
+  struct BundleSnapshot
+  {
+    size_t freshness_marker = 0;
+    // Keyed by module path, as in the modules table
+    std::map<std::string, std::vector<uint8_t>> bytecode;
+    // Modules named by endpoints, loaded along with their static imports
+    std::set<std::string> entry_modules;
+  };
+
+  using BundleSnapshotPtr = std::shared_ptr<const BundleSnapshot>;
+
+  // Reads the app's modules, and the freshness marker they were read at, from
+  // the given transaction
+  using BundleSnapshotReader =
+    std::function<BundleSnapshotPtr(ccf::kv::ReadOnlyTx&)>;
+
+  struct InterpreterCacheMetrics
+  {
+    // Requests served by a previously used interpreter from the cache
+    size_t hits = 0;
+    // Requests which needed a fresh interpreter, either because their
+    // endpoint does not permit reuse or because none was cached
+    size_t misses = 0;
+    // Misses served by an interpreter constructed ahead of demand
+    size_t prewarmed = 0;
+    // Misses served by an interpreter which had already loaded the app's
+    // modules from a bundle snapshot
+    size_t preloaded = 0;
+    size_t cached_interpreters = 0;
+    size_t interpreters_created = 0;
+    // Total time spent constructing interpreters, ahead of demand or not
+    uint64_t creation_time_us = 0;
+  };
+
+  DECLARE_JSON_TYPE(InterpreterCacheMetrics);
+  DECLARE_JSON_REQUIRED_FIELDS(
+    InterpreterCacheMetrics,
+    hits,
+    misses,
+    prewarmed,
+    preloaded,
+    cached_interpreters,
+    interpreters_created,
+    creation_time_us);
+
   class AbstractInterpreterCache : public ccf::AbstractNodeSubSystem
   {
   public:
@@ -42,11 +95,36 @@ namespace ccf::js
         interpreter_reuse,
       size_t freshness_marker) = 0;
 
-    // Cap the total number of interpreters which will be retained. The
-    // underlying cache functions as an LRU, evicting the interpreter which has
-    // been idle the longest when the cap is reached.
+    // Cap the number of interpreters which will be retained, in total across
+    // worker threads. The cap is divided between the threads' caches, which
+    // function as LRUs, evicting the interpreter which has been idle the
+    // longest when their share is reached. Pre-warmed interpreters (at most
+    // one RW and one RO per thread which has served requests) do not count
+    // towards the cap.
     virtual void set_max_cached_interpreters(size_t max) = 0;
 
     virtual void set_interpreter_factory(const InterpreterFactory& ip) = 0;
+
+    // Returns true if the cache would use a bundle snapshot for this freshness
+    // marker, and has not yet been given one
+    virtual bool needs_bundle_snapshot(size_t freshness_marker)
+    {
+      return false;
+    }
+
+    virtual void set_bundle_snapshot(const BundleSnapshotPtr& snapshot) {}
+
+    // Asks for a bundle snapshot to be captured by reader, if one is needed
+    // for this freshness marker. The cache may run reader later, off the
+    // request path, in a read-only transaction of its own.
+    virtual void request_bundle_snapshot(
+      size_t freshness_marker, const BundleSnapshotReader& reader)
+    {}
+
+    // Indexed by thread ID
+    virtual std::vector<InterpreterCacheMetrics> get_metrics() const
+    {
+      return {};
+    }
   };
 }
@@ -51,6 +51,12 @@ namespace ccf::kv::untyped
 
     std::optional<ValueType> get(const KeyType& key);
 
+    /** Get pointer to the current value of key, without copying it, or
+     * nullptr if it does not exist. The value is owned by this transaction,
+     * and the pointer may be invalidated by any later write to this map.
+     */
+    const ValueType* get_ptr(const KeyType& key);
+
     std::optional<Version> get_version_of_previous_write(const KeyType& key);
 
     std::optional<ValueType> get_globally_committed(const KeyType& key);
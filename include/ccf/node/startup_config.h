@@ -21,9 +21,14 @@ namespace ccf
   struct CCFConfig
   {
     size_t worker_threads = 0;
+    // If set, idle worker threads run stealable tasks queued for busy ones
+    bool work_stealing = false;
 
     // 2**24.5 as per RFC8446 Section 5.5
     size_t node_to_node_message_limit = 23'726'566;
+    // If set, small node-to-node messages are sealed together in batches.
+    // Only enable once every node in the service can receive batches
+    bool node_to_node_message_batching = false;
 
     ccf::ds::SizeString historical_cache_soft_limit = {"512MB"};
 
@@ -85,6 +90,7 @@ namespace ccf
 
     std::string startup_host_time;
     size_t snapshot_tx_interval = 10'000;
+    size_t snapshot_max_delta_chain_length = 0;
 
     // Only if starting or recovering
     size_t initial_service_certificate_validity_days = 1;
@@ -35,7 +35,9 @@ namespace ccf
     /// NOTE: this is a security risk as it may leak sensitive information,
     ///       albeit to the caller only.
     bool return_exception_details = Defaults::return_exception_details;
-    /// @brief how many interpreters may be cached in-memory for future reuse
+    /// @brief how many interpreters may be cached in-memory for future reuse,
+    /// in total across worker threads. Each thread which serves JS requests
+    /// also keeps up to 2 pre-warmed interpreters, which are not counted.
     size_t max_cached_interpreters = Defaults::max_cached_interpreters;
   };
 
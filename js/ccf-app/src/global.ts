@@ -34,11 +34,17 @@ export type JsonCompatible<T> = any;
  *
  * `KVMap` is modelled after JavaScript's `Map` object,
  * except that keys and values must be of type `ArrayBuffer`
- * and no guarantees on iteration order are provided.
+ * and no guarantees on iteration order are provided,
+ * other than by `range`.
  */
 export interface KvMap {
   has(key: ArrayBuffer): boolean;
   get(key: ArrayBuffer): ArrayBuffer | undefined;
+  /**
+   * Look up several keys at once, returning their values (or `undefined`)
+   * in the same order.
+   */
+  getMany(keys: ArrayBuffer[]): (ArrayBuffer | undefined)[];
   getVersionOfPreviousWrite(key: ArrayBuffer): number | undefined;
   set(key: ArrayBuffer, value: ArrayBuffer): KvMap;
   delete(key: ArrayBuffer): void;
@@ -46,6 +52,17 @@ export interface KvMap {
   forEach(
     callback: (value: ArrayBuffer, key: ArrayBuffer, kvmap: KvMap) => void,
   ): void;
+  /**
+   * Like `forEach`, but only visits entries whose keys are in `[from, to)`,
+   * in increasing bytewise order of keys. Either bound may be omitted.
+   * Each value is read when its entry is visited, so entries removed by the
+   * callback are skipped, and entries it adds are not visited.
+   */
+  range(
+    callback: (value: ArrayBuffer, key: ArrayBuffer, kvmap: KvMap) => void,
+    from?: ArrayBuffer,
+    to?: ArrayBuffer,
+  ): void;
   size: number;
 }
 
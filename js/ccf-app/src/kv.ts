@@ -56,6 +56,11 @@ export class TypedKvMap<K, V> {
     return v === undefined ? undefined : this.vt.decode(v);
   }
 
+  getMany(keys: K[]): (V | undefined)[] {
+    const vs = this.kv.getMany(keys.map((key) => this.kt.encode(key)));
+    return vs.map((v) => (v === undefined ? undefined : this.vt.decode(v)));
+  }
+
   getVersionOfPreviousWrite(key: K): number | undefined {
     return this.kv.getVersionOfPreviousWrite(this.kt.encode(key));
   }
@@ -86,6 +91,27 @@ export class TypedKvMap<K, V> {
     });
   }
 
+  /**
+   * Visits entries whose keys are in `[from, to)`, in increasing order of
+   * their encoded keys. Either bound may be omitted.
+   */
+  range(
+    callback: (value: V, key: K, table: TypedKvMap<K, V>) => void,
+    from?: K,
+    to?: K,
+  ): void {
+    let kt = this.kt;
+    let vt = this.vt;
+    let typedMap = this;
+    this.kv.range(
+      function (raw_v: ArrayBuffer, raw_k: ArrayBuffer, table: KvMap) {
+        callback(vt.decode(raw_v), kt.decode(raw_k), typedMap);
+      },
+      from === undefined ? undefined : kt.encode(from),
+      to === undefined ? undefined : kt.encode(to),
+    );
+  }
+
   get size(): number {
     return this.kv.size;
   }
@@ -52,6 +52,9 @@ class KvMapPolyfill implements KvMap {
   get(key: ArrayBuffer): ArrayBuffer | undefined {
     return this.map.get(base64(key));
   }
+  getMany(keys: ArrayBuffer[]): (ArrayBuffer | undefined)[] {
+    return keys.map((key) => this.get(key));
+  }
   getVersionOfPreviousWrite(key: ArrayBuffer): number | undefined {
     throw new Error("Not implemented");
   }
@@ -72,6 +75,29 @@ class KvMapPolyfill implements KvMap {
       callback(value, unbase64(key), this);
     });
   }
+  range(
+    callback: (value: ArrayBuffer, key: ArrayBuffer, kvmap: KvMap) => void,
+    from?: ArrayBuffer,
+    to?: ArrayBuffer,
+  ): void {
+    const keys: ArrayBuffer[] = [];
+    this.map.forEach((_, key) => {
+      const rawKey = unbase64(key);
+      if (
+        (from === undefined || compareBytes(rawKey, from) >= 0) &&
+        (to === undefined || compareBytes(rawKey, to) < 0)
+      ) {
+        keys.push(rawKey);
+      }
+    });
+    keys.sort(compareBytes);
+    for (const key of keys) {
+      const value = this.get(key);
+      if (value !== undefined) {
+        callback(value, key, this);
+      }
+    }
+  }
   get size(): number {
     return this.map.size;
   }
@@ -661,3 +687,7 @@ function base64(buf: ArrayBuffer): string {
 function unbase64(s: string): ArrayBuffer {
   return nodeBufToArrBuf(Buffer.from(s, "base64"));
 }
+
+function compareBytes(a: ArrayBuffer, b: ArrayBuffer): number {
+  return Buffer.compare(Buffer.from(a), Buffer.from(b));
+}
@@ -62,6 +62,45 @@ describe("typedKv", function () {
     foo.clear();
     assert.equal(foo.size, 0);
   });
+
+  it("getMany", function () {
+    foo.set(key, val);
+    assert.deepEqual(foo.getMany([key2, key, key]), [undefined, val, val]);
+    assert.deepEqual(foo.getMany([]), []);
+    foo.clear();
+  });
+
+  it("range", function () {
+    for (const k of ["d", "b", "a", "c"]) {
+      foo.set(k, k.charCodeAt(0));
+    }
+    const visit = (from?: string, to?: string) => {
+      const keys: string[] = [];
+      foo.range(
+        (v, k) => {
+          assert.equal(v, k.charCodeAt(0));
+          keys.push(k);
+        },
+        from,
+        to,
+      );
+      return keys;
+    };
+    assert.deepEqual(visit(), ["a", "b", "c", "d"]);
+    assert.deepEqual(visit("b"), ["b", "c", "d"]);
+    assert.deepEqual(visit(undefined, "c"), ["a", "b"]);
+    assert.deepEqual(visit("b", "d"), ["b", "c"]);
+    assert.deepEqual(visit("c", "c"), []);
+
+    const visited: string[] = [];
+    foo.range((_, k) => {
+      visited.push(k);
+      foo.delete("c");
+      foo.set("e", 0);
+    });
+    assert.deepEqual(visited, ["a", "b", "d"]);
+    foo.clear();
+  });
 });
 
 describe("typedKvSet", function () {
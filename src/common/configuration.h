@@ -89,12 +89,14 @@ namespace ccf
   DECLARE_JSON_OPTIONAL_FIELDS(
     CCFConfig,
     worker_threads,
+    work_stealing,
     node_certificate,
     consensus,
     ledger_signatures,
     jwt,
     attestation,
     node_to_node_message_limit,
+    node_to_node_message_batching,
     historical_cache_soft_limit);
 
   DECLARE_JSON_TYPE(StartupConfig::Start);
@@ -113,7 +115,7 @@ namespace ccf
   DECLARE_JSON_REQUIRED_FIELDS(
     StartupConfig::Recover, previous_service_identity);
 
-  DECLARE_JSON_TYPE_WITH_BASE(StartupConfig, CCFConfig);
+  DECLARE_JSON_TYPE_WITH_BASE_AND_OPTIONAL_FIELDS(StartupConfig, CCFConfig);
   DECLARE_JSON_REQUIRED_FIELDS(
     StartupConfig,
     startup_host_time,
@@ -126,4 +128,5 @@ namespace ccf
     start,
     join,
     recover);
+  DECLARE_JSON_OPTIONAL_FIELDS(StartupConfig, snapshot_max_delta_chain_length);
 }
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ds/thread_messaging.h"
+#include "kv/kv_types.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace aft
+{
+  // Prepares (decrypts and parses) a batch of received entries, which must
+  // then be applied strictly in order. Worker threads, if any, prepare
+  // entries in parallel, while the applying thread waits for each entry in
+  // turn, preparing entries itself rather than idling whenever some remain
+  // unclaimed.
+  class EntryPreparer
+  {
+  public:
+    using EntryPtr = std::shared_ptr<ccf::kv::AbstractExecutionWrapper>;
+
+  private:
+    // Shared with the worker tasks, which may outlive the preparer if the
+    // batch is abandoned (e.g. when an entry fails to apply). Entries may
+    // borrow their data from the received message, so no entry is prepared
+    // once the preparer is destroyed.
+    struct Batch
+    {
+      std::vector<EntryPtr> entries;
+      std::unique_ptr<std::atomic<bool>[]> prepared;
+      std::atomic<size_t> next_to_prepare = 0;
+
+      Batch(std::vector<EntryPtr>&& entries_) :
+        entries(std::move(entries_)),
+        prepared(std::make_unique<std::atomic<bool>[]>(entries.size()))
+      {}
+
+      // Claims and prepares the next unclaimed entry. Returns false if all
+      // entries have already been claimed
+      bool prepare_next()
+      {
+        const auto idx = next_to_prepare.fetch_add(1);
+        if (idx >= entries.size())
+        {
+          return false;
+        }
+
+        entries[idx]->prepare();
+        prepared[idx].store(true);
+        return true;
+      }
+    };
+
+    std::shared_ptr<Batch> batch;
+
+    struct PrepareMsg
+    {
+      std::shared_ptr<Batch> batch;
+
+      PrepareMsg(const std::shared_ptr<Batch>& batch_) : batch(batch_) {}
+    };
+
+    static void prepare_cb(std::unique_ptr<::threading::Tmsg<PrepareMsg>> msg)
+    {
+      while (msg->data.batch->prepare_next())
+      {
+      }
+    }
+
+  public:
+    EntryPreparer(std::vector<EntryPtr>&& entries) :
+      batch(std::make_shared<Batch>(std::move(entries)))
+    {
+      auto& tm = ::threading::ThreadMessaging::instance();
+      const size_t workers_count = tm.thread_count() - 1;
+      if (workers_count == 0 || batch->entries.size() < 2)
+      {
+        return;
+      }
+
+      // The applying thread prepares the first entry itself
+      const auto tasks_count =
+        std::min(workers_count, batch->entries.size() - 1);
+      for (size_t i = 0; i < tasks_count; ++i)
+      {
+        tm.add_stealable_task(
+          tm.get_execution_thread(i),
+          std::make_unique<::threading::Tmsg<PrepareMsg>>(&prepare_cb, batch));
+      }
+    }
+
+    ~EntryPreparer()
+    {
+      // Entries which have not yet been claimed will not be applied, so don't
+      // prepare them, but wait for those already being prepared by workers
+      const auto size = batch->entries.size();
+      const auto claimed =
+        std::min(batch->next_to_prepare.exchange(size), size);
+      for (size_t idx = 0; idx < claimed; ++idx)
+      {
+        while (!batch->prepared[idx].load())
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    // Returns once the entry at idx has been prepared (successfully or not).
+    // Entries must be waited for in order.
+    void wait_for(size_t idx)
+    {
+      while (!batch->prepared[idx].load())
+      {
+        if (!batch->prepare_next())
+        {
+          // The entry is being prepared by a worker
+          std::this_thread::yield();
+        }
+      }
+    }
+  };
+}
@@ -9,6 +9,7 @@
 #include "ccf/tx_id.h"
 #include "ccf/tx_status.h"
 #include "ds/serialized.h"
+#include "impl/entry_preparer.h"
 #include "impl/state.h"
 #include "kv/kv_types.h"
 #include "node/node_client.h"
@@ -185,6 +186,11 @@ namespace aft
 
     size_t entry_size_not_limited = 0;
     size_t entry_count = 0;
+
+    // Entries received in AppendEntries, and the bytes copied out of them when
+    // they were applied
+    size_t entries_received = 0;
+    size_t entry_bytes_copied = 0;
     Index entries_batch_size = 20;
     static constexpr int batch_window_size = 100;
     int batch_window_sum = 0;
@@ -629,6 +635,8 @@ namespace aft
           v.match_idx, static_cast<size_t>(v.last_ack_timeout.count())};
       }
       details.reconfiguration_type = reconfiguration_type;
+      details.entries_received = entries_received;
+      details.entry_bytes_copied = entry_bytes_copied;
       return details;
     }
 
@@ -745,7 +753,10 @@ namespace aft
     }
 
     void recv_message(
-      const ccf::NodeId& from, const uint8_t* data, size_t size) override
+      const ccf::NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false) override
     {
       RaftMsgType type = serialized::peek<RaftMsgType>(data, size);
 
@@ -757,7 +768,7 @@ namespace aft
           {
             AppendEntries r =
               channels->template recv_authenticated<AppendEntries>(
-                from, data, size);
+                from, data, size, pre_authenticated);
             recv_append_entries(from, r, data, size);
             break;
           }
@@ -766,7 +777,7 @@ namespace aft
           {
             AppendEntriesResponse r =
               channels->template recv_authenticated<AppendEntriesResponse>(
-                from, data, size);
+                from, data, size, pre_authenticated);
             recv_append_entries_response(from, r);
             break;
           }
@@ -774,7 +785,7 @@ namespace aft
           case raft_request_vote:
           {
             RequestVote r = channels->template recv_authenticated<RequestVote>(
-              from, data, size);
+              from, data, size, pre_authenticated);
             recv_request_vote(from, r);
             break;
           }
@@ -783,7 +794,7 @@ namespace aft
           {
             RequestVoteResponse r =
               channels->template recv_authenticated<RequestVoteResponse>(
-                from, data, size);
+                from, data, size, pre_authenticated);
             recv_request_vote_response(from, r);
             break;
           }
@@ -792,7 +803,7 @@ namespace aft
           {
             ProposeRequestVote r =
               channels->template recv_authenticated<ProposeRequestVote>(
-                from, data, size);
+                from, data, size, pre_authenticated);
             recv_propose_request_vote(from, r);
             break;
           }
@@ -1217,7 +1228,7 @@ namespace aft
         r.prev_idx);
 
       std::vector<std::tuple<
-        std::unique_ptr<ccf::kv::AbstractExecutionWrapper>,
+        std::shared_ptr<ccf::kv::AbstractExecutionWrapper>,
         ccf::kv::Version>>
         append_entries;
       // Finally, deserialise each entry in the batch
@@ -1283,10 +1294,12 @@ namespace aft
           }
         }
 
-        std::vector<uint8_t> entry;
+        // Entries are deserialised in place, and remain valid until the
+        // batch has been applied, within this call
+        std::span<const uint8_t> entry;
         try
         {
-          entry = LedgerProxy::get_entry(data, size);
+          entry = LedgerProxy::get_entry_view(data, size);
         }
         catch (const std::logic_error& e)
         {
@@ -1301,7 +1314,8 @@ namespace aft
         }
 
         ccf::kv::TxID expected{r.term_of_idx, i};
-        auto ds = store->deserialize(entry, public_only, expected);
+        auto ds = store->deserialize(
+          ccf::kv::EntryView(entry), public_only, expected);
         if (ds == nullptr)
         {
           RAFT_FAIL_FMT(
@@ -1313,6 +1327,7 @@ namespace aft
           return;
         }
 
+        ++entries_received;
         append_entries.push_back(std::make_tuple(std::move(ds), i));
       }
 
@@ -1322,14 +1337,26 @@ namespace aft
 
     void execute_append_entries_sync(
       std::vector<std::tuple<
-        std::unique_ptr<ccf::kv::AbstractExecutionWrapper>,
+        std::shared_ptr<ccf::kv::AbstractExecutionWrapper>,
         ccf::kv::Version>>&& append_entries,
       const ccf::NodeId& from,
       AppendEntries&& r)
     {
-      for (auto& ae : append_entries)
+      // Entries are decrypted and parsed in parallel across worker threads
+      // (when there are any), but still applied in order
+      std::vector<EntryPreparer::EntryPtr> entries;
+      entries.reserve(append_entries.size());
+      for (const auto& ae : append_entries)
       {
-        auto& [ds, i] = ae;
+        entries.push_back(std::get<0>(ae));
+      }
+      EntryPreparer preparer(std::move(entries));
+
+      for (size_t idx = 0; idx < append_entries.size(); ++idx)
+      {
+        preparer.wait_for(idx);
+
+        auto& [ds, i] = append_entries[idx];
         RAFT_DEBUG_FMT("Replicating on follower {}: {}", state->node_id, i);
 
 #ifdef CCF_RAFT_TRACING
@@ -1351,6 +1378,7 @@ namespace aft
           return;
         }
         state->last_idx = i;
+        entry_bytes_copied += ds->get_bytes_copied();
 
         for (auto& hook : ds->get_hooks())
         {
@@ -1364,10 +1392,14 @@ namespace aft
           start_ticking_if_necessary();
         }
 
-        const auto& entry = ds->get_entry();
+        const auto entry = ds->get_entry();
 
         ledger->put_entry(
-          entry, globally_committable, ds->get_term(), ds->get_index());
+          entry.data(),
+          entry.size(),
+          globally_committable,
+          ds->get_term(),
+          ds->get_index());
 
         switch (apply_success)
         {
@@ -38,7 +38,7 @@ namespace aft
       const ccf::kv::TxID& tx_id, Term term_of_next_version) = 0;
     virtual void initialise_term(Term t) = 0;
     virtual std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
-      const std::vector<uint8_t> data,
+      const ccf::kv::EntryView& entry,
       bool public_only = false,
       const std::optional<ccf::kv::TxID>& expected_txid = std::nullopt) = 0;
   };
@@ -81,14 +81,14 @@ namespace aft
     }
 
     std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
-      const std::vector<uint8_t> data,
+      const ccf::kv::EntryView& entry,
       bool public_only = false,
       const std::optional<ccf::kv::TxID>& expected_txid = std::nullopt) override
     {
       auto p = x.lock();
       if (p)
       {
-        return p->deserialize(data, public_only, expected_txid);
+        return p->deserialize(entry, public_only, expected_txid);
       }
       return nullptr;
     }
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+
+#include "consensus/aft/impl/entry_preparer.h"
+#include "crypto/openssl/hash.h"
+#include "kv/store.h"
+#include "kv/test/stub_consensus.h"
+#include "node/encryptor.h"
+
+#include <picobench/picobench.hpp>
+#include <thread>
+
+std::unique_ptr<threading::ThreadMessaging>
+  threading::ThreadMessaging::singleton = nullptr;
+
+using MapType = ccf::kv::Map<size_t, std::vector<uint8_t>>;
+
+static constexpr size_t writes_per_tx = 8;
+static constexpr size_t value_size = 256;
+
+// Measures the rate at which a backup applies a batch of received entries
+// (private, so each must be decrypted), with entries prepared in parallel
+// across WORKERS worker threads
+template <uint16_t WORKERS>
+static void catch_up(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  ::threading::ThreadMessaging::init(WORKERS + 1);
+
+  auto secrets = std::make_shared<ccf::LedgerSecrets>();
+  secrets->init();
+  auto encryptor = std::make_shared<ccf::NodeEncryptor>(secrets);
+
+  ccf::kv::Store primary;
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  primary.set_consensus(consensus);
+  primary.set_encryptor(encryptor);
+
+  MapType map("map");
+  const std::vector<uint8_t> value(value_size, 42);
+  for (size_t i = 0; i < s.iterations(); ++i)
+  {
+    auto tx = primary.create_tx();
+    auto handle = tx.rw(map);
+    for (size_t k = 0; k < writes_per_tx; ++k)
+    {
+      handle->put(i * writes_per_tx + k, value);
+    }
+    if (tx.commit() != ccf::kv::CommitResult::SUCCESS)
+    {
+      throw std::logic_error("Transaction commit failed");
+    }
+  }
+
+  ccf::kv::Store backup;
+  backup.set_encryptor(encryptor);
+
+  std::atomic<bool> done = false;
+  std::vector<std::thread> workers;
+  for (uint16_t tid = 1; tid <= WORKERS; ++tid)
+  {
+    workers.emplace_back([&done, tid]() {
+      while (!done.load())
+      {
+        if (!::threading::ThreadMessaging::instance().run_one(tid))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  s.start_timer();
+  std::vector<aft::EntryPreparer::EntryPtr> entries;
+  entries.reserve(s.iterations());
+  for (const auto& [version, data, committable, hooks] : consensus->replica)
+  {
+    entries.push_back(backup.deserialize(*data));
+  }
+  auto applying = entries;
+  aft::EntryPreparer preparer(std::move(entries));
+  for (size_t i = 0; i < applying.size(); ++i)
+  {
+    preparer.wait_for(i);
+    if (applying[i]->apply() == ccf::kv::ApplyResult::FAIL)
+    {
+      throw std::logic_error("Transaction deserialisation failed");
+    }
+  }
+  s.stop_timer();
+
+  done = true;
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
+
+const std::vector<int> entry_counts = {1000, 10000};
+
+PICOBENCH_SUITE("catch_up");
+PICOBENCH(catch_up<0>).iterations(entry_counts).samples(10).baseline();
+PICOBENCH(catch_up<2>).iterations(entry_counts).samples(10);
+PICOBENCH(catch_up<4>).iterations(entry_counts).samples(10);
+PICOBENCH(catch_up<8>).iterations(entry_counts).samples(10);
+
+int main(int argc, char** argv)
+{
+  ccf::crypto::openssl_sha256_init();
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  return runner.run();
+}
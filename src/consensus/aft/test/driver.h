@@ -44,6 +44,7 @@ std::string stringify(const std::optional<std::vector<uint8_t>>& o)
 struct LedgerStubProxy_Mermaid : public aft::LedgerStubProxy
 {
   using LedgerStubProxy::LedgerStubProxy;
+  using LedgerStubProxy::put_entry;
 
   void put_entry(
     const std::vector<uint8_t>& data,
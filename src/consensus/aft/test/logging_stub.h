@@ -8,6 +8,7 @@
 
 #include <map>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace aft
@@ -63,6 +64,20 @@ namespace aft
       ledger.push_back(combined);
     }
 
+    void put_entry(
+      const uint8_t* data,
+      size_t size,
+      bool globally_committable,
+      ccf::kv::Term term,
+      ccf::kv::Version index)
+    {
+      put_entry(
+        std::vector<uint8_t>(data, data + size),
+        globally_committable,
+        term,
+        index);
+    }
+
     void skip_entry(const uint8_t*& data, size_t& size)
     {
       get_entry(data, size);
@@ -70,9 +85,16 @@ namespace aft
     }
 
     static std::vector<uint8_t> get_entry(const uint8_t*& data, size_t& size)
+    {
+      const auto entry = get_entry_view(data, size);
+      return {entry.begin(), entry.end()};
+    }
+
+    static std::span<const uint8_t> get_entry_view(
+      const uint8_t*& data, size_t& size)
     {
       const auto entry_size = serialized::read<size_t>(data, size);
-      std::vector<uint8_t> entry(data, data + entry_size);
+      std::span<const uint8_t> entry(data, entry_size);
       serialized::skip(data, size, entry_size);
       return entry;
     }
@@ -223,12 +245,24 @@ namespace aft
       return true;
     }
 
+    void recv_pre_authenticated(const uint8_t*& data, size_t& size) override
+    {}
+
     bool recv_channel_message(
       const ccf::NodeId& from, const uint8_t* data, size_t size) override
     {
       return true;
     }
 
+    bool recv_batched_messages(
+      const ccf::NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      const BatchedMessageHandler& handler) override
+    {
+      return true;
+    }
+
     void initialize(
       const ccf::NodeId& self_id,
       const ccf::crypto::Pem& service_cert,
@@ -255,6 +289,7 @@ namespace aft
     }
 
     void set_message_limit(size_t message_limit) override {}
+    void set_message_batching(bool batching) override {}
     void set_idle_timeout(std::chrono::milliseconds idle_timeout) override {}
 
     void tick(std::chrono::milliseconds elapsed) override {}
@@ -373,7 +408,7 @@ namespace aft
 
     public:
       ExecutionWrapper(
-        const std::vector<uint8_t>& data_,
+        std::span<const uint8_t> data_,
         const std::optional<ccf::kv::TxID>& expected_txid,
         ccf::kv::ConsensusHookPtrs&& hooks_) :
         hooks(std::move(hooks_))
@@ -419,7 +454,7 @@ namespace aft
         return hooks;
       }
 
-      const std::vector<uint8_t>& get_entry() override
+      std::span<const uint8_t> get_entry() override
       {
         return entry;
       }
@@ -451,13 +486,13 @@ namespace aft
     };
 
     virtual std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
-      const std::vector<uint8_t>& data,
+      const ccf::kv::EntryView& entry,
       bool public_only = false,
       const std::optional<ccf::kv::TxID>& expected_txid = std::nullopt)
     {
       ccf::kv::ConsensusHookPtrs hooks = {};
       return std::make_unique<ExecutionWrapper>(
-        data, expected_txid, std::move(hooks));
+        entry.data, expected_txid, std::move(hooks));
     }
 
     bool flag_enabled(ccf::kv::AbstractStore::Flag)
@@ -516,14 +551,14 @@ namespace aft
     }
 
     virtual std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
-      const std::vector<uint8_t>& data,
+      const ccf::kv::EntryView& entry,
       bool public_only = false,
       const std::optional<ccf::kv::TxID>& expected_txid = std::nullopt) override
     {
       // Set reconfiguration hook if there are any new nodes
       // Read wrapping term and version
-      auto data_ = data.data();
-      auto size = data.size();
+      auto data_ = entry.data.data();
+      auto size = entry.data.size();
       const auto committable = serialized::read<bool>(data_, size);
       serialized::read<aft::Term>(data_, size);
       auto version = serialized::read<ccf::kv::Version>(data_, size);
@@ -545,7 +580,7 @@ namespace aft
       }
 
       return std::make_unique<ExecutionWrapper>(
-        data, expected_txid, std::move(hooks));
+        entry.data, expected_txid, std::move(hooks));
     }
   };
 
@@ -8,6 +8,8 @@
 #include "kv/kv_types.h"
 #include "kv/serialised_entry_format.h"
 
+#include <span>
+
 namespace consensus
 {
   class LedgerEnclave
@@ -24,11 +26,27 @@ namespace consensus
      * @return Raw entry as a vector
      */
     static std::vector<uint8_t> get_entry(const uint8_t*& data, size_t& size)
+    {
+      const auto entry = get_entry_view(data, size);
+      return {entry.begin(), entry.end()};
+    }
+
+    /**
+     * Retrieve a single entry without copying it, advancing offset to the
+     * next entry.
+     *
+     * @param data Serialised entries
+     * @param size Size of overall serialised entries
+     *
+     * @return Raw entry, as a view into the serialised entries
+     */
+    static std::span<const uint8_t> get_entry_view(
+      const uint8_t*& data, size_t& size)
     {
       auto header =
         serialized::peek<ccf::kv::SerialisedEntryHeader>(data, size);
       size_t entry_size = ccf::kv::serialised_entry_header_size + header.size;
-      std::vector<uint8_t> entry(data, data + entry_size);
+      std::span<const uint8_t> entry(data, entry_size);
       serialized::skip(data, size, entry_size);
       return entry;
     }
@@ -33,12 +33,11 @@ namespace consensus
     DEFINE_RINGBUFFER_MSG_TYPE(ledger_init),
     DEFINE_RINGBUFFER_MSG_TYPE(ledger_open),
 
-    /// Ask for host memory allocation and commit a snapshot. Enclave -> Host
-    DEFINE_RINGBUFFER_MSG_TYPE(snapshot_allocate),
+    /// Stream a snapshot to the host in fixed-size chunks and commit it.
+    /// Enclave -> Host
+    DEFINE_RINGBUFFER_MSG_TYPE(snapshot_begin),
+    DEFINE_RINGBUFFER_MSG_TYPE(snapshot_chunk),
     DEFINE_RINGBUFFER_MSG_TYPE(snapshot_commit),
-
-    /// Host -> Enclave
-    DEFINE_RINGBUFFER_MSG_TYPE(snapshot_allocated),
   };
 }
 
@@ -71,15 +70,15 @@ DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ::consensus::ledger_commit, ::consensus::Index);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(::consensus::ledger_open);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
-  ::consensus::snapshot_allocate,
+  ::consensus::snapshot_begin,
   ::consensus::Index /* snapshot idx */,
   ::consensus::Index /* evidence idx */,
-  size_t /* size to allocate */,
-  uint32_t /* unique request id */);
+  size_t /* total snapshot size */,
+  ::consensus::Index /* base snapshot idx of delta snapshot, 0 if full */);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
-  ::consensus::snapshot_allocated,
-  std::span<uint8_t>, /* span to host-allocated memory for snapshot */
-  uint32_t /* unique request id */);
+  ::consensus::snapshot_chunk,
+  ::consensus::Index /* snapshot idx */,
+  std::vector<uint8_t> /* snapshot chunk */);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   ::consensus::snapshot_commit,
   ::consensus::Index /* snapshot idx */,
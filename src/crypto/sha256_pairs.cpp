@@ -0,0 +1,499 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+
+#include "crypto/sha256_pairs.h"
+
+#include "crypto/openssl/hash.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#  include <cpuid.h>
+#  include <immintrin.h>
+#  define CCF_SHA256_PAIRS_X86
+#endif
+
+namespace ccf::crypto
+{
+  namespace
+  {
+    constexpr std::array<uint32_t, 64> K = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    constexpr std::array<uint32_t, 8> H0 = {
+      0x6a09e667,
+      0xbb67ae85,
+      0x3c6ef372,
+      0xa54ff53a,
+      0x510e527f,
+      0x9b05688c,
+      0x1f83d9ab,
+      0x5be0cd19};
+
+    constexpr uint32_t rotr(uint32_t x, int n)
+    {
+      return (x >> n) | (x << (32 - n));
+    }
+
+    // The second block of a 64-byte message only holds its padding, which is
+    // the same for every message, so its message schedule is computed (and
+    // added to the round constants) once
+    constexpr std::array<uint32_t, 64> padding_schedule()
+    {
+      std::array<uint32_t, 64> w = {};
+      w[0] = 0x80000000;
+      w[15] = 64 * 8;
+      for (size_t t = 16; t < 64; ++t)
+      {
+        const auto s0 =
+          rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        const auto s1 =
+          rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+      }
+      for (size_t t = 0; t < 64; ++t)
+      {
+        w[t] += K[t];
+      }
+      return w;
+    }
+
+    constexpr std::array<uint32_t, 64> KP = padding_schedule();
+
+    void sha256_pairs_openssl(
+      size_t n,
+      const uint8_t* const* l,
+      const uint8_t* const* r,
+      uint8_t* const* out)
+    {
+      uint8_t block[sha256_pair_half_size * 2];
+      for (size_t i = 0; i < n; ++i)
+      {
+        memcpy(&block[0], l[i], sha256_pair_half_size);
+        memcpy(&block[sha256_pair_half_size], r[i], sha256_pair_half_size);
+        openssl_sha256(block, out[i]);
+      }
+    }
+
+#ifdef CCF_SHA256_PAIRS_X86
+    struct CpuFeatures
+    {
+      bool sha_ni = false;
+      bool avx2 = false;
+    };
+
+    CpuFeatures detect_cpu_features()
+    {
+      CpuFeatures features;
+
+      unsigned int eax, ebx, ecx, edx;
+      if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      {
+        return features;
+      }
+      const bool sse41 = (ecx & bit_SSE4_1) != 0;
+      const bool ssse3 = (ecx & bit_SSSE3) != 0;
+      const bool osxsave = (ecx & bit_OSXSAVE) != 0;
+      const bool avx = (ecx & bit_AVX) != 0;
+
+      // AVX2 also requires the OS to save the YMM registers
+      bool ymm_enabled = false;
+      if (osxsave)
+      {
+        uint32_t xcr0_lo, xcr0_hi;
+        asm volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        ymm_enabled = (xcr0_lo & 0x6) == 0x6;
+      }
+
+      if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+      {
+        return features;
+      }
+      features.sha_ni = (ebx & bit_SHA) != 0 && sse41 && ssse3;
+      features.avx2 = (ebx & bit_AVX2) != 0 && avx && ymm_enabled;
+      return features;
+    }
+
+    const CpuFeatures& cpu_features()
+    {
+      static const CpuFeatures features = detect_cpu_features();
+      return features;
+    }
+
+    // Number of pairs whose rounds are interleaved, to hide the latency of
+    // the SHA instructions
+    static constexpr size_t sha_ni_lanes = 2;
+
+    template <size_t N>
+    __attribute__((target("sha,sse4.1,ssse3"))) void sha_ni_pairs(
+      const uint8_t* const* l, const uint8_t* const* r, uint8_t* const* out)
+    {
+      const __m128i bswap =
+        _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+      // The SHA instructions hold the state as ABEF and CDGH
+      const __m128i abef_init = _mm_set_epi32(H0[0], H0[1], H0[4], H0[5]);
+      const __m128i cdgh_init = _mm_set_epi32(H0[2], H0[3], H0[6], H0[7]);
+
+      __m128i abef[N], cdgh[N], w[N][4];
+      for (size_t i = 0; i < N; ++i)
+      {
+        abef[i] = abef_init;
+        cdgh[i] = cdgh_init;
+        w[i][0] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(l[i])), bswap);
+        w[i][1] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(l[i] + 16)), bswap);
+        w[i][2] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(r[i])), bswap);
+        w[i][3] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(r[i] + 16)), bswap);
+      }
+
+      // First block: the message itself. Each step runs 4 rounds, w[i][g % 4]
+      // holding the 4 message words of step g once it has been scheduled.
+      // Unrolling keeps the message words in registers.
+#pragma GCC unroll 16
+      for (size_t g = 0; g < 16; ++g)
+      {
+        const __m128i k =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * g]));
+        for (size_t i = 0; i < N; ++i)
+        {
+          if (g >= 4)
+          {
+            auto tmp = _mm_sha256msg1_epu32(w[i][g % 4], w[i][(g + 1) % 4]);
+            tmp = _mm_add_epi32(
+              tmp, _mm_alignr_epi8(w[i][(g + 3) % 4], w[i][(g + 2) % 4], 4));
+            w[i][g % 4] = _mm_sha256msg2_epu32(tmp, w[i][(g + 3) % 4]);
+          }
+          auto msg = _mm_add_epi32(w[i][g % 4], k);
+          cdgh[i] = _mm_sha256rnds2_epu32(cdgh[i], abef[i], msg);
+          msg = _mm_shuffle_epi32(msg, 0x0E);
+          abef[i] = _mm_sha256rnds2_epu32(abef[i], cdgh[i], msg);
+        }
+      }
+
+      __m128i abef_mid[N], cdgh_mid[N];
+      for (size_t i = 0; i < N; ++i)
+      {
+        abef[i] = abef_mid[i] = _mm_add_epi32(abef[i], abef_init);
+        cdgh[i] = cdgh_mid[i] = _mm_add_epi32(cdgh[i], cdgh_init);
+      }
+
+      // Second block: the padding, whose schedule is precomputed
+#pragma GCC unroll 16
+      for (size_t g = 0; g < 16; ++g)
+      {
+        const __m128i kp =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(&KP[4 * g]));
+        const __m128i kp_hi = _mm_shuffle_epi32(kp, 0x0E);
+        for (size_t i = 0; i < N; ++i)
+        {
+          cdgh[i] = _mm_sha256rnds2_epu32(cdgh[i], abef[i], kp);
+          abef[i] = _mm_sha256rnds2_epu32(abef[i], cdgh[i], kp_hi);
+        }
+      }
+
+      for (size_t i = 0; i < N; ++i)
+      {
+        const auto feba =
+          _mm_shuffle_epi32(_mm_add_epi32(abef[i], abef_mid[i]), 0x1B);
+        const auto dchg =
+          _mm_shuffle_epi32(_mm_add_epi32(cdgh[i], cdgh_mid[i]), 0xB1);
+        const auto abcd = _mm_blend_epi16(feba, dchg, 0xF0);
+        const auto efgh = _mm_alignr_epi8(dchg, feba, 8);
+        _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out[i]), _mm_shuffle_epi8(abcd, bswap));
+        _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out[i] + 16),
+          _mm_shuffle_epi8(efgh, bswap));
+      }
+    }
+
+    void sha256_pairs_sha_ni(
+      size_t n,
+      const uint8_t* const* l,
+      const uint8_t* const* r,
+      uint8_t* const* out)
+    {
+      size_t i = 0;
+      for (; i + sha_ni_lanes <= n; i += sha_ni_lanes)
+      {
+        sha_ni_pairs<sha_ni_lanes>(l + i, r + i, out + i);
+      }
+      for (; i < n; ++i)
+      {
+        sha_ni_pairs<1>(l + i, r + i, out + i);
+      }
+    }
+
+    static constexpr size_t avx2_lanes = 8;
+
+    template <int N>
+    __attribute__((target("avx2"))) inline __m256i rotr_x8(__m256i x)
+    {
+      return _mm256_or_si256(
+        _mm256_srli_epi32(x, N), _mm256_slli_epi32(x, 32 - N));
+    }
+
+    // Transposes 8 rows of 8 32-bit words, so that v[j] holds word j of each
+    // row
+    __attribute__((target("avx2"))) inline void transpose_x8(__m256i* v)
+    {
+      __m256i t[8], u[8];
+      for (size_t i = 0; i < 8; i += 2)
+      {
+        t[i] = _mm256_unpacklo_epi32(v[i], v[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(v[i], v[i + 1]);
+      }
+      for (size_t i = 0; i < 8; i += 4)
+      {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+      }
+      for (size_t i = 0; i < 4; ++i)
+      {
+        v[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        v[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+      }
+    }
+
+    // Runs the 64 rounds of one block for 8 messages, one per lane. If
+    // PADDING, the block is the padding of a 64-byte message and w is unused.
+    template <bool PADDING>
+    __attribute__((target("avx2"))) inline void compress_x8(
+      __m256i* state, __m256i* w)
+    {
+      auto a = state[0], b = state[1], c = state[2], d = state[3];
+      auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+      for (size_t t = 0; t < 64; ++t)
+      {
+        __m256i wk;
+        if constexpr (PADDING)
+        {
+          wk = _mm256_set1_epi32(KP[t]);
+        }
+        else
+        {
+          if (t >= 16)
+          {
+            const auto w15 = w[(t - 15) % 16];
+            const auto w2 = w[(t - 2) % 16];
+            const auto s0 = _mm256_xor_si256(
+              _mm256_xor_si256(rotr_x8<7>(w15), rotr_x8<18>(w15)),
+              _mm256_srli_epi32(w15, 3));
+            const auto s1 = _mm256_xor_si256(
+              _mm256_xor_si256(rotr_x8<17>(w2), rotr_x8<19>(w2)),
+              _mm256_srli_epi32(w2, 10));
+            w[t % 16] = _mm256_add_epi32(
+              _mm256_add_epi32(w[t % 16], s0),
+              _mm256_add_epi32(w[(t - 7) % 16], s1));
+          }
+          wk = _mm256_add_epi32(w[t % 16], _mm256_set1_epi32(K[t]));
+        }
+
+        const auto s1 = _mm256_xor_si256(
+          _mm256_xor_si256(rotr_x8<6>(e), rotr_x8<11>(e)), rotr_x8<25>(e));
+        const auto ch =
+          _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        const auto t1 = _mm256_add_epi32(
+          _mm256_add_epi32(h, s1), _mm256_add_epi32(ch, wk));
+        const auto s0 = _mm256_xor_si256(
+          _mm256_xor_si256(rotr_x8<2>(a), rotr_x8<13>(a)), rotr_x8<22>(a));
+        const auto maj = _mm256_or_si256(
+          _mm256_and_si256(a, b),
+          _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        const auto t2 = _mm256_add_epi32(s0, maj);
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+      }
+
+      state[0] = _mm256_add_epi32(state[0], a);
+      state[1] = _mm256_add_epi32(state[1], b);
+      state[2] = _mm256_add_epi32(state[2], c);
+      state[3] = _mm256_add_epi32(state[3], d);
+      state[4] = _mm256_add_epi32(state[4], e);
+      state[5] = _mm256_add_epi32(state[5], f);
+      state[6] = _mm256_add_epi32(state[6], g);
+      state[7] = _mm256_add_epi32(state[7], h);
+    }
+
+    __attribute__((target("avx2"))) void avx2_pairs(
+      const uint8_t* const* l, const uint8_t* const* r, uint8_t* const* out)
+    {
+      const __m256i bswap = _mm256_set_epi64x(
+        0x0c0d0e0f08090a0bULL,
+        0x0405060700010203ULL,
+        0x0c0d0e0f08090a0bULL,
+        0x0405060700010203ULL);
+
+      __m256i w[16];
+      for (size_t i = 0; i < avx2_lanes; ++i)
+      {
+        w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(l[i]));
+        w[i + 8] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r[i]));
+      }
+      transpose_x8(&w[0]);
+      transpose_x8(&w[8]);
+      for (auto& word : w)
+      {
+        word = _mm256_shuffle_epi8(word, bswap);
+      }
+
+      __m256i state[8];
+      for (size_t j = 0; j < 8; ++j)
+      {
+        state[j] = _mm256_set1_epi32(H0[j]);
+      }
+      compress_x8<false>(state, w);
+      compress_x8<true>(state, nullptr);
+
+      transpose_x8(state);
+      for (size_t i = 0; i < avx2_lanes; ++i)
+      {
+        _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out[i]),
+          _mm256_shuffle_epi8(state[i], bswap));
+      }
+    }
+
+    // Below this many pairs, hashing them one at a time is faster than
+    // filling the 8 lanes
+    static constexpr size_t avx2_min_pairs = 4;
+
+    void sha256_pairs_avx2(
+      size_t n,
+      const uint8_t* const* l,
+      const uint8_t* const* r,
+      uint8_t* const* out)
+    {
+      size_t i = 0;
+      for (; i + avx2_lanes <= n; i += avx2_lanes)
+      {
+        avx2_pairs(l + i, r + i, out + i);
+      }
+
+      const auto remaining = n - i;
+      if (remaining == 0)
+      {
+        return;
+      }
+      if (remaining < avx2_min_pairs)
+      {
+        sha256_pairs_openssl(remaining, l + i, r + i, out + i);
+        return;
+      }
+
+      // Fill the unused lanes with copies of the first pair, whose results
+      // are discarded
+      uint8_t discarded[sha256_pair_half_size];
+      const uint8_t* lanes_l[avx2_lanes];
+      const uint8_t* lanes_r[avx2_lanes];
+      uint8_t* lanes_out[avx2_lanes];
+      for (size_t j = 0; j < avx2_lanes; ++j)
+      {
+        const bool used = j < remaining;
+        lanes_l[j] = l[used ? i + j : i];
+        lanes_r[j] = r[used ? i + j : i];
+        lanes_out[j] = used ? out[i + j] : discarded;
+      }
+      avx2_pairs(lanes_l, lanes_r, lanes_out);
+    }
+#endif
+  }
+
+  bool sha256_pairs_supported(Sha256PairsBackend backend)
+  {
+    switch (backend)
+    {
+      case Sha256PairsBackend::OpenSSL:
+        return true;
+#ifdef CCF_SHA256_PAIRS_X86
+      case Sha256PairsBackend::SHA_NI:
+        return cpu_features().sha_ni;
+      case Sha256PairsBackend::AVX2:
+        return cpu_features().avx2;
+#endif
+      default:
+        return false;
+    }
+  }
+
+  Sha256PairsBackend sha256_pairs_default_backend()
+  {
+    static const Sha256PairsBackend backend = []() {
+      if (sha256_pairs_supported(Sha256PairsBackend::SHA_NI))
+      {
+        return Sha256PairsBackend::SHA_NI;
+      }
+      if (sha256_pairs_supported(Sha256PairsBackend::AVX2))
+      {
+        return Sha256PairsBackend::AVX2;
+      }
+      return Sha256PairsBackend::OpenSSL;
+    }();
+    return backend;
+  }
+
+  void sha256_pairs(
+    Sha256PairsBackend backend,
+    size_t n,
+    const uint8_t* const* l,
+    const uint8_t* const* r,
+    uint8_t* const* out)
+  {
+    if (!sha256_pairs_supported(backend))
+    {
+      throw std::logic_error(fmt::format(
+        "sha256_pairs: backend {} is not supported by this CPU",
+        static_cast<int>(backend)));
+    }
+
+    switch (backend)
+    {
+#ifdef CCF_SHA256_PAIRS_X86
+      case Sha256PairsBackend::SHA_NI:
+        sha256_pairs_sha_ni(n, l, r, out);
+        return;
+      case Sha256PairsBackend::AVX2:
+        sha256_pairs_avx2(n, l, r, out);
+        return;
+#endif
+      default:
+        sha256_pairs_openssl(n, l, r, out);
+        return;
+    }
+  }
+
+  void sha256_pairs(
+    size_t n,
+    const uint8_t* const* l,
+    const uint8_t* const* r,
+    uint8_t* const* out)
+  {
+    sha256_pairs(sha256_pairs_default_backend(), n, l, r, out);
+  }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ccf::crypto
+{
+  static constexpr size_t sha256_pair_half_size = 32;
+
+  // Implementations of sha256_pairs, selected at runtime according to the
+  // instruction set extensions supported by the CPU
+  enum class Sha256PairsBackend
+  {
+    // One pair at a time, with openssl_sha256
+    OpenSSL,
+    // Several pairs interleaved, with the SHA extensions
+    SHA_NI,
+    // 8 pairs at once, one per 32-bit lane of AVX2 registers
+    AVX2
+  };
+
+  bool sha256_pairs_supported(Sha256PairsBackend backend);
+
+  // The fastest supported backend
+  Sha256PairsBackend sha256_pairs_default_backend();
+
+  // Computes out[i] = SHA-256(l[i] || r[i]) for n independent pairs, where
+  // each of l[i], r[i] and out[i] points to 32 bytes (e.g. the children and
+  // parent of a Merkle tree node). Like openssl_sha256, which it may fall back
+  // to, openssl_sha256_init must have been called on the current thread.
+  void sha256_pairs(
+    size_t n,
+    const uint8_t* const* l,
+    const uint8_t* const* r,
+    uint8_t* const* out);
+
+  void sha256_pairs(
+    Sha256PairsBackend backend,
+    size_t n,
+    const uint8_t* const* l,
+    const uint8_t* const* r,
+    uint8_t* const* out);
+}
@@ -22,6 +22,7 @@
 #include "crypto/openssl/symmetric_key.h"
 #include "crypto/openssl/verifier.h"
 #include "crypto/openssl/x509_time.h"
+#include "crypto/sha256_pairs.h"
 
 #include <chrono>
 #include <cstring>
@@ -1193,6 +1194,61 @@ TEST_CASE("Incremental hash")
   ccf::crypto::openssl_sha256_shutdown();
 }
 
+TEST_CASE("Hash pairs")
+{
+  ccf::crypto::openssl_sha256_init();
+
+  for (auto backend :
+       {ccf::crypto::Sha256PairsBackend::OpenSSL,
+        ccf::crypto::Sha256PairsBackend::SHA_NI,
+        ccf::crypto::Sha256PairsBackend::AVX2})
+  {
+    if (!ccf::crypto::sha256_pairs_supported(backend))
+    {
+      REQUIRE_THROWS_AS(
+        ccf::crypto::sha256_pairs(backend, 0, nullptr, nullptr, nullptr),
+        std::logic_error);
+      continue;
+    }
+
+    // Cover partially filled batches of every size
+    for (size_t n = 0; n <= 33; ++n)
+    {
+      INFO(fmt::format("Backend {}, {} pairs", static_cast<int>(backend), n));
+      std::vector<uint8_t> l_data(n * ccf::crypto::sha256_pair_half_size);
+      std::vector<uint8_t> r_data(n * ccf::crypto::sha256_pair_half_size);
+      for (auto& b : l_data)
+      {
+        b = rand();
+      }
+      for (auto& b : r_data)
+      {
+        b = rand();
+      }
+
+      std::vector<ccf::crypto::Sha256Hash> hashes(n);
+      std::vector<const uint8_t*> l, r;
+      std::vector<uint8_t*> out;
+      for (size_t i = 0; i < n; ++i)
+      {
+        l.push_back(l_data.data() + i * ccf::crypto::sha256_pair_half_size);
+        r.push_back(r_data.data() + i * ccf::crypto::sha256_pair_half_size);
+        out.push_back(hashes[i].h.data());
+      }
+      ccf::crypto::sha256_pairs(backend, n, l.data(), r.data(), out.data());
+
+      for (size_t i = 0; i < n; ++i)
+      {
+        std::vector<uint8_t> block(l[i], l[i] + 32);
+        block.insert(block.end(), r[i], r[i] + 32);
+        REQUIRE(hashes[i] == ccf::crypto::Sha256Hash(block));
+      }
+    }
+  }
+
+  ccf::crypto::openssl_sha256_shutdown();
+}
+
 TEST_CASE("Sign and verify with RSA key")
 {
   const auto kp = ccf::crypto::make_rsa_key_pair();
@@ -5,11 +5,14 @@
 #include "ccf/ds/hash.h"
 #include "ds/ccf_assert.h"
 #include "ds/map_serializers.h"
+#include "ds/pool_allocator.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace champ
@@ -77,16 +80,149 @@ namespace champ
     }
   };
 
+  template <class K, class V>
+  struct Entry;
+
+  template <class K, class V, class H>
+  struct Collisions;
+
   template <class K, class V, class H>
   struct SubNodes;
 
+  enum class NodeKind : uint8_t
+  {
+    Entry,
+    Collisions,
+    SubNodes
+  };
+
+  // Header of every node. Nodes are immutable once shared between maps, and
+  // are reference counted intrusively: each node is a single allocation with
+  // no separate control block, and children are referred to by a single
+  // pointer. The arrays of children are allocated from ds::pool.
+  struct NodeBase
+  {
+    mutable std::atomic<uint32_t> ref_count = 0;
+    const NodeKind kind;
+
+    NodeBase(NodeKind kind_) : kind(kind_) {}
+
+    // Copies of a node are new, unshared nodes
+    NodeBase(const NodeBase& other) : kind(other.kind) {}
+  };
+
+  template <class K, class V, class H>
+  class Node
+  {
+  private:
+    NodeBase* node = nullptr;
+
+    explicit Node(NodeBase* node_) : node(node_)
+    {
+      if (node != nullptr)
+      {
+        node->ref_count.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    // Takes the first reference to a node which has not been shared yet, so
+    // does not need an atomic increment
+    struct Adopt
+    {};
+
+    Node(NodeBase* node_, Adopt) : node(node_)
+    {
+      node->ref_count.store(1, std::memory_order_relaxed);
+    }
+
+    template <class T>
+    static void destroy_as(NodeBase* n)
+    {
+      delete static_cast<T*>(n);
+    }
+
+    void release()
+    {
+      if (
+        node != nullptr &&
+        node->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        switch (node->kind)
+        {
+          case NodeKind::Entry:
+            destroy_as<Entry<K, V>>(node);
+            break;
+          case NodeKind::Collisions:
+            destroy_as<Collisions<K, V, H>>(node);
+            break;
+          case NodeKind::SubNodes:
+            destroy_as<SubNodes<K, V, H>>(node);
+            break;
+        }
+      }
+      node = nullptr;
+    }
+
+  public:
+    Node() = default;
+
+    template <class T, class... Args>
+    static Node make(Args&&... args)
+    {
+      return Node(new T(std::forward<Args>(args)...), Adopt{});
+    }
+
+    Node(const Node& other) : Node(other.node) {}
+
+    Node(Node&& other) noexcept : node(std::exchange(other.node, nullptr)) {}
+
+    Node& operator=(const Node& other)
+    {
+      if (node != other.node)
+      {
+        Node copy(other);
+        std::swap(node, copy.node);
+      }
+      return *this;
+    }
+
+    Node& operator=(Node&& other) noexcept
+    {
+      if (this != &other)
+      {
+        release();
+        node = std::exchange(other.node, nullptr);
+      }
+      return *this;
+    }
+
+    ~Node()
+    {
+      release();
+    }
+
+    template <class T>
+    const T* as() const
+    {
+      return static_cast<const T*>(node);
+    }
+
+    bool operator==(const Node& other) const
+    {
+      return node == other.node;
+    }
+  };
+
+  template <class T>
+  using PoolVector = std::vector<T, ds::PoolAllocator<T>>;
+
   template <class K, class V>
-  struct Entry
+  struct Entry : public NodeBase
   {
     K key;
     V value;
 
-    Entry(K k, V v) : key(k), value(v) {}
+    Entry(K k, V v) : NodeBase(NodeKind::Entry), key(k), value(v) {}
 
     const V* getp(const K& k) const
     {
@@ -98,12 +234,13 @@ namespace champ
   };
 
   template <class K, class V, class H>
-  using Node = std::shared_ptr<void>;
-
-  template <class K, class V, class H>
-  struct Collisions
+  struct Collisions : public NodeBase
   {
-    std::array<std::vector<std::shared_ptr<Entry<K, V>>>, collision_bins> bins;
+    using EntryType = Entry<K, V>;
+
+    std::array<PoolVector<Node<K, V, H>>, collision_bins> bins;
+
+    Collisions() : NodeBase(NodeKind::Collisions) {}
 
     const V* getp(Hash hash, const K& k) const
     {
@@ -111,8 +248,9 @@ namespace champ
       const auto& bin = bins[idx];
       for (const auto& node : bin)
       {
-        if (k == node->key)
-          return &node->value;
+        const auto entry = node.template as<EntryType>();
+        if (k == entry->key)
+          return &entry->value;
       }
       return nullptr;
     }
@@ -123,16 +261,16 @@ namespace champ
       auto& bin = bins[idx];
       for (size_t i = 0; i < bin.size(); ++i)
       {
-        const auto& entry = bin[i];
+        const auto entry = bin[i].template as<EntryType>();
         if (k == entry->key)
         {
           const auto diff = map::get_serialized_size_with_padding(entry->key) +
             map::get_serialized_size_with_padding(entry->value);
-          bin[i] = std::make_shared<Entry<K, V>>(k, v);
+          bin[i] = Node<K, V, H>::template make<EntryType>(k, v);
           return diff;
         }
       }
-      bin.push_back(std::make_shared<Entry<K, V>>(k, v));
+      bin.push_back(Node<K, V, H>::template make<EntryType>(k, v));
       return 0;
     }
 
@@ -142,7 +280,7 @@ namespace champ
       auto& bin = bins[idx];
       for (size_t i = 0; i < bin.size(); ++i)
       {
-        const auto& entry = bin[i];
+        const auto entry = bin[i].template as<EntryType>();
         if (k == entry->key)
         {
           const auto diff = map::get_serialized_size_with_padding(entry->key) +
@@ -159,26 +297,33 @@ namespace champ
     {
       for (const auto& bin : bins)
       {
-        for (const auto& entry : bin)
+        for (const auto& node : bin)
+        {
+          const auto entry = node.template as<EntryType>();
           if (!f(entry->key, entry->value))
             return false;
+        }
       }
       return true;
     }
   };
 
   template <class K, class V, class H>
-  struct SubNodes
+  struct SubNodes : public NodeBase
   {
-    std::vector<Node<K, V, H>> nodes;
+    using Nodes = PoolVector<Node<K, V, H>>;
+
+    Nodes nodes;
     Bitmap node_map;
     Bitmap data_map;
 
-    SubNodes() {}
+    SubNodes() : NodeBase(NodeKind::SubNodes) {}
 
-    SubNodes(std::vector<Node<K, V, H>>&& ns) : nodes(std::move(ns)) {}
+    SubNodes(Nodes&& ns) : NodeBase(NodeKind::SubNodes), nodes(std::move(ns))
+    {}
 
-    SubNodes(std::vector<Node<K, V, H>>&& ns, Bitmap nm, Bitmap dm) :
+    SubNodes(Nodes&& ns, Bitmap nm, Bitmap dm) :
+      NodeBase(NodeKind::SubNodes),
       nodes(std::move(ns)),
       node_map(nm),
       data_map(dm)
@@ -224,7 +369,8 @@ namespace champ
         data_map = data_map.set(idx);
         c_idx = compressed_idx(idx);
         nodes.insert(
-          nodes.begin() + c_idx, std::make_shared<Entry<K, V>>(k, v));
+          nodes.begin() + c_idx,
+          Node<K, V, H>::template make<Entry<K, V>>(k, v));
         return 0;
       }
 
@@ -235,32 +381,39 @@ namespace champ
         {
           auto sn = *node_as<SubNodes<K, V, H>>(c_idx);
           insert = sn.put_mut(depth + 1, hash, k, v);
-          nodes[c_idx] = std::make_shared<SubNodes<K, V, H>>(std::move(sn));
+          nodes[c_idx] =
+            Node<K, V, H>::template make<SubNodes<K, V, H>>(std::move(sn));
         }
         else
         {
           auto sn = *node_as<Collisions<K, V, H>>(c_idx);
           insert = sn.put_mut(hash, k, v);
-          nodes[c_idx] = std::make_shared<Collisions<K, V, H>>(std::move(sn));
+          nodes[c_idx] =
+            Node<K, V, H>::template make<Collisions<K, V, H>>(std::move(sn));
         }
         return insert;
       }
 
-      const auto& entry0 = node_as<Entry<K, V>>(c_idx);
+      const auto entry0 = node_as<Entry<K, V>>(c_idx);
       if (k == entry0->key)
       {
         auto current_size = map::get_serialized_size_with_padding(entry0->key) +
           map::get_serialized_size_with_padding(entry0->value);
-        nodes[c_idx] = std::make_shared<Entry<K, V>>(k, v);
+        nodes[c_idx] = Node<K, V, H>::template make<Entry<K, V>>(k, v);
         return current_size;
       }
 
+      // The existing entry is moved (rather than copied) into a new sub-node,
+      // which replaces it
+      auto node0 = std::move(nodes[c_idx]);
+      const auto hash0 = H()(entry0->key);
       if (depth < (collision_depth - 1))
       {
-        const auto hash0 = H()(entry0->key);
         const auto idx0 = mask(hash0, depth + 1);
-        auto sub_node =
-          SubNodes<K, V, H>({entry0}, Bitmap(0), Bitmap(0).set(idx0));
+        Nodes sub_nodes;
+        sub_nodes.push_back(std::move(node0));
+        auto sub_node = SubNodes<K, V, H>(
+          std::move(sub_nodes), Bitmap(0), Bitmap(0).set(idx0));
         sub_node.put_mut(depth + 1, hash, k, v);
 
         nodes.erase(nodes.begin() + c_idx);
@@ -269,16 +422,16 @@ namespace champ
         c_idx = compressed_idx(idx);
         nodes.insert(
           nodes.begin() + c_idx,
-          std::make_shared<SubNodes<K, V, H>>(std::move(sub_node)));
+          Node<K, V, H>::template make<SubNodes<K, V, H>>(std::move(sub_node)));
       }
       else
       {
         auto sub_node = Collisions<K, V, H>();
-        const auto hash0 = H()(entry0->key);
         const auto idx0 = mask(hash0, collision_depth);
-        sub_node.bins[idx0].push_back(entry0);
+        sub_node.bins[idx0].push_back(std::move(node0));
         const auto idx1 = mask(hash, collision_depth);
-        sub_node.bins[idx1].push_back(std::make_shared<Entry<K, V>>(k, v));
+        sub_node.bins[idx1].push_back(
+          Node<K, V, H>::template make<Entry<K, V>>(k, v));
 
         nodes.erase(nodes.begin() + c_idx);
         data_map = data_map.clear(idx);
@@ -286,18 +439,19 @@ namespace champ
         c_idx = compressed_idx(idx);
         nodes.insert(
           nodes.begin() + c_idx,
-          std::make_shared<Collisions<K, V, H>>(std::move(sub_node)));
+          Node<K, V, H>::template make<Collisions<K, V, H>>(
+            std::move(sub_node)));
       }
       return 0;
     }
 
-    std::pair<std::shared_ptr<SubNodes<K, V, H>>, size_t> put(
+    std::pair<Node<K, V, H>, size_t> put(
       SmallIndex depth, Hash hash, const K& k, const V& v) const
     {
       auto node = *this;
       auto r = node.put_mut(depth, hash, k, v);
       return std::make_pair(
-        std::make_shared<SubNodes<K, V, H>>(std::move(node)), r);
+        Node<K, V, H>::template make<SubNodes<K, V, H>>(std::move(node)), r);
     }
 
     // Returns serialised size of removed (k,v) if k exists, 0 otherwise
@@ -311,7 +465,7 @@ namespace champ
 
       if (data_map.check(idx))
       {
-        const auto& entry = node_as<Entry<K, V>>(c_idx);
+        const auto entry = node_as<Entry<K, V>>(c_idx);
         if (entry->key != k)
           return 0;
 
@@ -326,23 +480,25 @@ namespace champ
       {
         auto sn = *node_as<Collisions<K, V, H>>(c_idx);
         const auto diff = sn.remove_mut(hash, k);
-        nodes[c_idx] = std::make_shared<Collisions<K, V, H>>(std::move(sn));
+        nodes[c_idx] =
+          Node<K, V, H>::template make<Collisions<K, V, H>>(std::move(sn));
         return diff;
       }
 
       auto sn = *node_as<SubNodes<K, V, H>>(c_idx);
       const auto diff = sn.remove_mut(depth + 1, hash, k);
-      nodes[c_idx] = std::make_shared<SubNodes<K, V, H>>(std::move(sn));
+      nodes[c_idx] =
+        Node<K, V, H>::template make<SubNodes<K, V, H>>(std::move(sn));
       return diff;
     }
 
-    std::pair<std::shared_ptr<SubNodes<K, V, H>>, size_t> remove(
+    std::pair<Node<K, V, H>, size_t> remove(
       SmallIndex depth, Hash hash, const K& k) const
     {
       auto node = *this;
       auto r = node.remove_mut(depth, hash, k);
       return std::make_pair(
-        std::make_shared<SubNodes<K, V, H>>(std::move(node)), r);
+        Node<K, V, H>::template make<SubNodes<K, V, H>>(std::move(node)), r);
     }
 
     template <class F>
@@ -351,7 +507,7 @@ namespace champ
       const auto entries = data_map.pop();
       for (SmallIndex i = 0; i < entries; ++i)
       {
-        const auto& entry = node_as<Entry<K, V>>(i);
+        const auto entry = node_as<Entry<K, V>>(i);
         if (!f(entry->key, entry->value))
           return false;
       }
@@ -372,11 +528,114 @@ namespace champ
       return true;
     }
 
+    // Calls put(k, v) for each entry of cur that is not in base (or has been
+    // overwritten since), and remove(k) for each key of base that is not in
+    // cur. Sub-trees shared by both nodes are skipped.
+    template <class FPut, class FRemove>
+    static void diff(
+      SmallIndex depth,
+      const SubNodes<K, V, H>& base,
+      const SubNodes<K, V, H>& cur,
+      FPut&& put,
+      FRemove&& remove)
+    {
+      for (SmallIndex idx = 0; idx <= index_mask; ++idx)
+      {
+        const auto base_idx = base.compressed_idx(idx);
+        const auto cur_idx = cur.compressed_idx(idx);
+        if (base_idx == (SmallIndex)-1 && cur_idx == (SmallIndex)-1)
+        {
+          continue;
+        }
+
+        if (
+          base_idx != (SmallIndex)-1 && cur_idx != (SmallIndex)-1 &&
+          base.nodes[base_idx] == cur.nodes[cur_idx])
+        {
+          continue;
+        }
+
+        if (
+          base.node_map.check(idx) && cur.node_map.check(idx) &&
+          depth < (collision_depth - 1))
+        {
+          diff(
+            depth + 1,
+            *base.template node_as<SubNodes<K, V, H>>(base_idx),
+            *cur.template node_as<SubNodes<K, V, H>>(cur_idx),
+            put,
+            remove);
+          continue;
+        }
+
+        // At least one side is a single entry, a collision node or missing,
+        // so compare the entries under this index exhaustively
+        EntryRefs base_entries;
+        EntryRefs cur_entries;
+        base.collect(depth, idx, base_entries);
+        cur.collect(depth, idx, cur_entries);
+
+        for (const auto& [k, v] : cur_entries)
+        {
+          auto it = std::find_if(
+            base_entries.begin(), base_entries.end(), [k](const auto& e) {
+              return *e.first == *k;
+            });
+          // Unmodified entries are shared, so compare addresses
+          if (it == base_entries.end() || it->first != k)
+          {
+            put(*k, *v);
+          }
+        }
+        for (const auto& [k, _] : base_entries)
+        {
+          auto it = std::find_if(
+            cur_entries.begin(), cur_entries.end(), [k](const auto& e) {
+              return *e.first == *k;
+            });
+          if (it == cur_entries.end())
+          {
+            remove(*k);
+          }
+        }
+      }
+    }
+
   private:
+    using EntryRefs = std::vector<std::pair<const K*, const V*>>;
+
+    void collect(SmallIndex depth, SmallIndex idx, EntryRefs& entries) const
+    {
+      const auto c_idx = compressed_idx(idx);
+      if (c_idx == (SmallIndex)-1)
+      {
+        return;
+      }
+
+      auto f = [&entries](const K& k, const V& v) {
+        entries.emplace_back(&k, &v);
+        return true;
+      };
+
+      if (data_map.check(idx))
+      {
+        const auto entry = node_as<Entry<K, V>>(c_idx);
+        f(entry->key, entry->value);
+      }
+      else if (depth == (collision_depth - 1))
+      {
+        node_as<Collisions<K, V, H>>(c_idx)->foreach(f);
+      }
+      else
+      {
+        node_as<SubNodes<K, V, H>>(c_idx)->foreach(depth + 1, f);
+      }
+    }
+
     template <class A>
-    const std::shared_ptr<A>& node_as(SmallIndex c_idx) const
+    const A* node_as(SmallIndex c_idx) const
     {
-      return reinterpret_cast<const std::shared_ptr<A>&>(nodes[c_idx]);
+      return nodes[c_idx].template as<A>();
     }
   };
 
@@ -384,25 +643,27 @@ namespace champ
   class Map
   {
   private:
-    std::shared_ptr<SubNodes<K, V, H>> root;
+    Node<K, V, H> root;
     size_t map_size = 0;
     size_t serialized_size = 0;
 
-    Map(
-      std::shared_ptr<SubNodes<K, V, H>>&& root_,
-      size_t size_,
-      size_t serialized_size_) :
+    Map(Node<K, V, H>&& root_, size_t size_, size_t serialized_size_) :
       root(std::move(root_)),
       map_size(size_),
       serialized_size(serialized_size_)
     {}
 
+    const SubNodes<K, V, H>* root_node() const
+    {
+      return root.template as<SubNodes<K, V, H>>();
+    }
+
   public:
     using KeyType = K;
     using ValueType = V;
     using Snapshot = Snapshot<K, V, H>;
 
-    Map() : root(std::make_shared<SubNodes<K, V, H>>()) {}
+    Map() : root(Node<K, V, H>::template make<SubNodes<K, V, H>>()) {}
 
     size_t size() const
     {
@@ -421,7 +682,7 @@ namespace champ
 
     std::optional<V> get(const K& key) const
     {
-      auto v = root->getp(0, H()(key), key);
+      auto v = root_node()->getp(0, H()(key), key);
 
       if (v)
         return *v;
@@ -431,12 +692,12 @@ namespace champ
 
     const V* getp(const K& key) const
     {
-      return root->getp(0, H()(key), key);
+      return root_node()->getp(0, H()(key), key);
     }
 
     const Map<K, V, H> put(const K& key, const V& value) const
     {
-      auto r = root->put(0, H()(key), key, value);
+      auto r = root_node()->put(0, H()(key), key, value);
       auto size_ = map_size;
       if (r.second == 0)
         size_++;
@@ -450,7 +711,7 @@ namespace champ
 
     const Map<K, V, H> remove(const K& key) const
     {
-      auto r = root->remove(0, H()(key), key);
+      auto r = root_node()->remove(0, H()(key), key);
       auto size_ = map_size;
       if (r.second > 0)
         size_--;
@@ -461,7 +722,22 @@ namespace champ
     template <class F>
     bool foreach(F&& f) const
     {
-      return root->foreach(0, std::forward<F>(f));
+      return root_node()->foreach(0, std::forward<F>(f));
+    }
+
+    // Calls put(k, v) for each entry added or overwritten since base, and
+    // remove(k) for each key removed since base. Because base and this map
+    // share all unmodified nodes, the cost is proportional to the number of
+    // changes rather than to the size of the map.
+    template <class FPut, class FRemove>
+    void foreach_diff(
+      const Map<K, V, H>& base, FPut&& put, FRemove&& remove) const
+    {
+      if (root != base.root)
+      {
+        SubNodes<K, V, H>::diff(
+          0, *base.root_node(), *root_node(), put, remove);
+      }
     }
 
     std::unique_ptr<Snapshot> make_snapshot() const
@@ -488,6 +764,11 @@ namespace champ
   public:
     Snapshot(const Map<K, V, H>& map_) : map(map_) {}
 
+    const Map<K, V, H>& get_map() const
+    {
+      return map;
+    }
+
     size_t get_serialized_size()
     {
       return map.get_serialized_size();
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ds
+{
+  /** Wakes a thread blocked waiting for work, when that work is published by
+   * another thread.
+   *
+   * A waiter registers itself, then re-checks for work, and only blocks (on a
+   * futex) if there is none. A ringer publishes its work, then calls ring(),
+   * which only makes a syscall if a waiter is registered. Either the waiter's
+   * re-check sees the work, or the ringer sees the waiter, so no wakeup is
+   * lost. Ringing with no waiter costs a fence and a load.
+   *
+   * Waiters and ringers may be in different threads of the same process, or
+   * different processes sharing the memory the Doorbell lives in.
+   */
+  class Doorbell
+  {
+    // Incremented on each ring() which sees a waiter. This is the futex word
+    std::atomic<uint32_t> rings = 0;
+    std::atomic<uint32_t> waiters = 0;
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+  public:
+    void ring()
+    {
+      // Order the caller's publication of work before the load of waiters
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters.load() != 0)
+      {
+        rings.fetch_add(1);
+        syscall(
+          SYS_futex,
+          reinterpret_cast<uint32_t*>(&rings),
+          FUTEX_WAKE,
+          INT32_MAX,
+          nullptr,
+          nullptr,
+          0);
+      }
+    }
+
+    /** True if a thread is waiting (or about to wait) on this Doorbell. As for
+     * ring(), the caller's publication of work is ordered before the check, so
+     * a waiter which is not seen sees the work when it re-checks.
+     */
+    bool has_waiters()
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return waiters.load() != 0;
+    }
+
+    /** Blocks the calling thread until ring() is called or timeout elapses,
+     * unless has_work() returns true once the thread is registered to be
+     * woken. Returns early, spuriously, in rare cases, so callers should
+     * re-check for work after returning.
+     */
+    template <typename F>
+    void wait(F&& has_work, std::chrono::microseconds timeout)
+    {
+      waiters.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const auto expected = rings.load();
+
+      if (!has_work())
+      {
+        const auto s =
+          std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        const auto ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - s);
+        ::timespec ts{(time_t)s.count(), (long)ns.count()};
+        syscall(
+          SYS_futex,
+          reinterpret_cast<uint32_t*>(&rings),
+          FUTEX_WAIT,
+          expected,
+          &ts,
+          nullptr,
+          0);
+      }
+
+      waiters.fetch_sub(1);
+    }
+  };
+}
@@ -4,11 +4,21 @@
 
 #include "ccf/ds/logger.h"
 #include "ring_buffer.h"
+#include "serialized.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <deque>
 #include <map>
+#include <numeric>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace messaging
 {
@@ -24,15 +34,148 @@ namespace messaging
     using logic_error::logic_error;
   };
 
+  /// Number of messages of a type, their total size, and a histogram of the
+  /// time taken to handle a sample of them
   struct Counts
   {
-    size_t messages;
-    size_t bytes;
+    // Bucket i counts handler calls taking less than 2^i ns (and at least
+    // 2^(i-1)ns). The last bucket also counts anything slower
+    static constexpr size_t latency_buckets = 32;
+
+    // Reading the clock can cost more than dispatching a message, so by
+    // default only one in this many messages of each type is timed
+    static constexpr size_t default_latency_sample_rate = 64;
+
+    size_t messages = 0;
+    size_t bytes = 0;
+    std::array<size_t, latency_buckets> latency_ns = {};
+
+    static size_t get_latency_bucket(std::chrono::nanoseconds latency)
+    {
+      return std::min<size_t>(
+        std::bit_width((uint64_t)std::max<int64_t>(latency.count(), 0)),
+        latency_buckets - 1);
+    }
+
+    /// Upper bound, in ns, of the bucket containing the p-th fraction of
+    /// sampled calls
+    size_t get_latency_percentile(double p) const
+    {
+      const auto sampled =
+        std::accumulate(latency_ns.begin(), latency_ns.end(), (size_t)0);
+      const auto target = (size_t)std::ceil(p * sampled);
+      size_t seen = 0;
+      for (size_t i = 0; i < latency_buckets; ++i)
+      {
+        seen += latency_ns[i];
+        if (seen >= target && seen != 0)
+        {
+          return (size_t)1 << i;
+        }
+      }
+      return 0;
+    }
+
+    Counts& operator+=(const Counts& other)
+    {
+      messages += other.messages;
+      bytes += other.bytes;
+      for (size_t i = 0; i < latency_buckets; ++i)
+      {
+        latency_ns[i] += other.latency_ns[i];
+      }
+      return *this;
+    }
   };
 
   template <typename MessageType>
   using MessageCounts = std::unordered_map<MessageType, Counts>;
 
+  /// Counts keyed by message name, for reporting and for passing between
+  /// processes, which may not share message types
+  using LabelledCounts = std::map<std::string, Counts>;
+
+  static inline nlohmann::json convert_labelled_counts(
+    const LabelledCounts& lc)
+  {
+    auto j = nlohmann::json::object();
+    for (const auto& [label, counts] : lc)
+    {
+      j[label] = {
+        {"count", counts.messages},
+        {"bytes", counts.bytes},
+        {"p50_ns", counts.get_latency_percentile(0.5)},
+        {"p99_ns", counts.get_latency_percentile(0.99)}};
+    }
+    return j;
+  }
+
+  /// Compact binary form of LabelledCounts, which only includes non-empty
+  /// latency buckets
+  static inline std::vector<uint8_t> serialise_labelled_counts(
+    const LabelledCounts& lc)
+  {
+    size_t size = sizeof(size_t);
+    for (const auto& [label, counts] : lc)
+    {
+      size += sizeof(size_t) + label.size() + 3 * sizeof(size_t) +
+        Counts::latency_buckets * (sizeof(uint8_t) + sizeof(size_t));
+    }
+
+    std::vector<uint8_t> buf(size);
+    auto data = buf.data();
+    serialized::write(data, size, lc.size());
+    for (const auto& [label, counts] : lc)
+    {
+      serialized::write(data, size, label);
+      serialized::write(data, size, counts.messages);
+      serialized::write(data, size, counts.bytes);
+
+      const auto non_empty = std::count_if(
+        counts.latency_ns.begin(), counts.latency_ns.end(), [](size_t n) {
+          return n != 0;
+        });
+      serialized::write(data, size, (size_t)non_empty);
+      for (size_t i = 0; i < Counts::latency_buckets; ++i)
+      {
+        if (counts.latency_ns[i] != 0)
+        {
+          serialized::write(data, size, (uint8_t)i);
+          serialized::write(data, size, counts.latency_ns[i]);
+        }
+      }
+    }
+
+    buf.resize(buf.size() - size);
+    return buf;
+  }
+
+  static inline LabelledCounts deserialise_labelled_counts(
+    const uint8_t* data, size_t size)
+  {
+    LabelledCounts lc;
+    const auto entries = serialized::read<size_t>(data, size);
+    for (size_t e = 0; e < entries; ++e)
+    {
+      auto& counts = lc[serialized::read<std::string>(data, size)];
+      counts.messages = serialized::read<size_t>(data, size);
+      counts.bytes = serialized::read<size_t>(data, size);
+
+      const auto non_empty = serialized::read<size_t>(data, size);
+      for (size_t n = 0; n < non_empty; ++n)
+      {
+        const auto i = serialized::read<uint8_t>(data, size);
+        if (i >= Counts::latency_buckets)
+        {
+          throw std::logic_error(
+            fmt::format("Invalid latency bucket {}", (size_t)i));
+        }
+        counts.latency_ns[i] = serialized::read<size_t>(data, size);
+      }
+    }
+    return lc;
+  }
+
   template <typename MessageType>
   class Dispatcher
   {
@@ -43,10 +186,94 @@ namespace messaging
     // Store a name to distinguish error messages
     char const* const name;
 
-    std::map<MessageType, Handler> handlers;
-    std::map<MessageType, char const*> message_labels;
+    // Each message type ever registered, with its handler (if not since
+    // removed) and counts since they were last retrieved. Aligned so that the
+    // counts of different types do not share cache lines. The counts are only
+    // updated by the dispatching thread, so are atomic only so that they can
+    // be read safely elsewhere
+    struct alignas(64) Slot
+    {
+      const MessageType m;
+      char const* label = nullptr;
+      Handler handler;
+
+      std::atomic<size_t> messages = 0;
+      std::atomic<size_t> bytes = 0;
+      std::array<std::atomic<size_t>, Counts::latency_buckets> latency_ns = {};
+
+      Slot(MessageType m_) : m(m_) {}
+    };
+
+    // Never erased, so that handlers may register other handlers while being
+    // called
+    std::deque<Slot> slots;
+
+    // Open-addressed table from message type to (1 + index of) its slot, or 0
+    // if empty. Kept at least twice the size of slots, so probes are short
+    std::vector<uint32_t> slot_index = std::vector<uint32_t>(16, 0);
+    size_t slot_index_bits = 4;
+
+    // One in this many messages of each type is timed, or none if 0. Always a
+    // power of 2, so that sampling costs no division
+    size_t latency_sample_rate = Counts::default_latency_sample_rate;
+
+    size_t get_bucket(MessageType m) const
+    {
+      // Fibonacci hashing, to spread both small sequential message types and
+      // hashed ringbuffer message types across the table
+      return ((uint64_t)m * 0x9E3779B97F4A7C15ull) >> (64 - slot_index_bits);
+    }
+
+    Slot* find_slot(MessageType m)
+    {
+      const auto mask = slot_index.size() - 1;
+      for (auto i = get_bucket(m);; i = (i + 1) & mask)
+      {
+        const auto entry = slot_index[i];
+        if (entry == 0)
+        {
+          return nullptr;
+        }
+
+        auto& slot = slots[entry - 1];
+        if (slot.m == m)
+        {
+          return &slot;
+        }
+      }
+    }
 
-    MessageCounts message_counts;
+    void index_slot(size_t slot_idx)
+    {
+      const auto mask = slot_index.size() - 1;
+      auto i = get_bucket(slots[slot_idx].m);
+      while (slot_index[i] != 0)
+      {
+        i = (i + 1) & mask;
+      }
+      slot_index[i] = slot_idx + 1;
+    }
+
+    Slot& add_slot(MessageType m)
+    {
+      slots.emplace_back(m);
+
+      if (slots.size() * 2 > slot_index.size())
+      {
+        ++slot_index_bits;
+        slot_index.assign((size_t)1 << slot_index_bits, 0);
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+          index_slot(i);
+        }
+      }
+      else
+      {
+        index_slot(slots.size() - 1);
+      }
+
+      return slots.back();
+    }
 
     std::string get_error_prefix()
     {
@@ -55,13 +282,13 @@ namespace messaging
 
     char const* get_message_name(MessageType m)
     {
-      const auto it = message_labels.find(m);
-      if (it == message_labels.end())
+      const auto slot = find_slot(m);
+      if (slot == nullptr || slot->label == nullptr)
       {
         return "unknown";
       }
 
-      return it->second;
+      return slot->label;
     }
 
     static std::string decorate_message_name(MessageType m, char const* s)
@@ -75,7 +302,33 @@ namespace messaging
     }
 
   public:
-    Dispatcher(char const* name) : name(name), handlers() {}
+    Dispatcher(char const* name) : name(name) {}
+
+    /** Set how often handler latency is sampled
+     *
+     * One in every sample_rate messages of each type will be timed. A
+     * sample_rate of 0 disables timing entirely, leaving only message and byte
+     * counts.
+     *
+     * @throws std::logic_error if sample_rate is neither 0 nor a power of 2.
+     */
+    void set_latency_sample_rate(size_t sample_rate)
+    {
+      if (sample_rate != 0 && !std::has_single_bit(sample_rate))
+      {
+        throw std::logic_error(
+          get_error_prefix() +
+          "Latency sample rate must be 0 or a power of 2, not " +
+          std::to_string(sample_rate));
+      }
+
+      latency_sample_rate = sample_rate;
+    }
+
+    size_t get_latency_sample_rate() const
+    {
+      return latency_sample_rate;
+    }
 
     /** Set a callback for this message type
      *
@@ -92,9 +345,8 @@ namespace messaging
     void set_message_handler(
       MessageType m, char const* message_label, Handler h)
     {
-      // Check for presence first, so we only copy if we're actually inserting
-      auto it = handlers.find(m);
-      if (it != handlers.end())
+      auto slot = find_slot(m);
+      if (slot != nullptr && slot->handler)
       {
         throw already_handled(
           get_error_prefix() + "MessageType " + std::to_string(m) +
@@ -104,11 +356,15 @@ namespace messaging
       }
 
       LOG_DEBUG_FMT("Setting handler for {} ({})", message_label, m);
-      handlers.insert(it, {m, h});
+      if (slot == nullptr)
+      {
+        slot = &add_slot(m);
+      }
+      slot->handler = std::move(h);
 
-      if (message_label != nullptr)
+      if (message_label != nullptr && slot->label == nullptr)
       {
-        message_labels.emplace(m, message_label);
+        slot->label = message_label;
       }
     }
 
@@ -121,8 +377,8 @@ namespace messaging
      */
     void remove_message_handler(MessageType m)
     {
-      auto it = handlers.find(m);
-      if (it == handlers.end())
+      auto slot = find_slot(m);
+      if (slot == nullptr || !slot->handler)
       {
         throw no_handler(
           get_error_prefix() +
@@ -130,7 +386,7 @@ namespace messaging
           get_decorated_message_name(m));
       }
 
-      handlers.erase(it);
+      slot->handler = nullptr;
     }
 
     /** Is handler already registered for this message type
@@ -140,7 +396,8 @@ namespace messaging
      */
     bool has_handler(MessageType m)
     {
-      return handlers.find(m) != handlers.end();
+      const auto slot = find_slot(m);
+      return slot != nullptr && slot->handler;
     }
 
     /** Dispatch a single message
@@ -152,18 +409,26 @@ namespace messaging
      */
     void dispatch(MessageType m, const uint8_t* data, size_t size)
     {
-      auto it = handlers.find(m);
-      if (it == handlers.end())
+      auto slot = find_slot(m);
+      if (slot == nullptr || !slot->handler)
       {
         throw no_handler(
           get_error_prefix() +
           "No handler for this message: " + get_decorated_message_name(m));
       }
 
-      // Handlers may register or remove handlers, so iterator is invalidated
+      const auto messages = slot->messages.load(std::memory_order_relaxed);
+      const bool timed = latency_sample_rate != 0 &&
+        (messages & (latency_sample_rate - 1)) == 0;
+      std::chrono::steady_clock::time_point start;
+      if (timed)
+      {
+        start = std::chrono::steady_clock::now();
+      }
+
       try
       {
-        it->second(data, size);
+        slot->handler(data, size);
       }
       catch (const std::exception& e)
       {
@@ -175,27 +440,65 @@ namespace messaging
         throw e;
       }
 
-      auto& counts = message_counts[m];
-      counts.messages++;
-      counts.bytes += size;
+      // Only this thread writes the counts, so there is no need for an atomic
+      // read-modify-write
+      const auto add = [](std::atomic<size_t>& counter, size_t n) {
+        counter.store(
+          counter.load(std::memory_order_relaxed) + n,
+          std::memory_order_relaxed);
+      };
+      add(slot->messages, 1);
+      add(slot->bytes, size);
+      if (timed)
+      {
+        const auto latency = std::chrono::steady_clock::now() - start;
+        add(slot->latency_ns[Counts::get_latency_bucket(latency)], 1);
+      }
     }
 
+    /** Retrieve the counts of each message type dispatched since the last
+     * call, and reset them. Must be called from the dispatching thread.
+     */
     MessageCounts retrieve_message_counts()
     {
       MessageCounts current;
-      std::swap(message_counts, current);
+      for (auto& slot : slots)
+      {
+        const auto messages = slot.messages.load(std::memory_order_relaxed);
+        if (messages == 0)
+        {
+          continue;
+        }
+
+        auto& counts = current[slot.m];
+        counts.messages = messages;
+        counts.bytes = slot.bytes.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < Counts::latency_buckets; ++i)
+        {
+          counts.latency_ns[i] =
+            slot.latency_ns[i].load(std::memory_order_relaxed);
+          slot.latency_ns[i].store(0, std::memory_order_relaxed);
+        }
+
+        slot.messages.store(0, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+      }
       return current;
     }
 
-    nlohmann::json convert_message_counts(const MessageCounts& mc)
+    LabelledCounts label_message_counts(const MessageCounts& mc)
     {
-      auto j = nlohmann::json::object();
-      for (const auto& it : mc)
+      LabelledCounts lc;
+      for (const auto& [m, counts] : mc)
       {
-        j[get_message_name(it.first)] = {
-          {"count", it.second.messages}, {"bytes", it.second.bytes}};
+        lc[get_message_name(m)] += counts;
       }
-      return j;
+      return lc;
+    }
+
+    nlohmann::json convert_message_counts(const MessageCounts& mc)
+    {
+      return convert_labelled_counts(label_message_counts(mc));
     }
   };
 
@@ -335,6 +335,12 @@ namespace oversized
     {
       return max_total_size;
     }
+
+    size_t get_max_non_blocking_message_size() override
+    {
+      // Messages split into several fragments can only be written blocking
+      return max_fragment_size;
+    }
   };
 
   struct WriterConfig
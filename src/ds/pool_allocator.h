@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace ds
+{
+  // Size-class pool for small objects which are allocated and freed at a high
+  // rate (e.g. the nodes of persistent maps). Freed blocks are cached in
+  // per-thread free lists, and reused by later allocations of the same size
+  // class on that thread, so that most allocations need neither the global
+  // allocator nor any synchronisation. A block may be freed by a different
+  // thread from the one which allocated it, in which case it joins the free
+  // list of the freeing thread.
+  namespace pool
+  {
+    static constexpr size_t granularity = 16;
+    static constexpr size_t max_pooled_size = 512;
+    static constexpr size_t size_classes = max_pooled_size / granularity;
+
+    // Beyond this many cached blocks per size class and thread, freed blocks
+    // are returned to the global allocator
+    static constexpr size_t max_cached_blocks = 4096;
+
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    // Trivially destructible, so that the free lists can still be accessed
+    // (and bypassed) while the thread's other thread-locals are destroyed
+    struct FreeLists
+    {
+      std::array<FreeBlock*, size_classes> heads;
+      std::array<size_t, size_classes> counts;
+      bool registered;
+      bool released;
+    };
+
+    inline FreeLists& get_free_lists()
+    {
+      thread_local FreeLists free_lists = {};
+      return free_lists;
+    }
+
+    // Returns the blocks cached by the thread to the global allocator when
+    // the thread exits
+    struct FreeListsRelease
+    {
+      ~FreeListsRelease()
+      {
+        auto& free_lists = get_free_lists();
+        free_lists.released = true;
+        for (auto& head : free_lists.heads)
+        {
+          while (head != nullptr)
+          {
+            auto next = head->next;
+            ::operator delete(head);
+            head = next;
+          }
+        }
+        free_lists.counts = {};
+      }
+    };
+
+    static constexpr size_t size_class(size_t size)
+    {
+      return (size - 1) / granularity;
+    }
+
+    inline void* allocate(size_t size)
+    {
+      if (size > max_pooled_size)
+      {
+        return ::operator new(size);
+      }
+
+      const auto idx = size_class(size);
+      auto& free_lists = get_free_lists();
+      auto& head = free_lists.heads[idx];
+      if (head == nullptr)
+      {
+        return ::operator new((idx + 1) * granularity);
+      }
+
+      auto block = head;
+      head = block->next;
+      --free_lists.counts[idx];
+      return block;
+    }
+
+    inline void deallocate(void* p, size_t size)
+    {
+      if (size > max_pooled_size)
+      {
+        ::operator delete(p);
+        return;
+      }
+
+      const auto idx = size_class(size);
+      auto& free_lists = get_free_lists();
+      if (
+        free_lists.released || free_lists.counts[idx] >= max_cached_blocks)
+      {
+        ::operator delete(p);
+        return;
+      }
+
+      if (!free_lists.registered)
+      {
+        free_lists.registered = true;
+        thread_local FreeListsRelease release;
+        (void)release;
+      }
+
+      auto block = static_cast<FreeBlock*>(p);
+      block->next = free_lists.heads[idx];
+      free_lists.heads[idx] = block;
+      ++free_lists.counts[idx];
+    }
+  }
+
+  // Standard allocator allocating from ds::pool, e.g. for the small vectors
+  // owned by pooled objects
+  template <class T>
+  struct PoolAllocator
+  {
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&)
+    {}
+
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+      pool::deallocate(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>&) const
+    {
+      return true;
+    }
+  };
+}
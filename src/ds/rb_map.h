@@ -175,6 +175,33 @@ namespace rb
       return true;
     }
 
+    // Calls put(k, v) for each entry added or overwritten since base, and
+    // remove(k) for each key removed since base.
+    template <class FPut, class FRemove>
+    void foreach_diff(const Map& base, FPut&& put, FRemove&& remove) const
+    {
+      if (_root == base._root)
+      {
+        return;
+      }
+
+      foreach([&base, &put](const K& k, const V& v) {
+        // Unmodified entries are shared, so compare addresses
+        if (base.getp(k) != &v)
+        {
+          put(k, v);
+        }
+        return true;
+      });
+      base.foreach([this, &remove](const K& k, const V&) {
+        if (getp(k) == nullptr)
+        {
+          remove(k);
+        }
+        return true;
+      });
+    }
+
     std::unique_ptr<Snapshot> make_snapshot() const
     {
       return std::make_unique<Snapshot>(*this);
@@ -669,6 +696,11 @@ namespace rb
   public:
     Snapshot(const Map<K, V>& map_) : map(map_) {}
 
+    const Map<K, V>& get_map() const
+    {
+      return map;
+    }
+
     size_t get_serialized_size()
     {
       return map.get_serialized_size();
@@ -279,6 +279,19 @@ namespace ringbuffer
 
       return count;
     }
+
+    // True if any message has been written, or is being written, which has
+    // not yet been read
+    bool has_pending()
+    {
+      return bd.offsets->head.load(std::memory_order_acquire) !=
+        bd.offsets->tail.load(std::memory_order_acquire);
+    }
+
+    ds::Doorbell& get_doorbell()
+    {
+      return bd.offsets->doorbell;
+    }
   };
 
   class Writer : public AbstractWriter
@@ -386,6 +399,8 @@ namespace ringbuffer
         const auto m = message(header);
         const auto finished_header = Const::make_header(m, size, false);
         write64(index, finished_header);
+
+        bd.offsets->doorbell.ring();
       }
     }
 
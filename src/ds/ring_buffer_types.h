@@ -4,6 +4,7 @@
 
 #include "ccf/ds/hash.h"
 #include "ccf/ds/nonstd.h"
+#include "doorbell.h"
 #include "serializer.h"
 
 #include <atomic>
@@ -43,6 +44,10 @@ namespace ringbuffer
     // message's memory. It is read by writers, but only to update the
     // head_cache value which is used for calculations.
     alignas(CACHELINE_SIZE) std::atomic<size_t> head = {0};
+
+    // Rung by writers as each message is completed, so that a reader which is
+    // waiting for messages can block rather than poll
+    alignas(CACHELINE_SIZE) ds::Doorbell doorbell;
   };
 
   class message_error : public std::logic_error
@@ -120,6 +125,13 @@ namespace ringbuffer
     virtual size_t get_max_message_size() = 0;
     ///@}
 
+    /// Largest message which can be written without waiting, e.g. with
+    /// try_write. Larger messages may need to be split and written blocking.
+    virtual size_t get_max_non_blocking_message_size()
+    {
+      return get_max_message_size();
+    }
+
   private:
     template <typename Serializer, typename... Ts>
     bool write_multiple(Message m, bool wait, Ts&&... ts)
@@ -3,8 +3,15 @@
 
 #include "ccf/ds/logger.h"
 
+#include "ccf/ds/json.h"
+#include "ds/ring_buffer.h"
+#include "enclave/interface.h"
+#include "enclave/ringbuffer_logger.h"
+
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <atomic>
 #include <doctest/doctest.h>
+#include <thread>
 
 template <typename Base>
 class TestLogger : public Base
@@ -178,4 +185,184 @@ TEST_CASE("Custom logging macros")
   }
 
   ccf::logger::config::loggers().clear();
-}
\ No newline at end of file
+}
+// Receives CCF_LOG_FMT messages with their arguments captured, and formats
+// them from the captured bytes, as a host would
+class TestDeferredLogger : public ccf::logger::AbstractLogger
+{
+public:
+  std::vector<std::string>& logs;
+  size_t deferred_count = 0;
+
+  TestDeferredLogger(std::vector<std::string>& l) : logs(l) {}
+
+  bool writes_deferred() const override
+  {
+    return true;
+  }
+
+  void write(
+    const ccf::logger::LogLine& ll,
+    const std::optional<double>& enclave_offset = std::nullopt) override
+  {
+    if (ll.deferred.has_value())
+    {
+      ++deferred_count;
+      const auto& d = ll.deferred.value();
+      ccf::logger::DeferredFormat received(
+        d.site_id, d.site->format, d.get_args());
+      logs.push_back(received.format());
+    }
+    else
+    {
+      logs.push_back(ll.msg);
+    }
+  }
+};
+
+TEST_CASE("Deferred formatting")
+{
+  std::vector<std::string> deferred_logs;
+  std::vector<std::string> text_logs;
+
+  auto deferred_logger = std::make_unique<TestDeferredLogger>(deferred_logs);
+  auto& deferred = *deferred_logger;
+  ccf::logger::config::loggers().emplace_back(std::move(deferred_logger));
+  ccf::logger::config::loggers().emplace_back(
+    std::make_unique<TestTextLogger>(text_logs));
+
+  const std::string name = "alice";
+  const std::string_view view = "bob";
+  const char* cstr = "carol";
+
+  {
+    INFO("Numbers, characters and strings are captured");
+    LOG_INFO_FMT(
+      "{} {:x} {:>4} {} {:.3f} {} {} {} {} {}",
+      -42,
+      255u,
+      'c',
+      true,
+      3.14159,
+      0.1f,
+      name,
+      view,
+      cstr,
+      uint64_t(-1));
+    REQUIRE(deferred.deferred_count == 1);
+    const auto expected = fmt::format(
+      "{} {:x} {:>4} {} {:.3f} {} {} {} {} {}",
+      -42,
+      255u,
+      'c',
+      true,
+      3.14159,
+      0.1f,
+      name,
+      view,
+      cstr,
+      uint64_t(-1));
+    REQUIRE(deferred_logs.back() == expected);
+    REQUIRE(text_logs.back().find(expected) != std::string::npos);
+  }
+
+  {
+    INFO("Other arguments are formatted eagerly");
+    LOG_INFO_FMT("{} {}", std::vector<int>{1, 2}, 3);
+    REQUIRE(deferred.deferred_count == 1);
+    REQUIRE(deferred_logs.back() == "[1, 2] 3");
+    REQUIRE(text_logs.back().find("[1, 2] 3") != std::string::npos);
+  }
+
+  {
+    INFO("Arguments too large to capture are formatted eagerly");
+    const std::string long_string(
+      ccf::logger::DeferredFormat::max_args_size, 'x');
+    LOG_INFO_FMT("{}!", long_string);
+    REQUIRE(deferred.deferred_count == 1);
+    REQUIRE(deferred_logs.back() == long_string + "!");
+  }
+
+  {
+    INFO("Messages mixing streamed items are formatted eagerly");
+    CCF_LOG_OUT(INFO, "") << CCF_LOG_FMT_2("{}", 1) << " and " << 2;
+    REQUIRE(deferred.deferred_count == 1);
+    REQUIRE(deferred_logs.back() == "1 and 2");
+  }
+
+  {
+    INFO("Truncated arguments are rejected");
+    ccf::logger::FormatSite site("{}");
+    ccf::logger::DeferredFormat d(site);
+    REQUIRE(d.capture(name));
+    const auto args = d.get_args();
+    ccf::logger::DeferredFormat received(
+      site.id, site.format, args.subspan(0, args.size() - 1));
+    REQUIRE_THROWS(received.format());
+  }
+
+  ccf::logger::config::loggers().clear();
+}
+
+TEST_CASE("Only verbose deferred messages are dropped by a full ringbuffer")
+{
+  auto buffer = std::make_unique<ringbuffer::TestBuffer>(1 << 12);
+  ringbuffer::Reader reader(buffer->bd);
+  ccf::logger::config::loggers().emplace_back(
+    std::make_unique<ccf::RingbufferLogger>(
+      std::make_shared<ringbuffer::Writer>(reader)));
+
+  size_t infos = 0;
+  size_t fails = 0;
+  size_t dropped = 0;
+  auto drain = [&]() {
+    return reader.read(
+      -1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+        if (m == AdminMessage::log_deferred_msg)
+        {
+          auto [us, site_id, thread_id, dropped_before, args] =
+            ringbuffer::read_message<AdminMessage::log_deferred_msg>(
+              data, size);
+          dropped += dropped_before;
+          // The failure is the only message with no argument
+          if (args.size == 0)
+          {
+            ++fails;
+          }
+          else
+          {
+            ++infos;
+          }
+        }
+      });
+  };
+
+  const size_t count = 1000;
+  for (size_t i = 0; i < count; ++i)
+  {
+    LOG_INFO_FMT("info {}", i);
+  }
+  REQUIRE(infos + dropped == 0);
+
+  {
+    INFO("Failures wait for the host to make room");
+    std::atomic<bool> logged = false;
+    std::thread host([&]() {
+      while (!logged)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        drain();
+      }
+    });
+    LOG_FAIL_FMT("failure");
+    logged = true;
+    host.join();
+    drain();
+  }
+
+  REQUIRE(fails == 1);
+  REQUIRE(dropped > 0);
+  REQUIRE(infos + dropped == count);
+
+  ccf::logger::config::loggers().clear();
+}
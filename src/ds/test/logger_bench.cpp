@@ -11,10 +11,32 @@ enum LoggerKind
 
   Console = 0x1,
   JSON = 0x2,
+  Deferred = 0x4,
 
   All = 0xffff,
 };
 
+// Stands in for the enclave's RingbufferLogger, which passes the captured
+// arguments of CCF_LOG_FMT messages to the host rather than formatting them
+class DeferredLogger : public ccf::logger::AbstractLogger
+{
+public:
+  size_t written = 0;
+
+  bool writes_deferred() const override
+  {
+    return true;
+  }
+
+  void write(
+    const ccf::logger::LogLine& ll,
+    const std::optional<double>& enclave_offset = std::nullopt) override
+  {
+    written += ll.deferred.has_value() ? ll.deferred->get_args().size() :
+                                         ll.msg.size();
+  }
+};
+
 template <LoggerKind LK, bool Absorb = true>
 static void prepare_loggers()
 {
@@ -32,6 +54,12 @@ static void prepare_loggers()
       std::make_unique<ccf::logger::JsonConsoleLogger>());
   }
 
+  if constexpr ((LK & LoggerKind::Deferred) != 0)
+  {
+    ccf::logger::config::loggers().emplace_back(
+      std::make_unique<DeferredLogger>());
+  }
+
   if constexpr (Absorb)
   {
     // Swallow all output for duration of benchmarks
@@ -82,6 +110,25 @@ static void log_accepted_fmt(picobench::state& s)
   reset_loggers();
 }
 
+template <LoggerKind LK, bool Absorb = true>
+static void log_accepted_fmt_args(picobench::state& s)
+{
+  prepare_loggers<LK, Absorb>();
+
+  const std::string name = "alice";
+  ccf::logger::config::level() = ccf::LoggerLevel::DEBUG;
+  {
+    picobench::scope scope(s);
+
+    for (size_t i = 0; i < s.iterations(); ++i)
+    {
+      LOG_DEBUG_FMT("request {} from {} took {:.3f}ms", i, name, i * 0.001);
+    }
+  }
+
+  reset_loggers();
+}
+
 template <LoggerKind LK, bool Absorb = true>
 static void log_rejected(picobench::state& s)
 {
@@ -139,6 +186,16 @@ PICOBENCH(json_reject).iterations(sizes).samples(10);
 auto json_reject_fmt = log_rejected_fmt<LoggerKind::JSON>;
 PICOBENCH(json_reject_fmt).iterations(sizes).samples(10);
 
+auto console_accept_fmt_args = log_accepted_fmt_args<LoggerKind::Console>;
+PICOBENCH(console_accept_fmt_args).iterations(sizes).samples(10);
+
+// The enclave's logger, which leaves formatting of CCF_LOG_FMT messages to the
+// host
+auto deferred_accept_fmt = log_accepted_fmt<LoggerKind::Deferred>;
+PICOBENCH(deferred_accept_fmt).iterations(sizes).samples(10);
+auto deferred_accept_fmt_args = log_accepted_fmt_args<LoggerKind::Deferred>;
+PICOBENCH(deferred_accept_fmt_args).iterations(sizes).samples(10);
+
 // The enabled benchmarks are artifically cheap since they talk to a broken
 // stream, skipping the cost of _actually writing something_. To compare this,
 // uncomment the lines below (~3x slower)
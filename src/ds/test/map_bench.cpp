@@ -1,12 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
-#define PICOBENCH_IMPLEMENT_WITH_MAIN
+#define PICOBENCH_IMPLEMENT
 #include "../champ_map.h"
 #include "../rb_map.h"
 
+#include <fstream>
+#include <malloc.h>
 #include <map>
 #include <picobench/picobench.hpp>
+#include <sys/wait.h>
+#include <thread>
 #include <type_traits>
+#include <unistd.h>
 #include <unordered_map>
 
 using namespace std;
@@ -237,3 +242,58 @@ auto bench_std_map_remove = benchmark_remove<std::map<K, V>>;
 PICOBENCH(bench_std_map_remove).iterations(sizes).samples(10);
 auto bench_unord_map_remove = benchmark_remove<std::unordered_map<K, V>>;
 PICOBENCH(bench_unord_map_remove).iterations(sizes).samples(10);
+
+// Resident set size of the process, in bytes
+static size_t get_rss()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0;
+  size_t resident = 0;
+  statm >> size >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Reports the growth of the resident set size while building a map of the
+// given size. This is measured in a child process, after releasing free heap
+// memory, so that measurements do not depend on each other.
+template <class M>
+static void report_rss(const std::string& name, size_t size)
+{
+  const auto pid = fork();
+  if (pid == 0)
+  {
+    malloc_trim(0);
+    const auto before = get_rss();
+    auto map = gen_map<M>(size);
+    const auto after = get_rss();
+    do_not_optimize(map);
+    std::cout << fmt::format(
+                   "  {}<{}>: {}KB", name, size, (after - before) / 1024)
+              << std::endl;
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+}
+
+int main(int argc, char** argv)
+{
+  // With libstdc++, std::shared_ptr reference counts are not atomic until a
+  // second thread has been started. Maps are always used from multiple
+  // threads in a node, so this is done up front for representative results.
+  std::thread([]() {}).join();
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  auto ret = runner.run();
+
+  // Values are kept small, so that the memory used by the map's nodes is not
+  // dwarfed by that of the values
+  val_size = 1;
+  std::cout << "Resident memory growth while building map" << std::endl;
+  for (const size_t size : {32 << 8, 32 << 12, 32 << 14})
+  {
+    report_rss<rb::Map<K, V>>("rb::Map", size);
+    report_rss<champ::Map<K, V>>("champ::Map", size);
+  }
+  return ret;
+}
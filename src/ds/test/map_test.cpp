@@ -424,3 +424,53 @@ TEST_CASE_TEMPLATE("Foreach", M, RBMap, ChampMap)
   size_t threshold = map.size() / 2;
   forall_threshold(map, threshold);
 }
+
+TEST_CASE_TEMPLATE("Diff", M, ChampMap, RBMap)
+{
+  size_t ops_count = 2048;
+  auto base = gen_map<M>(ops_count);
+
+  INFO("Unchanged map has empty diff");
+  {
+    size_t diff_count = 0;
+    base.foreach_diff(
+      base,
+      [&diff_count](const K&, const V&) { diff_count++; },
+      [&diff_count](const K&) { diff_count++; });
+    REQUIRE(diff_count == 0);
+  }
+
+  INFO("Applying diff to base produces current map");
+  {
+    auto map = base;
+    auto ops = gen_ops<M>(ops_count / 8);
+    Model model;
+    for (auto& op : ops)
+    {
+      auto r = op->apply(model, map);
+      map = r.second;
+    }
+
+    auto patched = base;
+    size_t put_count = 0;
+    map.foreach_diff(
+      base,
+      [&patched, &put_count](const K& k, const V& v) {
+        patched = patched.put(k, v);
+        put_count++;
+      },
+      [&patched, &map](const K& k) {
+        REQUIRE(!map.get(k).has_value());
+        patched = patched.remove(k);
+      });
+
+    REQUIRE(put_count <= map.size());
+    REQUIRE(patched.size() == map.size());
+    map.foreach([&patched](const K& k, const V& v) {
+      auto p = patched.get(k);
+      REQUIRE(p.has_value());
+      REQUIRE(p.value() == v);
+      return true;
+    });
+  }
+}
@@ -148,6 +148,134 @@ TEST_CASE("Dispatch" * doctest::test_suite("messaging"))
   }
 }
 
+TEST_CASE("Dispatch statistics" * doctest::test_suite("messaging"))
+{
+  Dispatcher<Message> d("Test");
+
+  // A mix of hashed (as used for ringbuffer messages) and sequential types,
+  // enough to grow the dispatch table several times
+  std::vector<Message> types;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    types.push_back(ccf::ds::fnv_1a<Message>(std::to_string(i).c_str()));
+    types.push_back(Const::msg_min + i);
+  }
+
+  std::vector<size_t> calls(types.size(), 0);
+  for (size_t i = 0; i < types.size(); ++i)
+  {
+    d.set_message_handler(
+      types[i], "type", [&calls, i](const uint8_t*, size_t) { ++calls[i]; });
+  }
+
+  INFO("Each type is dispatched to its own handler");
+  {
+    for (size_t i = 0; i < types.size(); ++i)
+    {
+      for (size_t n = 0; n <= i % 3; ++n)
+      {
+        d.dispatch(types[i], nullptr, i);
+      }
+    }
+
+    const auto counts = d.retrieve_message_counts();
+    REQUIRE(counts.size() == types.size());
+    for (size_t i = 0; i < types.size(); ++i)
+    {
+      REQUIRE(calls[i] == i % 3 + 1);
+
+      const auto& c = counts.at(types[i]);
+      REQUIRE(c.messages == calls[i]);
+      REQUIRE(c.bytes == calls[i] * i);
+      REQUIRE(
+        std::accumulate(c.latency_ns.begin(), c.latency_ns.end(), 0ul) == 1);
+    }
+
+    REQUIRE(d.retrieve_message_counts().empty());
+  }
+
+  INFO("Handlers can register handlers for new types while being called");
+  {
+    constexpr Message outer = Const::msg_min + 1000;
+    constexpr Message inner_base = Const::msg_min + 2000;
+    size_t inner_calls = 0;
+    DISPATCHER_SET_MESSAGE_HANDLER(d, outer, [&](const uint8_t*, size_t) {
+      for (size_t i = 0; i < 100; ++i)
+      {
+        DISPATCHER_SET_MESSAGE_HANDLER(
+          d, inner_base + i, [&](const uint8_t*, size_t) { ++inner_calls; });
+      }
+    });
+
+    d.dispatch(outer, nullptr, 0);
+    for (size_t i = 0; i < 100; ++i)
+    {
+      d.dispatch(inner_base + i, nullptr, 0);
+    }
+    REQUIRE(inner_calls == 100);
+    REQUIRE(d.retrieve_message_counts().at(outer).messages == 1);
+  }
+
+  INFO("Handler latency is recorded");
+  {
+    constexpr Message slow = Const::msg_min + 3000;
+    DISPATCHER_SET_MESSAGE_HANDLER(d, slow, [](const uint8_t*, size_t) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    d.dispatch(slow, nullptr, 0);
+    const auto counts = d.retrieve_message_counts().at(slow);
+    REQUIRE(counts.get_latency_percentile(0.5) >= 1'000'000);
+    REQUIRE(counts.get_latency_percentile(0.5) < 1'000'000'000);
+  }
+
+  INFO("Latency sampling can be configured or disabled");
+  {
+    REQUIRE_THROWS_AS(d.set_latency_sample_rate(3), std::logic_error);
+
+    const auto sampled = [&d, &types](size_t messages) {
+      for (size_t i = 0; i < messages; ++i)
+      {
+        d.dispatch(types[0], nullptr, 0);
+      }
+      const auto c = d.retrieve_message_counts().at(types[0]);
+      REQUIRE(c.messages == messages);
+      return std::accumulate(c.latency_ns.begin(), c.latency_ns.end(), 0ul);
+    };
+
+    d.set_latency_sample_rate(4);
+    REQUIRE(sampled(16) == 4);
+
+    d.set_latency_sample_rate(0);
+    REQUIRE(sampled(16) == 0);
+
+    d.set_latency_sample_rate(Counts::default_latency_sample_rate);
+  }
+
+  INFO("Counts can be passed between processes in binary form");
+  {
+    d.dispatch(types[0], nullptr, 10);
+    d.dispatch(types[0], nullptr, 20);
+    d.dispatch(types[1], nullptr, 30);
+
+    const auto labelled = d.label_message_counts(d.retrieve_message_counts());
+    REQUIRE(labelled.size() == 1);
+
+    const auto serialised = serialise_labelled_counts(labelled);
+    const auto received =
+      deserialise_labelled_counts(serialised.data(), serialised.size());
+    REQUIRE(received.size() == 1);
+
+    const auto& counts = received.at("type");
+    REQUIRE(counts.messages == 3);
+    REQUIRE(counts.bytes == 60);
+    REQUIRE(counts.latency_ns == labelled.at("type").latency_ns);
+
+    REQUIRE_THROWS(
+      deserialise_labelled_counts(serialised.data(), serialised.size() - 1));
+  }
+}
+
 TEST_CASE("Basic message loop" * doctest::test_suite("messaging"))
 {
   enum : Message
@@ -2,6 +2,7 @@
 // Licensed under the Apache 2.0 License.
 #define PICOBENCH_IMPLEMENT_WITH_MAIN
 #define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#include "../messaging.h"
 #include "../ring_buffer.h"
 
 #include <picobench/picobench.hpp>
@@ -182,3 +183,80 @@ auto spin_200 = specialize<32, 1, 4, spin_pause_handler<200>>;
 FIXED_PICO(spin_200);
 auto spin_400 = specialize<32, 1, 4, spin_pause_handler<400>>;
 FIXED_PICO(spin_400);
+
+// Measures the cost of dispatching messages to handlers by type, rather than
+// of the ringbuffer itself. All messages are written before timing starts
+template <
+  size_t TypeCount,
+  bool Dispatch = true,
+  size_t SampleRate = messaging::Counts::default_latency_sample_rate>
+static void dispatch_impl(picobench::state& s)
+{
+  const size_t msg_count = s.iterations();
+  constexpr size_t message_size = 16;
+
+  auto buffer = std::make_unique<ringbuffer::TestBuffer>(
+    std::bit_ceil(Const::entry_size(message_size) * msg_count) * 2);
+  Reader r(buffer->bd);
+  Writer w(r);
+
+  // Message types are hashes, as they are for real ringbuffer messages
+  std::vector<Message> types;
+  for (size_t i = 0; i < TypeCount; ++i)
+  {
+    types.push_back(ccf::ds::fnv_1a<Message>(std::to_string(i).c_str()));
+  }
+
+  messaging::BufferProcessor bp("bench");
+  bp.get_dispatcher().set_latency_sample_rate(SampleRate);
+  size_t handled = 0;
+  for (const auto type : types)
+  {
+    bp.set_message_handler(
+      type, "bench", [&handled](const uint8_t*, size_t) { ++handled; });
+  }
+
+  std::vector<uint8_t> payload(message_size);
+  for (size_t i = 0; i < msg_count; ++i)
+  {
+    w.write(
+      types[i % TypeCount],
+      serializer::ByteRange{payload.data(), message_size});
+  }
+
+  s.start_timer();
+  if constexpr (Dispatch)
+  {
+    bp.read_all(r);
+  }
+  else
+  {
+    while (r.read(-1, [&handled](Message, const uint8_t*, size_t) {
+      ++handled;
+    }) != 0)
+    {
+    }
+  }
+  s.stop_timer();
+
+  if (handled != msg_count)
+    throw std::logic_error("Handled unexpected number of messages");
+}
+
+const std::vector<int> dispatch_counts = {10000, 100000};
+
+PICOBENCH_SUITE("dispatch (16b per-message)");
+auto read_only = dispatch_impl<1, false>;
+PICOBENCH(read_only).iterations(dispatch_counts).samples(10).baseline();
+auto dispatch_1_type = dispatch_impl<1>;
+PICOBENCH(dispatch_1_type).iterations(dispatch_counts).samples(10);
+auto dispatch_8_types = dispatch_impl<8>;
+PICOBENCH(dispatch_8_types).iterations(dispatch_counts).samples(10);
+auto dispatch_32_types = dispatch_impl<32>;
+PICOBENCH(dispatch_32_types).iterations(dispatch_counts).samples(10);
+auto dispatch_1_type_untimed = dispatch_impl<1, true, 0>;
+PICOBENCH(dispatch_1_type_untimed).iterations(dispatch_counts).samples(10);
+auto dispatch_8_types_untimed = dispatch_impl<8, true, 0>;
+PICOBENCH(dispatch_8_types_untimed).iterations(dispatch_counts).samples(10);
+auto dispatch_32_types_untimed = dispatch_impl<32, true, 0>;
+PICOBENCH(dispatch_32_types_untimed).iterations(dispatch_counts).samples(10);
@@ -2,7 +2,10 @@
 // Licensed under the Apache 2.0 License.
 #include "../thread_messaging.h"
 
+#include <array>
 #include <doctest/doctest.h>
+#include <functional>
+#include <thread>
 
 struct Foo
 {
@@ -210,3 +213,386 @@ TEST_CASE("Unique thread IDs" * doctest::test_suite("threadmessaging"))
     fmt::format(
       "Thread IDs are not unique: {}", fmt::join(assigned_ids, ", ")));
 }
+
+struct Step
+{
+  std::vector<std::string>& log;
+  std::string name;
+  std::function<void()> during;
+
+  Step(
+    std::vector<std::string>& log_,
+    const std::string& name_,
+    std::function<void()> during_) :
+    log(log_),
+    name(name_),
+    during(during_)
+  {}
+};
+
+static void log_step(std::unique_ptr<::threading::Tmsg<Step>> msg)
+{
+  if (msg->data.during != nullptr)
+  {
+    msg->data.during();
+  }
+  msg->data.log.push_back(msg->data.name);
+}
+
+TEST_CASE("Work stealing" * doctest::test_suite("threadmessaging"))
+{
+  // Threads are identified explicitly, so that tasks can be run "on" several
+  // threads from the test thread
+  static constexpr auto main_id = ccf::threading::MAIN_THREAD_ID;
+  static constexpr auto worker_a_id = main_id + 1;
+  static constexpr auto worker_b_id = worker_a_id + 1;
+
+  ::threading::ThreadMessaging tm(3);
+  std::vector<std::string> log;
+
+  auto add = [&](
+               uint16_t tid,
+               const std::string& name,
+               std::optional<uint64_t> key = std::nullopt,
+               std::function<void()> during = nullptr) {
+    tm.add_stealable_task<Step>(
+      tid,
+      std::make_unique<::threading::Tmsg<Step>>(&log_step, log, name, during),
+      key);
+  };
+
+  INFO("Stealable tasks are only run by their own thread by default");
+  {
+    add(worker_a_id, "a");
+    REQUIRE_FALSE(tm.run_one(worker_b_id));
+    REQUIRE(tm.get_metrics()[worker_a_id].queue_depth == 1);
+    REQUIRE(tm.run_one(worker_a_id));
+    REQUIRE(log == std::vector<std::string>{"a"});
+  }
+
+  tm.set_work_stealing();
+  log.clear();
+
+  INFO("Idle workers steal stealable tasks, but never owned tasks");
+  {
+    bool happened = false;
+    tm.add_task<Foo>(
+      worker_a_id, std::make_unique<::threading::Tmsg<Foo>>(&always, happened));
+    add(worker_a_id, "a");
+
+    REQUIRE(tm.run_one(worker_b_id));
+    REQUIRE(log == std::vector<std::string>{"a"});
+    REQUIRE_FALSE(tm.run_one(worker_b_id));
+    REQUIRE_FALSE(happened);
+
+    REQUIRE(tm.run_one(worker_a_id));
+    REQUIRE(happened);
+
+    const auto metrics = tm.get_metrics();
+    REQUIRE(metrics[worker_a_id].queue_depth == 0);
+    REQUIRE(metrics[worker_a_id].tasks_stolen == 0);
+    REQUIRE(metrics[worker_b_id].tasks_stolen == 1);
+    REQUIRE(metrics[worker_b_id].tasks_run == 1);
+  }
+
+  log.clear();
+
+  INFO("The main thread does not steal");
+  {
+    add(worker_a_id, "a");
+    REQUIRE_FALSE(tm.run_one(main_id));
+    REQUIRE(tm.run_one(worker_a_id));
+  }
+
+  log.clear();
+
+  INFO("Tasks with the same ordering key are never run concurrently");
+  {
+    static constexpr uint64_t key_x = 1;
+    static constexpr uint64_t key_y = 2;
+
+    // While x1 is running on worker a, worker b skips x2 (blocked by x1) and
+    // steals y1 instead
+    add(worker_a_id, "x1", key_x, [&]() {
+      REQUIRE(tm.run_one(worker_b_id));
+      REQUIRE(log == std::vector<std::string>{"y1"});
+      REQUIRE_FALSE(tm.run_one(worker_b_id));
+    });
+    add(worker_a_id, "x2", key_x);
+    add(worker_a_id, "y1", key_y);
+
+    REQUIRE(tm.run_one(worker_a_id));
+    REQUIRE(log == std::vector<std::string>{"y1", "x1"});
+
+    REQUIRE(tm.run_one(worker_b_id));
+    REQUIRE(log == std::vector<std::string>{"y1", "x1", "x2"});
+  }
+
+  log.clear();
+
+  INFO("Tasks blocked by a running task with the same key are not runnable");
+  {
+    static constexpr uint64_t key_x = 1;
+
+    add(worker_a_id, "x1", key_x, [&]() {
+      // x2 is queued, but idle workers have no work until x1 completes
+      REQUIRE(tm.get_metrics()[worker_a_id].queue_depth == 1);
+      REQUIRE_FALSE(tm.has_work(worker_b_id));
+      REQUIRE_FALSE(tm.run_one(worker_b_id));
+    });
+    add(worker_a_id, "x2", key_x);
+    REQUIRE(tm.has_work(worker_b_id));
+
+    REQUIRE(tm.run_one(worker_a_id));
+    REQUIRE(tm.has_work(worker_b_id));
+    REQUIRE(tm.run_one(worker_b_id));
+    REQUIRE(log == std::vector<std::string>{"x1", "x2"});
+    REQUIRE_FALSE(tm.has_work(worker_b_id));
+  }
+}
+
+TEST_CASE(
+  "Concurrent work stealing preserves order" *
+  doctest::test_suite("threadmessaging"))
+{
+  static constexpr size_t workers_count = 4;
+  static constexpr size_t keys_count = 8;
+  static constexpr size_t tasks_per_key = 200;
+
+  ::threading::ThreadMessaging tm(workers_count + 1);
+  tm.set_work_stealing();
+
+  struct KeyState
+  {
+    std::atomic<bool> running = false;
+    std::vector<size_t> order;
+  };
+  std::array<KeyState, keys_count> keys;
+
+  struct Record
+  {
+    KeyState& key;
+    size_t seqno;
+
+    Record(KeyState& key_, size_t seqno_) : key(key_), seqno(seqno_) {}
+  };
+
+  // All tasks are queued for a single worker, and must be run in order per
+  // key, even though other workers steal them
+  for (size_t i = 0; i < tasks_per_key; ++i)
+  {
+    for (size_t k = 0; k < keys_count; ++k)
+    {
+      tm.add_stealable_task<Record>(
+        1,
+        std::make_unique<::threading::Tmsg<Record>>(
+          [](std::unique_ptr<::threading::Tmsg<Record>> msg) {
+            auto& key = msg->data.key;
+            REQUIRE_FALSE(key.running.exchange(true));
+            key.order.push_back(msg->data.seqno);
+            key.running.store(false);
+          },
+          keys[k],
+          i),
+        k);
+    }
+  }
+
+  std::atomic<size_t> remaining = keys_count * tasks_per_key;
+  std::vector<std::thread> threads;
+  for (uint16_t tid = 1; tid <= workers_count; ++tid)
+  {
+    threads.emplace_back([&, tid]() {
+      while (remaining.load() > 0)
+      {
+        if (tm.run_one(tid))
+        {
+          --remaining;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (auto& key : keys)
+  {
+    REQUIRE(key.order.size() == tasks_per_key);
+    REQUIRE(std::is_sorted(key.order.begin(), key.order.end()));
+  }
+
+  size_t total_run = 0;
+  for (const auto& m : tm.get_metrics())
+  {
+    REQUIRE(m.queue_depth == 0);
+    total_run += m.tasks_run;
+  }
+  REQUIRE(total_run == keys_count * tasks_per_key);
+}
+
+TEST_CASE(
+  "Idle threads wake for tasks" * doctest::test_suite("threadmessaging"))
+{
+  ::threading::ThreadMessaging tm(2);
+
+  ds::Doorbell doorbell;
+  tm.set_doorbell(1, doorbell);
+
+  // Far longer than the test should take, so that tasks are only run promptly
+  // if adding them wakes the worker
+  constexpr std::chrono::seconds backstop(30);
+
+  std::atomic<size_t> run_count = 0;
+  std::atomic<bool> stop = false;
+  std::thread worker([&]() {
+    while (!stop.load())
+    {
+      if (tm.run_one(1))
+      {
+        ++run_count;
+      }
+      else
+      {
+        doorbell.wait(
+          [&]() { return stop.load() || tm.has_work(1); }, backstop);
+      }
+    }
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i <= 3; ++i)
+  {
+    // Give the worker time to block before each task is added
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    bool happened = false;
+    tm.add_task<Foo>(
+      1, std::make_unique<::threading::Tmsg<Foo>>(&always, happened));
+    while (run_count.load() < i)
+    {
+      std::this_thread::yield();
+    }
+    REQUIRE(happened);
+  }
+
+  INFO("Finishing also wakes idle threads");
+  stop.store(true);
+  tm.set_finished();
+  worker.join();
+  REQUIRE(std::chrono::steady_clock::now() - start < backstop);
+}
+
+TEST_CASE(
+  "Stealable tasks wake a single idle thread" *
+  doctest::test_suite("threadmessaging"))
+{
+  static constexpr uint16_t worker_a_id = 1;
+  static constexpr uint16_t worker_b_id = 2;
+  static constexpr uint16_t worker_c_id = 3;
+
+  ::threading::ThreadMessaging tm(4);
+  tm.set_work_stealing();
+
+  std::array<ds::Doorbell, 4> doorbells;
+  for (uint16_t tid = worker_a_id; tid <= worker_c_id; ++tid)
+  {
+    tm.set_doorbell(tid, doorbells[tid]);
+  }
+
+  // Far longer than the test should take, so that idle threads only return
+  // promptly if they are woken
+  constexpr std::chrono::seconds backstop(30);
+
+  std::vector<std::string> log;
+  auto add = [&](
+               uint16_t tid,
+               const std::string& name,
+               std::optional<uint64_t> key = std::nullopt,
+               std::function<void()> during = nullptr) {
+    tm.add_stealable_task<Step>(
+      tid,
+      std::make_unique<::threading::Tmsg<Step>>(&log_step, log, name, during),
+      key);
+  };
+
+  auto wait_idle = [&](uint16_t tid) {
+    return std::thread([&, tid]() {
+      doorbells[tid].wait([&]() { return tm.has_work(tid); }, backstop);
+    });
+  };
+
+  auto wait_for_waiter = [&](uint16_t tid) {
+    while (!doorbells[tid].has_waiters())
+    {
+      std::this_thread::yield();
+    }
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+
+  INFO("An idle owning thread is woken, rather than other idle threads");
+  {
+    auto idle_a = wait_idle(worker_a_id);
+    auto idle_b = wait_idle(worker_b_id);
+    wait_for_waiter(worker_a_id);
+    wait_for_waiter(worker_b_id);
+
+    add(worker_a_id, "a");
+    idle_a.join();
+    REQUIRE(doorbells[worker_b_id].has_waiters());
+
+    REQUIRE(tm.run_one(worker_a_id));
+    doorbells[worker_b_id].ring();
+    idle_b.join();
+  }
+
+  INFO("A single idle thread is woken to steal from a busy thread");
+  {
+    auto idle_b = wait_idle(worker_b_id);
+    auto idle_c = wait_idle(worker_c_id);
+    wait_for_waiter(worker_b_id);
+    wait_for_waiter(worker_c_id);
+
+    add(worker_a_id, "a");
+    while (doorbells[worker_b_id].has_waiters() &&
+           doorbells[worker_c_id].has_waiters())
+    {
+      std::this_thread::yield();
+    }
+    const auto woken = doorbells[worker_b_id].has_waiters() ? worker_c_id :
+                                                              worker_b_id;
+    const auto still_idle =
+      woken == worker_b_id ? worker_c_id : worker_b_id;
+    REQUIRE(doorbells[still_idle].has_waiters());
+
+    REQUIRE(tm.run_one(woken));
+    doorbells[still_idle].ring();
+    idle_b.join();
+    idle_c.join();
+  }
+
+  log.clear();
+
+  INFO("An idle thread is woken when a blocked task becomes runnable");
+  {
+    static constexpr uint64_t key_x = 1;
+
+    std::thread idle_b;
+    add(worker_a_id, "x1", key_x, [&]() {
+      // x2 is blocked by x1, so worker b has no work and waits
+      idle_b = wait_idle(worker_b_id);
+      wait_for_waiter(worker_b_id);
+    });
+    add(worker_a_id, "x2", key_x);
+
+    REQUIRE(tm.run_one(worker_a_id));
+    idle_b.join();
+    REQUIRE(tm.run_one(worker_b_id));
+    REQUIRE(log == std::vector<std::string>{"x1", "x2"});
+  }
+
+  REQUIRE(std::chrono::steady_clock::now() - start < backstop);
+}
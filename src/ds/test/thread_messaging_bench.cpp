@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+#define PICOBENCH_DONT_BIND_TO_ONE_CORE
+#include "../thread_messaging.h"
+
+#include <algorithm>
+#include <picobench/picobench.hpp>
+#include <thread>
+
+static constexpr uint16_t workers_count = 4;
+static constexpr size_t sessions_count = 16;
+
+// Time from a task being queued until it has run, per benchmark, to report
+// tail latency
+std::map<std::string, std::vector<std::chrono::nanoseconds>> latencies;
+
+struct SessionTask
+{
+  std::chrono::high_resolution_clock::time_point queued;
+  std::chrono::nanoseconds& latency;
+  std::atomic<size_t>& remaining;
+
+  SessionTask(
+    std::chrono::high_resolution_clock::time_point queued_,
+    std::chrono::nanoseconds& latency_,
+    std::atomic<size_t>& remaining_) :
+    queued(queued_),
+    latency(latency_),
+    remaining(remaining_)
+  {}
+};
+
+static void session_task(std::unique_ptr<::threading::Tmsg<SessionTask>> msg)
+{
+  // Simulate the execution of a small request
+  volatile size_t i = 0;
+  while (i < 2000)
+  {
+    i = i + 1;
+  }
+
+  msg->data.latency =
+    std::chrono::high_resolution_clock::now() - msg->data.queued;
+  --msg->data.remaining;
+}
+
+// Queues s.iterations() tasks for sessions_count sessions, each pinned to a
+// worker thread. HotPercent of the tasks belong to the sessions of the first
+// worker, the rest are spread uniformly across all sessions. Tasks of the
+// same session are ordered by session ID, as HTTP/1.1 request processing
+// tasks are (see HTTPServerSession).
+template <size_t HotPercent, bool WorkStealing>
+static void skewed(picobench::state& s)
+{
+  ::threading::ThreadMessaging tm(workers_count + 1);
+  tm.set_work_stealing(WorkStealing);
+
+  auto& lat = latencies[fmt::format(
+    "{}<{}>", WorkStealing ? "stealing" : "pinned", HotPercent)];
+  std::vector<std::chrono::nanoseconds> task_latencies(s.iterations());
+  std::atomic<size_t> remaining = s.iterations();
+
+  std::vector<size_t> hot_sessions;
+  for (size_t i = 0; i < sessions_count; ++i)
+  {
+    if (tm.get_execution_thread(i) == 1)
+    {
+      hot_sessions.push_back(i);
+    }
+  }
+
+  std::atomic<bool> started = false;
+  std::vector<std::thread> workers;
+  for (uint16_t tid = 1; tid <= workers_count; ++tid)
+  {
+    workers.emplace_back([&, tid]() {
+      while (!started.load())
+      {
+        std::this_thread::yield();
+      }
+      while (remaining.load() > 0)
+      {
+        if (!tm.run_one(tid))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  s.start_timer();
+  for (size_t i = 0; i < s.iterations(); ++i)
+  {
+    size_t session = i % sessions_count;
+    if ((i * 7919) % 100 < HotPercent)
+    {
+      session = hot_sessions[i % hot_sessions.size()];
+    }
+
+    tm.add_stealable_task(
+      tm.get_execution_thread(session),
+      std::make_unique<::threading::Tmsg<SessionTask>>(
+        &session_task,
+        std::chrono::high_resolution_clock::now(),
+        task_latencies[i],
+        remaining),
+      session);
+
+    if (i == 0)
+    {
+      started.store(true);
+    }
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+  s.stop_timer();
+
+  lat.insert(lat.end(), task_latencies.begin(), task_latencies.end());
+}
+
+const std::vector<int> task_counts = {10000};
+
+PICOBENCH_SUITE("uniform load");
+auto pinned_0 = skewed<0, false>;
+PICOBENCH(pinned_0).iterations(task_counts).samples(10).baseline();
+auto stealing_0 = skewed<0, true>;
+PICOBENCH(stealing_0).iterations(task_counts).samples(10);
+
+PICOBENCH_SUITE("skewed load");
+auto pinned_80 = skewed<80, false>;
+PICOBENCH(pinned_80).iterations(task_counts).samples(10).baseline();
+auto stealing_80 = skewed<80, true>;
+PICOBENCH(stealing_80).iterations(task_counts).samples(10);
+
+int main(int argc, char** argv)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  auto ret = runner.run();
+
+  std::cout << "Per-task latency" << std::endl;
+  for (auto& [name, lat] : latencies)
+  {
+    if (lat.empty())
+    {
+      continue;
+    }
+    std::sort(lat.begin(), lat.end());
+    const auto p50 = lat[lat.size() / 2];
+    const auto p99 = lat[lat.size() * 99 / 100];
+    std::cout << fmt::format(
+                   "  {}: p50 {}ns, p99 {}ns", name, p50.count(), p99.count())
+              << std::endl;
+  }
+  return ret;
+}
@@ -3,12 +3,19 @@
 #pragma once
 
 #include "ccf/ds/logger.h"
+#include "ccf/pal/locking.h"
 #include "ccf/threading/thread_ids.h"
 #include "ds/ccf_assert.h"
+#include "ds/doorbell.h"
 
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
 
 namespace threading
 {
@@ -43,16 +50,88 @@ namespace threading
 
   class ThreadMessaging;
 
+  struct TaskQueueMetrics
+  {
+    // Number of tasks currently waiting in the queue
+    size_t queue_depth = 0;
+    // Number of tasks run by the queue's thread, including stolen tasks
+    size_t tasks_run = 0;
+    // Number of tasks the queue's thread stole from other queues
+    size_t tasks_stolen = 0;
+  };
+
   class TaskQueue
   {
     std::atomic<ThreadMsg*> item_head = nullptr;
     ThreadMsg* local_msg = nullptr;
 
+    // Stealable tasks may be run by any thread (in work stealing mode), so
+    // are not owned by the queue's thread and are protected by a lock. Tasks
+    // which share an ordering key are run one at a time, in the order they
+    // were added: only the oldest task of each key is runnable, the others are
+    // blocked until it has run.
+    struct StealableTask
+    {
+      ThreadMsg* msg;
+      std::optional<uint64_t> ordering_key;
+    };
+
+    ccf::pal::Mutex stealable_lock;
+    // Tasks which can run now, in the order they became runnable
+    std::deque<StealableTask> runnable_tasks;
+    // For each key with a task runnable or running, the tasks with that key
+    // blocked behind it
+    std::map<uint64_t, std::deque<ThreadMsg*>> active_keys;
+    std::atomic<size_t> runnable_count = 0;
+    bool stealable_turn = false;
+
+    // Called whenever a stealable task becomes runnable, to wake a thread
+    // which may run it. Rings the queue's doorbell unless replaced
+    std::function<void()> on_stealable_runnable = nullptr;
+
+    std::atomic<size_t> queue_depth = 0;
+    std::atomic<size_t> tasks_run = 0;
+    std::atomic<size_t> tasks_stolen = 0;
+
+    // Rung as tasks are added, to wake the queue's thread if it is waiting
+    // for work. May be replaced by a doorbell shared with another source of
+    // work for the same thread
+    ds::Doorbell own_doorbell;
+    ds::Doorbell* doorbell = nullptr;
+
   public:
     TaskQueue() = default;
 
+    ds::Doorbell& get_doorbell()
+    {
+      return doorbell != nullptr ? *doorbell : own_doorbell;
+    }
+
+    // True if the queue's thread has tasks of its own to run. Should only be
+    // called by that thread
+    bool has_pending()
+    {
+      return local_msg != nullptr || item_head.load() != nullptr ||
+        runnable_count.load() != 0;
+    }
+
+    // True if the queue has a stealable task which can run now (i.e. not
+    // blocked by a task with the same ordering key)
+    bool has_stealable()
+    {
+      return runnable_count.load() != 0;
+    }
+
     bool run_next_task()
     {
+      // Alternate between owned and stealable tasks, so that neither kind
+      // can starve the other
+      stealable_turn = !stealable_turn;
+      if (stealable_turn && run_stealable_task(*this))
+      {
+        return true;
+      }
+
       if (local_msg == nullptr && item_head != nullptr)
       {
         local_msg = item_head.exchange(nullptr);
@@ -61,24 +140,113 @@ namespace threading
 
       if (local_msg == nullptr)
       {
-        return false;
+        return !stealable_turn && run_stealable_task(*this);
       }
 
       ThreadMsg* current = local_msg;
       local_msg = local_msg->next;
 
+      --queue_depth;
+      ++tasks_run;
       current->cb(std::unique_ptr<ThreadMsg>(current));
       return true;
     }
 
     void add_task(ThreadMsg* item)
     {
+      ++queue_depth;
       ThreadMsg* tmp_head;
       do
       {
         tmp_head = item_head.load();
         item->next = tmp_head;
       } while (!item_head.compare_exchange_strong(tmp_head, item));
+
+      get_doorbell().ring();
+    }
+
+    void add_stealable_task(
+      ThreadMsg* item, std::optional<uint64_t> ordering_key)
+    {
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(stealable_lock);
+        ++queue_depth;
+        if (ordering_key.has_value())
+        {
+          auto [it, inserted] = active_keys.try_emplace(ordering_key.value());
+          if (!inserted)
+          {
+            it->second.push_back(item);
+            return;
+          }
+        }
+
+        runnable_tasks.push_back({item, ordering_key});
+        ++runnable_count;
+      }
+
+      notify_stealable_runnable();
+    }
+
+    // Runs the oldest runnable stealable task of this queue, on behalf of
+    // runner (which is this queue when the task is not stolen)
+    bool run_stealable_task(TaskQueue& runner)
+    {
+      if (runnable_count.load() == 0)
+      {
+        return false;
+      }
+
+      std::optional<StealableTask> task = std::nullopt;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(stealable_lock);
+        if (!runnable_tasks.empty())
+        {
+          task = runnable_tasks.front();
+          runnable_tasks.pop_front();
+          --runnable_count;
+          --queue_depth;
+        }
+      }
+
+      if (!task.has_value())
+      {
+        return false;
+      }
+
+      ++runner.tasks_run;
+      if (&runner != this)
+      {
+        ++runner.tasks_stolen;
+      }
+
+      task->msg->cb(std::unique_ptr<ThreadMsg>(task->msg));
+
+      if (task->ordering_key.has_value())
+      {
+        // The next task with the same key, if any, is now runnable
+        {
+          std::lock_guard<ccf::pal::Mutex> guard(stealable_lock);
+          auto it = active_keys.find(task->ordering_key.value());
+          if (it->second.empty())
+          {
+            active_keys.erase(it);
+            return true;
+          }
+
+          runnable_tasks.push_back({it->second.front(), it->first});
+          it->second.pop_front();
+          ++runnable_count;
+        }
+
+        notify_stealable_runnable();
+      }
+      return true;
+    }
+
+    TaskQueueMetrics get_metrics() const
+    {
+      return {queue_depth.load(), tasks_run.load(), tasks_stolen.load()};
     }
 
     struct TimerEntry
@@ -203,6 +371,34 @@ namespace threading
         local_msg = local_msg->next;
         delete current;
       }
+
+      std::lock_guard<ccf::pal::Mutex> guard(stealable_lock);
+      for (auto& task : runnable_tasks)
+      {
+        delete task.msg;
+      }
+      runnable_tasks.clear();
+      for (auto& [_, blocked] : active_keys)
+      {
+        for (auto msg : blocked)
+        {
+          delete msg;
+        }
+      }
+      active_keys.clear();
+      runnable_count = 0;
+    }
+
+    void notify_stealable_runnable()
+    {
+      if (on_stealable_runnable != nullptr)
+      {
+        on_stealable_runnable();
+      }
+      else
+      {
+        get_doorbell().ring();
+      }
     }
 
     friend ThreadMessaging;
@@ -211,7 +407,9 @@ namespace threading
   class ThreadMessaging
   {
     std::atomic<bool> finished;
+    std::atomic<bool> work_stealing = false;
     std::vector<TaskQueue> tasks; // Fixed-size at construction
+    std::atomic<size_t> next_woken = 0;
 
     // Drop all pending tasks, this is only ever to be used
     // on shutdown, to avoid leaks, and after all thread but
@@ -239,9 +437,23 @@ namespace threading
 
     static std::unique_ptr<ThreadMessaging> singleton;
 
+    // The main thread never steals, as it is responsible for processing
+    // messages from the host
+    bool can_steal(uint16_t tid) const
+    {
+      return work_stealing.load() &&
+        (tid != ccf::threading::MAIN_THREAD_ID || tasks.size() == 1);
+    }
+
   public:
     static constexpr uint16_t max_num_threads = 24;
 
+    // An idle thread re-checks for tasks this many times before blocking
+    // until one is added, so that bursts of tasks do not each pay for a
+    // wakeup. The wait is bounded only as a backstop
+    static constexpr size_t idle_spins_before_wait = 1000;
+    static constexpr std::chrono::milliseconds max_idle_wait{50};
+
     ThreadMessaging(uint16_t num_task_queues) :
       finished(false),
       tasks(num_task_queues)
@@ -253,6 +465,13 @@ namespace threading
           num_task_queues,
           max_num_threads));
       }
+
+      for (auto& task : tasks)
+      {
+        task.on_stealable_runnable = [this, &task]() {
+          wake_for_stealable(task);
+        };
+      }
     }
 
     ~ThreadMessaging()
@@ -290,22 +509,102 @@ namespace threading
     void set_finished(bool v = true)
     {
       finished.store(v);
+
+      for (auto& task : tasks)
+      {
+        task.get_doorbell().ring();
+      }
+    }
+
+    // Replaces the doorbell rung when tasks are added for thread tid, so that
+    // it may wait for those and another source of work (such as a ringbuffer)
+    // at once
+    void set_doorbell(uint16_t tid, ds::Doorbell& doorbell)
+    {
+      get_tasks(tid).doorbell = &doorbell;
+    }
+
+    // True if thread tid has a task it could run now, or should stop
+    bool has_work(uint16_t tid)
+    {
+      if (is_finished() || get_tasks(tid).has_pending())
+      {
+        return true;
+      }
+
+      if (can_steal(tid))
+      {
+        for (auto& victim : tasks)
+        {
+          if (victim.has_stealable())
+          {
+            return true;
+          }
+        }
+      }
+
+      return false;
+    }
+
+    // When enabled, worker threads with no tasks of their own run stealable
+    // tasks queued for other threads
+    void set_work_stealing(bool v = true)
+    {
+      work_stealing.store(v);
+    }
+
+    bool get_work_stealing() const
+    {
+      return work_stealing.load();
     }
 
     void run()
     {
-      TaskQueue& task = get_tasks(ccf::threading::get_current_thread_id());
+      const auto tid = ccf::threading::get_current_thread_id();
+      auto& doorbell = get_tasks(tid).get_doorbell();
 
+      size_t consecutive_idles = 0;
       while (!is_finished())
       {
-        task.run_next_task();
+        if (run_one(tid))
+        {
+          consecutive_idles = 0;
+        }
+        else if (++consecutive_idles >= idle_spins_before_wait)
+        {
+          doorbell.wait([this, tid]() { return has_work(tid); }, max_idle_wait);
+          consecutive_idles = 0;
+        }
       }
     }
 
     bool run_one()
     {
-      TaskQueue& task = get_tasks(ccf::threading::get_current_thread_id());
-      return task.run_next_task();
+      return run_one(ccf::threading::get_current_thread_id());
+    }
+
+    bool run_one(uint16_t tid)
+    {
+      TaskQueue& task = get_tasks(tid);
+      if (task.run_next_task())
+      {
+        return true;
+      }
+
+      if (!can_steal(tid))
+      {
+        return false;
+      }
+
+      for (size_t i = 1; i < tasks.size(); ++i)
+      {
+        auto& victim = tasks[(tid + i) % tasks.size()];
+        if (victim.run_stealable_task(task))
+        {
+          return true;
+        }
+      }
+      return false;
     }
 
     template <typename Payload>
@@ -316,6 +615,23 @@ namespace threading
       task.add_task(reinterpret_cast<ThreadMsg*>(msg.release()));
     }
 
+    // Queues a task for thread tid which, in work stealing mode, may instead
+    // be run by an idle worker thread. Such tasks must not depend on the
+    // thread they run on (e.g. session state or timers). Tasks with the same
+    // ordering_key are never run concurrently, and run in the order they were
+    // added, so long as they are all queued for the same thread.
+    template <typename Payload>
+    void add_stealable_task(
+      uint16_t tid,
+      std::unique_ptr<Tmsg<Payload>> msg,
+      std::optional<uint64_t> ordering_key = std::nullopt)
+    {
+      TaskQueue& task = get_tasks(tid);
+
+      task.add_stealable_task(
+        reinterpret_cast<ThreadMsg*>(msg.release()), ordering_key);
+    }
+
     template <typename Payload>
     TaskQueue::TimerEntry add_task_after(
       std::unique_ptr<Tmsg<Payload>> msg, std::chrono::milliseconds ms)
@@ -382,10 +698,54 @@ namespace threading
       return tasks.size();
     }
 
+    std::vector<TaskQueueMetrics> get_metrics() const
+    {
+      std::vector<TaskQueueMetrics> metrics;
+      metrics.reserve(tasks.size());
+      for (const auto& task : tasks)
+      {
+        metrics.push_back(task.get_metrics());
+      }
+      return metrics;
+    }
+
   private:
     bool is_finished()
     {
       return finished.load();
     }
+
+    // Wakes a single thread to run a newly runnable stealable task of owner:
+    // the owning thread if it is waiting for work (or if work stealing is
+    // disabled), otherwise one other idle thread which can steal. If no
+    // thread is waiting, none needs waking: busy threads look for stealable
+    // tasks between their own, and a thread starting to wait re-checks for
+    // work first.
+    void wake_for_stealable(TaskQueue& owner)
+    {
+      auto& owner_doorbell = owner.get_doorbell();
+      if (!work_stealing.load() || owner_doorbell.has_waiters())
+      {
+        owner_doorbell.ring();
+        return;
+      }
+
+      // Start from a different thread each time, to spread stolen tasks
+      const auto start = next_woken.fetch_add(1);
+      for (size_t i = 0; i < tasks.size(); ++i)
+      {
+        const auto tid = static_cast<uint16_t>((start + i) % tasks.size());
+        auto& other = tasks[tid];
+        if (&other != &owner && can_steal(tid))
+        {
+          auto& doorbell = other.get_doorbell();
+          if (doorbell.has_waiters())
+          {
+            doorbell.ring();
+            return;
+          }
+        }
+      }
+    }
   };
 };
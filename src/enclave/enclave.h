@@ -141,9 +141,12 @@ namespace ccf
         writer_factory->create_writer_to_outside());
       context->install_subsystem(historical_state_cache);
 
+      // With worker threads available, strategies are updated in parallel on
+      // those workers
       indexer = std::make_shared<ccf::indexing::Indexer>(
         std::make_shared<ccf::indexing::HistoricalTransactionFetcher>(
-          historical_state_cache));
+          historical_state_cache),
+        ::threading::ThreadMessaging::instance().thread_count() > 1);
       context->install_subsystem(indexer);
 
       lfs_access = std::make_shared<ccf::indexing::EnclaveLFSAccess>(
@@ -170,7 +173,8 @@ namespace ccf
 
       static constexpr size_t max_interpreter_cache_size = 10;
       auto interpreter_cache =
-        std::make_shared<ccf::js::InterpreterCache>(max_interpreter_cache_size);
+        std::make_shared<ccf::js::InterpreterCache>(
+          max_interpreter_cache_size, network.tables);
       context->install_subsystem(interpreter_cache);
 
       context->install_subsystem(
@@ -229,7 +233,7 @@ namespace ccf
     CreateNodeStatus create_new_node(
       StartType start_type_,
       ccf::StartupConfig&& ccf_config_,
-      std::vector<uint8_t>&& startup_snapshot,
+      ccf::SnapshotChain&& startup_snapshot,
       uint8_t* node_cert,
       size_t node_cert_size,
       size_t* node_cert_len,
@@ -246,6 +250,8 @@ namespace ccf
       rpcsessions->update_listening_interface_options(ccf_config_.network);
 
       node->set_n2n_message_limit(ccf_config_.node_to_node_message_limit);
+      node->set_n2n_message_batching(
+        ccf_config_.node_to_node_message_batching);
 
       historical_state_cache->set_soft_cache_limit(
         ccf_config_.historical_cache_soft_limit);
@@ -338,9 +344,11 @@ namespace ccf
           AdminMessage::tick,
           [this, &disp = bp.get_dispatcher()](const uint8_t*, size_t) {
             const auto message_counts = disp.retrieve_message_counts();
-            const auto j = disp.convert_message_counts(message_counts);
             RINGBUFFER_WRITE_MESSAGE(
-              AdminMessage::work_stats, to_host, j.dump());
+              AdminMessage::work_stats,
+              to_host,
+              messaging::serialise_labelled_counts(
+                disp.label_message_counts(message_counts)));
 
             const auto time_now = ccf::get_enclave_time();
             ringbuffer_logger->set_time(time_now);
@@ -448,33 +456,30 @@ namespace ccf
             }
           });
 
-        DISPATCHER_SET_MESSAGE_HANDLER(
-          bp,
-          ::consensus::snapshot_allocated,
-          [this](const uint8_t* data, size_t size) {
-            const auto [snapshot_span, generation_count] =
-              ringbuffer::read_message<::consensus::snapshot_allocated>(
-                data, size);
-
-            node->write_snapshot(snapshot_span, generation_count);
-          });
-
         rpcsessions->register_message_handlers(bp.get_dispatcher());
 
         // Maximum number of inbound ringbuffer messages which will be
         // processed in a single iteration
         static constexpr size_t max_messages = 256;
 
+        auto& thread_messaging = ::threading::ThreadMessaging::instance();
+        auto& inbound = circuit->read_from_outside();
+        const auto tid = ccf::threading::get_current_thread_id();
+
+        // Both the host, writing to the inbound ringbuffer, and other threads,
+        // adding tasks for this thread, ring the same doorbell
+        auto& doorbell = inbound.get_doorbell();
+        thread_messaging.set_doorbell(tid, doorbell);
+
         size_t consecutive_idles = 0u;
         while (!bp.get_finished())
         {
           // First, read some messages from the ringbuffer
-          auto read = bp.read_n(max_messages, circuit->read_from_outside());
+          auto read = bp.read_n(max_messages, inbound);
 
           // Then, execute some thread messages
           size_t thread_msg = 0;
-          while (thread_msg < max_messages &&
-                 ::threading::ThreadMessaging::instance().run_one())
+          while (thread_msg < max_messages && thread_messaging.run_one(tid))
           {
             thread_msg++;
           }
@@ -483,26 +488,24 @@ namespace ccf
           // messages were executed, idle
           if (read == 0 && thread_msg == 0)
           {
-            const auto time_now = ccf::get_enclave_time();
-            static std::chrono::microseconds idling_start_time;
-
-            if (consecutive_idles == 0)
+            // Handle initial idles by pausing, then block until either the
+            // host or another thread has work for this thread
+            if (
+              ++consecutive_idles >=
+              ::threading::ThreadMessaging::idle_spins_before_wait)
             {
-              idling_start_time = time_now;
-            }
-
-            // Handle initial idles by pausing, eventually sleep (in host)
-            constexpr std::chrono::milliseconds timeout(5);
-            if ((time_now - idling_start_time) > timeout)
-            {
-              std::this_thread::sleep_for(timeout * 10);
+              doorbell.wait(
+                [&]() {
+                  return bp.get_finished() || inbound.has_pending() ||
+                    thread_messaging.has_work(tid);
+                },
+                ::threading::ThreadMessaging::max_idle_wait);
+              consecutive_idles = 0;
             }
             else
             {
               CCF_PAUSE();
             }
-
-            consecutive_idles++;
           }
           else
           {
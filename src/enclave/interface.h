@@ -14,6 +14,14 @@ enum AdminMessage : ringbuffer::Message
   /// Log message. Enclave -> Host
   DEFINE_RINGBUFFER_MSG_TYPE(log_msg),
 
+  /// Format string of a log call site, sent once before any
+  /// log_deferred_msg from that site. Enclave -> Host
+  DEFINE_RINGBUFFER_MSG_TYPE(log_format),
+
+  /// Log message as a call site id and its unformatted arguments, with the
+  /// count of such messages dropped before it. Enclave -> Host
+  DEFINE_RINGBUFFER_MSG_TYPE(log_deferred_msg),
+
   /// Fatal error message. Enclave -> Host
   DEFINE_RINGBUFFER_MSG_TYPE(fatal_error_msg),
 
@@ -42,12 +50,28 @@ DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
   std::string,
   uint16_t,
   std::string);
+DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
+  AdminMessage::log_format,
+  uint32_t,
+  std::string,
+  size_t,
+  ccf::LoggerLevel,
+  std::string,
+  std::string);
+DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
+  AdminMessage::log_deferred_msg,
+  std::chrono::microseconds::rep,
+  uint32_t,
+  uint16_t,
+  size_t,
+  serializer::ByteRange);
 DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(AdminMessage::fatal_error_msg, std::string);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(AdminMessage::stop);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(AdminMessage::stop_notice);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(AdminMessage::stopped);
 DECLARE_RINGBUFFER_MESSAGE_NO_PAYLOAD(AdminMessage::tick);
-DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(AdminMessage::work_stats, std::string);
+DECLARE_RINGBUFFER_MESSAGE_PAYLOAD(
+  AdminMessage::work_stats, std::vector<uint8_t>);
 
 /// Messages sent from app endpoints
 enum AppMessage : ringbuffer::Message
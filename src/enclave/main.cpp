@@ -249,6 +249,8 @@ extern "C"
 
     ccf::logger::config::level() = permitted;
 
+    threading::ThreadMessaging::instance().set_work_stealing(cc.work_stealing);
+
     ccf::Enclave* enclave = nullptr;
 
     try
@@ -300,8 +302,18 @@ extern "C"
 
     try
     {
-      std::vector<uint8_t> startup_snapshot(
-        startup_snapshot_data, startup_snapshot_data + startup_snapshot_size);
+      // Each startup snapshot is prefixed with its size, and the whole buffer
+      // is padded with (fewer than 8) NULLs
+      ccf::SnapshotChain startup_snapshot;
+      const uint8_t* snapshot_data = startup_snapshot_data;
+      size_t snapshot_size = startup_snapshot_size;
+      while (snapshot_size >= sizeof(size_t))
+      {
+        const auto size =
+          serialized::read<size_t>(snapshot_data, snapshot_size);
+        startup_snapshot.push_back(
+          serialized::read(snapshot_data, snapshot_size, size));
+      }
       status = enclave->create_new_node(
         start_type,
         std::move(cc),
@@ -15,13 +15,95 @@ namespace ccf
     // produce offsets to host time when logging from inside the enclave
     std::atomic<std::chrono::microseconds> us = {};
 
+    // Deferred messages which could not be written because the ringbuffer was
+    // full, and have not yet been reported to the host
+    std::atomic<size_t> dropped = 0;
+
+    // Returns false if the format of the site is being published by another
+    // thread, so cannot yet be referred to
+    bool publish_format(
+      const ccf::logger::LogLine& line, ccf::logger::FormatSite& site)
+    {
+      using Published = ccf::logger::FormatSite::Published;
+
+      auto published = site.published.load();
+      if (published == Published::YES)
+      {
+        return true;
+      }
+
+      if (
+        published == Published::IN_PROGRESS ||
+        !site.published.compare_exchange_strong(
+          published, Published::IN_PROGRESS))
+      {
+        return published == Published::YES;
+      }
+
+      RINGBUFFER_WRITE_MESSAGE(
+        AdminMessage::log_format,
+        writer,
+        site.id,
+        line.file_name,
+        line.line_number,
+        line.log_level,
+        line.tag,
+        std::string(site.format));
+
+      site.published.store(Published::YES);
+      return true;
+    }
+
   public:
     RingbufferLogger(const ringbuffer::WriterPtr& writer_) : writer(writer_) {}
 
+    bool writes_deferred() const override
+    {
+      return true;
+    }
+
     void write(
       const ccf::logger::LogLine& line,
       const std::optional<double>& enclave_offset = std::nullopt) override
     {
+      if (line.deferred.has_value())
+      {
+        const auto& deferred = line.deferred.value();
+        if (publish_format(line, *deferred.site))
+        {
+          const auto args = deferred.get_args();
+          const auto dropped_before = dropped.exchange(0);
+          if (ccf::logger::is_droppable(line.log_level))
+          {
+            // Never block the logging thread for these: if the host is not
+            // keeping up, drop the message and report the count with the next
+            if (!RINGBUFFER_TRY_WRITE_MESSAGE(
+                  AdminMessage::log_deferred_msg,
+                  writer,
+                  us.load().count(),
+                  deferred.site_id,
+                  line.thread_id,
+                  dropped_before,
+                  serializer::ByteRange{args.data(), args.size()}))
+            {
+              dropped += dropped_before + 1;
+            }
+          }
+          else
+          {
+            RINGBUFFER_WRITE_MESSAGE(
+              AdminMessage::log_deferred_msg,
+              writer,
+              us.load().count(),
+              deferred.site_id,
+              line.thread_id,
+              dropped_before,
+              serializer::ByteRange{args.data(), args.size()});
+          }
+          return;
+        }
+      }
+
       writer->write(
         AdminMessage::log_msg,
         us.load().count(),
@@ -30,7 +112,7 @@ namespace ccf
         line.log_level,
         line.tag,
         line.thread_id,
-        line.msg);
+        line.deferred.has_value() ? line.deferred->format() : line.msg);
     }
 
     void set_time(std::chrono::microseconds us_)
@@ -38,4 +120,4 @@ namespace ccf
       us.exchange(us_);
     }
   };
-}
\ No newline at end of file
+}
@@ -270,6 +270,13 @@ namespace ccf
           interface.errors};
       }
 
+      const auto& counters = TLSSession::write_counters;
+      sm.tls_writes = {
+        counters.sends.load(std::memory_order_relaxed),
+        counters.records.load(std::memory_order_relaxed),
+        counters.host_messages.load(std::memory_order_relaxed),
+        counters.host_bytes.load(std::memory_order_relaxed)};
+
       return sm;
     }
 
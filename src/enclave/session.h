@@ -52,5 +52,18 @@ namespace ccf
     }
 
     virtual void handle_incoming_data_thread(std::vector<uint8_t>&& data) = 0;
+
+  protected:
+    // Dispatches a thread message which processes data previously received
+    // (and buffered) by this session, as if no new data had arrived
+    void resume_incoming_data()
+    {
+      auto msg = std::make_unique<::threading::Tmsg<SendRecvMsg>>(
+        &handle_incoming_data_cb);
+      msg->data.self = this->shared_from_this();
+
+      ::threading::ThreadMessaging::instance().add_task(
+        execution_thread, std::move(msg));
+    }
   };
 }
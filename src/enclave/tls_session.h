@@ -11,6 +11,8 @@
 #include "tls/context.h"
 #include "tls/tls.h"
 
+#include <atomic>
+#include <chrono>
 #include <exception>
 
 namespace ccf
@@ -25,11 +27,37 @@ namespace ccf
     error
   };
 
+  // Totals over all sessions, from which the mean number of TLS records per
+  // send and bytes per ringbuffer message can be derived
+  struct TLSWriteCounters
+  {
+    // Plaintext sends, e.g. a response or an HTTP/2 frame
+    std::atomic<size_t> sends = 0;
+    std::atomic<size_t> records = 0;
+    std::atomic<size_t> host_messages = 0;
+    std::atomic<size_t> host_bytes = 0;
+  };
+
   class TLSSession : public std::enable_shared_from_this<TLSSession>
   {
   public:
     using HandshakeErrorCB = std::function<void(std::string&&)>;
 
+    static inline TLSWriteCounters write_counters;
+
+    // Sends are coalesced until a full record's worth of plaintext is pending,
+    // or until the session's thread has processed the tasks already queued.
+    // Sends are also flushed at once when they are the max_coalesced_sends-th
+    // since the last flush, or come max_flush_delay after the first of those,
+    // so that a busy thread does not hold back earlier responses.
+    static constexpr size_t max_record_plaintext_size = 16 * 1024;
+    static constexpr size_t max_coalesced_sends = 32;
+    static constexpr std::chrono::microseconds max_flush_delay{200};
+
+    // Ciphertext is written to the host in messages of up to this size, each
+    // typically holding several records
+    static constexpr size_t max_host_message_size = 64 * 1024;
+
   protected:
     ringbuffer::WriterPtr to_host;
     ::tcp::ConnID session_id;
@@ -38,6 +66,14 @@ namespace ccf
   private:
     std::vector<uint8_t> pending_write;
     std::vector<uint8_t> pending_read;
+    // Encrypted data, not yet written to the host
+    std::vector<uint8_t> pending_outbound;
+    // Set while flushing, so that records are gathered in pending_outbound
+    bool batching_outbound = false;
+    bool flush_scheduled = false;
+    // Sends since the last flush, and the time of the first of them
+    size_t coalesced_sends = 0;
+    std::chrono::steady_clock::time_point first_coalesced_send;
     // Decrypted data
     std::vector<uint8_t> read_buffer;
 
@@ -273,6 +309,14 @@ namespace ccf
       msg->data.self->close_thread();
     }
 
+    void schedule_close()
+    {
+      auto msg = std::make_unique<::threading::Tmsg<EmptyMsg>>(&close_cb);
+      msg->data.self = this->shared_from_this();
+      ::threading::ThreadMessaging::instance().add_task(
+        execution_thread, std::move(msg));
+    }
+
     virtual void close_thread()
     {
       if (ccf::threading::get_current_thread_id() != execution_thread)
@@ -292,7 +336,26 @@ namespace ccf
         case ready:
         case closing:
         {
+          // Data sent before closing must precede the close notification, so
+          // closing is retried until the host has taken all of it
+          flush();
+          if (!can_send())
+          {
+            break;
+          }
+          if (!pending_outbound.empty())
+          {
+            LOG_TRACE_FMT("TLS {} closing after pending data", session_id);
+            schedule_close();
+            break;
+          }
+
+          // The close notification is then the only data left to write, and
+          // must reach the host before the session is stopped
+          batching_outbound = true;
           int r = ctx->close();
+          batching_outbound = false;
+          write_pending_outbound(true);
 
           switch (r)
           {
@@ -329,13 +392,26 @@ namespace ccf
     }
 
     void send_raw(const uint8_t* data, size_t size)
+    {
+      if (ccf::threading::get_current_thread_id() != execution_thread)
+      {
+        send_raw(std::vector<uint8_t>(data, data + size));
+      }
+      else
+      {
+        // Send inline immediately
+        send_raw_thread(data, size);
+      }
+    }
+
+    void send_raw(std::vector<uint8_t>&& data)
     {
       if (ccf::threading::get_current_thread_id() != execution_thread)
       {
         auto msg =
           std::make_unique<::threading::Tmsg<SendRecvMsg>>(&send_raw_cb);
         msg->data.self = this->shared_from_this();
-        msg->data.data = std::vector<uint8_t>(data, data + size);
+        msg->data.data = std::move(data);
 
         ::threading::ThreadMessaging::instance().add_task(
           execution_thread, std::move(msg));
@@ -343,7 +419,7 @@ namespace ccf
       else
       {
         // Send inline immediately
-        send_raw_thread(data, size);
+        send_raw_thread(data.data(), data.size());
       }
     }
 
@@ -354,6 +430,28 @@ namespace ccf
         msg->data.data.data(), msg->data.data.size());
     }
 
+    static void flush_cb(std::unique_ptr<::threading::Tmsg<EmptyMsg>> msg)
+    {
+      msg->data.self->flush_scheduled = false;
+      msg->data.self->flush();
+    }
+
+    // Flushes once the tasks already queued on this session's thread have
+    // run, so that the sends they make are encrypted together
+    void schedule_flush()
+    {
+      if (flush_scheduled)
+      {
+        return;
+      }
+
+      flush_scheduled = true;
+      auto msg = std::make_unique<::threading::Tmsg<EmptyMsg>>(&flush_cb);
+      msg->data.self = this->shared_from_this();
+      ::threading::ThreadMessaging::instance().add_task(
+        execution_thread, std::move(msg));
+    }
+
     void send_raw_thread(const uint8_t* data, size_t size)
     {
       if (ccf::threading::get_current_thread_id() != execution_thread)
@@ -368,6 +466,7 @@ namespace ccf
 
       if (status == handshake)
       {
+        write_counters.sends.fetch_add(1, std::memory_order_relaxed);
         pending_write.insert(pending_write.end(), data, data + size);
         return;
       }
@@ -377,9 +476,26 @@ namespace ccf
         return;
       }
 
+      write_counters.sends.fetch_add(1, std::memory_order_relaxed);
       pending_write.insert(pending_write.end(), data, data + size);
 
-      flush();
+      const auto now = std::chrono::steady_clock::now();
+      if (coalesced_sends++ == 0)
+      {
+        first_coalesced_send = now;
+      }
+
+      if (
+        pending_write.size() >= max_record_plaintext_size ||
+        coalesced_sends >= max_coalesced_sends ||
+        now - first_coalesced_send >= max_flush_delay)
+      {
+        flush();
+      }
+      else
+      {
+        schedule_flush();
+      }
     }
 
     void send_buffered(const std::vector<uint8_t>& data)
@@ -399,6 +515,8 @@ namespace ccf
         throw std::runtime_error("Called flush from incorrect thread");
       }
 
+      coalesced_sends = 0;
+
       do_handshake();
 
       if (!can_send())
@@ -406,6 +524,13 @@ namespace ccf
         return;
       }
 
+      // Leave the remaining data unencrypted while the host is not keeping up
+      if (!write_pending_outbound())
+      {
+        return;
+      }
+
+      batching_outbound = true;
       while (pending_write.size() > 0)
       {
         auto r = write_some(pending_write);
@@ -422,8 +547,48 @@ namespace ccf
         {
           LOG_TRACE_FMT("TLS session {} error on flush: {}", session_id, -r);
           stop(error);
+          break;
         }
       }
+      batching_outbound = false;
+
+      write_pending_outbound();
+    }
+
+    // Returns true if all encrypted data has been written to the host. If
+    // blocking, waits for the host to make room for all of it.
+    bool write_pending_outbound(bool blocking = false)
+    {
+      const auto max_size = std::min(
+        max_host_message_size,
+        to_host->get_max_message_size() - sizeof(::tcp::ConnID) -
+          sizeof(size_t));
+
+      size_t written = 0;
+      while (written < pending_outbound.size())
+      {
+        const auto size = std::min(max_size, pending_outbound.size() - written);
+        const serializer::ByteRange data{
+          pending_outbound.data() + written, size};
+        if (blocking)
+        {
+          RINGBUFFER_WRITE_MESSAGE(
+            ::tcp::tcp_outbound, to_host, session_id, data);
+        }
+        else if (!RINGBUFFER_TRY_WRITE_MESSAGE(
+                   ::tcp::tcp_outbound, to_host, session_id, data))
+        {
+          break;
+        }
+
+        write_counters.host_messages.fetch_add(1, std::memory_order_relaxed);
+        write_counters.host_bytes.fetch_add(size, std::memory_order_relaxed);
+        written += size;
+      }
+
+      pending_outbound.erase(
+        pending_outbound.begin(), pending_outbound.begin() + written);
+      return pending_outbound.empty();
     }
 
     void do_handshake()
@@ -560,6 +725,16 @@ namespace ccf
 
     int handle_send(const uint8_t* buf, size_t len)
     {
+      // Records written while flushing are gathered, and written to the host
+      // together once the flush completes. Others must also queue behind any
+      // data already gathered.
+      if (batching_outbound || !pending_outbound.empty())
+      {
+        pending_outbound.insert(pending_outbound.end(), buf, buf + len);
+        write_counters.records.fetch_add(1, std::memory_order_relaxed);
+        return (int)len;
+      }
+
       // Either write all of the data or none of it.
       auto wrote = RINGBUFFER_TRY_WRITE_MESSAGE(
         ::tcp::tcp_outbound,
@@ -570,6 +745,9 @@ namespace ccf
       if (!wrote)
         return TLS_WRITING;
 
+      write_counters.records.fetch_add(1, std::memory_order_relaxed);
+      write_counters.host_messages.fetch_add(1, std::memory_order_relaxed);
+      write_counters.host_bytes.fetch_add(len, std::memory_order_relaxed);
       return (int)len;
     }
 
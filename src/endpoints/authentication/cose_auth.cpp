@@ -6,9 +6,12 @@
 #include "ccf/crypto/cose_verifier.h"
 #include "ccf/crypto/public_key.h"
 #include "ccf/http_consts.h"
+#include "ccf/pal/locking.h"
 #include "ccf/rpc_context.h"
 #include "ccf/service/tables/members.h"
 #include "ccf/service/tables/users.h"
+#include "ds/lru.h"
+#include "endpoints/authentication/verified_signatures_cache.h"
 #include "node/cose_common.h"
 
 #include <qcbor/qcbor.h>
@@ -294,6 +297,88 @@ namespace ccf
     }
   }
 
+  namespace
+  {
+    // Shared by all COSE Sign1 policies, since these are constructed per
+    // endpoint, while the same members and users sign requests to many of them
+    struct COSESign1VerifiersCache
+    {
+      static constexpr size_t DEFAULT_MAX_VERIFIERS = 100;
+
+      using DER = std::vector<uint8_t>;
+      using VerifierPtr = std::shared_ptr<ccf::crypto::COSEVerifier>;
+
+      ccf::pal::Mutex verifiers_lock;
+      LRU<DER, VerifierPtr> verifiers;
+      VerifiedSignaturesCache verified;
+
+      COSESign1VerifiersCache(size_t max_verifiers = DEFAULT_MAX_VERIFIERS) :
+        verifiers(max_verifiers)
+      {}
+
+      // Requests signed by the same key share a verifier, so the signer's
+      // certificate is only parsed once. Verification itself happens outside
+      // the lock, so that workers verify signatures concurrently.
+      VerifierPtr get_verifier(const DER& cert)
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(verifiers_lock);
+
+        auto it = verifiers.find(cert);
+        if (it == verifiers.end())
+        {
+          it = verifiers.insert(
+            cert, ccf::crypto::make_cose_verifier_from_cert(cert));
+        }
+        else
+        {
+          verifiers.promote(it);
+        }
+
+        return it->second;
+      }
+
+      bool verify(
+        const DER& cert,
+        std::span<const uint8_t> envelope,
+        std::span<uint8_t>& authned_content)
+      {
+        const auto key = VerifiedSignaturesCache::make_key({cert, envelope});
+        const auto entry = verified.find(key);
+        if (entry.has_value())
+        {
+          authned_content = {
+            const_cast<uint8_t*>(envelope.data()) + entry->content_offset,
+            entry->content_size};
+          return true;
+        }
+
+        if (!get_verifier(cert)->verify(envelope, authned_content))
+        {
+          return false;
+        }
+
+        // Content is decoded in place, so lies within the envelope
+        const uint8_t* content = authned_content.data();
+        if (
+          content >= envelope.data() &&
+          content + authned_content.size() <= envelope.data() + envelope.size())
+        {
+          verified.insert(
+            key,
+            {static_cast<size_t>(content - envelope.data()),
+             authned_content.size()});
+        }
+        return true;
+      }
+    };
+
+    COSESign1VerifiersCache& cose_sign1_verifiers()
+    {
+      static COSESign1VerifiersCache cache;
+      return cache;
+    }
+  }
+
   MemberCOSESign1AuthnPolicy::MemberCOSESign1AuthnPolicy(
     std::optional<std::string> gov_msg_type_) :
     gov_msg_type(gov_msg_type_){};
@@ -334,13 +419,11 @@ namespace ccf
     auto member_cert = member_certs->get(phdr.kid);
     if (member_cert.has_value())
     {
-      auto verifier =
-        ccf::crypto::make_cose_verifier_from_cert(member_cert->raw());
-
       std::span<const uint8_t> body = {
         ctx->get_request_body().data(), ctx->get_request_body().size()};
       std::span<uint8_t> authned_content;
-      if (!verifier->verify(body, authned_content))
+      if (!cose_sign1_verifiers().verify(
+            member_cert->raw(), body, authned_content))
       {
         error_reason = fmt::format("Failed to validate COSE Sign1");
         return nullptr;
@@ -474,13 +557,11 @@ namespace ccf
     auto user_cert = user_certs->get(phdr.kid);
     if (user_cert.has_value())
     {
-      auto verifier =
-        ccf::crypto::make_cose_verifier_from_cert(user_cert->raw());
-
       std::span<const uint8_t> body = {
         ctx->get_request_body().data(), ctx->get_request_body().size()};
       std::span<uint8_t> authned_content;
-      if (!verifier->verify(body, authned_content))
+      if (!cose_sign1_verifiers().verify(
+            user_cert->raw(), body, authned_content))
       {
         error_reason = fmt::format("Failed to validate COSE Sign1");
         return nullptr;
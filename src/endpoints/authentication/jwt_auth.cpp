@@ -12,6 +12,7 @@
 #include "ccf/service/tables/jwt.h"
 #include "ds/lru.h"
 #include "enclave/enclave_time.h"
+#include "endpoints/authentication/verified_signatures_cache.h"
 #include "http/http_jwt.h"
 
 namespace
@@ -95,14 +96,13 @@ namespace ccf
     ccf::pal::Mutex keys_lock;
     LRU<DER, KeyVariant> keys;
 
+    // A bearer token is usually presented on many requests, and its signature
+    // need only be verified once
+    VerifiedSignaturesCache verified;
+
     PublicKeysCache(size_t max_keys = DEFAULT_MAX_KEYS) : keys(max_keys) {}
 
-    bool verify(
-      const uint8_t* contents,
-      size_t contents_size,
-      const uint8_t* signature,
-      size_t signature_size,
-      const DER& der)
+    KeyVariant get_key(const DER& der)
     {
       std::lock_guard<ccf::pal::Mutex> guard(keys_lock);
 
@@ -119,14 +119,34 @@ namespace ccf
         }
       }
 
-      const auto& key = it->second;
+      return it->second;
+    }
+
+    bool verify(
+      const uint8_t* contents,
+      size_t contents_size,
+      const uint8_t* signature,
+      size_t signature_size,
+      const DER& der)
+    {
+      const auto verified_key = VerifiedSignaturesCache::make_key(
+        {der, {contents, contents_size}, {signature, signature_size}});
+      if (verified.find(verified_key).has_value())
+      {
+        return true;
+      }
+
+      // Verification happens outside the lock, so that signatures for the
+      // same key are verified concurrently by all workers
+      const auto key = get_key(der);
+      bool valid = false;
       if (std::holds_alternative<ccf::crypto::RSAPublicKeyPtr>(key))
       {
         LOG_DEBUG_FMT("Verify der: {} as RSA key", der);
 
         // Obsolete PKCS1 padding is chosen for JWT, as explained in details in
         // https://github.com/microsoft/CCF/issues/6601#issuecomment-2512059875.
-        return std::get<ccf::crypto::RSAPublicKeyPtr>(key)->verify_pkcs1(
+        valid = std::get<ccf::crypto::RSAPublicKeyPtr>(key)->verify_pkcs1(
           contents,
           contents_size,
           signature,
@@ -139,7 +159,7 @@ namespace ccf
 
         const auto sig_der =
           ccf::crypto::ecdsa_sig_p1363_to_der({signature, signature_size});
-        return std::get<ccf::crypto::PublicKeyPtr>(key)->verify(
+        valid = std::get<ccf::crypto::PublicKeyPtr>(key)->verify(
           contents,
           contents_size,
           sig_der.data(),
@@ -149,8 +169,13 @@ namespace ccf
       else
       {
         LOG_DEBUG_FMT("Key not found for der: {}", der);
-        return false;
       }
+
+      if (valid)
+      {
+        verified.insert(verified_key);
+      }
+      return valid;
     }
   };
 
@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/crypto/hash_provider.h"
+#include "ccf/crypto/sha256_hash.h"
+#include "ccf/pal/locking.h"
+#include "ds/lru.h"
+
+#include <initializer_list>
+#include <optional>
+#include <span>
+
+namespace ccf
+{
+  struct VerifiedSignature
+  {
+    // For envelopes which carry their content (COSE Sign1), the position of
+    // the authenticated content within the verified bytes
+    size_t content_offset = 0;
+    size_t content_size = 0;
+  };
+
+  /** Bounded cache of successfully verified signatures, so that a signed
+   * request which is retried or replayed verbatim (for instance, a governance
+   * COSE Sign1 resubmitted by a client, or a JWT bearer token presented on
+   * every request of a session) is not verified again.
+   *
+   * Entries are keyed by a digest over the verifying key, the signed content
+   * and the signature, so only the exact bytes which were verified, against
+   * the same key, can hit. Failed verifications are not cached. Checks which
+   * depend on the current time or on the KV (expiry, membership status) are
+   * not covered by the cache, and must still be made on every request.
+   */
+  class VerifiedSignaturesCache
+  {
+  public:
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 1000;
+
+    using Key = ccf::crypto::Sha256Hash::Representation;
+
+  private:
+    ccf::pal::Mutex entries_lock;
+    LRU<Key, VerifiedSignature> entries;
+
+  public:
+    VerifiedSignaturesCache(size_t max_entries = DEFAULT_MAX_ENTRIES) :
+      entries(max_entries)
+    {}
+
+    // Each part is prefixed with its size, so that bytes cannot be moved
+    // between adjacent parts to produce the same key
+    static Key make_key(std::initializer_list<std::span<const uint8_t>> parts)
+    {
+      auto hash = ccf::crypto::make_incremental_sha256();
+      for (const auto& part : parts)
+      {
+        const uint64_t size = part.size();
+        hash->update_hash({(const uint8_t*)&size, sizeof(size)});
+        hash->update_hash(part);
+      }
+      return hash->finalise().h;
+    }
+
+    std::optional<VerifiedSignature> find(const Key& key)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(entries_lock);
+
+      auto it = entries.find(key);
+      if (it == entries.end())
+      {
+        return std::nullopt;
+      }
+
+      entries.promote(it);
+      return it->second;
+    }
+
+    void insert(const Key& key, VerifiedSignature&& entry = {})
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(entries_lock);
+      entries.insert(key, std::move(entry));
+    }
+
+    size_t size()
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(entries_lock);
+      return entries.size();
+    }
+  };
+}
@@ -9,6 +9,7 @@
 #include "endpoint_utils.h"
 #include "http/http_parser.h"
 #include "node/rpc_context_impl.h"
+#include "path_template_trie.h"
 
 namespace ccf::endpoints
 {
@@ -305,6 +306,13 @@ namespace ccf::endpoints
       auto templated_endpoint =
         std::make_shared<PathTemplatedEndpoint>(endpoint);
       templated_endpoint->spec = std::move(template_spec.value());
+
+      if (templated_endpoints_trie == nullptr)
+      {
+        templated_endpoints_trie = std::make_shared<PathTemplateTrie>();
+      }
+      templated_endpoints_trie->insert(templated_endpoint);
+
       templated_endpoints[endpoint.dispatch.uri_path][endpoint.dispatch.verb] =
         templated_endpoint;
     }
@@ -429,48 +437,32 @@ namespace ccf::endpoints
     // If that doesn't exist, look through the templated endpoints to find
     // templated matches. Exactly one is a returnable match, more is an error,
     // fewer is fallthrough.
+    if (templated_endpoints_trie != nullptr)
     {
       std::vector<EndpointDefinitionPtr> matches;
-
-      std::smatch match;
-      for (auto& [original_method, verb_endpoints] : templated_endpoints)
-      {
-        auto templated_endpoints_for_verb =
-          verb_endpoints.find(rpc_ctx.get_request_verb());
-        if (templated_endpoints_for_verb != verb_endpoints.end())
-        {
-          auto& endpoint = templated_endpoints_for_verb->second;
-          if (std::regex_match(method, match, endpoint->spec.template_regex))
+      std::shared_ptr<PathTemplatedEndpoint> endpoint;
+      PathTemplateTrie::Captures path_param_values;
+
+      templated_endpoints_trie->match(
+        method,
+        [&](
+          const PathTemplateTrie::Endpoints& verb_endpoints,
+          const PathTemplateTrie::Captures& captures) {
+          auto templated_endpoints_for_verb =
+            verb_endpoints.find(rpc_ctx.get_request_verb());
+          if (templated_endpoints_for_verb != verb_endpoints.end())
           {
-            // Populate the request_path_params the first-time through. If we
-            // get a second match, we're just building up a list for
-            // error-reporting
+            // Keep the path params of the first match. If we get a second
+            // match, we're just building up a list for error-reporting
             if (matches.size() == 0)
             {
-              auto ctx_impl = static_cast<ccf::RpcContextImpl*>(&rpc_ctx);
-              if (ctx_impl == nullptr)
-              {
-                throw std::logic_error("Unexpected type of RpcContext");
-              }
-              auto& path_params = ctx_impl->path_params;
-              auto& decoded_path_params = ctx_impl->decoded_path_params;
-              for (size_t i = 0;
-                   i < endpoint->spec.template_component_names.size();
-                   ++i)
-              {
-                const auto& template_name =
-                  endpoint->spec.template_component_names[i];
-                const auto& template_value = match[i + 1].str();
-                auto decoded_value = ::http::url_decode(template_value);
-                path_params[template_name] = template_value;
-                decoded_path_params[template_name] = decoded_value;
-              }
+              endpoint = templated_endpoints_for_verb->second;
+              path_param_values = captures;
             }
 
-            matches.push_back(endpoint);
+            matches.push_back(templated_endpoints_for_verb->second);
           }
-        }
-      }
+        });
 
       if (matches.size() > 1)
       {
@@ -478,7 +470,26 @@ namespace ccf::endpoints
       }
       else if (matches.size() == 1)
       {
-        return matches[0];
+        auto ctx_impl = static_cast<ccf::RpcContextImpl*>(&rpc_ctx);
+        if (ctx_impl == nullptr)
+        {
+          throw std::logic_error("Unexpected type of RpcContext");
+        }
+
+        auto& path_params = ctx_impl->path_params;
+        auto& decoded_path_params = ctx_impl->decoded_path_params;
+        for (size_t i = 0; i < endpoint->spec.template_component_names.size();
+             ++i)
+        {
+          const auto& template_name =
+            endpoint->spec.template_component_names[i];
+          const auto& template_value = path_param_values[i];
+          path_params[template_name] = template_value;
+          decoded_path_params[template_name] =
+            ::http::url_decode(template_value);
+        }
+
+        return endpoint;
       }
     }
 
@@ -535,16 +546,18 @@ namespace ccf::endpoints
       }
     }
 
-    std::smatch match;
-    for (const auto& [original_method, verb_endpoints] : templated_endpoints)
+    if (templated_endpoints_trie != nullptr)
     {
-      for (const auto& [verb, endpoint] : verb_endpoints)
-      {
-        if (std::regex_match(method, match, endpoint->spec.template_regex))
-        {
-          verbs.insert(verb);
-        }
-      }
+      templated_endpoints_trie->match(
+        method,
+        [&verbs](
+          const PathTemplateTrie::Endpoints& verb_endpoints,
+          const PathTemplateTrie::Captures&) {
+          for (const auto& [verb, endpoint] : verb_endpoints)
+          {
+            verbs.insert(verb);
+          }
+        });
     }
 
     return verbs;
@@ -0,0 +1,272 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/endpoint_registry.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ccf::endpoints
+{
+  /** Templated endpoints, indexed by the '/'-separated segments of their
+   * paths. Each segment of a template is either a literal, a single path
+   * parameter ("{id}"), or a compound of parameters and literals separated by
+   * ':' ("{id}:withdraw"). A request path is matched by walking its segments
+   * down the trie, so lookup cost depends on the depth of the path rather than
+   * on the number of installed templates.
+   *
+   * Templates which differ only in the names of their parameters would match
+   * exactly the same requests, and are rejected on insertion. Templates which
+   * overlap only for some paths (eg - "/{a}/b" and "/a/{b}") may still both
+   * match a given request, so all matches are returned.
+   */
+  class PathTemplateTrie
+  {
+  public:
+    using Endpoints =
+      std::map<RESTVerb, std::shared_ptr<PathTemplatedEndpoint>>;
+
+    // Values of the path parameters, in the order they appear in the
+    // template, viewing the matched path
+    using Captures = std::vector<std::string_view>;
+
+  private:
+    struct Piece
+    {
+      // Empty for a parameter
+      std::string literal;
+    };
+
+    struct Node;
+
+    struct CompoundEdge
+    {
+      // The segment with each parameter name removed, eg - "{}:withdraw"
+      std::string shape;
+      std::vector<Piece> pieces;
+      std::unique_ptr<Node> child;
+    };
+
+    struct Node
+    {
+      std::map<std::string, std::unique_ptr<Node>, std::less<>> literals;
+      std::unique_ptr<Node> param;
+      std::vector<CompoundEdge> compounds;
+
+      Endpoints endpoints;
+    };
+
+    Node root;
+
+    template <typename F>
+    static void for_each_segment(std::string_view path, F&& f)
+    {
+      size_t start = 0;
+      while (true)
+      {
+        const auto end = path.find('/', start);
+        if (end == std::string_view::npos)
+        {
+          f(path.substr(start));
+          return;
+        }
+
+        f(path.substr(start, end - start));
+        start = end + 1;
+      }
+    }
+
+    static std::vector<std::string_view> split(std::string_view path)
+    {
+      std::vector<std::string_view> segments;
+      for_each_segment(path, [&segments](std::string_view segment) {
+        segments.push_back(segment);
+      });
+      return segments;
+    }
+
+    static std::vector<Piece> parse_compound(
+      std::string_view segment, std::string& shape)
+    {
+      std::vector<Piece> pieces;
+      while (!segment.empty())
+      {
+        if (segment[0] == '{')
+        {
+          const auto end = segment.find('}');
+          pieces.push_back({});
+          shape += "{}";
+          segment.remove_prefix(end + 1);
+        }
+        else
+        {
+          const auto end = segment.find('{');
+          const auto literal = segment.substr(0, end);
+          pieces.push_back({std::string(literal)});
+          shape += literal;
+          segment.remove_prefix(literal.size());
+        }
+      }
+      return pieces;
+    }
+
+    // Matches with the same semantics as the equivalent regex, where each
+    // parameter is a greedy ([^/]+)
+    static bool match_compound(
+      const std::vector<Piece>& pieces,
+      size_t i,
+      std::string_view segment,
+      Captures& captures)
+    {
+      if (i == pieces.size())
+      {
+        return segment.empty();
+      }
+
+      const auto& piece = pieces[i];
+      if (!piece.literal.empty())
+      {
+        if (!segment.starts_with(piece.literal))
+        {
+          return false;
+        }
+
+        return match_compound(
+          pieces, i + 1, segment.substr(piece.literal.size()), captures);
+      }
+
+      for (auto n = segment.size(); n > 0; --n)
+      {
+        captures.push_back(segment.substr(0, n));
+        if (match_compound(pieces, i + 1, segment.substr(n), captures))
+        {
+          return true;
+        }
+        captures.pop_back();
+      }
+
+      return false;
+    }
+
+    template <typename F>
+    static void match_from(
+      const Node& node,
+      const std::vector<std::string_view>& segments,
+      size_t i,
+      Captures& captures,
+      F&& f)
+    {
+      if (i == segments.size())
+      {
+        if (!node.endpoints.empty())
+        {
+          f(node.endpoints, captures);
+        }
+        return;
+      }
+
+      const auto segment = segments[i];
+
+      const auto literal = node.literals.find(segment);
+      if (literal != node.literals.end())
+      {
+        match_from(*literal->second, segments, i + 1, captures, f);
+      }
+
+      if (node.param != nullptr && !segment.empty())
+      {
+        captures.push_back(segment);
+        match_from(*node.param, segments, i + 1, captures, f);
+        captures.pop_back();
+      }
+
+      for (const auto& compound : node.compounds)
+      {
+        const auto size_before = captures.size();
+        if (match_compound(compound.pieces, 0, segment, captures))
+        {
+          match_from(*compound.child, segments, i + 1, captures, f);
+        }
+        captures.resize(size_before);
+      }
+    }
+
+  public:
+    void insert(const std::shared_ptr<PathTemplatedEndpoint>& endpoint)
+    {
+      const auto& uri_path = endpoint->dispatch.uri_path;
+
+      Node* node = &root;
+      for_each_segment(uri_path, [&node](std::string_view segment) {
+        std::unique_ptr<Node>* next = nullptr;
+
+        if (segment.find('{') == std::string_view::npos)
+        {
+          auto it = node->literals.find(segment);
+          if (it == node->literals.end())
+          {
+            it = node->literals.emplace(std::string(segment), nullptr).first;
+          }
+          next = &it->second;
+        }
+        else if (
+          segment.front() == '{' && segment.find('}') == segment.size() - 1)
+        {
+          next = &node->param;
+        }
+        else
+        {
+          std::string shape;
+          auto pieces = parse_compound(segment, shape);
+          auto it = std::find_if(
+            node->compounds.begin(),
+            node->compounds.end(),
+            [&shape](const CompoundEdge& e) { return e.shape == shape; });
+          if (it == node->compounds.end())
+          {
+            node->compounds.push_back({shape, std::move(pieces), nullptr});
+            it = std::prev(node->compounds.end());
+          }
+          next = &it->child;
+        }
+
+        if (*next == nullptr)
+        {
+          *next = std::make_unique<Node>();
+        }
+        node = next->get();
+      });
+
+      const auto& verb = endpoint->dispatch.verb;
+      auto it = node->endpoints.find(verb);
+      if (
+        it != node->endpoints.end() &&
+        it->second->dispatch.uri_path != uri_path)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot install {} {} - it matches exactly the same paths as {}",
+          verb.c_str(),
+          uri_path,
+          it->second->dispatch.uri_path));
+      }
+
+      node->endpoints[verb] = endpoint;
+    }
+
+    /** Calls f(endpoints, captures) for each installed template matching
+     * path. The captures view path, so must not outlive it.
+     */
+    template <typename F>
+    void match(std::string_view path, F&& f) const
+    {
+      const auto segments = split(path);
+      Captures captures;
+      match_from(root, segments, 0, captures, f);
+    }
+  };
+}
@@ -7,6 +7,7 @@
 #include "ccf/ds/logger.h"
 #include "ds/nonstd.h"
 #include "endpoint_utils.h"
+#include "path_template_trie.h"
 
 #include <doctest/doctest.h>
 
@@ -100,6 +101,109 @@ TEST_CASE("URL template parsing")
   REQUIRE_THROWS(PathTemplateSpec::parse("/{id}/{id}/foo"));
 }
 
+static std::shared_ptr<PathTemplatedEndpoint> make_templated_endpoint(
+  const std::string& uri_path, ccf::RESTVerb verb = HTTP_GET)
+{
+  Endpoint e;
+  e.dispatch.uri_path = uri_path;
+  e.dispatch.verb = verb;
+  auto endpoint = std::make_shared<PathTemplatedEndpoint>(e);
+  endpoint->spec = PathTemplateSpec::parse(uri_path).value();
+  return endpoint;
+}
+
+using TrieMatch = std::pair<std::string, std::vector<std::string>>;
+
+static std::vector<TrieMatch> match_all(
+  const PathTemplateTrie& trie,
+  const std::string& path,
+  ccf::RESTVerb verb = HTTP_GET)
+{
+  std::vector<TrieMatch> matches;
+  trie.match(
+    path,
+    [&](
+      const PathTemplateTrie::Endpoints& endpoints,
+      const PathTemplateTrie::Captures& captures) {
+      auto it = endpoints.find(verb);
+      if (it != endpoints.end())
+      {
+        matches.emplace_back(
+          it->second->dispatch.uri_path,
+          std::vector<std::string>(captures.begin(), captures.end()));
+      }
+    });
+  return matches;
+}
+
+TEST_CASE("Path template trie")
+{
+  PathTemplateTrie trie;
+  for (const auto& uri : {
+         "/records/{id}",
+         "/records/{id}/history",
+         "/records/{id}:withdraw",
+         "/records/{id}:{action}/{place}",
+         "/records/bob:{action}",
+         "/users/{user}/records/{id}",
+         "/{first}/b",
+         "/a/{second}",
+       })
+  {
+    trie.insert(make_templated_endpoint(uri));
+  }
+
+  using V = std::vector<TrieMatch>;
+
+  REQUIRE(match_all(trie, "/records/42") == V{{"/records/{id}", {"42"}}});
+  REQUIRE(match_all(trie, "/records/42", HTTP_POST).empty());
+  REQUIRE(
+    match_all(trie, "/records/42/history") ==
+    V{{"/records/{id}/history", {"42"}}});
+  REQUIRE(
+    match_all(trie, "/users/alice/records/42") ==
+    V{{"/users/{user}/records/{id}", {"alice", "42"}}});
+
+  INFO("Parameters match non-empty segments only");
+  REQUIRE(match_all(trie, "/records/").empty());
+  REQUIRE(match_all(trie, "/records").empty());
+  REQUIRE(match_all(trie, "/records/42/").empty());
+  REQUIRE(match_all(trie, "/records//history").empty());
+
+  INFO("Compound segments match as the equivalent regex would");
+  {
+    const auto m = match_all(trie, "/records/42:withdraw");
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[0] == TrieMatch{"/records/{id}", {"42:withdraw"}});
+    REQUIRE(m[1] == TrieMatch{"/records/{id}:withdraw", {"42"}});
+  }
+  REQUIRE(
+    match_all(trie, "/records/a:b:c/spain") ==
+    V{{"/records/{id}:{action}/{place}", {"a:b", "c", "spain"}}});
+  REQUIRE(
+    match_all(trie, "/records/:withdraw") ==
+    V{{"/records/{id}", {":withdraw"}}});
+  {
+    const auto m = match_all(trie, "/records/bob:run");
+    REQUIRE(m.size() == 2);
+    REQUIRE(m[0] == TrieMatch{"/records/{id}", {"bob:run"}});
+    REQUIRE(m[1] == TrieMatch{"/records/bob:{action}", {"run"}});
+  }
+
+  INFO("Partially overlapping templates may both match");
+  REQUIRE(
+    match_all(trie, "/a/b") ==
+    V{{"/a/{second}", {"b"}}, {"/{first}/b", {"a"}}});
+
+  INFO("Templates which always match the same paths are rejected");
+  REQUIRE_THROWS(trie.insert(make_templated_endpoint("/records/{key}")));
+  REQUIRE_THROWS(
+    trie.insert(make_templated_endpoint("/records/{key}:withdraw")));
+  REQUIRE_NOTHROW(
+    trie.insert(make_templated_endpoint("/records/{key}", HTTP_POST)));
+  REQUIRE_NOTHROW(trie.insert(make_templated_endpoint("/records/{id}")));
+}
+
 TEST_CASE("camel_case" * doctest::test_suite("nonstd"))
 {
   using ccf::endpoints::camel_case;
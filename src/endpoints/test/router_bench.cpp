@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+
+#include "ccf/ds/logger.h"
+#include "endpoints/path_template_trie.h"
+
+#include <picobench/picobench.hpp>
+
+using namespace ccf::endpoints;
+
+template <class A>
+inline void do_not_optimize(A const& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// An app with families of templated routes, of the kinds used by CCF's own
+// APIs, for each of resources_count resources
+static std::vector<std::shared_ptr<PathTemplatedEndpoint>> make_routes(
+  size_t resources_count)
+{
+  std::vector<std::shared_ptr<PathTemplatedEndpoint>> routes;
+  for (size_t i = 0; i < resources_count; ++i)
+  {
+    for (const auto& [uri, verb] :
+         std::vector<std::pair<std::string, llhttp_method>>{
+           {fmt::format("/app/resource{}/{{id}}", i), HTTP_GET},
+           {fmt::format("/app/resource{}/{{id}}", i), HTTP_PUT},
+           {fmt::format("/app/resource{}/{{id}}/history", i), HTTP_GET},
+           {fmt::format("/app/resource{}/{{id}}:archive", i), HTTP_POST},
+           {fmt::format("/app/users/{{user}}/resource{}/{{id}}", i),
+            HTTP_GET}})
+    {
+      Endpoint e;
+      e.dispatch.uri_path = uri;
+      e.dispatch.verb = verb;
+      auto endpoint = std::make_shared<PathTemplatedEndpoint>(e);
+      endpoint->spec = PathTemplateSpec::parse(uri).value();
+      routes.push_back(endpoint);
+    }
+  }
+  return routes;
+}
+
+static std::vector<std::pair<std::string, ccf::RESTVerb>> make_requests(
+  size_t resources_count)
+{
+  std::vector<std::pair<std::string, ccf::RESTVerb>> requests;
+  for (size_t i = 0; i < resources_count; i += 7)
+  {
+    requests.emplace_back(fmt::format("/app/resource{}/42", i), HTTP_GET);
+    requests.emplace_back(
+      fmt::format("/app/resource{}/42/history", i), HTTP_GET);
+    requests.emplace_back(
+      fmt::format("/app/resource{}/42:archive", i), HTTP_POST);
+    requests.emplace_back(
+      fmt::format("/app/users/alice/resource{}/42", i), HTTP_GET);
+  }
+  return requests;
+}
+
+// The previous approach: try the regex of every templated endpoint in turn
+template <size_t resources_count>
+static void regex_scan(picobench::state& s)
+{
+  std::map<
+    std::string,
+    std::map<ccf::RESTVerb, std::shared_ptr<PathTemplatedEndpoint>>>
+    templated_endpoints;
+  for (const auto& route : make_routes(resources_count))
+  {
+    templated_endpoints[route->dispatch.uri_path][route->dispatch.verb] =
+      route;
+  }
+  const auto requests = make_requests(resources_count);
+
+  size_t i = 0;
+  s.start_timer();
+  for (auto _ : s)
+  {
+    (void)_;
+    const auto& [path, verb] = requests[i++ % requests.size()];
+
+    size_t matches = 0;
+    std::smatch match;
+    for (const auto& [uri, verb_endpoints] : templated_endpoints)
+    {
+      const auto it = verb_endpoints.find(verb);
+      if (
+        it != verb_endpoints.end() &&
+        std::regex_match(path, match, it->second->spec.template_regex))
+      {
+        do_not_optimize(match[1].str());
+        ++matches;
+      }
+    }
+
+    if (matches != 1)
+    {
+      throw std::logic_error("Expected exactly one match");
+    }
+  }
+  s.stop_timer();
+}
+
+template <size_t resources_count>
+static void trie_match(picobench::state& s)
+{
+  PathTemplateTrie trie;
+  for (const auto& route : make_routes(resources_count))
+  {
+    trie.insert(route);
+  }
+  const auto requests = make_requests(resources_count);
+
+  size_t i = 0;
+  s.start_timer();
+  for (auto _ : s)
+  {
+    (void)_;
+    const auto& [path, verb] = requests[i++ % requests.size()];
+
+    size_t matches = 0;
+    trie.match(
+      path,
+      [&](
+        const PathTemplateTrie::Endpoints& endpoints,
+        const PathTemplateTrie::Captures& captures) {
+        if (endpoints.find(verb) != endpoints.end())
+        {
+          do_not_optimize(captures[0]);
+          ++matches;
+        }
+      });
+
+    if (matches != 1)
+    {
+      throw std::logic_error("Expected exactly one match");
+    }
+  }
+  s.stop_timer();
+}
+
+const std::vector<int> sizes = {1000, 10000};
+
+// Each resource has 5 templated routes
+PICOBENCH_SUITE("route_6_resources");
+auto regex_6 = regex_scan<6>;
+PICOBENCH(regex_6).iterations(sizes).samples(10).baseline();
+auto trie_6 = trie_match<6>;
+PICOBENCH(trie_6).iterations(sizes).samples(10);
+
+PICOBENCH_SUITE("route_30_resources");
+auto regex_30 = regex_scan<30>;
+PICOBENCH(regex_30).iterations(sizes).samples(10).baseline();
+auto trie_30 = trie_match<30>;
+PICOBENCH(trie_30).iterations(sizes).samples(10);
+
+PICOBENCH_SUITE("route_100_resources");
+auto regex_100 = regex_scan<100>;
+PICOBENCH(regex_100).iterations(sizes).samples(10).baseline();
+auto trie_100 = trie_match<100>;
+PICOBENCH(trie_100).iterations(sizes).samples(10);
+
+int main(int argc, char** argv)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  return runner.run();
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "endpoints/authentication/verified_signatures_cache.h"
+
+#include <doctest/doctest.h>
+
+using namespace ccf;
+
+static std::vector<uint8_t> bytes(const std::string& s)
+{
+  return {s.begin(), s.end()};
+}
+
+TEST_CASE("Verified signatures cache keys")
+{
+  const auto make_key = VerifiedSignaturesCache::make_key;
+  const auto key = bytes("key");
+  const auto content = bytes("content");
+  const auto signature = bytes("signature");
+
+  const auto k = make_key({key, content, signature});
+  REQUIRE(k == make_key({key, content, signature}));
+
+  INFO("Any change to the key, content or signature produces another key");
+  REQUIRE(k != make_key({bytes("kez"), content, signature}));
+  REQUIRE(k != make_key({key, bytes("contenT"), signature}));
+  REQUIRE(k != make_key({key, content, bytes("signaturE")}));
+
+  INFO("Bytes cannot be moved from one part to another");
+  REQUIRE(k != make_key({bytes("keyc"), bytes("ontent"), signature}));
+  REQUIRE(k != make_key({bytes("keycontentsignature")}));
+}
+
+TEST_CASE("Verified signatures cache")
+{
+  VerifiedSignaturesCache cache(2);
+
+  const auto a = VerifiedSignaturesCache::make_key({bytes("a")});
+  const auto b = VerifiedSignaturesCache::make_key({bytes("b")});
+  const auto c = VerifiedSignaturesCache::make_key({bytes("c")});
+
+  REQUIRE_FALSE(cache.find(a).has_value());
+
+  cache.insert(a, {4, 2});
+  const auto entry = cache.find(a);
+  REQUIRE(entry.has_value());
+  REQUIRE(entry->content_offset == 4);
+  REQUIRE(entry->content_size == 2);
+
+  INFO("The least recently verified signatures are evicted beyond the cap");
+  cache.insert(b);
+  REQUIRE(cache.find(a).has_value());
+  cache.insert(c);
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.find(a).has_value());
+  REQUIRE_FALSE(cache.find(b).has_value());
+  REQUIRE(cache.find(c).has_value());
+}
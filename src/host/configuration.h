@@ -98,6 +98,7 @@ namespace host
       std::string directory = "ledger";
       std::vector<std::string> read_only_directories = {};
       ccf::ds::SizeString chunk_size = {"5MB"};
+      ccf::ds::SizeString entry_cache_size = {"16MB"};
 
       bool operator==(const Ledger&) const = default;
     };
@@ -108,6 +109,7 @@ namespace host
       std::string directory = "snapshots";
       size_t tx_count = 10'000;
       std::optional<std::string> read_only_directory = std::nullopt;
+      size_t max_delta_chain_length = 0;
 
       bool operator==(const Snapshots&) const = default;
     };
@@ -187,12 +189,20 @@ namespace host
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(CCHostConfig::Ledger);
   DECLARE_JSON_REQUIRED_FIELDS(CCHostConfig::Ledger);
   DECLARE_JSON_OPTIONAL_FIELDS(
-    CCHostConfig::Ledger, directory, read_only_directories, chunk_size);
+    CCHostConfig::Ledger,
+    directory,
+    read_only_directories,
+    chunk_size,
+    entry_cache_size);
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(CCHostConfig::Snapshots);
   DECLARE_JSON_REQUIRED_FIELDS(CCHostConfig::Snapshots);
   DECLARE_JSON_OPTIONAL_FIELDS(
-    CCHostConfig::Snapshots, directory, tx_count, read_only_directory);
+    CCHostConfig::Snapshots,
+    directory,
+    tx_count,
+    read_only_directory,
+    max_delta_chain_length);
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(CCHostConfig::Logging);
   DECLARE_JSON_REQUIRED_FIELDS(CCHostConfig::Logging);
@@ -4,6 +4,7 @@
 
 #include "ccf/ds/logger.h"
 #include "ccf/version.h"
+#include "ds/serialized.h"
 #include "enclave/interface.h"
 
 #include <dlfcn.h>
@@ -212,7 +213,7 @@ namespace host
     CreateNodeStatus create_node(
       const EnclaveConfig& enclave_config,
       const ccf::StartupConfig& ccf_config,
-      std::vector<uint8_t>&& startup_snapshot,
+      std::vector<std::vector<uint8_t>>&& startup_snapshots,
       std::vector<uint8_t>& node_cert,
       std::vector<uint8_t>& service_cert,
       StartType start_type,
@@ -239,15 +240,29 @@ namespace host
       auto copy_end = std::copy(config_s.begin(), config_s.end(), config);
       std::fill(copy_end, config + config_aligned_size, 0);
 
+      // Startup snapshots (a full snapshot followed by the delta snapshots
+      // chained to it) are each prefixed with their size
+      size_t snapshots_size = 0;
+      for (const auto& s : startup_snapshots)
+      {
+        snapshots_size += sizeof(size_t) + s.size();
+      }
       auto [snapshot, snapshot_aligned_size] =
-        allocate_8_aligned(startup_snapshot.size());
+        allocate_8_aligned(snapshots_size);
       LOG_DEBUG_FMT(
-        "Padding startup snapshot of size {} to {} bytes",
-        startup_snapshot.size(),
+        "Padding {} startup snapshot(s) of size {} to {} bytes",
+        startup_snapshots.size(),
+        snapshots_size,
         snapshot_aligned_size);
 
-      auto snapshot_copy_end =
-        std::copy(startup_snapshot.begin(), startup_snapshot.end(), snapshot);
+      auto snapshot_copy_end = snapshot;
+      auto snapshot_remaining_size = snapshots_size;
+      for (const auto& s : startup_snapshots)
+      {
+        serialized::write(snapshot_copy_end, snapshot_remaining_size, s.size());
+        serialized::write(
+          snapshot_copy_end, snapshot_remaining_size, s.data(), s.size());
+      }
       std::fill(snapshot_copy_end, snapshot + snapshot_aligned_size, 0);
 
 #define CREATE_NODE_ARGS \
@@ -5,6 +5,7 @@
 #include "../ds/files.h"
 #include "../enclave/interface.h"
 #include "ccf/ds/logger.h"
+#include "log_thread.h"
 #include "timer.h"
 
 #include <chrono>
@@ -14,6 +15,7 @@
 #include <string>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace asynchost
 {
@@ -28,6 +30,49 @@ namespace asynchost
     ringbuffer::Reader& r;
     ringbuffer::NonBlockingWriterFactory& nbwf;
 
+    // Log call sites in the enclave, by id, as published by the enclave before
+    // their first deferred message. Never erased, so that queued log lines can
+    // refer to their format strings
+    struct LogFormat
+    {
+      std::string file_name;
+      size_t line_number;
+      ccf::LoggerLevel log_level;
+      std::string tag;
+      std::string format;
+    };
+    std::unordered_map<uint32_t, LogFormat> log_formats;
+
+    LogThread log_thread;
+
+    static std::optional<double> get_offset(
+      std::chrono::microseconds::rep log_time_us_count)
+    {
+      // Represent offset as a real (counting seconds) to handle both small
+      // negative _and_ positive numbers. Since the system clock used is not
+      // monotonic, the offset we calculate could go in either direction,
+      // and tm can't represent small negative values.
+      std::optional<double> offset_time = std::nullopt;
+
+      // If enclave doesn't know the
+      // current time yet, don't try to produce an offset, just give them
+      // the host's time (producing offset of 0)
+      if (log_time_us_count != 0)
+      {
+        // Enclave time is recomputed every time. If multiple threads
+        // log inside the enclave, offsets may not always increase
+        const double enclave_time_s = log_time_us_count / 1'000'000.0;
+
+        ::timespec ts;
+        ::timespec_get(&ts, TIME_UTC);
+        const double host_time_s = ts.tv_sec + (ts.tv_nsec / 1'000'000'000.0);
+
+        offset_time = enclave_time_s - host_time_s;
+      }
+
+      return offset_time;
+    }
+
   public:
     HandleRingbufferImpl(
       messaging::BufferProcessor& bp,
@@ -39,7 +84,7 @@ namespace asynchost
     {
       // Register message handler for log message from enclave
       DISPATCHER_SET_MESSAGE_HANDLER(
-        bp, AdminMessage::log_msg, [](const uint8_t* data, size_t size) {
+        bp, AdminMessage::log_msg, [this](const uint8_t* data, size_t size) {
           auto
             [log_time_us_count,
              file_name,
@@ -53,43 +98,64 @@ namespace asynchost
             log_level, tag, file_name.c_str(), line_number, thread_id);
           ll.msg = msg;
 
-          // Represent offset as a real (counting seconds) to handle both small
-          // negative _and_ positive numbers. Since the system clock used is not
-          // monotonic, the offset we calculate could go in either direction,
-          // and tm can't represent small negative values.
-          std::optional<double> offset_time = std::nullopt;
-
-          // If enclave doesn't know the
-          // current time yet, don't try to produce an offset, just give them
-          // the host's time (producing offset of 0)
-          if (log_time_us_count != 0)
-          {
-            // Enclave time is recomputed every time. If multiple threads
-            // log inside the enclave, offsets may not always increase
-            const double enclave_time_s = log_time_us_count / 1'000'000.0;
-
-            ::timespec ts;
-            ::timespec_get(&ts, TIME_UTC);
-            const double host_time_s =
-              ts.tv_sec + (ts.tv_nsec / 1'000'000'000.0);
+          log_thread.write(std::move(ll), get_offset(log_time_us_count));
+        });
 
-            offset_time = enclave_time_s - host_time_s;
-          }
+      DISPATCHER_SET_MESSAGE_HANDLER(
+        bp, AdminMessage::log_format, [this](const uint8_t* data, size_t size) {
+          auto [site_id, file_name, line_number, log_level, tag, format] =
+            ringbuffer::read_message<AdminMessage::log_format>(data, size);
+
+          log_formats.try_emplace(
+            site_id,
+            std::move(file_name),
+            line_number,
+            log_level,
+            std::move(tag),
+            std::move(format));
+        });
 
-          auto& loggers = ccf::logger::config::loggers();
-          for (auto const& logger : loggers)
+      DISPATCHER_SET_MESSAGE_HANDLER(
+        bp,
+        AdminMessage::log_deferred_msg,
+        [this](const uint8_t* data, size_t size) {
+          auto [log_time_us_count, site_id, thread_id, dropped, args] =
+            ringbuffer::read_message<AdminMessage::log_deferred_msg>(
+              data, size);
+
+          const auto it = log_formats.find(site_id);
+          if (it == log_formats.end())
           {
-            logger->write(ll, offset_time);
+            LOG_FAIL_FMT("Received log message for unknown site {}", site_id);
+            return;
           }
+
+          const auto& site = it->second;
+          ccf::logger::LogLine ll(
+            site.log_level,
+            site.tag,
+            site.file_name,
+            site.line_number,
+            thread_id);
+          ll.deferred.emplace(
+            site_id,
+            site.format,
+            std::span<const uint8_t>(args.data, args.size));
+
+          log_thread.write(
+            std::move(ll), get_offset(log_time_us_count), dropped);
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
         bp,
         AdminMessage::fatal_error_msg,
-        [](const uint8_t* data, size_t size) {
+        [this](const uint8_t* data, size_t size) {
           auto [msg] =
             ringbuffer::read_message<AdminMessage::fatal_error_msg>(data, size);
 
+          // Make sure everything logged before the error is written first
+          log_thread.flush();
+
           std::cerr << msg << std::endl << std::flush;
           throw std::logic_error(msg);
         });
@@ -5,6 +5,7 @@
 #include "ccf/ds/logger.h"
 #include "ccf/ds/nonstd.h"
 #include "ccf/pal/locking.h"
+#include "before_io.h"
 #include "consensus/ledger_enclave_types.h"
 #include "ds/files.h"
 #include "ds/messaging.h"
@@ -15,6 +16,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <filesystem>
 #include <list>
 #include <map>
@@ -29,6 +31,12 @@ namespace fs = std::filesystem;
 namespace asynchost
 {
   static constexpr size_t ledger_max_read_cache_files_default = 5;
+  static constexpr size_t ledger_entry_cache_max_size_default =
+    16 * 1024 * 1024; // 16MB
+  // Size of the stdio buffer of ledger files open for writing, so that entries
+  // written in the same batch are written to disk in as few syscalls as
+  // possible
+  static constexpr size_t ledger_write_buffer_size = 1024 * 1024; // 1MB
 
   static constexpr auto ledger_committed_suffix = "committed";
   static constexpr auto ledger_start_idx_delimiter = "_";
@@ -144,6 +152,137 @@ namespace asynchost
     size_t end_idx;
   };
 
+  // In-memory cache of the most recently written ledger entries, so that
+  // AppendEntries to up-to-date backups can be served without reading entries
+  // back from the ledger files. Cached entries are always contiguous and the
+  // oldest ones are evicted once their total size exceeds max_size.
+  class LedgerEntryCache
+  {
+  public:
+    struct Stats
+    {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t entries = 0;
+      size_t size = 0;
+    };
+
+  private:
+    const size_t max_size;
+
+    // Index of the first entry in entries
+    size_t start_idx = 0;
+    std::deque<std::vector<uint8_t>> entries;
+    size_t current_size = 0;
+
+    size_t hits = 0;
+    size_t misses = 0;
+
+    void evict_front()
+    {
+      current_size -= entries.front().size();
+      entries.pop_front();
+      start_idx++;
+    }
+
+  public:
+    LedgerEntryCache(size_t max_size) : max_size(max_size) {}
+
+    size_t get_last_idx() const
+    {
+      return entries.empty() ? 0 : start_idx + entries.size() - 1;
+    }
+
+    void add(size_t idx, const uint8_t* data, size_t size)
+    {
+      if (size > max_size)
+      {
+        // Entry can never fit. Drop everything to keep cache contiguous.
+        clear();
+        return;
+      }
+
+      if (entries.empty() || idx != get_last_idx() + 1)
+      {
+        clear();
+        start_idx = idx;
+      }
+
+      entries.emplace_back(data, data + size);
+      current_size += size;
+
+      while (current_size > max_size)
+      {
+        evict_front();
+      }
+    }
+
+    // Discard all cached entries after idx
+    void truncate(size_t idx)
+    {
+      while (!entries.empty() && get_last_idx() > idx)
+      {
+        current_size -= entries.back().size();
+        entries.pop_back();
+      }
+    }
+
+    void clear()
+    {
+      entries.clear();
+      current_size = 0;
+      start_idx = 0;
+    }
+
+    // Returns entries [from, to] if they are all cached. If max_size is set,
+    // only returns the longest prefix of the range that fits within it.
+    std::optional<LedgerReadResult> read_entries(
+      size_t from, size_t to, std::optional<size_t> max_size = std::nullopt)
+    {
+      if (entries.empty() || from < start_idx || to > get_last_idx())
+      {
+        misses++;
+        return std::nullopt;
+      }
+
+      size_t size = 0;
+      size_t end_idx = from;
+      for (auto idx = from; idx <= to; ++idx)
+      {
+        const auto entry_size = entries[idx - start_idx].size();
+        if (max_size.has_value() && size + entry_size > max_size.value())
+        {
+          break;
+        }
+        size += entry_size;
+        end_idx = idx;
+      }
+
+      if (size == 0)
+      {
+        misses++;
+        return std::nullopt;
+      }
+
+      LedgerReadResult rr;
+      rr.end_idx = end_idx;
+      rr.data.reserve(size);
+      for (auto idx = from; idx <= end_idx; ++idx)
+      {
+        const auto& entry = entries[idx - start_idx];
+        rr.data.insert(rr.data.end(), entry.begin(), entry.end());
+      }
+
+      hits++;
+      return rr;
+    }
+
+    Stats get_stats() const
+    {
+      return {hits, misses, entries.size(), current_size};
+    }
+  };
+
   class LedgerFile
   {
   private:
@@ -167,6 +306,9 @@ namespace asynchost
 
     bool recovery = false;
 
+    // Set when entries have been written to the file but not yet flushed
+    bool unflushed = false;
+
     // This flag is set when an existing ledger is recovered and started (init)
     // from an old idx. In this case, further ledger files (i.e. those which
     // contain entries later than init idx), remain on disk and new entries are
@@ -202,6 +344,7 @@ namespace asynchost
         throw std::logic_error(fmt::format(
           "Unable to open ledger file {}: {}", file_path, strerror(errno)));
       }
+      setvbuf(file, nullptr, _IOFBF, ledger_write_buffer_size);
 
       // Header reserved for the offset to the position table
       fseeko(file, sizeof(positions_offset_header_t), SEEK_SET);
@@ -233,6 +376,11 @@ namespace asynchost
           "Unable to open ledger file {}: {}", file_path, strerror(errno)));
       }
 
+      if (!committed)
+      {
+        setvbuf(file, nullptr, _IOFBF, ledger_write_buffer_size);
+      }
+
       // First, get full size of file
       fseeko(file, 0, SEEK_END);
       size_t total_file_size = ftello(file);
@@ -411,16 +559,19 @@ namespace asynchost
 
       if (should_write)
       {
+        // Non-committable entries are buffered until the next committable
+        // entry or flush(), so that the entries of a transaction batch reach
+        // the file together
         if (fwrite(data, size, 1, file) != 1)
         {
           throw std::logic_error("Failed to write entry to ledger");
         }
+        unflushed = true;
 
         // Committable entries get flushed straight away
-        if (committable && fflush(file) != 0)
+        if (committable)
         {
-          throw std::logic_error(fmt::format(
-            "Failed to flush entry to ledger: {}", strerror(errno)));
+          flush();
         }
       }
 
@@ -574,6 +725,7 @@ namespace asynchost
         throw std::logic_error(
           fmt::format("Failed to truncate ledger: {}", strerror(errno)));
       }
+      unflushed = false;
 
       fseeko(file, total_len, SEEK_SET);
       LOG_TRACE_FMT("Truncated ledger file {} at seqno {}", file_name, idx);
@@ -620,6 +772,22 @@ namespace asynchost
       LOG_TRACE_FMT("Completed ledger file {}", file_name);
 
       completed = true;
+      unflushed = false;
+    }
+
+    void flush()
+    {
+      if (!unflushed)
+      {
+        return;
+      }
+
+      if (fflush(file) != 0)
+      {
+        throw std::logic_error(
+          fmt::format("Failed to flush ledger file: {}", strerror(errno)));
+      }
+      unflushed = false;
     }
 
     bool rename(const std::string& new_file_name)
@@ -657,11 +825,7 @@ namespace asynchost
         return false;
       }
 
-      if (fflush(file) != 0)
-      {
-        throw std::logic_error(
-          fmt::format("Failed to flush ledger file: {}", strerror(errno)));
-      }
+      flush();
 
       auto committed_file_name = fmt::format(
         "{}_{}-{}.{}",
@@ -713,6 +877,10 @@ namespace asynchost
     std::list<std::shared_ptr<LedgerFile>> files_read_cache;
     ccf::pal::Mutex read_cache_lock;
 
+    // Cache of recently written entries, served to uncommitted reads (e.g.
+    // AppendEntries). Only accessed from the main (uv) thread.
+    LedgerEntryCache entry_cache;
+
     const size_t chunk_threshold;
     size_t last_idx = 0;
     size_t committed_idx = 0;
@@ -1004,10 +1172,12 @@ namespace asynchost
       ringbuffer::AbstractWriterFactory& writer_factory,
       size_t chunk_threshold,
       size_t max_read_cache_files = ledger_max_read_cache_files_default,
-      const std::vector<std::string>& read_ledger_dirs_ = {}) :
+      const std::vector<std::string>& read_ledger_dirs_ = {},
+      size_t entry_cache_max_size = ledger_entry_cache_max_size_default) :
       to_enclave(writer_factory.create_writer_to_inside()),
       ledger_dir(ledger_dir),
       max_read_cache_files(max_read_cache_files),
+      entry_cache(entry_cache_max_size),
       chunk_threshold(chunk_threshold)
     {
       if (chunk_threshold == 0 || chunk_threshold > max_chunk_threshold_size)
@@ -1220,6 +1390,7 @@ namespace asynchost
       // Close all open write files as the the ledger should
       // restart cleanly, from a new chunk.
       files.clear();
+      entry_cache.clear();
 
       use_existing_files = true;
       last_idx_on_init = last_idx;
@@ -1294,9 +1465,23 @@ namespace asynchost
       TimeBoundLogger log_if_slow(
         fmt::format("Reading ledger entries from {} to {}", from, to));
 
+      // Recently written entries (e.g. for AppendEntries to up-to-date
+      // backups) are served from memory. Lagging readers fall back to the
+      // ledger files.
+      auto cached = entry_cache.read_entries(from, to, max_entries_size);
+      if (cached.has_value())
+      {
+        return cached;
+      }
+
       return read_entries_range(from, to, false, max_entries_size);
     }
 
+    LedgerEntryCache::Stats get_entry_cache_stats() const
+    {
+      return entry_cache.get_stats();
+    }
+
     size_t write_entry(const uint8_t* data, size_t size, bool committable)
     {
       TimeBoundLogger log_if_slow(fmt::format(
@@ -1356,6 +1541,7 @@ namespace asynchost
       auto [last_idx_, has_truncated] =
         file->write_entry(data, size, committable);
       last_idx = last_idx_;
+      entry_cache.add(last_idx, data, size);
 
       if (has_truncated)
       {
@@ -1428,6 +1614,7 @@ namespace asynchost
         }
       }
 
+      entry_cache.truncate(idx);
       last_idx = idx;
     }
 
@@ -1475,6 +1662,16 @@ namespace asynchost
       return idx <= end_of_committed_files_idx;
     }
 
+    // Writes all entries appended so far to the ledger files. Entries are
+    // buffered until then so that a batch of entries is written at once.
+    void flush()
+    {
+      for (auto& f : files)
+      {
+        f->flush();
+      }
+    }
+
     struct AsyncLedgerGet
     {
       // Filled on construction
@@ -1643,4 +1840,21 @@ namespace asynchost
         });
     }
   };
+
+  class LedgerFlushImpl
+  {
+  private:
+    Ledger& ledger;
+
+  public:
+    LedgerFlushImpl(Ledger& ledger) : ledger(ledger) {}
+
+    void before_io()
+    {
+      // All entries appended during this loop iteration are written together
+      ledger.flush();
+    }
+  };
+
+  using LedgerFlush = proxy_ptr<BeforeIO<LedgerFlushImpl>>;
 }
@@ -3,8 +3,12 @@
 #pragma once
 
 #include "ds/messaging.h"
+#include "ledger.h"
+#include "tcp.h"
 #include "timer.h"
 
+#include <map>
+
 namespace asynchost
 {
   class LoadMonitorImpl
@@ -14,7 +18,36 @@ namespace asynchost
 
     messaging::Dispatcher<ringbuffer::Message>& dispatcher;
 
-    nlohmann::json enclave_counts;
+    messaging::LabelledCounts enclave_counts;
+
+    std::map<std::string, std::shared_ptr<TCPTrafficStats>> tcp_stats;
+
+    Ledger* ledger = nullptr;
+    LedgerEntryCache::Stats last_entry_cache_stats;
+
+    static nlohmann::json report_and_reset(TCPTrafficStats& stats)
+    {
+      auto j = nlohmann::json::object();
+
+      j["bytes_read"] = stats.bytes_read;
+      j["reads"] = stats.reads;
+      j["read_allocations"] = stats.read_allocations;
+      j["bytes_written"] = stats.bytes_written;
+      j["writes"] = stats.writes;
+      j["write_allocations"] = stats.write_allocations;
+
+      const auto bytes = stats.bytes_read + stats.bytes_written;
+      if (bytes != 0)
+      {
+        constexpr double mb = 1024 * 1024;
+        j["syscalls_per_mb"] = (stats.reads + stats.writes) * mb / bytes;
+        j["allocations_per_mb"] =
+          (stats.read_allocations + stats.write_allocations) * mb / bytes;
+      }
+
+      stats = {};
+      return j;
+    }
 
   public:
     LoadMonitorImpl(messaging::BufferProcessor& bp) :
@@ -24,45 +57,43 @@ namespace asynchost
       last_update = std::chrono::duration_cast<std::chrono::milliseconds>(
         TClock::now().time_since_epoch());
 
-      enclave_counts = nlohmann::json::object();
-
       // Register message handler for work_stats message from enclave
       DISPATCHER_SET_MESSAGE_HANDLER(
         bp, AdminMessage::work_stats, [this](const uint8_t* data, size_t size) {
-          auto [dumped_json] =
+          auto [serialised_counts] =
             ringbuffer::read_message<AdminMessage::work_stats>(data, size);
 
-          nlohmann::json j;
+          messaging::LabelledCounts counts;
           try
           {
-            j = nlohmann::json::parse(dumped_json);
+            counts = messaging::deserialise_labelled_counts(
+              serialised_counts.data(), serialised_counts.size());
           }
-          catch (const nlohmann::json::parse_error& e)
+          catch (const std::exception& e)
           {
-            LOG_FAIL_FMT("Received unparseable work_stats from enclave");
+            LOG_FAIL_FMT("Received malformed work_stats from enclave");
             return;
           }
 
-          for (const auto& [outer_key, outer_value] : j.items())
+          for (const auto& [label, c] : counts)
           {
-            for (const auto& [inner_key, inner_value] : outer_value.items())
-            {
-              auto& outer_obj = enclave_counts[outer_key];
-              auto it = outer_obj.find(inner_key);
-              if (it == outer_obj.end())
-              {
-                outer_obj[inner_key] = inner_value;
-              }
-              else
-              {
-                const auto prev = it.value().get<size_t>();
-                outer_obj[inner_key] = prev + inner_value.get<size_t>();
-              }
-            }
+            enclave_counts[label] += c;
           }
         });
     }
 
+    void add_tcp_stats(
+      const std::string& name, std::shared_ptr<TCPTrafficStats> stats)
+    {
+      tcp_stats[name] = std::move(stats);
+    }
+
+    void set_ledger(Ledger& ledger_)
+    {
+      ledger = &ledger_;
+      last_entry_cache_stats = ledger->get_entry_cache_stats();
+    }
+
     void on_timer()
     {
       const auto message_counts = dispatcher.retrieve_message_counts();
@@ -85,14 +116,47 @@ namespace asynchost
         }
 
         {
-          j["ringbuffer_messages"] = enclave_counts;
-          enclave_counts = nlohmann::json::object();
+          j["ringbuffer_messages"] =
+            messaging::convert_labelled_counts(enclave_counts);
+          enclave_counts.clear();
 
           LOG_DEBUG_FMT("Enclave load: {}", j.dump());
         }
 
         last_update = time_now;
       }
+
+      if (!tcp_stats.empty())
+      {
+        auto j = nlohmann::json::object();
+        for (auto& [name, stats] : tcp_stats)
+        {
+          j[name] = report_and_reset(*stats);
+        }
+
+        LOG_DEBUG_FMT("Host TCP traffic: {}", j.dump());
+      }
+
+      if (ledger != nullptr)
+      {
+        // Cache hit and miss counts are cumulative, so report the change
+        const auto stats = ledger->get_entry_cache_stats();
+        const auto hits = stats.hits - last_entry_cache_stats.hits;
+        const auto misses = stats.misses - last_entry_cache_stats.misses;
+        last_entry_cache_stats = stats;
+
+        if (hits + misses != 0)
+        {
+          auto j = nlohmann::json::object();
+          j["hits"] = hits;
+          j["misses"] = misses;
+          j["hit_rate"] = (double)hits / (hits + misses);
+          j["entries"] = stats.entries;
+          j["size"] = stats.size;
+
+          LOG_DEBUG_FMT("Host ledger entry cache: {}", j.dump());
+        }
+      }
     }
   };
 
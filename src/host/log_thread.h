@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/ds/logger.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asynchost
+{
+  // Formats and writes log lines received from the enclave on a dedicated
+  // thread, so that the main thread does not spend time formatting messages
+  // or blocked on output. Lines arriving while the backlog is full are dropped,
+  // unless they report failures, and the number dropped is reported once the
+  // backlog has cleared.
+  class LogThread
+  {
+  private:
+    static constexpr size_t max_queued = 100'000;
+
+    struct Entry
+    {
+      ccf::logger::LogLine line;
+      std::optional<double> enclave_offset;
+    };
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::condition_variable drained;
+    bool stopping = false;
+    bool writing = false;
+
+    std::vector<Entry> queued;
+    size_t dropped = 0;
+
+    std::thread thread;
+
+    static void write_line(
+      ccf::logger::LogLine& line, const std::optional<double>& enclave_offset)
+    {
+      for (auto const& logger : ccf::logger::config::loggers())
+      {
+        if (!logger->writes_deferred())
+        {
+          line.format_deferred();
+        }
+        logger->write(line, enclave_offset);
+      }
+    }
+
+    static ccf::logger::LogLine make_dropped_line(
+      size_t count, std::string_view where)
+    {
+      ccf::logger::LogLine line(
+        ccf::LoggerLevel::FAIL, "", __FILE__, __LINE__);
+      line.msg = fmt::format(
+        "{} log messages were dropped by the {}, which was overloaded",
+        count,
+        where);
+      return line;
+    }
+
+    void run()
+    {
+      std::vector<Entry> entries;
+      while (true)
+      {
+        size_t dropped_here = 0;
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          writing = false;
+          drained.notify_all();
+          cv.wait(guard, [this] { return stopping || !queued.empty(); });
+          if (queued.empty())
+          {
+            return;
+          }
+          std::swap(entries, queued);
+          std::swap(dropped_here, dropped);
+          writing = true;
+        }
+
+        for (auto& entry : entries)
+        {
+          write_line(entry.line, entry.enclave_offset);
+        }
+        entries.clear();
+
+        if (dropped_here != 0)
+        {
+          auto line = make_dropped_line(dropped_here, "host");
+          write_line(line, std::nullopt);
+        }
+      }
+    }
+
+  public:
+    LogThread() : thread([this]() { run(); }) {}
+
+    ~LogThread()
+    {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+      }
+      cv.notify_one();
+      thread.join();
+    }
+
+    void write(
+      ccf::logger::LogLine&& line,
+      const std::optional<double>& enclave_offset,
+      size_t dropped_by_enclave = 0)
+    {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (dropped_by_enclave != 0)
+        {
+          queued.push_back(
+            {make_dropped_line(dropped_by_enclave, "enclave"), std::nullopt});
+        }
+
+        if (
+          queued.size() >= max_queued &&
+          ccf::logger::is_droppable(line.log_level))
+        {
+          ++dropped;
+          return;
+        }
+
+        queued.push_back({std::move(line), enclave_offset});
+      }
+      cv.notify_one();
+    }
+
+    // Blocks until all lines written so far have been written out
+    void flush()
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      drained.wait(guard, [this] { return queued.empty() && !writing; });
+    }
+  };
+}
@@ -53,6 +53,9 @@ using ResolvedAddresses = std::
 size_t asynchost::TCPImpl::remaining_read_quota =
   asynchost::TCPImpl::max_read_quota;
 bool asynchost::TCPImpl::alloc_quota_logged = false;
+asynchost::ReadBufferPool asynchost::TCPImpl::read_buffers(
+  asynchost::TCPImpl::max_read_size,
+  asynchost::TCPImpl::max_read_quota / asynchost::TCPImpl::max_read_size);
 
 size_t asynchost::UDPImpl::remaining_read_quota =
   asynchost::UDPImpl::max_read_quota;
@@ -373,9 +376,13 @@ int main(int argc, char** argv)
       writer_factory,
       config.ledger.chunk_size,
       asynchost::ledger_max_read_cache_files_default,
-      config.ledger.read_only_directories);
+      config.ledger.read_only_directories,
+      config.ledger.entry_cache_size);
     ledger.register_message_handlers(bp.get_dispatcher());
 
+    // flush ledger entries appended during each loop iteration together
+    asynchost::LedgerFlush ledger_flush(ledger);
+
     asynchost::SnapshotManager snapshots(
       config.snapshots.directory,
       writer_factory,
@@ -428,6 +435,12 @@ int main(int argc, char** argv)
       config.idle_connection_timeout);
     rpc->behaviour.register_message_handlers(bp.get_dispatcher());
 
+    load_monitor->behaviour.add_tcp_stats(
+      "node_to_node", node.get_tcp_stats());
+    load_monitor->behaviour.add_tcp_stats(
+      "client", rpc->behaviour.get_tcp_stats());
+    load_monitor->behaviour.set_ledger(ledger);
+
     // This is a temporary solution to keep UDP RPC handlers in the same
     // way as the TCP ones without having to parametrize per connection,
     // which is not yet possible, due to UDP and TCP not being derived
@@ -508,6 +521,8 @@ int main(int argc, char** argv)
     ccf::StartupConfig startup_config(config);
 
     startup_config.snapshot_tx_interval = config.snapshots.tx_count;
+    startup_config.snapshot_max_delta_chain_length =
+      config.snapshots.max_delta_chain_length;
 
     if (startup_config.attestation.snp_security_policy_file.has_value())
     {
@@ -684,23 +699,26 @@ int main(int argc, char** argv)
       return static_cast<int>(CLI::ExitCodes::ValidationError);
     }
 
-    std::vector<uint8_t> startup_snapshot = {};
+    std::vector<std::vector<uint8_t>> startup_snapshots = {};
 
     if (
       config.command.type == StartType::Join ||
       config.command.type == StartType::Recover)
     {
-      auto latest_committed_snapshot =
-        snapshots.find_latest_committed_snapshot();
-      if (latest_committed_snapshot.has_value())
+      // Latest full snapshot, followed by the delta snapshots chained to it
+      auto latest_committed_snapshot_chain =
+        snapshots.find_latest_committed_snapshot_chain();
+      if (!latest_committed_snapshot_chain.empty())
       {
-        auto& [snapshot_dir, snapshot_file] = latest_committed_snapshot.value();
-        startup_snapshot = files::slurp(snapshot_dir / snapshot_file);
+        for (const auto& snapshot_path : latest_committed_snapshot_chain)
+        {
+          startup_snapshots.push_back(files::slurp(snapshot_path));
 
-        LOG_INFO_FMT(
-          "Found latest snapshot file: {} (size: {})",
-          snapshot_dir / snapshot_file,
-          startup_snapshot.size());
+          LOG_INFO_FMT(
+            "Found latest snapshot file: {} (size: {})",
+            snapshot_path,
+            startup_snapshots.back().size());
+        }
       }
       else
       {
@@ -731,7 +749,7 @@ int main(int argc, char** argv)
     auto create_status = enclave.create_node(
       enclave_config,
       startup_config,
-      std::move(startup_snapshot),
+      std::move(startup_snapshots),
       node_cert,
       service_cert,
       config.command.type,
@@ -276,6 +276,9 @@ namespace asynchost
     std::optional<std::chrono::milliseconds> client_connection_timeout =
       std::nullopt;
 
+    std::shared_ptr<TCPTrafficStats> tcp_stats =
+      std::make_shared<TCPTrafficStats>();
+
   public:
     NodeConnections(
       messaging::Dispatcher<ringbuffer::Message>& disp,
@@ -292,6 +295,7 @@ namespace asynchost
       client_connection_timeout(client_connection_timeout_)
     {
       listener->set_behaviour(std::make_unique<NodeServerBehaviour>(*this));
+      listener->set_stats(tcp_stats);
       listener->listen(host, port);
       host = listener->get_host();
       port = listener->get_port();
@@ -299,6 +303,11 @@ namespace asynchost
       register_message_handlers(disp);
     }
 
+    std::shared_ptr<TCPTrafficStats> get_tcp_stats() const
+    {
+      return tcp_stats;
+    }
+
     void register_message_handlers(
       messaging::Dispatcher<ringbuffer::Message>& disp)
     {
@@ -324,6 +333,11 @@ namespace asynchost
 
       DISPATCHER_SET_MESSAGE_HANDLER(
         disp, ccf::node_outbound, [this](const uint8_t* data, size_t size) {
+          // Ledger entries are written in batches. Make sure that all entries
+          // appended before this message (e.g. acknowledged by it) are
+          // written before it is sent.
+          ledger.flush();
+
           // Read piece-by-piece rather than all at once
           ccf::NodeId to = serialized::read<ccf::NodeId::Value>(data, size);
 
@@ -405,18 +419,18 @@ namespace asynchost
               {
                 const auto& framed_entries = read_result->data;
                 frame += (uint32_t)framed_entries.size();
-                outbound_connection->write(sizeof(uint32_t), (uint8_t*)&frame);
-                outbound_connection->write(size_to_send, data_to_send);
-
-                outbound_connection->write(
-                  framed_entries.size(), framed_entries.data());
+                outbound_connection->writev(
+                  {{(uint8_t*)&frame, sizeof(uint32_t)},
+                   {data_to_send, size_to_send},
+                   framed_entries});
               }
             }
             else
             {
               // Header-only AE
-              outbound_connection->write(sizeof(uint32_t), (uint8_t*)&frame);
-              outbound_connection->write(size_to_send, data_to_send);
+              outbound_connection->writev(
+                {{(uint8_t*)&frame, sizeof(uint32_t)},
+                 {data_to_send, size_to_send}});
             }
 
             LOG_DEBUG_FMT(
@@ -433,8 +447,9 @@ namespace asynchost
 
             LOG_DEBUG_FMT("node send to {} [{}]", to, frame);
 
-            outbound_connection->write(sizeof(uint32_t), (uint8_t*)&frame);
-            outbound_connection->write(size_to_send, data_to_send);
+            outbound_connection->writev(
+              {{(uint8_t*)&frame, sizeof(uint32_t)},
+               {data_to_send, size_to_send}});
           }
         });
     }
@@ -447,6 +462,7 @@ namespace asynchost
     {
       auto s = TCP(true, client_connection_timeout);
       s->set_behaviour(std::make_unique<NodeOutgoingBehaviour>(*this, node_id));
+      s->set_stats(tcp_stats);
 
       if (!s->connect(host, port, client_interface))
       {
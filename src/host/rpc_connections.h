@@ -238,6 +238,9 @@ namespace asynchost
 
     std::optional<std::chrono::seconds> idle_connection_timeout = std::nullopt;
 
+    std::shared_ptr<TCPTrafficStats> tcp_stats =
+      std::make_shared<TCPTrafficStats>();
+
     ringbuffer::WriterPtr to_enclave;
 
   public:
@@ -254,6 +257,11 @@ namespace asynchost
       to_enclave(writer_factory.create_writer_to_inside())
     {}
 
+    std::shared_ptr<TCPTrafficStats> get_tcp_stats() const
+    {
+      return tcp_stats;
+    }
+
     bool listen(
       ConnID id, std::string& host, std::string& port, const std::string& name)
     {
@@ -270,6 +278,10 @@ namespace asynchost
 
       ConnType s;
       s->set_behaviour(std::make_unique<RPCServerBehaviour>(*this, id));
+      if constexpr (isTCP<ConnType>())
+      {
+        s->set_stats(tcp_stats);
+      }
 
       if (!s->listen(host, port, name))
       {
@@ -306,6 +318,10 @@ namespace asynchost
 
       auto s = ConnType(true, client_connection_timeout);
       s->set_behaviour(std::make_unique<RPCClientBehaviour>(*this, id));
+      if constexpr (isTCP<ConnType>())
+      {
+        s->set_stats(tcp_stats);
+      }
 
       if (!s->connect(host, port))
       {
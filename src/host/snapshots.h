@@ -6,7 +6,9 @@
 #include "consensus/ledger_enclave_types.h"
 #include "time_bound_logger.h"
 
+#include <algorithm>
 #include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -19,6 +21,7 @@ namespace asynchost
   static constexpr auto snapshot_file_prefix = "snapshot";
   static constexpr auto snapshot_idx_delimiter = "_";
   static constexpr auto snapshot_committed_suffix = ".committed";
+  static constexpr auto snapshot_delta_infix = ".delta_";
 
   static bool is_snapshot_file(const std::string& file_name)
   {
@@ -138,11 +141,29 @@ namespace asynchost
     return read_idx(file_name.substr(evidence_idx_pos + 1, end_str));
   }
 
-  std::optional<fs::path> find_latest_committed_snapshot_in_directory(
-    const fs::path& directory, size_t& latest_committed_snapshot_idx)
+  static std::optional<size_t> get_snapshot_base_idx_from_file_name(
+    const std::string& file_name)
   {
-    std::optional<fs::path> latest_committed_snapshot_file_name = std::nullopt;
+    // Delta snapshot file names are of the form "snapshot_X_Y.delta_B" (or
+    // "snapshot_X_Y.delta_B.committed"), where B is the seqno of the snapshot
+    // the delta is chained to
+    auto pos = file_name.find(snapshot_delta_infix);
+    if (pos == std::string::npos)
+    {
+      return std::nullopt;
+    }
+
+    pos += strlen(snapshot_delta_infix);
+    auto end = file_name.find(snapshot_committed_suffix, pos);
+    return read_idx(file_name.substr(
+      pos, end == std::string::npos ? std::string::npos : end - pos));
+  }
 
+  // Committed snapshot files in directory, by seqno. The first directory
+  // containing a snapshot at a given seqno takes precedence.
+  void find_committed_snapshots_in_directory(
+    const fs::path& directory, std::map<size_t, fs::path>& committed_snapshots)
+  {
     for (auto& f : fs::directory_iterator(directory))
     {
       auto file_name = f.path().filename();
@@ -158,15 +179,9 @@ namespace asynchost
         continue;
       }
 
-      auto snapshot_idx = get_snapshot_idx_from_file_name(file_name);
-      if (snapshot_idx > latest_committed_snapshot_idx)
-      {
-        latest_committed_snapshot_file_name = file_name;
-        latest_committed_snapshot_idx = snapshot_idx;
-      }
+      committed_snapshots.emplace(
+        get_snapshot_idx_from_file_name(file_name), f.path());
     }
-
-    return latest_committed_snapshot_file_name;
   }
 
   class SnapshotManager
@@ -177,13 +192,101 @@ namespace asynchost
     const fs::path snapshot_dir;
     const std::optional<fs::path> read_snapshot_dir = std::nullopt;
 
+    // Snapshots are streamed by the enclave in chunks, which are appended to
+    // a non-committed snapshot file as they are received. The file is only
+    // renamed to its committed name once the receipt has been appended.
     struct PendingSnapshot
     {
       ::consensus::Index evidence_idx;
-      std::shared_ptr<std::vector<uint8_t>> snapshot;
+      // Seqno of the base snapshot of a delta snapshot, 0 if full
+      ::consensus::Index base_idx;
+      size_t expected_size;
+      size_t written_size = 0;
+      fs::path path;
+      std::ofstream file;
     };
     std::map<size_t, PendingSnapshot> pending_snapshots;
 
+    // Seqno of the latest snapshot committed since startup. Pending snapshots
+    // at earlier seqnos (e.g. whose streaming was abandoned by the enclave
+    // after a rollback) are superseded by it, and are never committed.
+    ::consensus::Index last_committed_idx = 0;
+
+    fs::path get_snapshot_path(
+      ::consensus::Index idx,
+      ::consensus::Index evidence_idx,
+      ::consensus::Index base_idx,
+      bool committed) const
+    {
+      // e.g. snapshot_100_105 or snapshot_100_105.committed, or
+      // snapshot_100_105.delta_50.committed for a delta snapshot
+      return snapshot_dir /
+        fmt::format(
+               "{}{}{}{}{}{}{}",
+               snapshot_file_prefix,
+               snapshot_idx_delimiter,
+               idx,
+               snapshot_idx_delimiter,
+               evidence_idx,
+               base_idx != 0 ?
+                 fmt::format("{}{}", snapshot_delta_infix, base_idx) :
+                 "",
+               committed ? snapshot_committed_suffix : "");
+    }
+
+    void discard_pending_snapshot(
+      std::map<size_t, PendingSnapshot>::iterator it)
+    {
+      it->second.file.close();
+      std::error_code ec;
+      fs::remove(it->second.path, ec);
+      pending_snapshots.erase(it);
+    }
+
+    void discard_superseded_snapshots()
+    {
+      for (auto it = pending_snapshots.begin();
+           it != pending_snapshots.end() && it->first < last_committed_idx;)
+      {
+        LOG_DEBUG_FMT(
+          "Discarding snapshot {} superseded by committed snapshot {} [{}/{} "
+          "bytes received]",
+          it->first,
+          last_committed_idx,
+          it->second.written_size,
+          it->second.expected_size);
+        discard_pending_snapshot(it++);
+      }
+    }
+
+    void remove_non_committed_snapshots()
+    {
+      // Non-committed snapshot files left over by a previous run (e.g. whose
+      // streaming was interrupted) can never be committed, as the enclave
+      // does not resume streaming after a restart
+      for (auto& f : fs::directory_iterator(snapshot_dir))
+      {
+        auto file_name = f.path().filename();
+        if (
+          is_snapshot_file(file_name) &&
+          !is_snapshot_file_committed(file_name))
+        {
+          std::error_code ec;
+          if (fs::remove(f.path(), ec))
+          {
+            LOG_INFO_FMT("Removed non-committed snapshot file {}", file_name);
+          }
+          else
+          {
+            LOG_FAIL_FMT(
+              "Could not remove non-committed snapshot file {}: {}",
+              file_name,
+              ec.message());
+          }
+        }
+      }
+    }
+
   public:
     SnapshotManager(
       const std::string& snapshot_dir_,
@@ -197,6 +300,7 @@ namespace asynchost
       {
         LOG_INFO_FMT(
           "Snapshots will be stored in existing directory: {}", snapshot_dir);
+        remove_non_committed_snapshots();
       }
       else if (!fs::create_directory(snapshot_dir))
       {
@@ -219,18 +323,80 @@ namespace asynchost
       return snapshot_dir;
     }
 
-    std::shared_ptr<std::vector<uint8_t>> add_pending_snapshot(
+    void add_pending_snapshot(
       ::consensus::Index idx,
       ::consensus::Index evidence_idx,
-      size_t requested_size)
+      size_t expected_size,
+      ::consensus::Index base_idx = 0)
     {
-      auto snapshot = std::make_shared<std::vector<uint8_t>>(requested_size);
-      pending_snapshots.emplace(idx, PendingSnapshot{evidence_idx, snapshot});
+      if (idx < last_committed_idx)
+      {
+        LOG_DEBUG_FMT(
+          "Ignoring snapshot {}, superseded by committed snapshot {}",
+          idx,
+          last_committed_idx);
+        return;
+      }
 
-      LOG_DEBUG_FMT(
-        "Added pending snapshot {} [{} bytes]", idx, requested_size);
+      auto search = pending_snapshots.find(idx);
+      if (search != pending_snapshots.end())
+      {
+        // Snapshot at the same seqno was previously streamed (e.g. before a
+        // rollback of its evidence) but never committed
+        discard_pending_snapshot(search);
+      }
 
-      return snapshot;
+      auto path = get_snapshot_path(idx, evidence_idx, base_idx, false);
+      std::ofstream file(path, std::ios::trunc | std::ios::binary);
+      if (!file.good())
+      {
+        LOG_FAIL_FMT("Cannot write snapshot: error opening file {}", path);
+        return;
+      }
+
+      pending_snapshots.emplace(
+        idx,
+        PendingSnapshot{
+          evidence_idx, base_idx, expected_size, 0, path, std::move(file)});
+
+      LOG_DEBUG_FMT("Added pending snapshot {} [{} bytes]", idx, expected_size);
+    }
+
+    void write_snapshot_chunk(
+      ::consensus::Index idx, const uint8_t* data, size_t size)
+    {
+      auto search = pending_snapshots.find(idx);
+      if (search == pending_snapshots.end())
+      {
+        if (idx >= last_committed_idx)
+        {
+          LOG_FAIL_FMT("Could not find pending snapshot {} to write to", idx);
+        }
+        return;
+      }
+
+      auto& pending = search->second;
+      if (pending.written_size + size > pending.expected_size)
+      {
+        LOG_FAIL_FMT(
+          "Discarding snapshot {}: received {} bytes, more than expected {} "
+          "bytes",
+          idx,
+          pending.written_size + size,
+          pending.expected_size);
+        discard_pending_snapshot(search);
+        return;
+      }
+
+      pending.file.write(reinterpret_cast<const char*>(data), size);
+      if (!pending.file.good())
+      {
+        LOG_FAIL_FMT(
+          "Discarding snapshot {}: error writing to file {}", idx, pending.path);
+        discard_pending_snapshot(search);
+        return;
+      }
+      pending.written_size += size;
     }
 
     void commit_snapshot(
@@ -243,61 +409,63 @@ namespace asynchost
 
       try
       {
-        for (auto it = pending_snapshots.begin(); it != pending_snapshots.end();
-             it++)
+        auto it = pending_snapshots.find(snapshot_idx);
+        if (it == pending_snapshots.end())
         {
-          if (snapshot_idx == it->first)
+          if (snapshot_idx >= last_committed_idx)
           {
-            // e.g. snapshot_100_105.committed
-            auto file_name = fmt::format(
-              "{}{}{}{}{}{}",
-              snapshot_file_prefix,
-              snapshot_idx_delimiter,
-              it->first,
-              snapshot_idx_delimiter,
-              it->second.evidence_idx,
-              snapshot_committed_suffix);
-            auto full_snapshot_path = snapshot_dir / file_name;
-
-            if (fs::exists(full_snapshot_path))
-            {
-              // In the case that a file with this name already exists, keep
-              // existing file and drop pending snapshot
-              LOG_FAIL_FMT(
-                "Cannot write snapshot as file already exists: {}", file_name);
-            }
-            else
-            {
-              std::ofstream snapshot_file(
-                full_snapshot_path, std::ios::app | std::ios::binary);
-              if (!snapshot_file.good())
-              {
-                LOG_FAIL_FMT(
-                  "Cannot write snapshot: error opening file {}", file_name);
-              }
-              else
-              {
-                const auto& snapshot = it->second.snapshot;
-                snapshot_file.write(
-                  reinterpret_cast<const char*>(snapshot->data()),
-                  snapshot->size());
-                snapshot_file.write(
-                  reinterpret_cast<const char*>(receipt_data), receipt_size);
-
-                LOG_INFO_FMT(
-                  "New snapshot file written to {} [{} bytes]",
-                  file_name,
-                  static_cast<size_t>(snapshot_file.tellp()));
-              }
-            }
+            LOG_FAIL_FMT(
+              "Could not find snapshot to commit at {}", snapshot_idx);
+          }
+          return;
+        }
+
+        auto& pending = it->second;
+        auto full_snapshot_path = get_snapshot_path(
+          snapshot_idx, pending.evidence_idx, pending.base_idx, true);
+        auto file_name = full_snapshot_path.filename();
 
+        if (pending.written_size != pending.expected_size)
+        {
+          LOG_FAIL_FMT(
+            "Cannot commit snapshot {}: only {} out of {} bytes were received",
+            file_name,
+            pending.written_size,
+            pending.expected_size);
+        }
+        else if (fs::exists(full_snapshot_path))
+        {
+          // In the case that a file with this name already exists, keep
+          // existing file and drop pending snapshot
+          LOG_FAIL_FMT(
+            "Cannot write snapshot as file already exists: {}", file_name);
+        }
+        else
+        {
+          pending.file.write(
+            reinterpret_cast<const char*>(receipt_data), receipt_size);
+          pending.file.close();
+          if (pending.file.fail())
+          {
+            LOG_FAIL_FMT(
+              "Cannot write snapshot: error writing to file {}", pending.path);
+          }
+          else
+          {
+            fs::rename(pending.path, full_snapshot_path);
+            LOG_INFO_FMT(
+              "New snapshot file written to {} [{} bytes]",
+              file_name,
+              pending.expected_size + receipt_size);
             pending_snapshots.erase(it);
 
+            last_committed_idx = std::max(last_committed_idx, snapshot_idx);
+            discard_superseded_snapshots();
             return;
           }
         }
 
-        LOG_FAIL_FMT("Could not find snapshot to commit at {}", snapshot_idx);
+        discard_pending_snapshot(it);
       }
       catch (std::exception& e)
       {
@@ -308,37 +476,67 @@ namespace asynchost
       }
     }
 
-    std::optional<std::pair<fs::path, fs::path>>
-    find_latest_committed_snapshot()
+    // Returns the paths of the latest committed snapshot from which a node
+    // can start: a full snapshot, followed by the delta snapshots chained to
+    // it (if any), in order. Delta snapshots whose chain is incomplete (e.g.
+    // whose base was removed) are skipped.
+    std::vector<fs::path> find_latest_committed_snapshot_chain()
     {
-      // Keep track of latest snapshot file in both directories
-      size_t latest_idx = 0;
-
-      std::optional<fs::path> read_only_latest_committed_snapshot =
-        std::nullopt;
+      std::map<size_t, fs::path> committed_snapshots;
       if (read_snapshot_dir.has_value())
       {
-        read_only_latest_committed_snapshot =
-          find_latest_committed_snapshot_in_directory(
-            read_snapshot_dir.value(), latest_idx);
+        find_committed_snapshots_in_directory(
+          read_snapshot_dir.value(), committed_snapshots);
       }
+      find_committed_snapshots_in_directory(snapshot_dir, committed_snapshots);
 
-      auto main_latest_committed_snapshot =
-        find_latest_committed_snapshot_in_directory(snapshot_dir, latest_idx);
-
-      if (main_latest_committed_snapshot.has_value())
+      for (auto it = committed_snapshots.rbegin();
+           it != committed_snapshots.rend();
+           ++it)
       {
-        return std::make_pair(
-          snapshot_dir, main_latest_committed_snapshot.value());
+        std::vector<fs::path> chain = {it->second};
+        auto idx = it->first;
+        auto base_idx =
+          get_snapshot_base_idx_from_file_name(it->second.filename());
+        while (base_idx.has_value())
+        {
+          auto search = committed_snapshots.find(base_idx.value());
+          if (search == committed_snapshots.end() || base_idx.value() >= idx)
+          {
+            LOG_INFO_FMT(
+              "Ignoring delta snapshot file {}: base snapshot {} not found",
+              chain.back().filename(),
+              base_idx.value());
+            chain.clear();
+            break;
+          }
+          chain.push_back(search->second);
+          idx = search->first;
+          base_idx =
+            get_snapshot_base_idx_from_file_name(search->second.filename());
+        }
+
+        if (!chain.empty())
+        {
+          std::reverse(chain.begin(), chain.end());
+          return chain;
+        }
       }
-      else if (read_only_latest_committed_snapshot.has_value())
+
+      return {};
+    }
+
+    std::optional<std::pair<fs::path, fs::path>>
+    find_latest_committed_snapshot()
+    {
+      auto chain = find_latest_committed_snapshot_chain();
+      if (chain.empty())
       {
-        return std::make_pair(
-          read_snapshot_dir.value(),
-          read_only_latest_committed_snapshot.value());
+        return std::nullopt;
       }
 
-      return std::nullopt;
+      const auto& latest = chain.back();
+      return std::make_pair(latest.parent_path(), latest.filename());
     }
 
     void register_message_handlers(
@@ -346,21 +544,19 @@ namespace asynchost
     {
       DISPATCHER_SET_MESSAGE_HANDLER(
         disp,
-        ::consensus::snapshot_allocate,
+        ::consensus::snapshot_begin,
+        [this](const uint8_t* data, size_t size) {
+          auto [idx, evidence_idx, snapshot_size, base_idx] =
+            ringbuffer::read_message<::consensus::snapshot_begin>(data, size);
+          add_pending_snapshot(idx, evidence_idx, snapshot_size, base_idx);
+        });
+
+      DISPATCHER_SET_MESSAGE_HANDLER(
+        disp,
+        ::consensus::snapshot_chunk,
         [this](const uint8_t* data, size_t size) {
           auto idx = serialized::read<::consensus::Index>(data, size);
-          auto evidence_idx = serialized::read<::consensus::Index>(data, size);
-          auto requested_size = serialized::read<size_t>(data, size);
-          auto generation_count = serialized::read<uint32_t>(data, size);
-
-          auto snapshot =
-            add_pending_snapshot(idx, evidence_idx, requested_size);
-
-          RINGBUFFER_WRITE_MESSAGE(
-            ::consensus::snapshot_allocated,
-            to_enclave,
-            std::span<uint8_t>{snapshot->data(), snapshot->size()},
-            generation_count);
+          write_snapshot_chunk(idx, data, size);
         });
 
       DISPATCHER_SET_MESSAGE_HANDLER(
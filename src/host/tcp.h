@@ -10,14 +10,78 @@
 #include "proxy.h"
 #include "socket.h"
 
+#include <array>
+#include <initializer_list>
+#include <memory>
 #include <netinet/in.h>
+#include <new>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace asynchost
 {
   class TCPImpl;
   using TCP = proxy_ptr<TCPImpl>;
 
+  /// Counts of the work done by the host to move one kind of TCP traffic, so
+  /// that the allocations and syscalls per byte can be monitored.
+  struct TCPTrafficStats
+  {
+    size_t bytes_read = 0;
+    // Each is a single read from the socket
+    size_t reads = 0;
+    size_t read_allocations = 0;
+
+    size_t bytes_written = 0;
+    // Each is a single write (or writev) attempted by uv_try_write, or a
+    // request queued with uv_write for the remainder
+    size_t writes = 0;
+    size_t write_allocations = 0;
+  };
+
+  /// Fixed-size buffers for socket reads. Each read buffer is returned as soon
+  /// as its contents have been passed on, so only a handful are ever in use,
+  /// and these are recycled rather than allocated for every read.
+  class ReadBufferPool
+  {
+  private:
+    const size_t buffer_size;
+    const size_t max_pooled;
+    std::vector<std::unique_ptr<char[]>> pooled;
+
+  public:
+    ReadBufferPool(size_t buffer_size_, size_t max_pooled_) :
+      buffer_size(buffer_size_),
+      max_pooled(max_pooled_)
+    {}
+
+    // Returns a buffer of buffer_size bytes, and whether it was allocated
+    std::pair<char*, bool> get()
+    {
+      if (pooled.empty())
+      {
+        return {new char[buffer_size], true};
+      }
+
+      auto buffer = pooled.back().release();
+      pooled.pop_back();
+      return {buffer, false};
+    }
+
+    void put(char* buffer)
+    {
+      if (pooled.size() < max_pooled)
+      {
+        pooled.emplace_back(buffer);
+      }
+      else
+      {
+        delete[] buffer;
+      }
+    }
+  };
+
   class TCPImpl : public with_uv_handle<uv_tcp_t>
   {
   private:
@@ -25,12 +89,16 @@ namespace asynchost
 
     static constexpr int backlog = 128;
     static constexpr size_t max_read_size = 16384;
+    static constexpr size_t max_write_buffers = 8;
 
     // Each uv iteration, read only a capped amount from all sockets.
     static constexpr auto max_read_quota = max_read_size * 4;
     static size_t remaining_read_quota;
     static bool alloc_quota_logged;
 
+    // Enough buffers for a full quota of reads, shared by all sockets
+    static ReadBufferPool read_buffers;
+
     enum Status
     {
       FRESH,
@@ -55,6 +123,10 @@ namespace asynchost
     using PendingWrites = std::vector<PendingIO<uv_write_t>>;
     PendingWrites pending_writes;
 
+    // Shared by all sockets carrying the same kind of traffic, and inherited
+    // by sockets accepted from a listening socket
+    std::shared_ptr<TCPTrafficStats> stats;
+
     std::string host;
     std::string port;
     std::optional<std::string> client_host = std::nullopt;
@@ -136,6 +208,11 @@ namespace asynchost
       behaviour = std::move(b);
     }
 
+    void set_stats(std::shared_ptr<TCPTrafficStats> s)
+    {
+      stats = std::move(s);
+    }
+
     std::string get_host() const
     {
       return host;
@@ -328,11 +405,70 @@ namespace asynchost
 
     bool write(size_t len, const uint8_t* data, sockaddr addr = {})
     {
-      auto req = new uv_write_t;
-      char* copy = new char[len];
-      if (data)
-        memcpy(copy, data, len);
-      req->data = copy;
+      return writev({{data, len}});
+    }
+
+    /** Writes the concatenation of several buffers, which are only borrowed
+     * for the duration of the call. When connected, and with no earlier
+     * writes still queued, as much as the socket accepts is written directly
+     * from the buffers, and only the remainder is copied to be written later.
+     */
+    bool writev(std::initializer_list<std::span<const uint8_t>> bufs)
+    {
+      if (bufs.size() > max_write_buffers)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot write {} buffers at once (max {})",
+          bufs.size(),
+          max_write_buffers));
+      }
+
+      size_t len = 0;
+      std::array<uv_buf_t, max_write_buffers> uv_bufs;
+      for (size_t i = 0; const auto& buf : bufs)
+      {
+        uv_bufs[i++] = uv_buf_init((char*)buf.data(), buf.size());
+        len += buf.size();
+      }
+
+      size_t written = 0;
+      if (status == CONNECTED)
+      {
+        const auto rc =
+          uv_try_write((uv_stream_t*)&uv_handle, uv_bufs.data(), bufs.size());
+        if (rc < 0 && rc != UV_EAGAIN)
+        {
+          LOG_FAIL_FMT("uv_try_write failed: {}", uv_strerror(rc));
+          assert_status(CONNECTED, DISCONNECTED);
+          behaviour->on_disconnect();
+          return false;
+        }
+
+        written = rc > 0 ? rc : 0;
+        count_write(written);
+
+        if (written == len)
+        {
+          return true;
+        }
+      }
+
+      auto req = make_write(len - written);
+      auto copy = (uint8_t*)req->data;
+      for (const auto& buf : bufs)
+      {
+        if (written >= buf.size())
+        {
+          written -= buf.size();
+          continue;
+        }
+
+        const auto n = buf.size() - written;
+        memcpy(copy, buf.data() + written, n);
+        copy += n;
+        written = 0;
+      }
+      len = copy - (uint8_t*)req->data;
 
       switch (status)
       {
@@ -350,6 +486,7 @@ namespace asynchost
 
         case CONNECTED:
         {
+          count_write(len);
           return send_write(req, len);
         }
 
@@ -429,6 +566,32 @@ namespace asynchost
       return true;
     }
 
+    // Write requests are allocated together with their data, which follows
+    // the request in the same allocation
+    static constexpr std::align_val_t write_alignment{alignof(uv_write_t)};
+
+    uv_write_t* make_write(size_t len)
+    {
+      if (stats != nullptr)
+      {
+        stats->write_allocations++;
+      }
+
+      auto mem = ::operator new(sizeof(uv_write_t) + len, write_alignment);
+      auto req = new (mem) uv_write_t{};
+      req->data = static_cast<uint8_t*>(mem) + sizeof(uv_write_t);
+      return req;
+    }
+
+    void count_write(size_t len)
+    {
+      if (stats != nullptr)
+      {
+        stats->writes++;
+        stats->bytes_written += len;
+      }
+    }
+
     bool send_write(uv_write_t* req, size_t len)
     {
       char* copy = (char*)req->data;
@@ -669,6 +832,7 @@ namespace asynchost
       }
 
       peer->assert_status(FRESH, CONNECTED);
+      peer->set_stats(stats);
 
       if (!peer->read_start())
         return;
@@ -712,6 +876,7 @@ namespace asynchost
 
         for (auto& w : pending_writes)
         {
+          count_write(w.len);
           send_write(w.req, w.len);
           w.req = nullptr;
         }
@@ -761,13 +926,30 @@ namespace asynchost
           remaining_read_quota);
       }
 
-      buf->base = new char[alloc_size];
+      if (alloc_size == 0)
+      {
+        // Reported to on_read as UV_ENOBUFS
+        buf->base = nullptr;
+        buf->len = 0;
+        return;
+      }
+
+      const auto [base, allocated] = read_buffers.get();
+      if (allocated && stats != nullptr)
+      {
+        stats->read_allocations++;
+      }
+
+      buf->base = base;
       buf->len = alloc_size;
     }
 
     void on_free(const uv_buf_t* buf)
     {
-      delete[] buf->base;
+      if (buf->base != nullptr)
+      {
+        read_buffers.put(buf->base);
+      }
     }
 
     static void on_read(uv_stream_t* handle, ssize_t sz, const uv_buf_t* buf)
@@ -805,6 +987,12 @@ namespace asynchost
         return;
       }
 
+      if (stats != nullptr)
+      {
+        stats->reads++;
+        stats->bytes_read += sz;
+      }
+
       uint8_t* p = (uint8_t*)buf->base;
       const bool read_good = behaviour->on_read((size_t)sz, p, {});
 
@@ -832,9 +1020,9 @@ namespace asynchost
         return;
       }
 
-      char* copy = (char*)req->data;
-      delete[] copy;
-      delete req;
+      // The data was allocated with the request, by make_write
+      req->~uv_write_t();
+      ::operator delete(req, write_alignment);
     }
 
     static void on_reconnect(uv_handle_t* handle)
@@ -846,7 +846,15 @@ TEST_CASE("Limit number of open files")
   size_t chunk_threshold = 30;
   size_t chunk_count = 5;
   size_t max_read_cache_size = 2;
-  Ledger ledger(ledger_dir, wf, chunk_threshold, max_read_cache_size);
+  // Disable entry cache so that all reads are served from ledger files
+  size_t entry_cache_max_size = 0;
+  Ledger ledger(
+    ledger_dir,
+    wf,
+    chunk_threshold,
+    max_read_cache_size,
+    {},
+    entry_cache_max_size);
   TestEntrySubmitter entry_submitter(ledger);
 
   size_t initial_number_fd = number_open_fd();
@@ -1144,6 +1152,7 @@ TEST_CASE("Recovery resilience")
   {
     // Create new uncommitted ledger chunk
     entry_submitter.write(true);
+    ledger.flush();
     REQUIRE(number_of_files_in_ledger_dir() == 2);
 
     for (auto const& f : fs::directory_iterator(ledger_dir))
@@ -1166,6 +1175,7 @@ TEST_CASE("Recovery resilience")
     // Create new uncommitted ledger chunk with two entries
     entry_submitter.write(true);
     entry_submitter.write(true);
+    ledger.flush();
     size_t last_idx = entry_submitter.get_last_idx();
 
     REQUIRE(number_of_files_in_ledger_dir() == 2);
@@ -1202,8 +1212,9 @@ TEST_CASE("Delete committed file from main directory")
   size_t chunk_threshold = 30;
   size_t chunk_count = 5;
 
-  // Worst-case scenario: do not keep any committed file in cache
+  // Worst-case scenario: do not keep any committed file or entry in cache
   size_t max_read_cache_size = 0;
+  size_t entry_cache_max_size = 0;
 
   size_t last_idx = 0;
   size_t last_committed_idx = 0;
@@ -1216,7 +1227,8 @@ TEST_CASE("Delete committed file from main directory")
     wf,
     chunk_threshold,
     max_read_cache_size,
-    {ledger_dir_read_only});
+    {ledger_dir_read_only},
+    entry_cache_max_size);
   TestEntrySubmitter entry_submitter(ledger);
 
   INFO("Write many entries on ledger");
@@ -1295,6 +1307,25 @@ TEST_CASE("Snapshot file name" * doctest::test_suite("snapshot"))
         get_snapshot_evidence_idx_from_file_name(snap_committed) ==
         evidence_idx);
     }
+
+    INFO("Get base idx of delta snapshot");
+    {
+      size_t base_idx = snapshot_idx / 2;
+      auto delta = fmt::format("{}.delta_{}", snap, base_idx);
+      auto delta_committed = fmt::format("{}.committed", delta);
+      REQUIRE_FALSE(get_snapshot_base_idx_from_file_name(snap).has_value());
+      REQUIRE_FALSE(
+        get_snapshot_base_idx_from_file_name(snap_committed).has_value());
+      REQUIRE(get_snapshot_base_idx_from_file_name(delta) == base_idx);
+      REQUIRE(
+        get_snapshot_base_idx_from_file_name(delta_committed) == base_idx);
+      REQUIRE(get_snapshot_idx_from_file_name(delta_committed) == snapshot_idx);
+      REQUIRE(
+        get_snapshot_evidence_idx_from_file_name(delta_committed) ==
+        evidence_idx);
+      REQUIRE(is_snapshot_file_committed(delta_committed));
+      REQUIRE_FALSE(is_snapshot_file_committed(delta));
+    }
   }
 }
 
@@ -1310,6 +1341,18 @@ TEST_CASE("Generate and commit snapshots" * doctest::test_suite("snapshot"))
   size_t snapshot_count = 5;
   size_t last_snapshot_idx = 0;
 
+  auto count_snapshot_files = [](bool committed) {
+    size_t count = 0;
+    for (auto const& f : fs::directory_iterator(snapshot_dir))
+    {
+      if (is_snapshot_file_committed(f.path().filename()) == committed)
+      {
+        count++;
+      }
+    }
+    return count;
+  };
+
   INFO("Generate snapshots");
   {
     for (size_t i = 1; i < snapshot_interval * snapshot_count;
@@ -1317,6 +1360,12 @@ TEST_CASE("Generate and commit snapshots" * doctest::test_suite("snapshot"))
     {
       // Note: Evidence is assumed to be at snapshot idx + 1
       snapshots.add_pending_snapshot(i, i + 1, dummy_snapshot.size());
+
+      // Snapshot is streamed in chunks
+      const auto half = dummy_snapshot.size() / 2;
+      snapshots.write_snapshot_chunk(i, dummy_snapshot.data(), half);
+      snapshots.write_snapshot_chunk(
+        i, dummy_snapshot.data() + half, dummy_snapshot.size() - half);
     }
 
     REQUIRE_FALSE(snapshots.find_latest_committed_snapshot().has_value());
@@ -1361,6 +1410,8 @@ TEST_CASE("Generate and commit snapshots" * doctest::test_suite("snapshot"))
     size_t new_snapshot_idx = last_snapshot_idx + 1;
     snapshots.add_pending_snapshot(
       new_snapshot_idx, new_snapshot_idx + 1, dummy_snapshot.size());
+    snapshots.write_snapshot_chunk(
+      new_snapshot_idx, dummy_snapshot.data(), dummy_snapshot.size());
     snapshots.commit_snapshot(
       new_snapshot_idx, dummy_receipt.data(), dummy_receipt.size());
 
@@ -1368,6 +1419,176 @@ TEST_CASE("Generate and commit snapshots" * doctest::test_suite("snapshot"))
     REQUIRE(latest_committed_snapshot.has_value());
     const auto& snapshot = latest_committed_snapshot->second;
     REQUIRE(get_snapshot_idx_from_file_name(snapshot) == new_snapshot_idx);
+    REQUIRE(
+      fs::file_size(latest_committed_snapshot->first / snapshot) ==
+      dummy_snapshot.size() + dummy_receipt.size());
+    last_snapshot_idx = new_snapshot_idx;
+  }
+
+  INFO("Incomplete snapshot is not committed");
+  {
+    size_t new_snapshot_idx = last_snapshot_idx + 1;
+    snapshots.add_pending_snapshot(
+      new_snapshot_idx, new_snapshot_idx + 1, dummy_snapshot.size());
+    snapshots.write_snapshot_chunk(
+      new_snapshot_idx, dummy_snapshot.data(), dummy_snapshot.size() / 2);
+    snapshots.commit_snapshot(
+      new_snapshot_idx, dummy_receipt.data(), dummy_receipt.size());
+
+    auto latest_committed_snapshot = snapshots.find_latest_committed_snapshot();
+    REQUIRE(latest_committed_snapshot.has_value());
+    REQUIRE(
+      get_snapshot_idx_from_file_name(latest_committed_snapshot->second) ==
+      last_snapshot_idx);
+  }
+
+  INFO("Snapshots superseded by a committed snapshot are removed");
+  {
+    const auto half = dummy_snapshot.size() / 2;
+    size_t abandoned_snapshot_idx = last_snapshot_idx + 1;
+    snapshots.add_pending_snapshot(
+      abandoned_snapshot_idx,
+      abandoned_snapshot_idx + 1,
+      dummy_snapshot.size());
+    snapshots.write_snapshot_chunk(
+      abandoned_snapshot_idx, dummy_snapshot.data(), half);
+    REQUIRE(count_snapshot_files(false) == 1);
+
+    size_t new_snapshot_idx = abandoned_snapshot_idx + 1;
+    snapshots.add_pending_snapshot(
+      new_snapshot_idx, new_snapshot_idx + 1, dummy_snapshot.size());
+    snapshots.write_snapshot_chunk(
+      new_snapshot_idx, dummy_snapshot.data(), dummy_snapshot.size());
+    REQUIRE(count_snapshot_files(false) == 2);
+    snapshots.commit_snapshot(
+      new_snapshot_idx, dummy_receipt.data(), dummy_receipt.size());
+    REQUIRE(count_snapshot_files(false) == 0);
+
+    // Late messages for the superseded snapshot are ignored
+    snapshots.write_snapshot_chunk(
+      abandoned_snapshot_idx,
+      dummy_snapshot.data() + half,
+      dummy_snapshot.size() - half);
+    snapshots.commit_snapshot(
+      abandoned_snapshot_idx, dummy_receipt.data(), dummy_receipt.size());
+    snapshots.add_pending_snapshot(
+      abandoned_snapshot_idx,
+      abandoned_snapshot_idx + 1,
+      dummy_snapshot.size());
+    REQUIRE(count_snapshot_files(false) == 0);
+
+    auto latest_committed_snapshot = snapshots.find_latest_committed_snapshot();
+    REQUIRE(latest_committed_snapshot.has_value());
+    REQUIRE(
+      get_snapshot_idx_from_file_name(latest_committed_snapshot->second) ==
+      new_snapshot_idx);
+    last_snapshot_idx = new_snapshot_idx;
+  }
+
+  INFO("Non-committed snapshots are removed on startup");
+  {
+    size_t new_snapshot_idx = last_snapshot_idx + 1;
+    snapshots.add_pending_snapshot(
+      new_snapshot_idx, new_snapshot_idx + 1, dummy_snapshot.size());
+    snapshots.write_snapshot_chunk(
+      new_snapshot_idx, dummy_snapshot.data(), dummy_snapshot.size() / 2);
+
+    REQUIRE(count_snapshot_files(false) == 1);
+    const auto committed_count = count_snapshot_files(true);
+
+    SnapshotManager restarted_snapshots(snapshot_dir, wf);
+    REQUIRE(count_snapshot_files(false) == 0);
+    REQUIRE(count_snapshot_files(true) == committed_count);
+  }
+}
+
+TEST_CASE("Find chain of delta snapshots" * doctest::test_suite("snapshot"))
+{
+  auto snap_dir = AutoDeleteFolder(snapshot_dir);
+  auto snap_ro_dir = AutoDeleteFolder(snapshot_dir_read_only);
+  fs::create_directory(snapshot_dir_read_only);
+
+  SnapshotManager snapshots(snapshot_dir, wf, snapshot_dir_read_only);
+
+  auto commit_snapshot = [&snapshots](size_t idx, size_t base_idx) {
+    snapshots.add_pending_snapshot(
+      idx, idx + 1, dummy_snapshot.size(), base_idx);
+    snapshots.write_snapshot_chunk(
+      idx, dummy_snapshot.data(), dummy_snapshot.size());
+    snapshots.commit_snapshot(idx, dummy_receipt.data(), dummy_receipt.size());
+  };
+
+  auto chain_idxs = [&snapshots]() {
+    std::vector<size_t> idxs;
+    for (const auto& path : snapshots.find_latest_committed_snapshot_chain())
+    {
+      REQUIRE(
+        fs::file_size(path) == dummy_snapshot.size() + dummy_receipt.size());
+      idxs.push_back(get_snapshot_idx_from_file_name(path.filename()));
+    }
+    return idxs;
+  };
+
+  INFO("Full snapshot");
+  {
+    REQUIRE(chain_idxs().empty());
+    commit_snapshot(10, 0);
+    REQUIRE(chain_idxs() == std::vector<size_t>{10});
+    REQUIRE(fs::exists(fs::path(snapshot_dir) / "snapshot_10_11.committed"));
+  }
+
+  INFO("Delta snapshots are returned after their base");
+  {
+    commit_snapshot(20, 10);
+    REQUIRE(fs::exists(
+      fs::path(snapshot_dir) / "snapshot_20_21.delta_10.committed"));
+    commit_snapshot(30, 20);
+    REQUIRE(chain_idxs() == std::vector<size_t>{10, 20, 30});
+
+    auto latest_committed_snapshot = snapshots.find_latest_committed_snapshot();
+    REQUIRE(latest_committed_snapshot.has_value());
+    REQUIRE(
+      get_snapshot_idx_from_file_name(latest_committed_snapshot->second) ==
+      30);
+  }
+
+  INFO("Chain can span main and read-only directories");
+  {
+    fs::rename(
+      fs::path(snapshot_dir) / "snapshot_10_11.committed",
+      fs::path(snapshot_dir_read_only) / "snapshot_10_11.committed");
+    REQUIRE(chain_idxs() == std::vector<size_t>{10, 20, 30});
+  }
+
+  INFO("New full snapshot starts a new chain");
+  {
+    commit_snapshot(40, 0);
+    REQUIRE(chain_idxs() == std::vector<size_t>{40});
+    commit_snapshot(50, 40);
+    REQUIRE(chain_idxs() == std::vector<size_t>{40, 50});
+  }
+
+  INFO("Delta snapshots with a missing base are skipped");
+  {
+    fs::remove(fs::path(snapshot_dir) / "snapshot_40_41.committed");
+    REQUIRE(chain_idxs() == std::vector<size_t>{10, 20, 30});
+
+    fs::remove(fs::path(snapshot_dir) / "snapshot_20_21.delta_10.committed");
+    REQUIRE(chain_idxs() == std::vector<size_t>{10});
+  }
+
+  INFO("Delta snapshots cannot be chained to a later snapshot");
+  {
+    std::ofstream(
+      fs::path(snapshot_dir) / "snapshot_60_61.delta_60.committed")
+      .close();
+    std::ofstream(
+      fs::path(snapshot_dir) / "snapshot_70_71.delta_80.committed")
+      .close();
+    std::ofstream(
+      fs::path(snapshot_dir) / "snapshot_80_81.delta_70.committed")
+      .close();
+    REQUIRE(chain_idxs() == std::vector<size_t>{10});
   }
 }
 
@@ -1724,6 +1945,121 @@ TEST_CASE("Ledger init with existing files")
   }
 }
 
+TEST_CASE("Entry cache")
+{
+  auto dir = AutoDeleteFolder(ledger_dir);
+
+  size_t chunk_threshold = 30;
+  const auto entry_size =
+    ccf::kv::serialised_entry_header_size + sizeof(TestLedgerEntry);
+  size_t entries_in_cache = 4;
+  Ledger ledger(
+    ledger_dir,
+    wf,
+    chunk_threshold,
+    ledger_max_read_cache_files_default,
+    {},
+    entries_in_cache * entry_size);
+  TestEntrySubmitter entry_submitter(ledger);
+
+  size_t chunk_count = 3;
+  initialise_ledger(entry_submitter, chunk_threshold, chunk_count);
+  auto last_idx = entry_submitter.get_last_idx();
+  REQUIRE(last_idx > entries_in_cache);
+
+  auto stats = ledger.get_entry_cache_stats();
+  REQUIRE(stats.entries == entries_in_cache);
+  REQUIRE(stats.size == entries_in_cache * entry_size);
+
+  INFO("Recent entries are read from cache");
+  {
+    read_entries_range_from_ledger(
+      ledger, last_idx - entries_in_cache + 1, last_idx);
+    read_entries_range_from_ledger(ledger, last_idx, last_idx);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 0);
+  }
+
+  INFO("Cached reads honour max size");
+  {
+    REQUIRE(
+      read_entries_range_from_ledger(
+        ledger, last_idx - 1, last_idx, entry_size) == last_idx - 1);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.hits == 3);
+  }
+
+  INFO("Lagging reads fall back to ledger files");
+  {
+    read_entries_range_from_ledger(ledger, 1, last_idx);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 1);
+  }
+
+  INFO("Truncation evicts truncated entries");
+  {
+    entry_submitter.truncate(last_idx - 1);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.entries == entries_in_cache - 1);
+    REQUIRE(!ledger.read_entries(last_idx, last_idx).has_value());
+
+    entry_submitter.write(true);
+    read_entries_range_from_ledger(
+      ledger, last_idx - entries_in_cache + 1, last_idx);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.entries == entries_in_cache);
+  }
+
+  INFO("Cache is cleared on init");
+  {
+    ledger.init(last_idx);
+    stats = ledger.get_entry_cache_stats();
+    REQUIRE(stats.entries == 0);
+    REQUIRE(stats.size == 0);
+  }
+}
+
+TEST_CASE("Batched flush")
+{
+  auto dir = AutoDeleteFolder(ledger_dir);
+
+  size_t chunk_threshold = 30;
+  Ledger ledger(ledger_dir, wf, chunk_threshold);
+  TestEntrySubmitter entry_submitter(ledger);
+
+  auto ledger_dir_size = []() {
+    size_t size = 0;
+    for (const auto& f : fs::directory_iterator(ledger_dir))
+    {
+      size += fs::file_size(f.path());
+    }
+    return size;
+  };
+
+  INFO("Non-committable entries are written on flush");
+  {
+    entry_submitter.write(true);
+    const auto size_before = ledger_dir_size();
+    entry_submitter.write(false);
+    REQUIRE(ledger_dir_size() == size_before);
+    ledger.flush();
+    REQUIRE(ledger_dir_size() > size_before);
+  }
+
+  INFO("Committable entries are written without waiting for a flush");
+  {
+    entry_submitter.write(false);
+    const auto size_before = ledger_dir_size();
+    entry_submitter.write(true);
+    const auto size_after = ledger_dir_size();
+    REQUIRE(size_after > size_before);
+    ledger.flush();
+    REQUIRE(ledger_dir_size() == size_after);
+  }
+}
+
 int main(int argc, char** argv)
 {
   ccf::logger::config::default_init();
@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+#include "host/ledger.h"
+
+#include "ds/ring_buffer.h"
+#include "kv/serialised_entry_format.h"
+
+#include <algorithm>
+#include <picobench/picobench.hpp>
+
+using namespace asynchost;
+
+std::chrono::microseconds asynchost::TimeBoundLogger::default_max_time(
+  1'000'000);
+
+static constexpr auto ledger_dir = "ledger_bench_dir";
+static constexpr size_t chunk_threshold = 5 * 1024 * 1024;
+
+constexpr auto buffer_size = 1 << 16;
+auto in_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+auto out_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+ringbuffer::Circuit eio(in_buffer->bd, out_buffer->bd);
+auto wf = ringbuffer::WriterFactory(eio);
+
+// Per-entry write latencies (time until the entry's batch has been written to
+// the ledger file), per benchmark, to report tail latency
+std::map<std::string, std::vector<std::chrono::nanoseconds>> latencies;
+
+std::vector<uint8_t> make_entry(size_t size)
+{
+  std::vector<uint8_t> entry(ccf::kv::serialised_entry_header_size + size, 42);
+  auto data = entry.data();
+  auto remaining = entry.size();
+  ccf::kv::SerialisedEntryHeader header;
+  header.set_size(size);
+  serialized::write(data, remaining, header);
+  return entry;
+}
+
+void drain_ringbuffer()
+{
+  eio.read_from_outside().read(-1, [](auto, auto, auto) {});
+}
+
+// Writes s.iterations() entries, calling flush() after every entry. This
+// matches the previous behaviour of flushing each committable entry as soon as
+// it is written.
+template <size_t EntrySize>
+static void per_entry_flush(picobench::state& s)
+{
+  fs::remove_all(ledger_dir);
+  const auto entry = make_entry(EntrySize);
+  auto& lat = latencies[fmt::format("per_entry_flush<{}>", EntrySize)];
+  {
+    Ledger ledger(ledger_dir, wf, chunk_threshold);
+
+    s.start_timer();
+    for (auto _ : s)
+    {
+      (void)_;
+      auto start = std::chrono::high_resolution_clock::now();
+      ledger.write_entry(entry.data(), entry.size(), true);
+      ledger.flush();
+      lat.push_back(std::chrono::high_resolution_clock::now() - start);
+    }
+    s.stop_timer();
+  }
+  fs::remove_all(ledger_dir);
+}
+
+// Writes s.iterations() entries in batches of BatchSize, of which only the
+// last is committable (as for a batch of transactions followed by a
+// signature), so that each batch is flushed once.
+template <size_t EntrySize, size_t BatchSize>
+static void batched(picobench::state& s)
+{
+  fs::remove_all(ledger_dir);
+  const auto entry = make_entry(EntrySize);
+  auto& lat =
+    latencies[fmt::format("batched_flush<{}, {}>", EntrySize, BatchSize)];
+  {
+    Ledger ledger(ledger_dir, wf, chunk_threshold);
+
+    s.start_timer();
+    size_t written = 0;
+    while (written < s.iterations())
+    {
+      auto batch = std::min(BatchSize, s.iterations() - written);
+      auto start = std::chrono::high_resolution_clock::now();
+      for (size_t i = 0; i < batch; ++i)
+      {
+        ledger.write_entry(entry.data(), entry.size(), i == batch - 1);
+      }
+      ledger.flush();
+      // Latency of an entry is the time until its whole batch is written
+      auto elapsed = std::chrono::high_resolution_clock::now() - start;
+      for (size_t i = 0; i < batch; ++i)
+      {
+        lat.push_back(elapsed);
+      }
+      written += batch;
+    }
+    s.stop_timer();
+  }
+  fs::remove_all(ledger_dir);
+  drain_ringbuffer();
+}
+
+const std::vector<int> entry_counts = {1000, 10000};
+
+PICOBENCH_SUITE("ledger write 256B");
+auto per_entry_256 = per_entry_flush<256>;
+PICOBENCH(per_entry_256).iterations(entry_counts).samples(10).baseline();
+auto batched_256_10 = batched<256, 10>;
+PICOBENCH(batched_256_10).iterations(entry_counts).samples(10);
+auto batched_256_100 = batched<256, 100>;
+PICOBENCH(batched_256_100).iterations(entry_counts).samples(10);
+
+PICOBENCH_SUITE("ledger write 4KB");
+auto per_entry_4k = per_entry_flush<4096>;
+PICOBENCH(per_entry_4k).iterations(entry_counts).samples(10).baseline();
+auto batched_4k_10 = batched<4096, 10>;
+PICOBENCH(batched_4k_10).iterations(entry_counts).samples(10);
+auto batched_4k_100 = batched<4096, 100>;
+PICOBENCH(batched_4k_100).iterations(entry_counts).samples(10);
+
+int main(int argc, char** argv)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  auto ret = runner.run();
+
+  std::cout << "Per-entry write latency" << std::endl;
+  for (auto& [name, lat] : latencies)
+  {
+    if (lat.empty())
+    {
+      continue;
+    }
+    std::sort(lat.begin(), lat.end());
+    const auto p50 = lat[lat.size() / 2];
+    const auto p99 = lat[lat.size() * 99 / 100];
+    std::cout << fmt::format(
+                   "  {}: p50 {}ns, p99 {}ns", name, p50.count(), p99.count())
+              << std::endl;
+  }
+  return ret;
+}
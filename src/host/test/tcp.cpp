@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#include "host/tcp.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <doctest/doctest.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+size_t asynchost::TCPImpl::remaining_read_quota =
+  asynchost::TCPImpl::max_read_quota;
+bool asynchost::TCPImpl::alloc_quota_logged = false;
+asynchost::ReadBufferPool asynchost::TCPImpl::read_buffers(
+  asynchost::TCPImpl::max_read_size,
+  asynchost::TCPImpl::max_read_quota / asynchost::TCPImpl::max_read_size);
+
+class AcceptBehaviour : public asynchost::SocketBehaviour<asynchost::TCP>
+{
+  asynchost::TCP& accepted;
+
+public:
+  AcceptBehaviour(asynchost::TCP& accepted_) :
+    asynchost::SocketBehaviour<asynchost::TCP>("Test", "test"),
+    accepted(accepted_)
+  {}
+
+  void on_accept(asynchost::TCP& peer) override
+  {
+    peer->set_behaviour(
+      std::make_unique<asynchost::SocketBehaviour<asynchost::TCP>>(
+        "Test peer", "test"));
+    accepted = peer;
+  }
+};
+
+// Returns the file descriptor of the socket (in this process) connected to
+// the given local address of another socket
+static int find_peer_fd(const sockaddr_in& addr)
+{
+  for (int fd = 0; fd < 1024; ++fd)
+  {
+    sockaddr_in peer = {};
+    socklen_t len = sizeof(peer);
+    if (
+      getpeername(fd, (sockaddr*)&peer, &len) == 0 &&
+      peer.sin_family == AF_INET && peer.sin_port == addr.sin_port &&
+      peer.sin_addr.s_addr == addr.sin_addr.s_addr)
+    {
+      return fd;
+    }
+  }
+  return -1;
+}
+
+static std::vector<uint8_t> make_pattern(size_t size, uint8_t seed)
+{
+  std::vector<uint8_t> v(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    v[i] = static_cast<uint8_t>(seed + i * 7 + i / 251);
+  }
+  return v;
+}
+
+TEST_CASE("Partial writes of several buffers" * doctest::test_suite("tcp"))
+{
+  auto loop = uv_default_loop();
+
+  asynchost::TCP peer = nullptr;
+  auto stats = std::make_shared<asynchost::TCPTrafficStats>();
+  {
+    asynchost::TCP server;
+    server->set_stats(stats);
+    server->set_behaviour(std::make_unique<AcceptBehaviour>(peer));
+    REQUIRE(server->listen("127.0.0.1", "0"));
+
+    // The client never reads until all writes have been issued, and its
+    // receive buffer (as well as the peer's send buffer) is tiny, so that
+    // the socket only accepts part of each write
+    const int client = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    const int small_buffer = 4096;
+    setsockopt(
+      client, SOL_SOCKET, SO_RCVBUF, &small_buffer, sizeof(small_buffer));
+
+    sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(std::stoi(server->get_port()));
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    REQUIRE(
+      connect(client, (sockaddr*)&server_addr, sizeof(server_addr)) == 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::seconds(30);
+    while (peer.is_null() &&
+           std::chrono::steady_clock::now() - start < timeout)
+    {
+      uv_run(loop, UV_RUN_NOWAIT);
+    }
+    REQUIRE_FALSE(peer.is_null());
+
+    sockaddr_in client_addr = {};
+    socklen_t client_addr_len = sizeof(client_addr);
+    getsockname(client, (sockaddr*)&client_addr, &client_addr_len);
+    const auto peer_fd = find_peer_fd(client_addr);
+    REQUIRE(peer_fd >= 0);
+    setsockopt(
+      peer_fd, SOL_SOCKET, SO_SNDBUF, &small_buffer, sizeof(small_buffer));
+
+    const auto a = make_pattern(100'000, 1);
+    const auto b = make_pattern(1, 2);
+    const auto c = make_pattern(300'000, 3);
+    const auto d = make_pattern(200'000, 4);
+    const auto e = make_pattern(10, 5);
+
+    std::vector<uint8_t> expected;
+    for (const auto& buf : {a, b, c, d, e})
+    {
+      expected.insert(expected.end(), buf.begin(), buf.end());
+    }
+
+    INFO("Writes are only partially accepted by the socket");
+    {
+      // The first write is partial, and the following ones are queued
+      // behind its remainder
+      REQUIRE(peer->writev({a, b, {}, c}));
+      REQUIRE(stats->write_allocations == 1);
+      REQUIRE(peer->writev({d}));
+      REQUIRE(peer->write(e.size(), e.data()));
+      REQUIRE(stats->write_allocations == 3);
+      REQUIRE(stats->bytes_written == expected.size());
+    }
+
+    INFO("Byte stream is received in order");
+    {
+      fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+      std::vector<uint8_t> received;
+      std::vector<uint8_t> chunk(16384);
+      while (received.size() < expected.size() &&
+             std::chrono::steady_clock::now() - start < timeout)
+      {
+        uv_run(loop, UV_RUN_NOWAIT);
+        const auto n = read(client, chunk.data(), chunk.size());
+        if (n > 0)
+        {
+          received.insert(received.end(), chunk.begin(), chunk.begin() + n);
+        }
+      }
+      REQUIRE(received.size() == expected.size());
+      REQUIRE(received == expected);
+    }
+
+    close(client);
+    peer = nullptr;
+  }
+
+  // Let the sockets close
+  uv_run(loop, UV_RUN_NOWAIT);
+}
@@ -178,9 +178,71 @@ namespace http
     return u;
   }
 
+  // A token (URL, header field or header value) received in one or more
+  // pieces. While it arrives in one piece, as it usually does, it is a view
+  // into the buffer being parsed. Otherwise it is accumulated in a buffer
+  // owned by the parser, which retains its capacity across messages.
+  class ParsedToken
+  {
+  private:
+    std::string_view view = {};
+    std::string buffer;
+    bool buffered = false;
+
+  public:
+    void append(const char* at, size_t length)
+    {
+      if (!buffered && view.empty())
+      {
+        view = {at, length};
+        return;
+      }
+
+      detach();
+      buffer.append(at, length);
+      view = buffer;
+    }
+
+    // Must be called before the buffer being parsed is released, if the
+    // token may be appended to or read later
+    void detach()
+    {
+      if (!buffered)
+      {
+        buffer.assign(view);
+        buffered = true;
+        view = buffer;
+      }
+    }
+
+    void clear()
+    {
+      view = {};
+      buffer.clear();
+      buffered = false;
+    }
+
+    bool empty() const
+    {
+      return view.empty();
+    }
+
+    size_t size() const
+    {
+      return view.size();
+    }
+
+    std::string_view get() const
+    {
+      return view;
+    }
+  };
+
   class Parser
   {
   protected:
+    static constexpr size_t max_body_reservation = 64 * 1024;
+
     llhttp_t parser;
     llhttp_settings_t settings;
     ccf::http::ParserConfiguration configuration;
@@ -189,13 +251,25 @@ namespace http
     std::vector<uint8_t> body_buf;
     ccf::http::HeaderMap headers;
 
-    std::pair<std::string, std::string> partial_parsed_header = {};
+    ParsedToken partial_header_key;
+    ParsedToken partial_header_value;
 
     void complete_header()
     {
-      headers.emplace(partial_parsed_header);
-      partial_parsed_header.first.clear();
-      partial_parsed_header.second.clear();
+      // HTTP headers are stored lowercase as it is easier to verify HTTP
+      // signatures later on
+      std::string key(partial_header_key.get());
+      ccf::nonstd::to_lower(key);
+      headers.emplace(std::move(key), partial_header_value.get());
+      partial_header_key.clear();
+      partial_header_value.clear();
+    }
+
+    // Called once the buffer being parsed is about to be released
+    virtual void detach_tokens()
+    {
+      partial_header_key.detach();
+      partial_header_value.detach();
     }
 
     Parser(
@@ -223,6 +297,11 @@ namespace http
       const auto data_char = (const char*)data;
       auto err_no = llhttp_execute(&parser, data_char, size);
 
+      if (state == IN_MESSAGE)
+      {
+        detach_tokens();
+      }
+
       if (err_no == HPE_PAUSED_UPGRADE)
       {
         // Assume Upgrade requests will be handled by caller inspecting headers,
@@ -244,16 +323,17 @@ namespace http
       if (state == IN_MESSAGE)
       {
         LOG_TRACE_FMT("Appending chunk [{} bytes]", length);
-        std::copy(at, at + length, std::back_inserter(body_buf));
 
         auto const& max_body_size = configuration.max_body_size.value_or(
           ccf::http::default_max_body_size);
-        if (body_buf.size() > max_body_size)
+        if (body_buf.size() + length > max_body_size)
         {
           throw RequestPayloadTooLargeException(fmt::format(
             "HTTP request body is too large (max size allowed: {})",
             max_body_size));
         }
+
+        body_buf.insert(body_buf.end(), at, at + length);
       }
       else
       {
@@ -269,6 +349,8 @@ namespace http
         state = IN_MESSAGE;
         body_buf.clear();
         headers.clear();
+        partial_header_key.clear();
+        partial_header_value.clear();
       }
       else
       {
@@ -295,7 +377,7 @@ namespace http
 
     void header_field(const char* at, size_t length)
     {
-      if (!partial_parsed_header.second.empty())
+      if (!partial_header_value.empty())
       {
         complete_header();
       }
@@ -308,12 +390,7 @@ namespace http
           "Too many headers (max number allowed: {})", max_headers_count));
       }
 
-      // HTTP headers are stored lowercase as it is easier to verify HTTP
-      // signatures later on
-      auto f = std::string(at, length);
-      ccf::nonstd::to_lower(f);
-      auto& partial_header_key = partial_parsed_header.first;
-      partial_header_key.append(f);
+      partial_header_key.append(at, length);
 
       auto const& max_header_size = configuration.max_header_size.value_or(
         ccf::http::default_max_header_size);
@@ -321,14 +398,13 @@ namespace http
       {
         throw RequestHeaderTooLargeException(fmt::format(
           "Header key for '{}' is too large (max size allowed: {})",
-          partial_parsed_header.first,
+          partial_header_key.get(),
           max_header_size));
       }
     }
 
     void header_value(const char* at, size_t length)
     {
-      auto& partial_header_value = partial_parsed_header.second;
       partial_header_value.append(at, length);
       auto const& max_header_size = configuration.max_header_size.value_or(
         ccf::http::default_max_header_size);
@@ -336,7 +412,7 @@ namespace http
       {
         throw RequestHeaderTooLargeException(fmt::format(
           "Header value for '{}' is too large (max size allowed: {})",
-          partial_parsed_header.first,
+          partial_header_key.get(),
           max_header_size));
       }
     }
@@ -344,6 +420,14 @@ namespace http
     void headers_complete()
     {
       complete_header();
+
+      // Allocate the body once if its size is known, up to a bound so that
+      // a declared length alone cannot reserve large amounts of memory
+      if (parser.flags & F_CONTENT_LENGTH)
+      {
+        body_buf.reserve(
+          std::min<uint64_t>(parser.content_length, max_body_reservation));
+      }
     }
   };
 
@@ -395,7 +479,13 @@ namespace http
   private:
     RequestProcessor& proc;
 
-    std::string url = "";
+    ParsedToken url;
+
+    void detach_tokens() override
+    {
+      Parser::detach_tokens();
+      url.detach();
+    }
 
   public:
     RequestParser(
@@ -421,22 +511,11 @@ namespace http
 
     void handle_completed_message() override
     {
-      if (url.empty())
-      {
-        proc.handle_request(
-          llhttp_method(parser.method),
-          {},
-          std::move(headers),
-          std::move(body_buf));
-      }
-      else
-      {
-        proc.handle_request(
-          llhttp_method(parser.method),
-          url,
-          std::move(headers),
-          std::move(body_buf));
-      }
+      proc.handle_request(
+        llhttp_method(parser.method),
+        url.get(),
+        std::move(headers),
+        std::move(body_buf));
     }
   };
 
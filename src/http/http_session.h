@@ -32,6 +32,13 @@ namespace http
       session_id(session_id_)
     {}
 
+    // Returns false if the session should stop reading (and parsing) incoming
+    // data for now. Unread data remains buffered in the TLS session
+    virtual bool can_read()
+    {
+      return true;
+    }
+
   public:
     virtual bool parse(std::span<const uint8_t> data) = 0;
 
@@ -61,10 +68,9 @@ namespace http
         data.resize(min_read_block_size);
       }
 
-      auto n_read = tls_io->read(data.data(), data.size(), false);
-
-      while (true)
+      while (can_read())
       {
+        auto n_read = tls_io->read(data.data(), data.size(), false);
         if (n_read == 0)
         {
           return;
@@ -79,7 +85,6 @@ namespace http
         }
 
         // Used all provided bytes - check if more are available
-        n_read = tls_io->read(data.data(), data.size(), false);
       }
     }
   };
@@ -96,6 +101,30 @@ namespace http
     std::shared_ptr<ccf::SessionContext> session_ctx;
     ccf::ListenInterfaceID interface_id;
 
+    // In work stealing mode, the number of requests of this session queued or
+    // being processed on worker threads. Once it reaches
+    // max_in_flight_requests, reading from the session is paused (until a
+    // request completes), so that a single pipelining client cannot queue an
+    // unbounded number of requests
+    static constexpr size_t max_in_flight_requests = 32;
+    std::atomic<size_t> in_flight_requests = 0;
+    std::atomic<bool> reading_paused = false;
+
+    bool can_read() override
+    {
+      if (in_flight_requests.load() < max_in_flight_requests)
+      {
+        return true;
+      }
+
+      reading_paused.store(true);
+
+      // A request may have completed before reading was paused, in which case
+      // nothing would resume reading
+      return in_flight_requests.load() < max_in_flight_requests &&
+        reading_paused.exchange(false);
+    }
+
   public:
     HTTPServerSession(
       std::shared_ptr<ccf::RPCMap> rpc_map,
@@ -227,46 +256,107 @@ namespace http
           tls_io->close();
         }
 
-        std::shared_ptr<ccf::RpcHandler> search =
-          http::fetch_rpc_handler(rpc_ctx, rpc_map);
-
-        search->process(rpc_ctx);
-
-        if (rpc_ctx->response_is_pending)
+        auto& tm = ::threading::ThreadMessaging::instance();
+        if (tm.get_work_stealing())
         {
-          // If the RPC is pending, hold the connection.
-          LOG_TRACE_FMT("Pending");
+          // The request may be processed by any idle worker thread. Requests
+          // of this session are still processed one at a time, in order, and
+          // TLS state is only ever accessed from this session's thread (to
+          // which sending a response is dispatched).
+          auto msg = std::make_unique<::threading::Tmsg<ProcessRequestMsg>>(
+            &process_request_cb);
+          msg->data.self = std::static_pointer_cast<HTTPServerSession>(
+            this->shared_from_this());
+          msg->data.rpc_ctx = std::move(rpc_ctx);
+          ++in_flight_requests;
+          tm.add_stealable_task(
+            tm.get_execution_thread(session_id),
+            std::move(msg),
+            static_cast<uint64_t>(session_id));
           return;
         }
-        else
-        {
-          send_response(
-            rpc_ctx->get_response_http_status(),
-            rpc_ctx->get_response_headers(),
-            rpc_ctx->get_response_trailers(),
-            std::move(rpc_ctx->get_response_body()));
-
-          if (rpc_ctx->terminate_session)
-          {
-            tls_io->close();
-          }
-        }
+
+        process_request(rpc_ctx);
       }
       catch (const std::exception& e)
       {
-        send_odata_error_response(ccf::ErrorDetails{
-          HTTP_STATUS_INTERNAL_SERVER_ERROR,
-          ccf::errors::InternalError,
-          fmt::format("Exception: {}", e.what())});
-
-        // On any exception, close the connection.
-        LOG_FAIL_FMT("Closing connection");
-        LOG_DEBUG_FMT("Closing connection due to exception: {}", e.what());
-        tls_io->close();
+        send_exception_response(e);
         throw;
       }
     }
 
+  private:
+    struct ProcessRequestMsg
+    {
+      std::shared_ptr<HTTPServerSession> self;
+      std::shared_ptr<http::HttpRpcContext> rpc_ctx;
+    };
+
+    static void process_request_cb(
+      std::unique_ptr<::threading::Tmsg<ProcessRequestMsg>> msg)
+    {
+      auto& self = *msg->data.self;
+      try
+      {
+        self.process_request(msg->data.rpc_ctx);
+      }
+      catch (const std::exception& e)
+      {
+        // Not propagated, as this may run on any worker thread
+        self.send_exception_response(e);
+      }
+
+      if (
+        self.in_flight_requests.fetch_sub(1) <= max_in_flight_requests &&
+        self.reading_paused.exchange(false))
+      {
+        // Resume reading data buffered while paused, from the session's thread
+        self.resume_incoming_data();
+      }
+    }
+
+    void process_request(std::shared_ptr<http::HttpRpcContext>& rpc_ctx)
+    {
+      std::shared_ptr<ccf::RpcHandler> search =
+        http::fetch_rpc_handler(rpc_ctx, rpc_map);
+
+      search->process(rpc_ctx);
+
+      if (rpc_ctx->response_is_pending)
+      {
+        // If the RPC is pending, hold the connection.
+        LOG_TRACE_FMT("Pending");
+        return;
+      }
+      else
+      {
+        send_response(
+          rpc_ctx->get_response_http_status(),
+          rpc_ctx->get_response_headers(),
+          rpc_ctx->get_response_trailers(),
+          std::move(rpc_ctx->get_response_body()));
+
+        if (rpc_ctx->terminate_session)
+        {
+          tls_io->close();
+        }
+      }
+    }
+
+    void send_exception_response(const std::exception& e)
+    {
+      send_odata_error_response(ccf::ErrorDetails{
+        HTTP_STATUS_INTERNAL_SERVER_ERROR,
+        ccf::errors::InternalError,
+        fmt::format("Exception: {}", e.what())});
+
+      // On any exception, close the connection.
+      LOG_FAIL_FMT("Closing connection");
+      LOG_DEBUG_FMT("Closing connection due to exception: {}", e.what());
+      tls_io->close();
+    }
+
+  public:
     bool send_response(
       ccf::http_status status_code,
       ccf::http::HeaderMap&& headers,
@@ -286,7 +376,7 @@ namespace http
       response.set_body(body.data(), body.size());
 
       auto data = response.build_response();
-      tls_io->send_raw(data.data(), data.size());
+      tls_io->send_raw(std::move(data));
       return true;
     }
 
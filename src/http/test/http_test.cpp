@@ -166,6 +166,37 @@ DOCTEST_TEST_CASE("Partial body")
   DOCTEST_CHECK(m.body == r0);
 }
 
+DOCTEST_TEST_CASE("Request split at every offset")
+{
+  const auto r0 = s_to_v(request_0);
+  constexpr auto url = "/some/path?with=query";
+  auto builder = http::Request(url, HTTP_POST);
+  builder.set_header("X-Custom-Header", "custom user data");
+  builder.set_body(&r0);
+  const auto req = builder.build_request();
+
+  for (size_t split = 1; split < req.size(); ++split)
+  {
+    http::SimpleRequestProcessor sp;
+    http::RequestParser p(sp);
+
+    // The parser may only refer to each buffer while it is being parsed
+    std::vector<uint8_t> buf(req.begin(), req.begin() + split);
+    p.execute(buf.data(), buf.size());
+    std::fill(buf.begin(), buf.end(), 'X');
+    buf.assign(req.begin() + split, req.end());
+    p.execute(buf.data(), buf.size());
+    std::fill(buf.begin(), buf.end(), 'X');
+
+    DOCTEST_REQUIRE(sp.received.size() == 1);
+    const auto& m = sp.received.front();
+    DOCTEST_CHECK(m.method == HTTP_POST);
+    DOCTEST_CHECK(m.url == url);
+    DOCTEST_CHECK(m.headers.at("x-custom-header") == "custom user data");
+    DOCTEST_CHECK(m.body == r0);
+  }
+}
+
 DOCTEST_TEST_CASE("Multiple requests")
 {
   http::SimpleRequestProcessor sp;
@@ -4,10 +4,14 @@
 
 #include "ccf/ds/logger.h"
 #include "ccf/indexing/indexer_interface.h"
+#include "ds/thread_messaging.h"
 #include "indexing/transaction_fetcher_interface.h"
 #include "kv/kv_types.h"
 #include "kv/store.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -28,6 +32,110 @@ namespace ccf::indexing
 
     ccf::TxID committed = {};
 
+    // Copy of committed.seqno, read when describing the strategies from other
+    // threads
+    std::atomic<ccf::SeqNo> committed_seqno = 0;
+
+    // If set, each strategy is handed its batch of fetched transactions in a
+    // task on a worker thread, so that independent strategies are updated in
+    // parallel. While a strategy's batch is in progress, that strategy is
+    // neither ticked nor given further transactions.
+    bool dispatch_to_workers = false;
+    size_t next_worker = 0;
+
+    using BatchInProgress = std::shared_ptr<std::atomic<bool>>;
+    std::map<StrategyPtr, BatchInProgress> batches_in_progress;
+
+    using Stores = std::vector<ccf::kv::ReadOnlyStorePtr>;
+
+    struct BatchMsg
+    {
+      StrategyPtr strategy;
+      Stores stores;
+      BatchInProgress in_progress;
+
+      BatchMsg(
+        const StrategyPtr& strategy_,
+        Stores&& stores_,
+        const BatchInProgress& in_progress_) :
+        strategy(strategy_),
+        stores(std::move(stores_)),
+        in_progress(in_progress_)
+      {}
+    };
+
+    static void handle_batch(const StrategyPtr& strategy, const Stores& stores)
+    {
+      for (const auto& store : stores)
+      {
+        const ccf::TxID tx_id = store->get_txid();
+        const auto next_requested = strategy->next_requested();
+        if (next_requested.has_value() && (tx_id.seqno == *next_requested))
+        {
+          strategy->handle_committed_transaction(tx_id, store);
+        }
+      }
+    }
+
+    static void handle_batch_cb(
+      std::unique_ptr<::threading::Tmsg<BatchMsg>> msg)
+    {
+      try
+      {
+        handle_batch(msg->data.strategy, msg->data.stores);
+      }
+      catch (const std::exception& e)
+      {
+        LOG_FAIL_FMT(
+          "Error while indexing transactions for {}: {}",
+          msg->data.strategy->get_name(),
+          e.what());
+      }
+      msg->data.in_progress->store(false);
+    }
+
+    bool is_batch_in_progress(const StrategyPtr& strategy) const
+    {
+      const auto it = batches_in_progress.find(strategy);
+      return it != batches_in_progress.end() && it->second->load();
+    }
+
+    // Hands a strategy the suffix of the fetched stores which starts at the
+    // strategy's next requested transaction, if any
+    void dispatch_batch(
+      const StrategyPtr& strategy,
+      ccf::SeqNo next_requested,
+      const Stores& stores)
+    {
+      const auto it = std::find_if(
+        stores.begin(), stores.end(), [next_requested](const auto& store) {
+          return store->get_txid().seqno == next_requested;
+        });
+      if (it == stores.end())
+      {
+        return;
+      }
+
+      if (!dispatch_to_workers)
+      {
+        handle_batch(strategy, Stores(it, stores.end()));
+        return;
+      }
+
+      auto& in_progress = batches_in_progress[strategy];
+      if (in_progress == nullptr)
+      {
+        in_progress = std::make_shared<std::atomic<bool>>(false);
+      }
+      in_progress->store(true);
+
+      auto& tm = ::threading::ThreadMessaging::instance();
+      tm.add_stealable_task(
+        tm.get_execution_thread(next_worker++),
+        std::make_unique<::threading::Tmsg<BatchMsg>>(
+          &handle_batch_cb, strategy, Stores(it, stores.end()), in_progress));
+    }
+
     static bool tx_id_less(const ccf::TxID& a, const ccf::TxID& b)
     {
       // NB: This will return true for 2.10 < 4.5, which isn't necessarily
@@ -53,13 +161,39 @@ namespace ccf::indexing
       }
 
       committed = tx_id;
+      committed_seqno.store(tx_id.seqno);
     }
 
   public:
-    Indexer(const std::shared_ptr<TransactionFetcher>& tf) :
-      transaction_fetcher(tf)
+    Indexer(
+      const std::shared_ptr<TransactionFetcher>& tf,
+      bool dispatch_to_workers_ = false) :
+      transaction_fetcher(tf),
+      dispatch_to_workers(dispatch_to_workers_)
     {}
 
+    nlohmann::json describe() const override
+    {
+      auto j = IndexingStrategies::describe();
+
+      // Report, for each strategy, how many committed transactions it has yet
+      // to be given
+      const auto committed_ = committed_seqno.load();
+      size_t i = 0;
+      for (const auto& strategy : strategies)
+      {
+        const auto next_requested = strategy->next_requested();
+        size_t lag = 0;
+        if (next_requested.has_value() && *next_requested <= committed_)
+        {
+          lag = committed_ - *next_requested + 1;
+        }
+        j[i++]["lag"] = lag;
+      }
+
+      return j;
+    }
+
     // Returns true if it looks like there's still a gap to fill. Useful for
     // testing
     bool update_strategies(
@@ -67,9 +201,24 @@ namespace ccf::indexing
     {
       update_commit(newly_committed);
 
+      // Forget strategies which have been uninstalled, once their last batch
+      // is complete
+      std::erase_if(batches_in_progress, [this](const auto& entry) {
+        return strategies.find(entry.first) == strategies.end() &&
+          !entry.second->load();
+      });
+
+      bool any_in_progress = false;
       std::optional<ccf::SeqNo> min_requested = std::nullopt;
+      std::vector<std::pair<StrategyPtr, ccf::SeqNo>> requesting;
       for (auto& strategy : strategies)
       {
+        if (is_batch_in_progress(strategy))
+        {
+          any_in_progress = true;
+          continue;
+        }
+
         strategy->tick();
 
         const auto next_requested = strategy->next_requested();
@@ -81,6 +230,7 @@ namespace ccf::indexing
           continue;
         }
 
+        requesting.emplace_back(strategy, *next_requested);
         if (!min_requested.has_value() || *next_requested < *min_requested)
         {
           min_requested = next_requested;
@@ -99,24 +249,16 @@ namespace ccf::indexing
             committed.seqno - first_requested);
 
           SeqNoCollection seqnos;
-          for (auto i = first_requested; i <= first_requested + additional; ++i)
-          {
-            seqnos.insert(i);
-          }
+          seqnos.extend(first_requested, additional);
 
+          // Each store is fetched and deserialised once, and shared by every
+          // strategy which requested it
           auto stores = transaction_fetcher->fetch_transactions(seqnos);
-          for (auto& store : stores)
+          if (!stores.empty())
           {
-            const ccf::TxID tx_id = store->get_txid();
-
-            for (auto& strategy : strategies)
+            for (const auto& [strategy, next_requested] : requesting)
             {
-              const auto next_requested = strategy->next_requested();
-              if (
-                next_requested.has_value() && (tx_id.seqno == *next_requested))
-              {
-                strategy->handle_committed_transaction(tx_id, store);
-              }
+              dispatch_batch(strategy, next_requested, stores);
             }
           }
 
@@ -124,7 +266,7 @@ namespace ccf::indexing
         }
       }
 
-      return false;
+      return any_in_progress;
     }
   };
 }
\ No newline at end of file
@@ -253,6 +253,108 @@ TEST_CASE("basic indexing" * doctest::test_suite("indexing"))
     index_b);
 }
 
+TEST_CASE("parallel indexing" * doctest::test_suite("indexing"))
+{
+  static constexpr uint16_t workers_count = 2;
+  threading::ThreadMessaging::init(workers_count + 1);
+
+  std::atomic<bool> work_done = false;
+  std::vector<std::thread> workers;
+  for (uint16_t tid = 1; tid <= workers_count; ++tid)
+  {
+    workers.emplace_back([&, tid]() {
+      while (!work_done.load())
+      {
+        if (!threading::ThreadMessaging::instance().run_one(tid))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  ccf::kv::Store kv_store;
+
+  auto consensus = std::make_shared<AllCommittableConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto fetcher = std::make_shared<TestTransactionFetcher>();
+  const bool dispatch_to_workers = true;
+  ccf::indexing::Indexer indexer(fetcher, dispatch_to_workers);
+
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  kv_store.set_encryptor(encryptor);
+
+  auto index_a = std::make_shared<IndexA>(map_a);
+  REQUIRE(indexer.install_strategy(index_a));
+  auto index_b = std::make_shared<IndexB>(map_b);
+  REQUIRE(indexer.install_strategy(index_b));
+
+  ExpectedSeqNos seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2;
+  REQUIRE(create_transactions(
+    kv_store,
+    create_actions(seqnos_hello, seqnos_saluton, seqnos_1, seqnos_2)));
+
+  auto tick_until_caught_up = [&]() {
+    while (indexer.update_strategies(step_time, kv_store.current_txid()) ||
+           !fetcher->requested.empty())
+    {
+      for (auto seqno : fetcher->requested)
+      {
+        REQUIRE(consensus->replica.size() >= seqno);
+        const auto& entry = std::get<1>(consensus->replica[seqno - 1]);
+        fetcher->fetched_stores[seqno] =
+          fetcher->deserialise_transaction(seqno, entry->data(), entry->size());
+      }
+      fetcher->requested.clear();
+    }
+  };
+
+  {
+    INFO("Lag is reported for each strategy before it is populated");
+    indexer.update_strategies(step_time, kv_store.current_txid());
+    const auto description = indexer.describe();
+    REQUIRE(description.size() == 2);
+    for (const auto& strategy : description)
+    {
+      REQUIRE(strategy["lag"].get<size_t>() == kv_store.current_version());
+    }
+  }
+
+  tick_until_caught_up();
+
+  {
+    INFO("Strategies populated on worker threads have no remaining lag");
+    auto current_ = kv_store.current_txid();
+    ccf::TxID current{current_.term, current_.version};
+    REQUIRE(index_a->get_indexed_watermark() == current);
+    REQUIRE(index_b->get_indexed_watermark() == current);
+
+    for (const auto& strategy : indexer.describe())
+    {
+      REQUIRE(strategy["lag"].get<size_t>() == 0);
+    }
+  }
+
+  run_tests(
+    tick_until_caught_up,
+    kv_store,
+    indexer,
+    seqnos_hello,
+    seqnos_saluton,
+    seqnos_1,
+    seqnos_2,
+    index_a,
+    index_b);
+
+  work_done = true;
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+  threading::ThreadMessaging::shutdown();
+}
+
 ccf::kv::Version rekey(
   ccf::kv::Store& kv_store,
   const std::shared_ptr<ccf::LedgerSecrets>& ledger_secrets)
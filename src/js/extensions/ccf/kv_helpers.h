@@ -6,6 +6,8 @@
 #include "js/permissions_checks.h"
 #include "kv/untyped_map.h"
 
+#include <algorithm>
+
 namespace ccf::js::extensions::kvhelpers
 {
   using KVMap = ::ccf::kv::untyped::Map;
@@ -43,11 +45,13 @@ namespace ccf::js::extensions::kvhelpers
 
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_has_denied, "has")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_get_denied, "get")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_get_many_denied, "getMany")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_size_getter_denied, "size")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_set_denied, "set")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_delete_denied, "delete")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_clear_denied, "clear")
   JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_foreach_denied, "forEach")
+  JS_KV_PERMISSION_ERROR_HELPER(js_kv_map_range_denied, "range")
   JS_KV_PERMISSION_ERROR_HELPER(
     js_kv_get_version_of_previous_write_denied, "getVersionOfPreviousWrite")
 #undef JS_KV_PERMISSION_ERROR_HELPER
@@ -113,20 +117,80 @@ namespace ccf::js::extensions::kvhelpers
     auto handle = GetReadOnlyHandle(jsctx, this_val);
     JS_CHECK_HANDLE(handle);
 
-    auto val = handle->get({key, key + key_size});
+    // Copy the value straight from the transaction's state into the JS heap,
+    // rather than into an intermediate std::optional first
+    auto val = handle->get_ptr({key, key + key_size});
 
-    if (!val.has_value())
+    if (val == nullptr)
     {
       return ccf::js::core::constants::Undefined;
     }
 
-    auto buf =
-      jsctx.new_array_buffer_copy(val.value().data(), val.value().size());
+    auto buf = jsctx.new_array_buffer_copy(val->data(), val->size());
     JS_CHECK_EXC(buf);
 
     return buf.take();
   }
 
+  template <ROHandleGetter GetReadOnlyHandle>
+  static JSValue js_kv_map_get_many(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx = *(js::core::Context*)JS_GetContextOpaque(ctx);
+
+    if (argc != 1)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected 1", argc);
+    }
+
+    if (!JS_IsArray(ctx, argv[0]))
+    {
+      return JS_ThrowTypeError(ctx, "Argument must be an array");
+    }
+
+    auto keys = jsctx.wrap(argv[0]);
+    uint32_t keys_count = 0;
+    if (JS_ToUint32(ctx, &keys_count, keys["length"].val))
+    {
+      return ccf::js::core::constants::Exception;
+    }
+
+    auto handle = GetReadOnlyHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    auto values = jsctx.new_array();
+    JS_CHECK_EXC(values);
+
+    for (uint32_t i = 0; i < keys_count; ++i)
+    {
+      auto key_val = keys[i];
+      size_t key_size;
+      uint8_t* key = JS_GetArrayBuffer(ctx, &key_size, key_val.val);
+
+      if (!key)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Argument must be an array of ArrayBuffers");
+      }
+
+      auto val = handle->get_ptr({key, key + key_size});
+
+      if (val == nullptr)
+      {
+        JS_CHECK_SET(values.set_at_index(
+          i, jsctx.wrap(ccf::js::core::constants::Undefined)));
+        continue;
+      }
+
+      auto buf = jsctx.new_array_buffer_copy(val->data(), val->size());
+      JS_CHECK_EXC(buf);
+      JS_CHECK_SET(values.set_at_index(i, std::move(buf)));
+    }
+
+    return values.take();
+  }
+
   template <ROHandleGetter GetReadOnlyHandle>
   static JSValue js_kv_get_version_of_previous_write(
     JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
@@ -315,6 +379,101 @@ namespace ccf::js::extensions::kvhelpers
 
     return ccf::js::core::constants::Undefined;
   }
+
+  template <ROHandleGetter GetReadOnlyHandle>
+  static JSValue js_kv_map_range(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv)
+  {
+    js::core::Context& jsctx = *(js::core::Context*)JS_GetContextOpaque(ctx);
+
+    if (argc < 1 || argc > 3)
+    {
+      return JS_ThrowTypeError(
+        ctx, "Passed %d arguments, but expected between 1 and 3", argc);
+    }
+
+    js::core::JSWrappedValue func(ctx, argv[0]);
+    js::core::JSWrappedValue obj(ctx, this_val);
+
+    if (!JS_IsFunction(ctx, func.val))
+    {
+      return JS_ThrowTypeError(ctx, "First argument must be a function");
+    }
+
+    // Optional bounds of the range, [from, to)
+    std::optional<KVMap::K> from;
+    std::optional<KVMap::K> to;
+    for (int i = 1; i < argc; ++i)
+    {
+      if (JS_IsUndefined(argv[i]))
+      {
+        continue;
+      }
+
+      size_t bound_size;
+      uint8_t* bound = JS_GetArrayBuffer(ctx, &bound_size, argv[i]);
+
+      if (!bound)
+      {
+        return JS_ThrowTypeError(
+          ctx, "Range bounds must be ArrayBuffers or undefined");
+      }
+
+      (i == 1 ? from : to) = KVMap::K(bound, bound + bound_size);
+    }
+
+    auto handle = GetReadOnlyHandle(jsctx, this_val);
+    JS_CHECK_HANDLE(handle);
+
+    // The map is not ordered, so the keys in the range are collected and
+    // sorted first. Only keys are copied up front: each value is copied into
+    // the JS heap when its entry is visited, rather than all values of the
+    // range at once. The callback may write to the map. Entries it removes
+    // are then skipped, and entries it adds are not visited.
+    std::vector<KVMap::K> keys;
+    handle->foreach([&](const auto& k, const auto&) {
+      if (
+        (!from.has_value() || !(k < from.value())) &&
+        (!to.has_value() || k < to.value()))
+      {
+        keys.push_back(k);
+      }
+      return true;
+    });
+    std::sort(keys.begin(), keys.end());
+
+    for (const auto& k : keys)
+    {
+      const auto* v = handle->get_ptr(k);
+      if (v == nullptr)
+      {
+        continue;
+      }
+
+      auto value = jsctx.new_array_buffer_copy(v->data(), v->size());
+      if (value.is_exception())
+      {
+        return ccf::js::core::constants::Exception;
+      }
+      auto key = jsctx.new_array_buffer_copy(k.data(), k.size());
+      if (key.is_exception())
+      {
+        return ccf::js::core::constants::Exception;
+      }
+
+      // JS forEach expects (v, k, map) rather than (k, v)
+      std::vector<js::core::JSWrappedValue> args = {value, key, obj};
+
+      auto val = jsctx.inner_call(func, args);
+
+      if (val.is_exception())
+      {
+        return ccf::js::core::constants::Exception;
+      }
+    }
+
+    return ccf::js::core::constants::Undefined;
+  }
 #undef JS_CHECK_HANDLE
 
   template <ROHandleGetter GetReadOnlyHandle, RWHandleGetter GetWriteHandle>
@@ -387,8 +546,10 @@ namespace ccf::js::extensions::kvhelpers
 
     MAKE_RO_FUNCTION(js_kv_map_has, "has", 1);
     MAKE_RO_FUNCTION(js_kv_map_get, "get", 1);
+    MAKE_RO_FUNCTION(js_kv_map_get_many, "getMany", 1);
 
     MAKE_RO_FUNCTION(js_kv_map_foreach, "forEach", 1);
+    MAKE_RO_FUNCTION(js_kv_map_range, "range", 3);
     MAKE_RO_FUNCTION(
       js_kv_get_version_of_previous_write, "getVersionOfPreviousWrite", 1);
 
@@ -4,21 +4,104 @@
 
 #include "ccf/js/interpreter_cache_interface.h"
 #include "ccf/pal/locking.h"
+#include "ccf/threading/thread_ids.h"
 #include "ds/lru.h"
+#include "ds/thread_messaging.h"
+#include "js/modules/bundle_snapshot_module_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace ccf::js
 {
-  class InterpreterCache : public AbstractInterpreterCache
+  // Interpreters are pooled per worker thread. Each pool is only ever accessed
+  // by its own thread, so no lock is taken when handing out interpreters. The
+  // exceptions are the metrics, which are atomics so that they can be read
+  // from any thread, and the bundle snapshot shared by all pools.
+  class InterpreterCache
+    : public AbstractInterpreterCache,
+      public std::enable_shared_from_this<InterpreterCache>
   {
   protected:
-    // Locks access to all internal fields
-    ccf::pal::Mutex lock;
-    LRU<std::string, std::shared_ptr<js::core::Context>> lru;
-    size_t cache_build_marker = 0;
+    using ContextPtr = std::shared_ptr<js::core::Context>;
+
+    struct Spare
+    {
+      ContextPtr interpreter = nullptr;
+      // Set if the interpreter has loaded the modules of the bundle snapshot
+      // taken at this freshness marker
+      std::optional<size_t> preloaded_marker = std::nullopt;
+    };
+
+    struct ThreadPool
+    {
+      LRU<std::string, ContextPtr> lru;
+      size_t cache_build_marker = 0;
+
+      // Fresh interpreters constructed ahead of demand, by a task on this
+      // pool's thread, and handed out in place of constructing one while
+      // serving a request. These have never executed anything, so they remain
+      // valid when the app is updated, unless they have preloaded its modules.
+      Spare spare_rw;
+      Spare spare_ro;
+      // Also set from other threads, when a new bundle snapshot is available
+      std::atomic<bool> prewarm_pending = false;
+      // Snapshot which could not be loaded, and should not be retried
+      std::optional<size_t> failed_preload_marker = std::nullopt;
+
+      std::atomic<size_t> hits = 0;
+      std::atomic<size_t> misses = 0;
+      std::atomic<size_t> prewarmed = 0;
+      std::atomic<size_t> preloaded = 0;
+      std::atomic<size_t> cached = 0;
+      std::atomic<size_t> created = 0;
+      std::atomic<uint64_t> creation_time_us = 0;
+
+      ThreadPool(size_t max_cache_size) : lru(max_cache_size) {}
+
+      Spare& spare(js::TxAccess access)
+      {
+        return access == js::TxAccess::APP_RW ? spare_rw : spare_ro;
+      }
+    };
+
+    // Indexed by thread ID
+    std::vector<std::unique_ptr<ThreadPool>> pools;
+
+    // Budget shared by all pools, each of which applies its share the next
+    // time it is used
+    std::atomic<size_t> max_cached_interpreters;
 
     InterpreterFactory interpreter_factory = nullptr;
 
-    std::shared_ptr<js::core::Context> make_interpreter(js::TxAccess access)
+    static constexpr size_t no_snapshot = std::numeric_limits<size_t>::max();
+
+    // Snapshots are captured from this store, in their own transactions. If
+    // unset, snapshots are only those given by set_bundle_snapshot().
+    ccf::kv::ReadOnlyStorePtr store;
+
+    // Read without locking on every request, to decide whether a new snapshot
+    // should be captured
+    std::atomic<size_t> snapshot_marker = no_snapshot;
+    // Marker of the last requested snapshot, so that it is captured once
+    std::atomic<size_t> requested_marker = no_snapshot;
+    // Only read by pre-warm tasks, which run off the request path
+    ccf::pal::Mutex snapshot_lock;
+    BundleSnapshotPtr snapshot = nullptr;
+    BundleSnapshotReader pending_reader = nullptr;
+
+    BundleSnapshotPtr get_bundle_snapshot()
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(snapshot_lock);
+      return snapshot;
+    }
+
+    ContextPtr make_interpreter(js::TxAccess access)
     {
       if (interpreter_factory != nullptr)
       {
@@ -28,10 +111,251 @@ namespace ccf::js
       return std::make_shared<js::core::Context>(access);
     }
 
+    ContextPtr make_interpreter(ThreadPool& pool, js::TxAccess access)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      auto interpreter = make_interpreter(access);
+      const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start);
+      pool.created.fetch_add(1, std::memory_order_relaxed);
+      pool.creation_time_us.fetch_add(
+        elapsed.count(), std::memory_order_relaxed);
+      return interpreter;
+    }
+
+    // Loads the snapshot's modules into the interpreter, returning false (and
+    // leaving the interpreter unusable) if that fails
+    bool preload(
+      ThreadPool& pool,
+      js::core::Context& ctx,
+      const BundleSnapshotPtr& bundle_snapshot)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      try
+      {
+        js::modules::preload_bundle(ctx, bundle_snapshot);
+      }
+      catch (const std::exception& exc)
+      {
+        LOG_FAIL_FMT(
+          "Unable to preload modules of bundle snapshot at {}: {}",
+          bundle_snapshot->freshness_marker,
+          exc.what());
+        return false;
+      }
+      const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start);
+      pool.creation_time_us.fetch_add(
+        elapsed.count(), std::memory_order_relaxed);
+      return true;
+    }
+
+    // Takes the pre-warmed interpreter if there is one, else constructs one,
+    // and schedules the construction of a replacement
+    ContextPtr take_fresh_interpreter(
+      ThreadPool& pool,
+      ccf::threading::ThreadID tid,
+      js::TxAccess access,
+      size_t freshness_marker)
+    {
+      pool.misses.fetch_add(1, std::memory_order_relaxed);
+
+      auto& spare = pool.spare(access);
+      if (
+        spare.preloaded_marker.has_value() &&
+        spare.preloaded_marker.value() != freshness_marker)
+      {
+        // Holds the modules of another version of the app
+        spare = {};
+      }
+
+      ContextPtr interpreter = nullptr;
+      if (spare.interpreter != nullptr)
+      {
+        pool.prewarmed.fetch_add(1, std::memory_order_relaxed);
+        if (spare.preloaded_marker.has_value())
+        {
+          pool.preloaded.fetch_add(1, std::memory_order_relaxed);
+        }
+        interpreter = std::move(spare.interpreter);
+        spare = {};
+      }
+      else
+      {
+        interpreter = make_interpreter(pool, access);
+      }
+
+      schedule_prewarm(pool, tid);
+      return interpreter;
+    }
+
+    struct PrewarmMsg
+    {
+      std::weak_ptr<InterpreterCache> cache;
+      ccf::threading::ThreadID tid;
+
+      PrewarmMsg(
+        std::weak_ptr<InterpreterCache> cache_, ccf::threading::ThreadID tid_) :
+        cache(std::move(cache_)),
+        tid(tid_)
+      {}
+    };
+
+    static void prewarm_cb(std::unique_ptr<::threading::Tmsg<PrewarmMsg>> msg)
+    {
+      auto cache = msg->data.cache.lock();
+      if (cache != nullptr)
+      {
+        cache->prewarm(msg->data.tid);
+      }
+    }
+
+    void schedule_prewarm(ThreadPool& pool, ccf::threading::ThreadID tid)
+    {
+      // Only possible if this cache is owned by a shared_ptr, as it is when
+      // installed as a node subsystem
+      auto self = weak_from_this();
+      if (self.expired())
+      {
+        return;
+      }
+
+      if (pool.prewarm_pending.exchange(true))
+      {
+        return;
+      }
+
+      // Queued on this pool's own thread, so that it runs once the current
+      // request has been processed
+      ::threading::ThreadMessaging::instance().add_task(
+        tid,
+        std::make_unique<::threading::Tmsg<PrewarmMsg>>(
+          &prewarm_cb, std::move(self), tid));
+    }
+
+    // Runs the pending snapshot reader, if any, in a read-only transaction
+    // which is not that of the request which asked for the snapshot
+    void capture_bundle_snapshot()
+    {
+      BundleSnapshotReader reader = nullptr;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(snapshot_lock);
+        std::swap(reader, pending_reader);
+      }
+      if (reader == nullptr || store == nullptr)
+      {
+        return;
+      }
+
+      try
+      {
+        auto tx = store->create_read_only_tx();
+        set_bundle_snapshot(reader(tx));
+      }
+      catch (const std::exception& exc)
+      {
+        // Not retried until the app is next updated
+        LOG_FAIL_FMT("Unable to capture bundle snapshot: {}", exc.what());
+      }
+    }
+
+    void prewarm(ccf::threading::ThreadID tid)
+    {
+      auto& pool = *pools[tid];
+      // While this pool's pre-warm is still pending, a new snapshot does not
+      // schedule another one
+      capture_bundle_snapshot();
+      pool.prewarm_pending.store(false);
+
+      auto current = get_bundle_snapshot();
+      if (
+        current != nullptr &&
+        pool.failed_preload_marker == current->freshness_marker)
+      {
+        current = nullptr;
+      }
+
+      for (auto access : {js::TxAccess::APP_RW, js::TxAccess::APP_RO})
+      {
+        auto& spare = pool.spare(access);
+        if (
+          spare.preloaded_marker.has_value() &&
+          (current == nullptr ||
+           spare.preloaded_marker.value() != current->freshness_marker))
+        {
+          spare = {};
+        }
+
+        if (spare.interpreter == nullptr)
+        {
+          spare.interpreter = make_interpreter(pool, access);
+        }
+
+        if (current != nullptr && !spare.preloaded_marker.has_value())
+        {
+          if (preload(pool, *spare.interpreter, current))
+          {
+            spare.preloaded_marker = current->freshness_marker;
+          }
+          else
+          {
+            pool.failed_preload_marker = current->freshness_marker;
+            spare.interpreter = make_interpreter(pool, access);
+          }
+        }
+      }
+    }
+
+    // The budget is divided evenly between worker threads, the first
+    // (budget % threads) of which get one more, so that no more than
+    // max_cached_interpreters are cached in total
+    size_t get_max_cache_size(ccf::threading::ThreadID tid) const
+    {
+      const auto max_total =
+        max_cached_interpreters.load(std::memory_order_relaxed);
+      const size_t threads_count = std::max<size_t>(
+        1,
+        std::min<size_t>(
+          ::threading::ThreadMessaging::instance().thread_count(),
+          pools.size()));
+      return max_total / threads_count +
+        (tid < max_total % threads_count ? 1 : 0);
+    }
+
+    ThreadPool* get_pool(ccf::threading::ThreadID tid)
+    {
+      if (tid >= pools.size())
+      {
+        return nullptr;
+      }
+
+      auto& pool = *pools[tid];
+      const auto max_size = get_max_cache_size(tid);
+      if (pool.lru.get_max_size() != max_size)
+      {
+        pool.lru.set_max_size(max_size);
+        pool.cached.store(pool.lru.size(), std::memory_order_relaxed);
+      }
+      return &pool;
+    }
+
   public:
-    InterpreterCache(size_t max_cache_size) : lru(max_cache_size) {}
+    InterpreterCache(
+      size_t max_cache_size, ccf::kv::ReadOnlyStorePtr store_ = nullptr) :
+      max_cached_interpreters(max_cache_size),
+      store(std::move(store_))
+    {
+      pools.reserve(::threading::ThreadMessaging::max_num_threads);
+      for (size_t i = 0; i < ::threading::ThreadMessaging::max_num_threads;
+           ++i)
+      {
+        pools.push_back(std::make_unique<ThreadPool>(max_cache_size));
+      }
+    }
 
-    std::shared_ptr<js::core::Context> get_interpreter(
+    ContextPtr get_interpreter(
       js::TxAccess access,
       const std::optional<ccf::endpoints::InterpreterReusePolicy>&
         interpreter_reuse,
@@ -44,19 +368,32 @@ namespace ccf::js
           "interpreters");
       }
 
-      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      const auto tid = ccf::threading::get_current_thread_id();
+      auto pool_p = get_pool(tid);
+      if (pool_p == nullptr)
+      {
+        LOG_TRACE_FMT(
+          "Returning freshly constructed interpreter to thread {}", tid);
+        return make_interpreter(access);
+      }
+      auto& pool = *pool_p;
 
-      if (cache_build_marker != freshness_marker)
+      // Each pool drops its own stale interpreters, when it is next used after
+      // the app is updated
+      if (pool.cache_build_marker != freshness_marker)
       {
         LOG_INFO_FMT(
-          "Clearing interpreter lru at {} - rebuilding at {}",
-          cache_build_marker,
+          "Clearing interpreter lru for thread {} at {} - rebuilding at {}",
+          tid,
+          pool.cache_build_marker,
           freshness_marker);
-        lru.clear();
-        cache_build_marker = freshness_marker;
+        pool.lru.clear();
+        pool.cached.store(0, std::memory_order_relaxed);
+        pool.cache_build_marker = freshness_marker;
       }
 
-      if (interpreter_reuse.has_value())
+      // Threads with no share of the budget do not cache interpreters
+      if (interpreter_reuse.has_value() && pool.lru.get_max_size() > 0)
       {
         switch (interpreter_reuse->kind)
         {
@@ -71,21 +408,26 @@ namespace ccf::js
             {
               key += " (ro)";
             }
-            auto it = lru.find(key);
-            if (it == lru.end())
+            auto it = pool.lru.find(key);
+            if (it == pool.lru.end())
             {
-              it = lru.insert(key, make_interpreter(access));
+              it = pool.lru.insert(
+                key,
+                take_fresh_interpreter(pool, tid, access, freshness_marker));
+              pool.cached.store(pool.lru.size(), std::memory_order_relaxed);
               LOG_INFO_FMT(
-                "Constructed cached JS interpreter at key {}. Cache now "
-                "contains {} interpreters",
+                "Constructed cached JS interpreter at key {}. Cache for thread "
+                "{} now contains {} interpreters",
                 key,
-                lru.size());
+                tid,
+                pool.lru.size());
             }
             else
             {
               LOG_TRACE_FMT(
                 "Returning interpreter previously in cache, with key {}", key);
-              lru.promote(it);
+              pool.hits.fetch_add(1, std::memory_order_relaxed);
+              pool.lru.promote(it);
             }
 
             return it->second;
@@ -95,18 +437,104 @@ namespace ccf::js
 
       // Return a fresh interpreter, not stored in the cache
       LOG_TRACE_FMT("Returning freshly constructed interpreter");
-      return make_interpreter(access);
+      return take_fresh_interpreter(pool, tid, access, freshness_marker);
     }
 
     void set_max_cached_interpreters(size_t max) override
     {
-      std::lock_guard<ccf::pal::Mutex> guard(lock);
-      lru.set_max_size(max);
+      max_cached_interpreters.store(max, std::memory_order_relaxed);
     }
 
     void set_interpreter_factory(const InterpreterFactory& ip) override
     {
       interpreter_factory = ip;
     }
+
+    bool needs_bundle_snapshot(size_t freshness_marker) override
+    {
+      return snapshot_marker.load(std::memory_order_relaxed) !=
+        freshness_marker;
+    }
+
+    // The snapshot is captured by this thread's next pre-warm task, which
+    // then loads it into its spares
+    void request_bundle_snapshot(
+      size_t freshness_marker, const BundleSnapshotReader& reader) override
+    {
+      if (store == nullptr || !needs_bundle_snapshot(freshness_marker))
+      {
+        return;
+      }
+
+      const auto tid = ccf::threading::get_current_thread_id();
+      if (tid >= pools.size())
+      {
+        return;
+      }
+
+      if (requested_marker.exchange(freshness_marker) == freshness_marker)
+      {
+        return;
+      }
+
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(snapshot_lock);
+        pending_reader = reader;
+      }
+      schedule_prewarm(*pools[tid], tid);
+    }
+
+    // Spares on threads which have served requests are refreshed straight
+    // away, rather than when they are next used
+    void set_bundle_snapshot(const BundleSnapshotPtr& new_snapshot) override
+    {
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(snapshot_lock);
+        if (
+          snapshot != nullptr && new_snapshot != nullptr &&
+          snapshot->freshness_marker > new_snapshot->freshness_marker)
+        {
+          // Captured from an older version of the app
+          return;
+        }
+        snapshot = new_snapshot;
+        snapshot_marker.store(
+          snapshot != nullptr ? snapshot->freshness_marker : no_snapshot);
+      }
+
+      const size_t threads_count = std::min<size_t>(
+        ::threading::ThreadMessaging::instance().thread_count(), pools.size());
+      for (size_t i = 0; i < threads_count; ++i)
+      {
+        auto& pool = *pools[i];
+        if (pool.misses.load(std::memory_order_relaxed) > 0)
+        {
+          schedule_prewarm(pool, i);
+        }
+      }
+    }
+
+    std::vector<InterpreterCacheMetrics> get_metrics() const override
+    {
+      const size_t threads_count = std::min<size_t>(
+        ::threading::ThreadMessaging::instance().thread_count(), pools.size());
+
+      std::vector<InterpreterCacheMetrics> metrics;
+      metrics.reserve(threads_count);
+      for (size_t i = 0; i < threads_count; ++i)
+      {
+        const auto& pool = *pools[i];
+        auto& m = metrics.emplace_back();
+        m.hits = pool.hits.load(std::memory_order_relaxed);
+        m.misses = pool.misses.load(std::memory_order_relaxed);
+        m.prewarmed = pool.prewarmed.load(std::memory_order_relaxed);
+        m.preloaded = pool.preloaded.load(std::memory_order_relaxed);
+        m.cached_interpreters = pool.cached.load(std::memory_order_relaxed);
+        m.interpreters_created = pool.created.load(std::memory_order_relaxed);
+        m.creation_time_us =
+          pool.creation_time_us.load(std::memory_order_relaxed);
+      }
+      return metrics;
+    }
   };
 }
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ccf/ds/logger.h"
+#include "ccf/js/core/context.h"
+#include "ccf/js/interpreter_cache_interface.h"
+#include "ccf/js/modules/module_loader_interface.h"
+
+#include <string>
+
+namespace ccf::js::modules
+{
+  class BundleSnapshotModuleLoader : public ModuleLoaderInterface
+  {
+  protected:
+    BundleSnapshotPtr snapshot;
+
+  public:
+    BundleSnapshotModuleLoader(BundleSnapshotPtr snapshot_) :
+      snapshot(std::move(snapshot_))
+    {}
+
+    virtual std::optional<js::core::JSWrappedValue> get_module(
+      std::string_view module_name, js::core::Context& ctx) override
+    {
+      std::string module_name_kv(module_name);
+      if (module_name_kv[0] != '/')
+      {
+        module_name_kv.insert(0, "/");
+      }
+
+      const auto it = snapshot->bytecode.find(module_name_kv);
+      if (it == snapshot->bytecode.end())
+      {
+        CCF_APP_TRACE("Module '{}' not found in snapshot", module_name_kv);
+        return std::nullopt;
+      }
+
+      auto module_val = ctx.read_object(
+        it->second.data(), it->second.size(), JS_READ_OBJ_BYTECODE);
+      if (module_val.is_exception())
+      {
+        auto [reason, trace] = ctx.error_message();
+        throw std::runtime_error(fmt::format(
+          "Failed to deserialize bytecode for module '{}': {}",
+          module_name,
+          reason));
+      }
+
+      return module_val;
+    }
+  };
+
+  // Loads the snapshot's entry modules, and resolves their imports, without
+  // evaluating any of them. Module top-level code may depend on the state of
+  // the KV, so is only run by the request which then uses the interpreter.
+  static inline void preload_bundle(
+    js::core::Context& ctx, const BundleSnapshotPtr& snapshot)
+  {
+    ctx.set_module_loader(
+      std::make_shared<BundleSnapshotModuleLoader>(snapshot));
+    for (const auto& module_name : snapshot->entry_modules)
+    {
+      if (!ctx.get_module(module_name).has_value())
+      {
+        throw std::runtime_error(
+          fmt::format("Module '{}' not found in snapshot", module_name));
+      }
+    }
+    ctx.set_module_loader(nullptr);
+  }
+}
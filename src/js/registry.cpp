@@ -52,6 +52,49 @@ namespace ccf::js
     return std::string(sv);
   }
 
+  // Reads the app's bytecode, so that interpreters can load its modules ahead
+  // of demand. The bytecode table only changes along with the flush marker,
+  // which is read from the same transaction.
+  static BundleSnapshotPtr capture_bundle_snapshot(
+    ccf::kv::ReadOnlyTx& tx,
+    const std::string& interpreter_flush_map,
+    const std::string& metadata_map,
+    const std::string& modules_quickjs_bytecode_map,
+    const std::string& modules_quickjs_version_map)
+  {
+    auto bundle_snapshot = std::make_shared<BundleSnapshot>();
+    bundle_snapshot->freshness_marker =
+      tx.ro<ccf::InterpreterFlush>(interpreter_flush_map)
+        ->get_version_of_previous_write()
+        .value_or(0);
+
+    const auto version_in_kv =
+      tx.ro<ccf::ModulesQuickJsVersion>(modules_quickjs_version_map)->get();
+    if (version_in_kv != std::string(ccf::quickjs_version))
+    {
+      // Modules will be compiled from source by each request, as before
+      return bundle_snapshot;
+    }
+
+    tx.ro<ccf::ModulesQuickJsBytecode>(modules_quickjs_bytecode_map)
+      ->foreach([&](const auto& module_name, const auto& bytecode) {
+        bundle_snapshot->bytecode.emplace(module_name, bytecode);
+        return true;
+      });
+
+    tx.ro<ccf::endpoints::EndpointsMap>(metadata_map)
+      ->foreach([&](const auto&, const auto& properties) {
+        if (bundle_snapshot->bytecode.contains(
+              normalised_module_path(properties.js_module)))
+        {
+          bundle_snapshot->entry_modules.insert(properties.js_module);
+        }
+        return true;
+      });
+
+    return bundle_snapshot;
+  }
+
   void BaseDynamicJSEndpointRegistry::do_execute_request(
     const CustomJSEndpoint* endpoint,
     ccf::endpoints::EndpointContext& endpoint_ctx,
@@ -82,6 +125,25 @@ namespace ccf::js
       ccf::js::TxAccess::APP_RO;
     std::optional<ccf::endpoints::InterpreterReusePolicy> reuse_policy =
       endpoint->properties.interpreter_reuse;
+    if (interpreter_cache->needs_bundle_snapshot(flush_marker))
+    {
+      // Read later, in another transaction, so that this request's read set
+      // does not include the whole bundle
+      interpreter_cache->request_bundle_snapshot(
+        flush_marker,
+        [interpreter_flush_map = interpreter_flush_map,
+         metadata_map = metadata_map,
+         modules_quickjs_bytecode_map = modules_quickjs_bytecode_map,
+         modules_quickjs_version_map =
+           modules_quickjs_version_map](ccf::kv::ReadOnlyTx& tx) {
+          return capture_bundle_snapshot(
+            tx,
+            interpreter_flush_map,
+            metadata_map,
+            modules_quickjs_bytecode_map,
+            modules_quickjs_version_map);
+        });
+    }
     std::shared_ptr<ccf::js::core::Context> interpreter =
       interpreter_cache->get_interpreter(rw_access, reuse_policy, flush_marker);
     if (interpreter == nullptr)
@@ -91,12 +153,9 @@ namespace ccf::js
     ccf::js::core::Context& ctx = *interpreter;
 
     // Prevent any other thread modifying this interpreter, until this
-    // function completes. We could create interpreters per-thread, but then
-    // we would get no cross-thread caching benefit (and would need to either
-    // enforce, or share, caps across per-thread caches). We choose
-    // instead to allow interpreters to be maximally reused, even across
-    // threads, at the cost of locking (and potentially stalling another
-    // thread's request execution) here.
+    // function completes. The InterpreterCache only reuses interpreters on
+    // the thread which created them, so this is uncontended, but other
+    // AbstractInterpreterCache implementations may share them across threads.
     std::lock_guard<ccf::pal::Mutex> guard(ctx.lock);
     // Update the top of the stack for the current thread, used by the stack
     // guard Note this is only active outside SGX
@@ -1,11 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the Apache 2.0 License.
+#include "ccf/js/core/context.h"
+#include "js/global_class_ids.h"
+#include "js/interpreter_cache.h"
 #include "js/permissions_checks.h"
+#include "kv/store.h"
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <random>
 
+std::unique_ptr<threading::ThreadMessaging>
+  threading::ThreadMessaging::singleton = nullptr;
+
 TEST_CASE("Check KV Map access")
 {
   using namespace ccf::js;
@@ -169,3 +176,209 @@ TEST_CASE("Check KV Map access")
     }
   }
 }
+
+TEST_CASE("Interpreter cache")
+{
+  using namespace ccf::js;
+  register_class_ids();
+  ::threading::ThreadMessaging::init(1);
+  auto& tm = ::threading::ThreadMessaging::instance();
+  const auto tid = ccf::threading::get_current_thread_id();
+  REQUIRE(tid < tm.thread_count());
+  auto run_tasks = [&]() {
+    while (tm.run_one(tid))
+    {
+    }
+  };
+
+  auto cache = std::make_shared<InterpreterCache>(2);
+  const std::optional<ccf::endpoints::InterpreterReusePolicy> no_reuse =
+    std::nullopt;
+  auto reuse = [](const std::string& key) {
+    return ccf::endpoints::InterpreterReusePolicy{
+      ccf::endpoints::InterpreterReusePolicy::KeyBased, key};
+  };
+  size_t marker = 1;
+
+  {
+    INFO("Interpreters are fresh unless reuse is permitted");
+    auto a = cache->get_interpreter(TxAccess::APP_RW, no_reuse, marker);
+    auto b = cache->get_interpreter(TxAccess::APP_RW, no_reuse, marker);
+    REQUIRE(a != b);
+
+    auto m = cache->get_metrics().at(tid);
+    REQUIRE(m.hits == 0);
+    REQUIRE(m.misses == 2);
+    REQUIRE(m.prewarmed == 0);
+    REQUIRE(m.cached_interpreters == 0);
+  }
+
+  {
+    INFO("Once pre-warmed, fresh interpreters need not be constructed");
+    run_tasks();
+    const auto created = cache->get_metrics().at(tid).interpreters_created;
+
+    auto rw = cache->get_interpreter(TxAccess::APP_RW, no_reuse, marker);
+    auto ro = cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE(rw->access == TxAccess::APP_RW);
+    REQUIRE(ro->access == TxAccess::APP_RO);
+
+    auto m = cache->get_metrics().at(tid);
+    REQUIRE(m.prewarmed == 2);
+    REQUIRE(m.interpreters_created == created);
+    run_tasks();
+  }
+
+  {
+    INFO("Interpreters are reused by key and access");
+    auto a = cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker);
+    REQUIRE(
+      a == cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker));
+    REQUIRE(
+      a != cache->get_interpreter(TxAccess::APP_RO, reuse("a"), marker));
+
+    auto m = cache->get_metrics().at(tid);
+    REQUIRE(m.hits == 1);
+    REQUIRE(m.cached_interpreters == 2);
+
+    INFO("Until the app is updated");
+    ++marker;
+    REQUIRE(
+      a != cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker));
+    REQUIRE(cache->get_metrics().at(tid).cached_interpreters == 1);
+  }
+
+  {
+    INFO("The least recently used interpreters are evicted beyond the cap");
+    cache->set_max_cached_interpreters(1);
+    auto a = cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker);
+    auto b = cache->get_interpreter(TxAccess::APP_RW, reuse("b"), marker);
+    REQUIRE(
+      a != cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker));
+    REQUIRE(cache->get_metrics().at(tid).cached_interpreters == 1);
+  }
+
+  {
+    INFO("Pre-warmed interpreters load the modules of the bundle snapshot");
+    auto bundle_snapshot = std::make_shared<BundleSnapshot>();
+    bundle_snapshot->freshness_marker = marker;
+    {
+      // Imports are resolved by compilation, from previously compiled modules
+      core::Context compiler(TxAccess::APP_RW);
+      compiler.set_module_loader(
+        std::make_shared<modules::BundleSnapshotModuleLoader>(bundle_snapshot));
+      auto compile = [&](const std::string& name, const std::string& src) {
+        auto module_val = compiler.eval(
+          src.c_str(),
+          src.size(),
+          name.c_str(),
+          JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+        size_t len;
+        uint8_t* buf =
+          JS_WriteObject(compiler, &len, module_val.val, JS_WRITE_OBJ_BYTECODE);
+        REQUIRE(buf != nullptr);
+        bundle_snapshot->bytecode.emplace(
+          name, std::vector<uint8_t>(buf, buf + len));
+        js_free(compiler, buf);
+      };
+      compile("/lib.js", "export function f() { return 42; }");
+      compile(
+        "/app.js",
+        "import { f } from './lib.js'; export function g() { return f(); }");
+    }
+    bundle_snapshot->entry_modules.insert("app.js");
+
+    REQUIRE(cache->needs_bundle_snapshot(marker));
+    cache->set_bundle_snapshot(bundle_snapshot);
+    REQUIRE_FALSE(cache->needs_bundle_snapshot(marker));
+    run_tasks();
+
+    auto interpreter =
+      cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE(cache->get_metrics().at(tid).preloaded == 1);
+
+    // Loaded without a module loader, and evaluated only now
+    auto module_val = interpreter->get_module("app.js");
+    REQUIRE(module_val.has_value());
+    auto g = interpreter->get_exported_function(*module_val, "g", "app.js");
+    auto result = interpreter->inner_call(g, {});
+    REQUIRE(interpreter->to_str(result) == "42");
+    run_tasks();
+
+    INFO("Interpreters holding modules of a previous app are not handed out");
+    ++marker;
+    REQUIRE(cache->needs_bundle_snapshot(marker));
+    cache->get_interpreter(TxAccess::APP_RO, no_reuse, marker);
+    REQUIRE(cache->get_metrics().at(tid).preloaded == 1);
+    run_tasks();
+  }
+
+  {
+    INFO("Requested snapshots are read by the pre-warm task, in its own tx");
+    using Markers = ccf::kv::Value<size_t>;
+    auto store = std::make_shared<ccf::kv::Store>();
+    auto store_cache = std::make_shared<InterpreterCache>(2, store);
+    size_t reads = 0;
+    auto reader = [&](ccf::kv::ReadOnlyTx& tx) {
+      ++reads;
+      auto bundle_snapshot = std::make_shared<BundleSnapshot>();
+      bundle_snapshot->freshness_marker =
+        tx.ro<Markers>("markers")->get().value_or(marker);
+      return bundle_snapshot;
+    };
+
+    store_cache->request_bundle_snapshot(marker, reader);
+    store_cache->request_bundle_snapshot(marker, reader);
+    REQUIRE(reads == 0);
+    REQUIRE(store_cache->needs_bundle_snapshot(marker));
+
+    run_tasks();
+    REQUIRE(reads == 1);
+    REQUIRE_FALSE(store_cache->needs_bundle_snapshot(marker));
+
+    store_cache->request_bundle_snapshot(marker, reader);
+    run_tasks();
+    REQUIRE(reads == 1);
+  }
+
+  cache.reset();
+  {
+    INFO("Pre-warming tasks outliving the cache are harmless");
+    run_tasks();
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
+
+TEST_CASE("Interpreter cache budget is shared between threads")
+{
+  using namespace ccf::js;
+  register_class_ids();
+  ::threading::ThreadMessaging::init(4);
+  const auto tid = ccf::threading::get_current_thread_id();
+  REQUIRE(tid == 0);
+
+  auto reuse = [](const std::string& key) {
+    return ccf::endpoints::InterpreterReusePolicy{
+      ccf::endpoints::InterpreterReusePolicy::KeyBased, key};
+  };
+  const size_t marker = 1;
+
+  {
+    INFO("Each thread caches its share of the budget");
+    auto cache = std::make_shared<InterpreterCache>(6);
+    cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker);
+    cache->get_interpreter(TxAccess::APP_RW, reuse("b"), marker);
+    cache->get_interpreter(TxAccess::APP_RW, reuse("c"), marker);
+    REQUIRE(cache->get_metrics().at(tid).cached_interpreters == 2);
+  }
+
+  {
+    INFO("Threads without a share do not cache interpreters");
+    auto cache = std::make_shared<InterpreterCache>(0);
+    auto a = cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker);
+    REQUIRE(
+      a != cache->get_interpreter(TxAccess::APP_RW, reuse("a"), marker));
+    REQUIRE(cache->get_metrics().at(tid).cached_interpreters == 0);
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
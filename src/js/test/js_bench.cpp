@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#define PICOBENCH_IMPLEMENT
+
+#include "ccf/js/core/context.h"
+#include "js/global_class_ids.h"
+#include "js/modules/bundle_snapshot_module_loader.h"
+
+#include <fmt/format.h>
+#include <picobench/picobench.hpp>
+
+using namespace ccf::js;
+
+template <class A>
+inline void do_not_optimize(A const& value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+static constexpr size_t functions_per_module = 20;
+
+// Builds an app bundle of n modules, imported by a single entry module, and
+// compiles it to bytecode as when the app is installed
+static BundleSnapshotPtr make_bundle(size_t n)
+{
+  auto bundle = std::make_shared<BundleSnapshot>();
+
+  core::Context compiler(TxAccess::APP_RW);
+  compiler.set_module_loader(
+    std::make_shared<modules::BundleSnapshotModuleLoader>(bundle));
+  auto compile = [&](const std::string& name, const std::string& src) {
+    auto module_val = compiler.eval(
+      src.c_str(),
+      src.size(),
+      name.c_str(),
+      JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    size_t len;
+    uint8_t* buf =
+      JS_WriteObject(compiler, &len, module_val.val, JS_WRITE_OBJ_BYTECODE);
+    if (buf == nullptr)
+    {
+      throw std::runtime_error(fmt::format("Unable to compile {}", name));
+    }
+    bundle->bytecode.emplace(name, std::vector<uint8_t>(buf, buf + len));
+    js_free(compiler, buf);
+  };
+
+  std::string entry;
+  std::string calls;
+  for (size_t i = 0; i < n; ++i)
+  {
+    std::string src = fmt::format("const table = {{ id: {} }};\n", i);
+    for (size_t j = 0; j < functions_per_module; ++j)
+    {
+      src += fmt::format(
+        "export function f{}(x) {{ return x.map((v) => v + table.id * {}); "
+        "}}\n",
+        j,
+        j);
+    }
+    compile(fmt::format("/m{}.js", i), src);
+    entry += fmt::format("import * as m{} from './m{}.js';\n", i, i);
+    calls += fmt::format("m{}.f0(", i);
+  }
+  entry += fmt::format(
+    "export function run() {{ return {}[]{}; }}\n", calls, std::string(n, ')'));
+  compile("/app.js", entry);
+  bundle->entry_modules.insert("app.js");
+
+  return bundle;
+}
+
+static void get_run(core::Context& ctx)
+{
+  auto module_val = ctx.get_module("app.js");
+  do_not_optimize(ctx.get_exported_function(*module_val, "run", "app.js"));
+}
+
+// A request given a fresh interpreter, which loads the app's modules from
+// bytecode, then evaluates them
+static void fresh(picobench::state& s)
+{
+  const auto bundle = make_bundle(s.iterations());
+
+  s.start_timer();
+  core::Context ctx(TxAccess::APP_RW);
+  ctx.set_module_loader(
+    std::make_shared<modules::BundleSnapshotModuleLoader>(bundle));
+  get_run(ctx);
+  s.stop_timer();
+}
+
+// A request given an interpreter which has preloaded the app's modules ahead
+// of demand, so only evaluates them
+static void preloaded(picobench::state& s)
+{
+  const auto bundle = make_bundle(s.iterations());
+  core::Context ctx(TxAccess::APP_RW);
+  modules::preload_bundle(ctx, bundle);
+
+  s.start_timer();
+  get_run(ctx);
+  s.stop_timer();
+}
+
+// The work moved off the request path, by pre-warm tasks
+static void preload(picobench::state& s)
+{
+  const auto bundle = make_bundle(s.iterations());
+
+  s.start_timer();
+  core::Context ctx(TxAccess::APP_RW);
+  modules::preload_bundle(ctx, bundle);
+  s.stop_timer();
+}
+
+// Bundle size, in modules
+const std::vector<int> sizes = {1, 10, 100};
+
+PICOBENCH_SUITE("interpreter_ready");
+PICOBENCH(fresh).iterations(sizes).samples(10).baseline();
+PICOBENCH(preloaded).iterations(sizes).samples(10);
+PICOBENCH(preload).iterations(sizes).samples(10);
+
+int main(int argc, char** argv)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::FATAL;
+  register_class_ids();
+
+  picobench::runner runner;
+  runner.parse_cmd_line(argc, argv);
+  return runner.run();
+}
@@ -29,6 +29,9 @@ namespace ccf::kv
   // The track_read_versions parameter tells the store if it needs to track the
   // last read version for every key. This is required for backup execution as
   // described at the top of tx.h
+  //
+  // If conflicting_map is set, it is populated with the name of the map which
+  // caused the transaction to conflict, if any.
 
   using VersionLastNewMap = Version;
   using VersionResolver = std::function<std::tuple<Version, VersionLastNewMap>(
@@ -42,7 +45,8 @@ namespace ccf::kv
     const std::optional<Version>& new_maps_conflict_version,
     bool track_read_versions,
     bool track_deletes_on_missing_keys,
-    const std::optional<Version>& expected_rollback_count = std::nullopt)
+    const std::optional<Version>& expected_rollback_count = std::nullopt,
+    std::string* conflicting_map = nullptr)
   {
     // All maps with pending writes are locked, transactions are prepared
     // and possibly committed, and then all maps with pending writes are
@@ -97,6 +101,10 @@ namespace ccf::kv
       {
         if (!it->second->prepare(track_read_versions))
         {
+          if (conflicting_map != nullptr)
+          {
+            *conflicting_map = it->first;
+          }
           ok = false;
           break;
         }
@@ -127,6 +135,10 @@ namespace ccf::kv
 
       if (store->get_map_unsafe(current_v, map_name) != nullptr)
       {
+        if (conflicting_map != nullptr)
+        {
+          *conflicting_map = map_name;
+        }
         ok = false;
         break;
       }
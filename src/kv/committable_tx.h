@@ -37,6 +37,9 @@ namespace ccf::kv
     TxFlags flags = 0;
     SerialisedEntryFlags entry_flags = 0;
 
+    // Set if commit() failed because of a conflict on this map
+    std::optional<std::string> conflicting_map = std::nullopt;
+
     std::vector<uint8_t> serialise(
       ccf::crypto::Sha256Hash& commit_evidence_digest,
       std::string& commit_evidence,
@@ -160,6 +163,7 @@ namespace ccf::kv
       std::optional<Version> new_maps_conflict_version = std::nullopt;
 
       bool track_deletes_on_missing_keys = false;
+      std::string conflicting_map_name;
       auto c = apply_changes(
         all_changes,
         version_resolver == nullptr ?
@@ -171,7 +175,9 @@ namespace ccf::kv
         pimpl->created_maps,
         new_maps_conflict_version,
         track_read_versions,
-        track_deletes_on_missing_keys);
+        track_deletes_on_missing_keys,
+        std::nullopt,
+        &conflicting_map_name);
 
       if (maps_created)
       {
@@ -184,7 +190,10 @@ namespace ccf::kv
       {
         // This Tx is now in a dead state. Caller should create a new Tx and try
         // again.
-        LOG_TRACE_FMT("Could not commit transaction due to conflict");
+        LOG_TRACE_FMT(
+          "Could not commit transaction due to conflict on {}",
+          conflicting_map_name);
+        conflicting_map = conflicting_map_name;
         return CommitResult::FAIL_CONFLICT;
       }
       else
@@ -305,6 +314,16 @@ namespace ccf::kv
       return version;
     }
 
+    /** Map on which this transaction conflicted
+     *
+     * @return Name of the map which caused an earlier call to commit() to
+     * return CommitResult::FAIL_CONFLICT, or `std::nullopt` otherwise
+     */
+    const std::optional<std::string>& get_conflicting_map() const
+    {
+      return conflicting_map;
+    }
+
     std::optional<TxID> get_txid()
     {
       if (!committed)
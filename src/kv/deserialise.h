@@ -4,6 +4,7 @@
 
 #include "apply_changes.h"
 #include "kv/committable_tx.h"
+#include "kv_serialiser.h"
 #include "kv_types.h"
 #include "service/tables/shares.h"
 #include "service/tables/signatures.h"
@@ -17,7 +18,7 @@ namespace ccf::kv
   {
   public:
     virtual bool fill_maps(
-      const std::vector<uint8_t>& data,
+      std::span<const uint8_t> data,
       bool public_only,
       ccf::kv::Version& v,
       ccf::kv::Term& view,
@@ -25,7 +26,20 @@ namespace ccf::kv
       ccf::kv::MapCollection& new_maps,
       ccf::ClaimsDigest& claims_digest,
       std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
-      bool ignore_strict_versions = false) = 0;
+      size_t& bytes_copied,
+      bool ignore_strict_versions = false,
+      std::unique_ptr<KvStoreDeserialiser> prepared = nullptr) = 0;
+
+    // Reads the header of, and decrypts, a serialised transaction, to be
+    // passed to fill_maps() later. This does not depend on the state of the
+    // store, so may be called concurrently for several transactions. Returns
+    // nullptr if the transaction cannot be decrypted yet (e.g. it is
+    // encrypted with a ledger secret introduced by an earlier transaction
+    // which has not been applied).
+    virtual std::unique_ptr<KvStoreDeserialiser> prepare_deserialiser(
+      std::span<const uint8_t> data,
+      bool public_only,
+      ccf::kv::Term& view) = 0;
 
     virtual bool commit_deserialised(
       ccf::kv::OrderedChanges& changes,
@@ -41,7 +55,7 @@ namespace ccf::kv
   private:
     ExecutionWrapperStore* store;
     std::shared_ptr<TxHistory> history;
-    const std::vector<uint8_t> data;
+    const EntryView entry;
     bool public_only;
     ccf::kv::Version version;
     Term term;
@@ -50,6 +64,10 @@ namespace ccf::kv
     ccf::kv::ConsensusHookPtrs hooks;
     ccf::ClaimsDigest claims_digest;
     std::optional<ccf::crypto::Sha256Hash> commit_evidence_digest = {};
+    size_t bytes_copied = 0;
+
+    // Set by prepare(), and consumed by apply()
+    std::unique_ptr<KvStoreDeserialiser> prepared = nullptr;
 
     const std::optional<TxID> expected_txid;
 
@@ -57,12 +75,12 @@ namespace ccf::kv
     CFTExecutionWrapper(
       ExecutionWrapperStore* store_,
       std::shared_ptr<TxHistory> history_,
-      const std::vector<uint8_t>& data_,
+      const EntryView& entry_,
       bool public_only_,
       const std::optional<TxID>& expected_txid_) :
       store(store_),
       history(history_),
-      data(data_),
+      entry(entry_),
       public_only(public_only_),
       expected_txid(expected_txid_)
     {}
@@ -78,10 +96,24 @@ namespace ccf::kv
       return std::move(commit_evidence_digest);
     }
 
+    bool prepare() override
+    {
+      try
+      {
+        prepared = store->prepare_deserialiser(entry.data, public_only, term);
+      }
+      catch (const std::exception&)
+      {
+        // Malformed entries are reported when they are applied
+        prepared = nullptr;
+      }
+      return prepared != nullptr;
+    }
+
     ApplyResult apply(bool track_deletes_on_missing_keys) override
     {
       if (!store->fill_maps(
-            data,
+            entry.data,
             public_only,
             version,
             term,
@@ -89,7 +121,9 @@ namespace ccf::kv
             new_maps,
             claims_digest,
             commit_evidence_digest,
-            true))
+            bytes_copied,
+            true,
+            std::move(prepared)))
       {
         return ApplyResult::FAIL;
       }
@@ -168,7 +202,7 @@ namespace ccf::kv
       if (history)
       {
         history->append_entry(
-          ccf::entry_leaf(data, commit_evidence_digest, claims_digest));
+          ccf::entry_leaf(entry.data, commit_evidence_digest, claims_digest));
       }
       return success;
     }
@@ -178,9 +212,14 @@ namespace ccf::kv
       return hooks;
     }
 
-    const std::vector<uint8_t>& get_entry() override
+    std::span<const uint8_t> get_entry() override
+    {
+      return entry.data;
+    }
+
+    size_t get_bytes_copied() override
     {
-      return data;
+      return bytes_copied;
     }
 
     Term get_term() override
@@ -30,7 +30,7 @@ namespace ccf::kv
 
       hdr.set_iv_seq(tx_id.version);
       hdr.set_iv_term(tx_id.term);
-      if (entry_type == EntryType::Snapshot)
+      if (is_snapshot(entry_type))
       {
         hdr.set_iv_is_snapshot();
       }
@@ -113,16 +113,18 @@ namespace ccf::kv
      * @return Boolean status indicating success of decryption.
      */
     bool decrypt(
-      const std::vector<uint8_t>& cipher,
-      const std::vector<uint8_t>& additional_data,
-      const std::vector<uint8_t>& serialised_header,
+      std::span<const uint8_t> cipher,
+      std::span<const uint8_t> additional_data,
+      std::span<const uint8_t> serialised_header,
       std::vector<uint8_t>& plain,
       Version version,
       Term& term,
       bool historical_hint = false) override
     {
       S hdr;
-      hdr.deserialise(serialised_header);
+      auto hdr_data = serialised_header.data();
+      auto hdr_size = serialised_header.size();
+      hdr.deserialise(hdr_data, hdr_size);
       term = hdr.get_term();
 
       auto key =
@@ -251,6 +251,17 @@ namespace ccf::kv
     Version version;
     std::shared_ptr<AbstractTxEncryptor> crypto_util;
     std::optional<SecurityDomain> domain_restriction;
+    // Bytes copied out of the serialised transaction so far: the decrypted
+    // private domain, and the keys and values read from either domain
+    size_t bytes_copied = 0;
+
+    template <typename T>
+    T read_copy()
+    {
+      auto t = current_reader->template read_next<T>();
+      bytes_copied += t.size();
+      return t;
+    }
 
     // Should only be called once, once the GCM header and length of public
     // domain have been read
@@ -296,6 +307,21 @@ namespace ccf::kv
       return std::move(commit_evidence_digest);
     }
 
+    EntryType get_entry_type() const
+    {
+      return entry_type;
+    }
+
+    Version get_version() const
+    {
+      return version;
+    }
+
+    size_t get_bytes_copied() const
+    {
+      return bytes_copied;
+    }
+
     std::optional<Version> init(
       const uint8_t* data,
       size_t size,
@@ -365,12 +391,14 @@ namespace ccf::kv
       }
 
       serialized::skip(data_, size_, public_domain_length);
-      decrypted_buffer.resize(size_);
 
+      // The cipher, additional data and header are all read in place from the
+      // serialised entry. Only the decrypted private domain is written to a
+      // separate buffer.
       if (!crypto_util->decrypt(
-            {data_, data_ + size_},
-            {data_public, data_public + public_domain_length},
-            {gcm_hdr_data, gcm_hdr_data + crypto_util->get_header_length()},
+            {data_, size_},
+            {data_public, public_domain_length},
+            {gcm_hdr_data, crypto_util->get_header_length()},
             decrypted_buffer,
             version,
             term,
@@ -379,6 +407,7 @@ namespace ccf::kv
         return std::nullopt;
       }
 
+      bytes_copied += decrypted_buffer.size();
       private_reader.init(decrypted_buffer.data(), decrypted_buffer.size());
       return version;
     }
@@ -413,7 +442,7 @@ namespace ccf::kv
     std::tuple<SerialisedKey, Version> deserialise_read()
     {
       return {
-        current_reader->template read_next<SerialisedKey>(),
+        read_copy<SerialisedKey>(),
         current_reader->template read_next<Version>()};
     }
 
@@ -424,14 +453,12 @@ namespace ccf::kv
 
     std::tuple<SerialisedKey, SerialisedValue> deserialise_write()
     {
-      return {
-        current_reader->template read_next<SerialisedKey>(),
-        current_reader->template read_next<SerialisedValue>()};
+      return {read_copy<SerialisedKey>(), read_copy<SerialisedValue>()};
     }
 
     std::vector<uint8_t> deserialise_raw()
     {
-      return current_reader->template read_next<std::vector<uint8_t>>();
+      return read_copy<std::vector<uint8_t>>();
     }
 
     std::vector<Version> deserialise_view_history()
@@ -446,7 +473,7 @@ namespace ccf::kv
 
     SerialisedKey deserialise_remove()
     {
-      return current_reader->template read_next<SerialisedKey>();
+      return read_copy<SerialisedKey>();
     }
 
     bool end()
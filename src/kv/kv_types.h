@@ -24,6 +24,7 @@
 #include <list>
 #include <memory>
 #include <set>
+#include <span>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -198,6 +199,11 @@ namespace ccf::kv
     std::optional<ccf::NodeId> primary_id = std::nullopt;
     ccf::View current_view = 0;
     bool ticking = false;
+    // Entries received from other nodes, and the bytes copied out of them
+    // when they were applied (decrypted private domains, and keys and values
+    // written to the store)
+    size_t entries_received = 0;
+    size_t entry_bytes_copied = 0;
   };
 
   DECLARE_JSON_TYPE(ConsensusDetails::Ack);
@@ -211,7 +217,9 @@ namespace ccf::kv
     membership_state,
     primary_id,
     current_view,
-    ticking);
+    ticking,
+    entries_received,
+    entry_bytes_copied);
   DECLARE_JSON_OPTIONAL_FIELDS(
     ConsensusDetails,
     reconfiguration_type,
@@ -271,9 +279,19 @@ namespace ccf::kv
     WriteSetWithClaims = 2,
     WriteSetWithCommitEvidence = 3,
     WriteSetWithCommitEvidenceAndClaims = 4,
-    MAX = WriteSetWithCommitEvidenceAndClaims
+    SnapshotDelta = 5,
+    MAX = SnapshotDelta
   };
 
+  static bool is_snapshot(const EntryType& et)
+  {
+    return et == EntryType::Snapshot || et == EntryType::SnapshotDelta;
+  }
+
+  // The distance between a delta snapshot and its base snapshot is used as the
+  // term of the delta's IV, which is limited to 31 bits
+  static constexpr Version max_snapshot_delta_distance = 0x7FFFFFFF;
+
   static bool has_claims(const EntryType& et)
   {
     return et == EntryType::WriteSetWithClaims ||
@@ -469,8 +487,13 @@ namespace ccf::kv
     virtual ccf::SeqNo get_committed_seqno() = 0;
     virtual std::optional<NodeId> primary() = 0;
 
+    // pre_authenticated is set for messages received in a batch, which was
+    // authenticated as a whole
     virtual void recv_message(
-      const NodeId& from, const uint8_t* data, size_t size) = 0;
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false) = 0;
 
     virtual void periodic(std::chrono::milliseconds) {}
     virtual void periodic_end() {}
@@ -509,6 +532,14 @@ namespace ccf::kv
   public:
     virtual PendingTxInfo call() = 0;
     virtual ~PendingTx() = default;
+
+    // If false, call() does not depend on previous transactions having been
+    // committed (unlike signatures, which sign the root of the Merkle tree),
+    // so that it can be called outside of the ordered commit section
+    virtual bool requires_ordered_call() const
+    {
+      return true;
+    }
   };
 
   class MovePendingTx : public PendingTx
@@ -540,6 +571,32 @@ namespace ccf::kv
         std::move(commit_evidence_digest),
         std::move(hooks));
     }
+
+    bool requires_ordered_call() const override
+    {
+      return false;
+    }
+  };
+
+  // Pending transaction whose content has already been computed, before
+  // entering the ordered commit section
+  class PreparedPendingTx : public PendingTx
+  {
+  private:
+    PendingTxInfo info;
+
+  public:
+    PreparedPendingTx(PendingTxInfo&& info_) : info(std::move(info_)) {}
+
+    PendingTxInfo call() override
+    {
+      return std::move(info);
+    }
+
+    bool requires_ordered_call() const override
+    {
+      return false;
+    }
   };
 
   class AbstractTxEncryptor
@@ -556,9 +613,9 @@ namespace ccf::kv
       EntryType entry_type = EntryType::WriteSet,
       bool historical_hint = false) = 0;
     virtual bool decrypt(
-      const std::vector<uint8_t>& cipher,
-      const std::vector<uint8_t>& additional_data,
-      const std::vector<uint8_t>& serialised_header,
+      std::span<const uint8_t> cipher,
+      std::span<const uint8_t> additional_data,
+      std::span<const uint8_t> serialised_header,
       std::vector<uint8_t>& plain,
       Version version,
       Term& term,
@@ -616,7 +673,19 @@ namespace ccf::kv
     {
     public:
       virtual ~Snapshot() = default;
+      // Serialises the (immutable) state of the map ahead of serialise(), so
+      // that snapshots of distinct maps can be prepared concurrently
+      virtual void prepare() = 0;
+      // Size of the buffer held by this snapshot once prepared, until it is
+      // serialised
+      virtual size_t get_serialised_size() const = 0;
       virtual void serialise(KvStoreSerialiser& s) = 0;
+      // Serialises only the changes since base (nullptr if the map did not
+      // exist at base). Returns false, without serialising anything, if the
+      // map is unchanged.
+      virtual bool serialise_delta(
+        KvStoreSerialiser& s, const Snapshot* base) = 0;
+      virtual const std::string& get_name() const = 0;
       virtual SecurityDomain get_security_domain() const = 0;
     };
 
@@ -646,14 +715,59 @@ namespace ccf::kv
 
   class Tx;
 
+  // A serialised transaction which is not copied when deserialised, but
+  // borrowed from a larger buffer (e.g. a received message containing several
+  // transactions). The buffer must outlive any execution wrapper deserialised
+  // from the view. Either the caller guarantees this, or the view shares
+  // ownership of the buffer through owner.
+  struct EntryView
+  {
+    std::span<const uint8_t> data;
+    std::shared_ptr<const void> owner = nullptr;
+
+    explicit EntryView(
+      std::span<const uint8_t> data_,
+      std::shared_ptr<const void> owner_ = nullptr) :
+      data(data_),
+      owner(std::move(owner_))
+    {}
+
+    // Returns a view over a copy of data, which the view owns
+    static EntryView copy_of(std::span<const uint8_t> data)
+    {
+      auto copy =
+        std::make_shared<const std::vector<uint8_t>>(data.begin(), data.end());
+      return EntryView(*copy, copy);
+    }
+  };
+
   class AbstractExecutionWrapper
   {
   public:
     virtual ~AbstractExecutionWrapper() = default;
     virtual ccf::kv::ApplyResult apply(
       bool track_deletes_on_missing_keys = false) = 0;
+
+    // Optionally does the work of apply() which does not depend on the state
+    // of the store (e.g. decrypting the transaction), so that this can be done
+    // concurrently for several transactions before they are applied in order.
+    // Returns false if this was not possible, in which case apply() does this
+    // work itself.
+    virtual bool prepare()
+    {
+      return false;
+    }
+
     virtual ccf::kv::ConsensusHookPtrs& get_hooks() = 0;
-    virtual const std::vector<uint8_t>& get_entry() = 0;
+    virtual std::span<const uint8_t> get_entry() = 0;
+
+    // Number of bytes copied out of the entry by apply(), e.g. the decrypted
+    // private domain, and keys and values written to the store
+    virtual size_t get_bytes_copied()
+    {
+      return 0;
+    }
+
     virtual ccf::kv::Term get_term() = 0;
     virtual ccf::kv::Version get_index() = 0;
     virtual bool support_async_execution() = 0;
@@ -686,8 +800,17 @@ namespace ccf::kv
     public:
       virtual ~AbstractSnapshot() = default;
       virtual Version get_version() const = 0;
+      virtual size_t get_map_count() const = 0;
+      // May be called concurrently for distinct map indices, but not
+      // concurrently with serialise()
+      virtual void prepare_map(size_t idx) = 0;
+      virtual size_t get_map_serialised_size(size_t idx) const = 0;
       virtual std::vector<uint8_t> serialise(
         const std::shared_ptr<AbstractTxEncryptor>& encryptor) = 0;
+      virtual std::vector<uint8_t> serialise_delta(
+        const std::shared_ptr<AbstractTxEncryptor>& encryptor,
+        const AbstractSnapshot& base,
+        const ccf::crypto::Sha256Hash& base_digest) = 0;
     };
 
     virtual ~AbstractStore() {}
@@ -720,6 +843,10 @@ namespace ccf::kv
       const std::vector<uint8_t>& data,
       bool public_only = false,
       const std::optional<TxID>& expected_txid = std::nullopt) = 0;
+    virtual std::unique_ptr<AbstractExecutionWrapper> deserialize(
+      const EntryView& entry,
+      bool public_only = false,
+      const std::optional<TxID>& expected_txid = std::nullopt) = 0;
     virtual void compact(Version v) = 0;
     virtual void rollback(const TxID& tx_id, Term write_term_) = 0;
     virtual void initialise_term(Term t) = 0;
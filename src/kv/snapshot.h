@@ -4,6 +4,8 @@
 
 #include "kv/kv_types.h"
 
+#include <algorithm>
+
 namespace ccf::kv
 {
   class StoreSnapshot : public AbstractStore::AbstractSnapshot
@@ -39,6 +41,21 @@ namespace ccf::kv
       return version;
     }
 
+    size_t get_map_count() const override
+    {
+      return snapshots.size();
+    }
+
+    void prepare_map(size_t idx) override
+    {
+      snapshots.at(idx)->prepare();
+    }
+
+    size_t get_map_serialised_size(size_t idx) const override
+    {
+      return snapshots.at(idx)->get_serialised_size();
+    }
+
     std::vector<uint8_t> serialise(
       const std::shared_ptr<AbstractTxEncryptor>& encryptor) override
     {
@@ -60,14 +77,90 @@ namespace ccf::kv
         ccf::no_claims(),
         true /* historical_hint */);
 
-      if (hash_at_snapshot.has_value())
+      serialise_header(serialiser);
+
+      for (auto domain : {SecurityDomain::PUBLIC, SecurityDomain::PRIVATE})
       {
-        serialiser.serialise_raw(hash_at_snapshot.value());
+        for (const auto& it : snapshots)
+        {
+          if (it->get_security_domain() == domain)
+          {
+            it->serialise(serialiser);
+          }
+        }
       }
 
-      if (view_history.has_value())
+      return serialiser.get_raw_data();
+    }
+
+    std::vector<uint8_t> serialise_delta(
+      const std::shared_ptr<AbstractTxEncryptor>& encryptor,
+      const AbstractSnapshot& base_,
+      const ccf::crypto::Sha256Hash& base_digest) override
+    {
+      const auto& base = dynamic_cast<const StoreSnapshot&>(base_);
+      if (base.version >= version)
       {
-        serialiser.serialise_view_history(view_history.value());
+        throw std::logic_error(fmt::format(
+          "Cannot create delta snapshot at {} from later base snapshot at {}",
+          version,
+          base.version));
+      }
+
+      const auto distance = version - base.version;
+      if (distance > max_snapshot_delta_distance)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot create delta snapshot at {} from base snapshot at {}: "
+          "distance exceeds {}",
+          version,
+          base.version,
+          max_snapshot_delta_distance));
+      }
+
+      // A delta snapshot only contains the maps and keys written since its
+      // base snapshot, whose version and digest are recorded so that the
+      // snapshot evidence of the delta also covers its base.
+      // The distance to the base is used as the IV term. It is never 0 (the
+      // term of full snapshots) and identifies the base, so that snapshots at
+      // the same version but from different bases do not reuse IVs.
+      KvStoreSerialiser serialiser(
+        encryptor,
+        {static_cast<Term>(distance), version},
+        ccf::kv::EntryType::SnapshotDelta,
+        0,
+        {},
+        ccf::no_claims(),
+        true /* historical_hint */);
+
+      serialiser.serialise_entry_version(base.version);
+      serialiser.serialise_raw({base_digest.h.begin(), base_digest.h.end()});
+
+      serialise_header(serialiser);
+
+      std::map<std::string, const AbstractMap::Snapshot*> base_maps;
+      for (const auto& it : base.snapshots)
+      {
+        base_maps[it->get_name()] = it.get();
+      }
+
+      // Maps are only ever removed when the transaction creating them is
+      // rolled back, which cannot happen to maps included in a (compacted)
+      // base snapshot. Deltas therefore never need to record removed maps.
+      for (const auto& [name, _] : base_maps)
+      {
+        if (!std::any_of(
+              snapshots.begin(), snapshots.end(), [&name](const auto& it) {
+                return it->get_name() == name;
+              }))
+        {
+          throw std::logic_error(fmt::format(
+            "Cannot create delta snapshot at {}: map {} of base snapshot at {} "
+            "no longer exists",
+            version,
+            name,
+            base.version));
+        }
       }
 
       for (auto domain : {SecurityDomain::PUBLIC, SecurityDomain::PRIVATE})
@@ -76,12 +169,29 @@ namespace ccf::kv
         {
           if (it->get_security_domain() == domain)
           {
-            it->serialise(serialiser);
+            auto search = base_maps.find(it->get_name());
+            it->serialise_delta(
+              serialiser,
+              search != base_maps.end() ? search->second : nullptr);
           }
         }
       }
 
       return serialiser.get_raw_data();
     }
+
+  private:
+    void serialise_header(KvStoreSerialiser& serialiser)
+    {
+      if (hash_at_snapshot.has_value())
+      {
+        serialiser.serialise_raw(hash_at_snapshot.value());
+      }
+
+      if (view_history.has_value())
+      {
+        serialiser.serialise_view_history(view_history.value());
+      }
+    }
   };
 }
\ No newline at end of file
@@ -56,8 +56,13 @@ namespace ccf::kv
 
     Version rollback_count = 0;
 
-    std::unordered_map<Version, std::tuple<std::unique_ptr<PendingTx>, bool>>
-      pending_txs;
+    // Pending transactions, whether they are globally committable, and their
+    // Merkle tree leaf if it was computed before the ordered commit section
+    using PendingTxEntry = std::tuple<
+      std::unique_ptr<PendingTx>,
+      bool,
+      std::optional<ccf::crypto::Sha256Hash>>;
+    std::unordered_map<Version, PendingTxEntry> pending_txs;
 
   public:
     void clear()
@@ -109,6 +114,11 @@ namespace ccf::kv
     // Ledger entry header flags
     uint8_t flags = 0;
 
+    // Version and digest of the last snapshot applied to this store, on top of
+    // which a delta snapshot may be applied
+    std::optional<std::pair<Version, ccf::crypto::Sha256Hash>>
+      last_applied_snapshot = std::nullopt;
+
     bool commit_deserialised(
       OrderedChanges& changes,
       Version v,
@@ -402,6 +412,33 @@ namespace ccf::kv
         return ApplyResult::FAIL;
       }
       auto v = v_.value();
+
+      // A delta snapshot can only be applied on top of the exact snapshot it
+      // was generated from, with no other transaction applied since
+      const bool is_delta = d.get_entry_type() == EntryType::SnapshotDelta;
+      if (is_delta)
+      {
+        auto base_version = d.deserialise_entry_version();
+        auto base_digest = d.deserialise_raw();
+        if (
+          !last_applied_snapshot.has_value() ||
+          last_applied_snapshot->first != base_version ||
+          current_version() != base_version ||
+          !std::equal(
+            base_digest.begin(),
+            base_digest.end(),
+            last_applied_snapshot->second.h.begin(),
+            last_applied_snapshot->second.h.end()))
+        {
+          LOG_FAIL_FMT(
+            "Cannot apply delta snapshot at version {}: base snapshot at "
+            "version {} was not the last applied snapshot",
+            v,
+            base_version);
+          return ApplyResult::FAIL;
+        }
+      }
+
       std::shared_ptr<TxHistory> h = nullptr;
       std::vector<uint8_t> hash_at_snapshot;
       std::vector<Version> view_history_;
@@ -458,7 +495,8 @@ namespace ccf::kv
             return ApplyResult::FAIL;
           }
 
-          auto deserialised_snapshot_changes =
+          auto deserialised_snapshot_changes = is_delta ?
+            map->deserialise_snapshot_delta_changes(d) :
             map->deserialise_snapshot_changes(d);
 
           // Take ownership of the produced change set, store it to be committed
@@ -507,6 +545,8 @@ namespace ccf::kv
           version = v;
           last_replicated = v;
         }
+
+        last_applied_snapshot = {v, ccf::crypto::Sha256Hash(data, size)};
       }
 
       if (h)
@@ -687,7 +727,7 @@ namespace ccf::kv
     }
 
     bool fill_maps(
-      const std::vector<uint8_t>& data,
+      std::span<const uint8_t> data,
       bool public_only,
       ccf::kv::Version& v,
       ccf::kv::Term& view,
@@ -695,27 +735,31 @@ namespace ccf::kv
       MapCollection& new_maps,
       ccf::ClaimsDigest& claims_digest,
       std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
-      bool ignore_strict_versions = false) override
+      size_t& bytes_copied,
+      bool ignore_strict_versions = false,
+      std::unique_ptr<KvStoreDeserialiser> prepared = nullptr) override
     {
       // This will return FAILED if the serialised transaction is being
       // applied out of order.
       // Processing transactions locally and also deserialising to the
       // same store will result in a store version mismatch and
       // deserialisation will then fail.
-      auto e = get_encryptor();
-
-      auto d = KvStoreDeserialiser(
-        e,
-        public_only ? ccf::kv::SecurityDomain::PUBLIC :
-                      std::optional<ccf::kv::SecurityDomain>());
-
-      auto v_ = d.init(data.data(), data.size(), view, is_historical);
-      if (!v_.has_value())
+      if (prepared == nullptr)
       {
-        LOG_FAIL_FMT("Initialisation of deserialise object failed");
-        return false;
+        prepared = std::make_unique<KvStoreDeserialiser>(
+          get_encryptor(),
+          public_only ? ccf::kv::SecurityDomain::PUBLIC :
+                        std::optional<ccf::kv::SecurityDomain>());
+
+        if (!prepared->init(data.data(), data.size(), view, is_historical)
+               .has_value())
+        {
+          LOG_FAIL_FMT("Initialisation of deserialise object failed");
+          return false;
+        }
       }
-      v = v_.value();
+      auto& d = *prepared;
+      v = d.get_version();
 
       claims_digest = std::move(d.consume_claims_digest());
       LOG_TRACE_FMT(
@@ -793,16 +837,47 @@ namespace ccf::kv
         return false;
       }
 
+      bytes_copied = d.get_bytes_copied();
       return true;
     }
 
+    std::unique_ptr<KvStoreDeserialiser> prepare_deserialiser(
+      std::span<const uint8_t> data,
+      bool public_only,
+      ccf::kv::Term& view) override
+    {
+      auto d = std::make_unique<KvStoreDeserialiser>(
+        get_encryptor(),
+        public_only ? ccf::kv::SecurityDomain::PUBLIC :
+                      std::optional<ccf::kv::SecurityDomain>());
+
+      // Transactions may be prepared out of order, so the ledger secret for
+      // each is looked up by its version, rather than by assuming it follows
+      // the previously decrypted transaction
+      const bool historical_hint = true;
+      if (!d->init(data.data(), data.size(), view, historical_hint)
+             .has_value())
+      {
+        return nullptr;
+      }
+      return d;
+    }
+
     std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
       const std::vector<uint8_t>& data,
       bool public_only = false,
       const std::optional<TxID>& expected_txid = std::nullopt) override
+    {
+      return deserialize(EntryView::copy_of(data), public_only, expected_txid);
+    }
+
+    std::unique_ptr<ccf::kv::AbstractExecutionWrapper> deserialize(
+      const EntryView& entry,
+      bool public_only = false,
+      const std::optional<TxID>& expected_txid = std::nullopt) override
     {
       auto exec = std::make_unique<CFTExecutionWrapper>(
-        this, get_history(), std::move(data), public_only, expected_txid);
+        this, get_history(), entry, public_only, expected_txid);
       return exec;
     }
 
@@ -882,6 +957,24 @@ namespace ccf::kv
         return CommitResult::SUCCESS;
       }
 
+      auto h = get_history();
+
+      // Transactions whose content does not depend on the commit order are
+      // framed and hashed before entering the ordered commit section, so that
+      // this is done concurrently by the committing threads. Only appending
+      // to the Merkle tree and replicating remain serialised.
+      std::optional<ccf::crypto::Sha256Hash> leaf = std::nullopt;
+      if (!pending_tx->requires_ordered_call())
+      {
+        auto info = pending_tx->call();
+        if (h)
+        {
+          leaf = ccf::entry_leaf(
+            info.data, info.commit_evidence_digest, info.claims_digest);
+        }
+        pending_tx = std::make_unique<PreparedPendingTx>(std::move(info));
+      }
+
       std::lock_guard<ccf::pal::Mutex> cguard(commit_lock);
 
       LOG_DEBUG_FMT(
@@ -895,9 +988,7 @@ namespace ccf::kv
       Version previous_rollback_count = 0;
       ccf::View replication_view = 0;
 
-      std::vector<std::tuple<std::unique_ptr<PendingTx>, bool>>
-        contiguous_pending_txs;
-      auto h = get_history();
+      std::vector<PendingTxEntry> contiguous_pending_txs;
 
       {
         std::lock_guard<ccf::pal::Mutex> vguard(version_lock);
@@ -920,7 +1011,8 @@ namespace ccf::kv
 
         pending_txs.insert(
           {txid.version,
-           std::make_tuple(std::move(pending_tx), globally_committable)});
+           std::make_tuple(
+             std::move(pending_tx), globally_committable, std::move(leaf))});
 
         LOG_TRACE_FMT("Inserting pending tx at {}", txid.version);
 
@@ -958,7 +1050,7 @@ namespace ccf::kv
       }
 
       size_t offset = 1;
-      for (auto& [pending_tx_, committable_] : contiguous_pending_txs)
+      for (auto& [pending_tx_, committable_, leaf_] : contiguous_pending_txs)
       {
         auto
           [success_, data_, claims_digest_, commit_evidence_digest_, hooks_] =
@@ -980,8 +1072,10 @@ namespace ccf::kv
         if (h)
         {
           h->append_entry(
-            ccf::entry_leaf(
-              *data_shared, commit_evidence_digest_, claims_digest_),
+            leaf_.has_value() ?
+              leaf_.value() :
+              ccf::entry_leaf(
+                *data_shared, commit_evidence_digest_, claims_digest_),
             replication_view);
         }
 
@@ -6,9 +6,11 @@
 #include "kv/store.h"
 #include "kv/test/stub_consensus.h"
 #include "node/encryptor.h"
+#include "node/history.h"
 
 #include <picobench/picobench.hpp>
 #include <string>
+#include <thread>
 
 using KeyType = ccf::kv::serialisers::SerialisedEntry;
 using ValueType = ccf::kv::serialisers::SerialisedEntry;
@@ -162,6 +164,66 @@ static void commit_latency(picobench::state& s)
   s.stop_timer();
 }
 
+// Commits s.iterations() transactions from WRITERS concurrent threads, each
+// writing a 1KB value to one of 100 keys in its own map (so that transactions
+// do not conflict)
+template <size_t WRITERS>
+static void concurrent_commit(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  ccf::kv::Store kv_store;
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  kv_store.set_consensus(consensus);
+
+  auto kp = ccf::crypto::make_key_pair(ccf::crypto::CurveID::SECP384R1);
+  auto history = std::make_shared<ccf::NullTxHistory>(
+    kv_store, ccf::kv::test::PrimaryNodeId, *kp);
+  kv_store.set_history(history);
+
+  auto secrets = create_ledger_secrets();
+  auto encryptor = std::make_shared<ccf::NodeEncryptor>(secrets);
+  kv_store.set_encryptor(encryptor);
+
+  const ValueType value(1024, 'v');
+  const size_t tx_per_writer = s.iterations() / WRITERS;
+
+  s.start_timer();
+  std::vector<std::thread> writers;
+  for (size_t w = 0; w < WRITERS; ++w)
+  {
+    writers.emplace_back([&kv_store, &value, tx_per_writer, w]() {
+      ccf::crypto::openssl_sha256_init();
+      const auto map_name = fmt::format("map{}", w);
+      for (size_t i = 0; i < tx_per_writer; ++i)
+      {
+        auto tx = kv_store.create_tx();
+        auto handle = tx.rw<MapType>(map_name);
+        handle->put(gen_key(i % 100), value);
+        auto rc = tx.commit();
+        if (rc != ccf::kv::CommitResult::SUCCESS)
+        {
+          throw std::logic_error(
+            "Transaction commit failed: " + std::to_string(rc));
+        }
+
+        // Compact regularly, as a node would on commit, so that the cost of
+        // a commit does not depend on the number of previous transactions
+        if (i % 100 == 0)
+        {
+          kv_store.compact(kv_store.current_version());
+        }
+      }
+      ccf::crypto::openssl_sha256_shutdown();
+    });
+  }
+  for (auto& writer : writers)
+  {
+    writer.join();
+  }
+  s.stop_timer();
+}
+
 template <size_t KEY_COUNT>
 static void ser_snap(picobench::state& s)
 {
@@ -200,6 +262,65 @@ static void ser_snap(picobench::state& s)
   s.stop_timer();
 }
 
+// Serialises a snapshot of s.iterations() large maps, with the serialisation
+// of the maps first spread across THREAD_COUNT threads (as the snapshotter
+// does across worker threads)
+template <size_t THREAD_COUNT>
+static void par_ser_snap(picobench::state& s)
+{
+  ccf::logger::config::level() = ccf::LoggerLevel::INFO;
+
+  constexpr size_t key_count = 100000;
+
+  ccf::kv::Store kv_store;
+  auto secrets = create_ledger_secrets();
+  auto encryptor = std::make_shared<ccf::NodeEncryptor>(secrets);
+  kv_store.set_encryptor(encryptor);
+
+  auto tx = kv_store.create_tx();
+  for (int i = 0; i < s.iterations(); i++)
+  {
+    auto handle = tx.rw<MapType>(fmt::format("map{}", i));
+    for (size_t j = 0; j < key_count; j++)
+    {
+      const auto key = gen_key(j);
+      const auto value = gen_value(j);
+
+      handle->put(key, value);
+    }
+  }
+
+  auto rc = tx.commit();
+  if (rc != ccf::kv::CommitResult::SUCCESS)
+    throw std::logic_error("Transaction commit failed: " + std::to_string(rc));
+
+  s.start_timer();
+
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snap = nullptr;
+  {
+    ccf::kv::ScopedStoreMapsLock maps_lock(&kv_store);
+    snap = kv_store.snapshot_unsafe_maps(tx.commit_version());
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREAD_COUNT; ++t)
+  {
+    threads.emplace_back([&snap, t]() {
+      for (size_t i = t; i < snap->get_map_count(); i += THREAD_COUNT)
+      {
+        snap->prepare_map(i);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  kv_store.serialise_snapshot(std::move(snap));
+  s.stop_timer();
+}
+
 template <size_t KEY_COUNT>
 static void des_snap(picobench::state& s)
 {
@@ -252,6 +373,16 @@ PICOBENCH_SUITE("commit_latency");
 PICOBENCH(commit_latency<10>).iterations(tx_count).samples(10).baseline();
 PICOBENCH(commit_latency<100>).iterations(tx_count).samples(10);
 
+const std::vector<int> concurrent_tx_count = {1600, 16000};
+
+PICOBENCH_SUITE("concurrent_commit");
+PICOBENCH(concurrent_commit<1>)
+  .iterations(concurrent_tx_count)
+  .samples(10)
+  .baseline();
+PICOBENCH(concurrent_commit<4>).iterations(concurrent_tx_count).samples(10);
+PICOBENCH(concurrent_commit<16>).iterations(concurrent_tx_count).samples(10);
+
 PICOBENCH_SUITE("serialise");
 PICOBENCH(serialise<SD::PUBLIC>)
   .iterations(tx_count)
@@ -276,6 +407,20 @@ PICOBENCH(ser_snap<100>)
   .baseline();
 PICOBENCH(ser_snap<1000>).iterations(map_count).samples(snapshot_sample_size);
 
+const std::vector<int> large_map_count = {1, 4, 16};
+
+PICOBENCH_SUITE("serialise_snapshot_parallel");
+PICOBENCH(par_ser_snap<1>)
+  .iterations(large_map_count)
+  .samples(snapshot_sample_size)
+  .baseline();
+PICOBENCH(par_ser_snap<4>)
+  .iterations(large_map_count)
+  .samples(snapshot_sample_size);
+PICOBENCH(par_ser_snap<16>)
+  .iterations(large_map_count)
+  .samples(snapshot_sample_size);
+
 PICOBENCH_SUITE("deserialise_snapshot");
 PICOBENCH(des_snap<100>)
   .iterations(map_count)
@@ -713,4 +713,56 @@ TEST_CASE(
     REQUIRE(handle_priv->get("privk1") == "privv1");
     REQUIRE(handle_pub->get("pubk1") == "pubv1");
   }
-}
\ No newline at end of file
+}
+TEST_CASE(
+  "Deserialisation reports bytes copied" *
+  doctest::test_suite("serialisation"))
+{
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+
+  ccf::kv::Store kv_store;
+  kv_store.set_consensus(consensus);
+  kv_store.set_encryptor(encryptor);
+
+  ccf::kv::Store kv_store_target;
+  kv_store_target.set_encryptor(encryptor);
+
+  MapTypes::StringString pub_map("public:pub_map");
+  MapTypes::StringString priv_map("priv_map");
+
+  const std::string k1 = "key1";
+  const std::string k2 = "key2";
+  const std::string v1(1024, 'a');
+
+  using KS = MapTypes::StringString::KeySerialiser;
+  using VS = MapTypes::StringString::ValueSerialiser;
+  const auto key_size = KS::to_serialised(k1).size();
+  const auto value_size = VS::to_serialised(v1).size();
+
+  INFO("Public keys and values written to the store are counted");
+  {
+    auto tx = kv_store.create_tx();
+    tx.rw(pub_map)->put(k1, v1);
+    tx.rw(pub_map)->remove(k2);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+
+    auto wrapper =
+      kv_store_target.deserialize(consensus->get_latest_data().value());
+    REQUIRE(wrapper->get_bytes_copied() == 0);
+    REQUIRE(wrapper->apply() == ccf::kv::ApplyResult::PASS);
+    REQUIRE(wrapper->get_bytes_copied() == 2 * key_size + value_size);
+  }
+
+  INFO("The decrypted private domain is counted too");
+  {
+    auto tx = kv_store.create_tx();
+    tx.rw(priv_map)->put(k1, v1);
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+
+    auto wrapper =
+      kv_store_target.deserialize(consensus->get_latest_data().value());
+    REQUIRE(wrapper->apply() == ccf::kv::ApplyResult::PASS);
+    REQUIRE(wrapper->get_bytes_copied() > 2 * (key_size + value_size));
+  }
+}
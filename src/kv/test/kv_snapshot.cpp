@@ -6,6 +6,7 @@
 #include "kv/test/null_encryptor.h"
 
 #include <doctest/doctest.h>
+#include <thread>
 #undef FAIL
 
 struct MapTypes
@@ -584,4 +585,284 @@ TEST_CASE("Commit hooks with snapshot" * doctest::test_suite("snapshot"))
       }
     }
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Delta snapshot" * doctest::test_suite("snapshot"))
+{
+  ccf::kv::Store store;
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  store.set_encryptor(encryptor);
+
+  MapTypes::StringString other_map("public:other_map");
+  constexpr size_t large_map_size = 100;
+
+  ccf::kv::Version base_version = ccf::kv::NoVersion;
+  ccf::kv::Version delta_version = ccf::kv::NoVersion;
+
+  INFO("Apply transactions to original store");
+  {
+    auto tx1 = store.create_tx();
+    auto handle_s = tx1.rw(string_map);
+    handle_s->put("foo", "bar");
+    handle_s->put("baz", "hello");
+    auto handle_n = tx1.rw(num_map);
+    for (size_t i = 0; i < large_map_size; ++i)
+    {
+      handle_n->put(i, i);
+    }
+    REQUIRE(tx1.commit() == ccf::kv::CommitResult::SUCCESS);
+    base_version = tx1.commit_version();
+  }
+
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> base_snapshot =
+    nullptr;
+  {
+    ccf::kv::ScopedStoreMapsLock maps_lock(&store);
+    base_snapshot = store.snapshot_unsafe_maps(base_version);
+  }
+  auto base_serialised = base_snapshot->serialise(encryptor);
+  const auto base_digest = ccf::crypto::Sha256Hash(base_serialised);
+
+  INFO("Modify, remove and create entries and maps");
+  {
+    auto tx2 = store.create_tx();
+    auto handle_s = tx2.rw(string_map);
+    handle_s->remove("baz");
+    handle_s->put("foo", "updated");
+    auto handle_n = tx2.rw(num_map);
+    handle_n->put(42, 123);
+    auto handle_o = tx2.rw(other_map);
+    handle_o->put("new", "map");
+    REQUIRE(tx2.commit() == ccf::kv::CommitResult::SUCCESS);
+    delta_version = tx2.commit_version();
+  }
+
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot =
+    nullptr;
+  {
+    ccf::kv::ScopedStoreMapsLock maps_lock(&store);
+    snapshot = store.snapshot_unsafe_maps(delta_version);
+  }
+  auto delta_serialised =
+    snapshot->serialise_delta(encryptor, *base_snapshot, base_digest);
+  const auto delta_digest = ccf::crypto::Sha256Hash(delta_serialised);
+  auto full_serialised = snapshot->serialise(encryptor);
+
+  INFO("Delta only contains changes since base");
+  {
+    REQUIRE(delta_serialised.size() < full_serialised.size());
+    REQUIRE(delta_serialised.size() < base_serialised.size());
+  }
+
+  INFO("Apply base and delta snapshots to new store");
+  {
+    ccf::kv::Store new_store;
+    new_store.set_encryptor(encryptor);
+
+    ccf::kv::ConsensusHookPtrs hooks;
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        base_serialised.data(), base_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        delta_serialised.data(), delta_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+    REQUIRE_EQ(new_store.current_version(), delta_version);
+
+    auto tx = new_store.create_tx();
+    auto handle_s = tx.ro(string_map);
+    REQUIRE_EQ(handle_s->get("foo").value(), "updated");
+    REQUIRE_EQ(
+      handle_s->get_version_of_previous_write("foo").value(), delta_version);
+    REQUIRE(!handle_s->has("baz"));
+
+    auto handle_n = tx.ro(num_map);
+    REQUIRE_EQ(handle_n->size(), large_map_size);
+    REQUIRE_EQ(handle_n->get(42).value(), 123);
+    REQUIRE_EQ(
+      handle_n->get_version_of_previous_write(42).value(), delta_version);
+    REQUIRE_EQ(handle_n->get(41).value(), 41);
+    REQUIRE_EQ(
+      handle_n->get_version_of_previous_write(41).value(), base_version);
+
+    auto handle_o = tx.ro(other_map);
+    REQUIRE_EQ(handle_o->get("new").value(), "map");
+  }
+
+  INFO("Delta cannot be applied without its base");
+  {
+    ccf::kv::Store new_store;
+    new_store.set_encryptor(encryptor);
+
+    ccf::kv::ConsensusHookPtrs hooks;
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        delta_serialised.data(), delta_serialised.size(), hooks),
+      ccf::kv::ApplyResult::FAIL);
+  }
+
+  INFO("Delta cannot be applied on a different base");
+  {
+    std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot =
+      nullptr;
+    {
+      ccf::kv::ScopedStoreMapsLock maps_lock(&store);
+      snapshot = store.snapshot_unsafe_maps(delta_version);
+    }
+    auto wrong_delta_serialised = snapshot->serialise_delta(
+      encryptor, *base_snapshot, ccf::crypto::Sha256Hash("wrong base"));
+
+    ccf::kv::Store new_store;
+    new_store.set_encryptor(encryptor);
+
+    ccf::kv::ConsensusHookPtrs hooks;
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        base_serialised.data(), base_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        wrong_delta_serialised.data(), wrong_delta_serialised.size(), hooks),
+      ccf::kv::ApplyResult::FAIL);
+    REQUIRE_EQ(new_store.current_version(), base_version);
+
+    REQUIRE_THROWS(base_snapshot->serialise_delta(
+      encryptor, *snapshot, ccf::crypto::Sha256Hash(full_serialised)));
+  }
+
+  INFO("Deltas can be chained");
+  {
+    ccf::kv::Version chained_version = ccf::kv::NoVersion;
+    {
+      auto tx = store.create_tx();
+      auto handle_s = tx.rw(string_map);
+      handle_s->put("baz", "again");
+      REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+      chained_version = tx.commit_version();
+    }
+
+    std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> chained_snapshot =
+      nullptr;
+    {
+      ccf::kv::ScopedStoreMapsLock maps_lock(&store);
+      chained_snapshot = store.snapshot_unsafe_maps(chained_version);
+    }
+    auto chained_serialised =
+      chained_snapshot->serialise_delta(encryptor, *snapshot, delta_digest);
+
+    ccf::kv::Store new_store;
+    new_store.set_encryptor(encryptor);
+
+    ccf::kv::ConsensusHookPtrs hooks;
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        base_serialised.data(), base_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+
+    INFO("Links of the chain cannot be skipped");
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        chained_serialised.data(), chained_serialised.size(), hooks),
+      ccf::kv::ApplyResult::FAIL);
+
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        delta_serialised.data(), delta_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+    REQUIRE_EQ(
+      new_store.deserialise_snapshot(
+        chained_serialised.data(), chained_serialised.size(), hooks),
+      ccf::kv::ApplyResult::PASS);
+    REQUIRE_EQ(new_store.current_version(), chained_version);
+
+    auto tx = new_store.create_tx();
+    auto handle_s = tx.ro(string_map);
+    REQUIRE_EQ(handle_s->get("foo").value(), "updated");
+    REQUIRE_EQ(handle_s->get("baz").value(), "again");
+    REQUIRE_EQ(tx.ro(num_map)->get(42).value(), 123);
+  }
+}
+
+TEST_CASE(
+  "Snapshot maps prepared concurrently" * doctest::test_suite("snapshot"))
+{
+  ccf::kv::Store store;
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  store.set_encryptor(encryptor);
+
+  constexpr size_t maps_count = 16;
+  constexpr size_t keys_count = 100;
+  constexpr size_t threads_count = 4;
+
+  auto tx = store.create_tx();
+  for (size_t i = 0; i < maps_count; ++i)
+  {
+    auto handle = tx.rw<MapTypes::NumNum>(fmt::format("public:map_{}", i));
+    for (size_t j = 0; j < keys_count; ++j)
+    {
+      handle->put(j, i * j);
+    }
+  }
+  REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  const auto snapshot_version = tx.commit_version();
+
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot>
+    sequential_snapshot = nullptr;
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot>
+    concurrent_snapshot = nullptr;
+  std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot>
+    partially_prepared_snapshot = nullptr;
+  {
+    ccf::kv::ScopedStoreMapsLock maps_lock(&store);
+    sequential_snapshot = store.snapshot_unsafe_maps(snapshot_version);
+    concurrent_snapshot = store.snapshot_unsafe_maps(snapshot_version);
+    partially_prepared_snapshot = store.snapshot_unsafe_maps(snapshot_version);
+  }
+  REQUIRE_EQ(concurrent_snapshot->get_map_count(), maps_count);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; ++t)
+  {
+    threads.emplace_back([&concurrent_snapshot, t]() {
+      for (size_t i = t; i < concurrent_snapshot->get_map_count();
+           i += threads_count)
+      {
+        concurrent_snapshot->prepare_map(i);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // Only prepare some maps ahead, within a budget of prepared bytes
+  size_t total_size = 0;
+  for (size_t i = 0; i < maps_count; ++i)
+  {
+    total_size += partially_prepared_snapshot->get_map_serialised_size(i);
+  }
+  REQUIRE(total_size > 0);
+  size_t prepared_size = 0;
+  for (size_t i = 0; i < maps_count; ++i)
+  {
+    const auto size = partially_prepared_snapshot->get_map_serialised_size(i);
+    if (prepared_size + size <= total_size / 2)
+    {
+      partially_prepared_snapshot->prepare_map(i);
+      prepared_size += size;
+    }
+  }
+
+  INFO("Serialised snapshot does not depend on how maps were prepared");
+  {
+    const auto serialised =
+      store.serialise_snapshot(std::move(sequential_snapshot));
+    REQUIRE_EQ(
+      store.serialise_snapshot(std::move(concurrent_snapshot)), serialised);
+    REQUIRE_EQ(
+      store.serialise_snapshot(std::move(partially_prepared_snapshot)),
+      serialised);
+  }
+}
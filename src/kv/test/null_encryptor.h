@@ -24,15 +24,15 @@ namespace ccf::kv
     }
 
     bool decrypt(
-      const std::vector<uint8_t>& cipher,
-      const std::vector<uint8_t>& additional_data,
-      const std::vector<uint8_t>& serialised_header,
+      std::span<const uint8_t> cipher,
+      std::span<const uint8_t> additional_data,
+      std::span<const uint8_t> serialised_header,
       std::vector<uint8_t>& plain,
       Version version,
       Term& term,
       bool historical_hint = false) override
     {
-      plain = cipher;
+      plain = {cipher.begin(), cipher.end()};
       term = 0;
       return true;
     }
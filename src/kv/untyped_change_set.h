@@ -83,6 +83,9 @@ namespace ccf::kv::untyped
   {
     const ccf::kv::untyped::State state;
     const Version version;
+    // Only set for delta snapshots: entries written or removed since the base
+    // snapshot
+    const std::optional<ccf::kv::untyped::Write> delta_writes = std::nullopt;
 
     SnapshotChangeSet(
       ccf::kv::untyped::State&& snapshot_state, Version version_) :
@@ -90,6 +93,15 @@ namespace ccf::kv::untyped
       version(version_)
     {}
 
+    SnapshotChangeSet(
+      ccf::kv::untyped::State&& snapshot_state,
+      Version version_,
+      ccf::kv::untyped::Write&& delta_writes_) :
+      state(std::move(snapshot_state)),
+      version(version_),
+      delta_writes(std::move(delta_writes_))
+    {}
+
     SnapshotChangeSet(SnapshotChangeSet&) = delete;
 
     bool has_writes() const override
@@ -86,10 +86,15 @@ namespace ccf::kv::untyped
     ccf::pal::Mutex sl;
     const SecurityDomain security_domain;
 
-    static State deserialize_map_snapshot(
-      std::span<const uint8_t> serialized_state)
+    // Entries removed since the base of a delta snapshot are serialised with
+    // this (negative, when signed) version
+    static constexpr Version removed_version =
+      std::numeric_limits<Version>::max();
+
+    template <class F>
+    static void foreach_serialised_entry(
+      std::span<const uint8_t> serialized_state, F&& f)
     {
-      State map;
       const uint8_t* data = serialized_state.data();
       size_t size = serialized_state.size();
 
@@ -107,14 +112,24 @@ namespace ccf::kv::untyped
         value_size -= size;
         serialized::skip(data, size, map::get_padding(value_size));
 
-        // Version was previously signed, with negative values indicating
-        // deletions. Maintain ability to parse those snapshots, but do not
-        // retain these deletions locally.
-        if ((int64_t)value.version >= 0)
-        {
-          map = map.put(key, value);
-        }
+        f(std::move(key), std::move(value));
       }
+    }
+
+    static State deserialize_map_snapshot(
+      std::span<const uint8_t> serialized_state)
+    {
+      State map;
+      foreach_serialised_entry(
+        serialized_state, [&map](K&& key, VersionV&& value) {
+          // Version was previously signed, with negative values indicating
+          // deletions. Maintain ability to parse those snapshots, but do not
+          // retain these deletions locally.
+          if ((int64_t)value.version >= 0)
+          {
+            map = map.put(key, value);
+          }
+        });
       return map;
     }
 
@@ -297,6 +312,9 @@ namespace ccf::kv::untyped
 
       std::unique_ptr<StateSnapshot> map_snapshot;
 
+      // Set by prepare(), and released once written to the serialiser
+      std::optional<std::vector<uint8_t>> serialised_state = std::nullopt;
+
     public:
       Snapshot(
         const std::string& name_,
@@ -309,15 +327,106 @@ namespace ccf::kv::untyped
         map_snapshot(std::move(map_snapshot_))
       {}
 
+      void prepare() override
+      {
+        if (serialised_state.has_value())
+        {
+          return;
+        }
+
+        std::vector<uint8_t> ret(map_snapshot->get_serialized_size());
+        map_snapshot->serialize(ret.data());
+        serialised_state = std::move(ret);
+      }
+
+      size_t get_serialised_size() const override
+      {
+        return map_snapshot->get_serialized_size();
+      }
+
       void serialise(KvStoreSerialiser& s) override
       {
         LOG_TRACE_FMT("Serialising snapshot for map: {}", name);
+        // Maps that were not prepared ahead are prepared lazily, so that only
+        // one of their buffers is held at a time
+        prepare();
+
         s.start_map(name, security_domain);
         s.serialise_entry_version(version);
+        s.serialise_raw(serialised_state.value());
+        serialised_state.reset();
+      }
 
-        std::vector<uint8_t> ret(map_snapshot->get_serialized_size());
-        map_snapshot->serialize(ret.data());
+      bool serialise_delta(
+        KvStoreSerialiser& s, const AbstractMap::Snapshot* base_) override
+      {
+        static const VersionV removed = {removed_version, NoVersion, {}};
+
+        const auto* base = dynamic_cast<const Snapshot*>(base_);
+        const State empty;
+        const auto& base_state =
+          base != nullptr ? base->map_snapshot->get_map() : empty;
+
+        struct DeltaEntry
+        {
+          size_t h_k;
+          const K* k;
+          const VersionV* v;
+        };
+        std::vector<DeltaEntry> entries;
+        size_t serialized_size = 0;
+        auto add_entry = [&entries, &serialized_size](
+                           const K& k, const VersionV& v) {
+          entries.push_back({H()(k), &k, &v});
+          serialized_size += map::get_serialized_size_with_padding(k) +
+            map::get_serialized_size_with_padding(v);
+        };
+
+        map_snapshot->get_map().foreach_diff(
+          base_state,
+          [&add_entry](const K& k, const VersionV& v) { add_entry(k, v); },
+          [&add_entry](const K& k) { add_entry(k, removed); });
+
+        if (entries.empty() && base != nullptr && base->version == version)
+        {
+          // Map is unchanged since base
+          return false;
+        }
+
+        LOG_TRACE_FMT(
+          "Serialising delta snapshot for map: {} ({} entries)",
+          name,
+          entries.size());
+
+        // Sort keys to be able to generate byte-for-byte serialised snapshot
+        // from the same state
+        std::sort(
+          entries.begin(),
+          entries.end(),
+          [](const DeltaEntry& i, const DeltaEntry& j) {
+            return i.h_k < j.h_k || (i.h_k == j.h_k && *i.k < *j.k);
+          });
+
+        s.start_map(name, security_domain);
+        s.serialise_entry_version(version);
+
+        std::vector<uint8_t> ret(serialized_size);
+        auto data = ret.data();
+        for (const auto& e : entries)
+        {
+          uint32_t key_size = map::serialize(*e.k, data, serialized_size);
+          map::add_padding(key_size, data, serialized_size);
+
+          uint32_t value_size = map::serialize(*e.v, data, serialized_size);
+          map::add_padding(value_size, data, serialized_size);
+        }
         s.serialise_raw(ret);
+        return true;
+      }
+
+      const std::string& get_name() const override
+      {
+        return name;
       }
 
       SecurityDomain get_security_domain() const override
@@ -459,13 +568,21 @@ namespace ccf::kv::untyped
         r->version = change_set.version;
 
         // Executing hooks from snapshot requires copying the entire snapshotted
-        // state so only do it if there's a hook on the table
+        // state so only do it if there's a hook on the table. Delta snapshots
+        // only report the entries written or removed since their base.
         if (map.hook || map.global_hook)
         {
-          r->state.foreach([&r](const K& k, const VersionV& v) {
-            r->writes[k] = v.value;
-            return true;
-          });
+          if (change_set.delta_writes.has_value())
+          {
+            r->writes = change_set.delta_writes.value();
+          }
+          else
+          {
+            r->state.foreach([&r](const K& k, const VersionV& v) {
+              r->writes[k] = v.value;
+              return true;
+            });
+          }
         }
       }
 
@@ -486,6 +603,33 @@ namespace ccf::kv::untyped
         deserialize_map_snapshot(map_snapshot), v);
     }
 
+    ChangeSetPtr deserialise_snapshot_delta_changes(KvStoreDeserialiser& d)
+    {
+      // Create a change set applying d's delta on top of the latest state of
+      // the map. The Map expects to be locked.
+      auto v = d.deserialise_entry_version();
+      auto delta = d.deserialise_raw();
+
+      auto state = roll.commits->get_tail()->state;
+      Write writes;
+      foreach_serialised_entry(
+        delta, [&state, &writes](K&& key, VersionV&& value) {
+          if ((int64_t)value.version >= 0)
+          {
+            writes[key] = value.value;
+            state = state.put(key, value);
+          }
+          else
+          {
+            writes[key] = std::nullopt;
+            state = state.remove(key);
+          }
+        });
+
+      return std::make_unique<SnapshotChangeSet>(
+        std::move(state), v, std::move(writes));
+    }
+
     ChangeSetPtr deserialise_changes(KvStoreDeserialiser& d, Version version)
     {
       return deserialise_internal(d, version);
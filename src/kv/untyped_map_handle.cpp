@@ -110,6 +110,17 @@ namespace ccf::kv::untyped
     return *value_p;
   }
 
+  const MapHandle::ValueType* MapHandle::get_ptr(const MapHandle::KeyType& key)
+  {
+    auto value_p = read_key(key);
+    LOG_TRACE_FMT(
+      "KV[{}]::get_ptr({}) - {}found",
+      map_name,
+      key,
+      value_p != nullptr ? "" : "not ");
+    return value_p;
+  }
+
   std::optional<Version> MapHandle::get_version_of_previous_write(
     const MapHandle::KeyType& key)
   {
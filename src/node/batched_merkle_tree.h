@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include <merklecpp/merklecpp.h>
+#include <vector>
+
+namespace ccf
+{
+  // merkle::TreeT hashes dirty nodes one at a time, as it walks down to them
+  // from the root. Before each operation which needs the root, this hashes
+  // all dirty nodes of the tree first, one height at a time, with a single
+  // call to BATCH_HASH_FUNCTION per height (e.g. hashing several nodes at once
+  // with SIMD), so that merkle::TreeT then finds none left to hash.
+  //
+  // BATCH_HASH_FUNCTION(n, l, r, out) must set out[i] to the hash of l[i] and
+  // r[i], as HASH_FUNCTION does, for each of the n independent nodes.
+  template <
+    size_t HASH_SIZE,
+    void HASH_FUNCTION(
+      const merkle::HashT<HASH_SIZE>& l,
+      const merkle::HashT<HASH_SIZE>& r,
+      merkle::HashT<HASH_SIZE>& out),
+    void BATCH_HASH_FUNCTION(
+      size_t n,
+      const uint8_t* const* l,
+      const uint8_t* const* r,
+      uint8_t* const* out)>
+  class BatchedMerkleTreeT : public merkle::TreeT<HASH_SIZE, HASH_FUNCTION>
+  {
+  private:
+    using Base = merkle::TreeT<HASH_SIZE, HASH_FUNCTION>;
+    using Node = typename Base::Node;
+
+    // Dirty nodes by height, and arguments of BATCH_HASH_FUNCTION, kept
+    // across calls to avoid re-allocating them
+    std::vector<std::vector<Node*>> levels;
+    std::vector<Node*> stack;
+    std::vector<const uint8_t*> lefts;
+    std::vector<const uint8_t*> rights;
+    std::vector<uint8_t*> outs;
+
+    void hash_dirty_nodes()
+    {
+      if (this->num_leaves() == 0)
+      {
+        // Left to merkle::TreeT, which throws if the root is needed
+        return;
+      }
+
+      this->insert_leaves(true);
+      Node* root = this->_root;
+      if (root == nullptr || !root->dirty)
+      {
+        return;
+      }
+
+      // Leaves are never dirty, and children are always lower than their
+      // parent, so the nodes of each height can be hashed once all lower
+      // ones are
+      if (levels.size() < root->height + 1u)
+      {
+        levels.resize(root->height + 1u);
+      }
+      stack.push_back(root);
+      while (!stack.empty())
+      {
+        Node* n = stack.back();
+        stack.pop_back();
+        levels[n->height].push_back(n);
+        if (n->left->dirty)
+        {
+          stack.push_back(n->left);
+        }
+        if (n->right->dirty)
+        {
+          stack.push_back(n->right);
+        }
+      }
+
+      for (auto& level : levels)
+      {
+        if (level.empty())
+        {
+          continue;
+        }
+
+        lefts.clear();
+        rights.clear();
+        outs.clear();
+        for (Node* n : level)
+        {
+          lefts.push_back(n->left->hash.bytes);
+          rights.push_back(n->right->hash.bytes);
+          outs.push_back(n->hash.bytes);
+        }
+        BATCH_HASH_FUNCTION(
+          level.size(), lefts.data(), rights.data(), outs.data());
+        this->statistics.num_hash += level.size();
+
+        for (Node* n : level)
+        {
+          n->dirty = false;
+        }
+        level.clear();
+      }
+    }
+
+  public:
+    using Hash = typename Base::Hash;
+    using Path = typename Base::Path;
+
+    using Base::Base;
+
+    // Operations which compute the root first. retract_to() does too, but is
+    // left to merkle::TreeT, since it first drops the leaves it retracts.
+
+    const Hash& root()
+    {
+      hash_dirty_nodes();
+      return Base::root();
+    }
+
+    std::shared_ptr<Hash> past_root(size_t index)
+    {
+      hash_dirty_nodes();
+      return Base::past_root(index);
+    }
+
+    std::shared_ptr<Path> path(size_t index)
+    {
+      hash_dirty_nodes();
+      return Base::path(index);
+    }
+
+    std::shared_ptr<Path> past_path(size_t index, size_t as_of)
+    {
+      hash_dirty_nodes();
+      return Base::past_path(index, as_of);
+    }
+
+    void flush_to(size_t index)
+    {
+      hash_dirty_nodes();
+      Base::flush_to(index);
+    }
+
+    void serialise(std::vector<uint8_t>& bytes)
+    {
+      hash_dirty_nodes();
+      Base::serialise(bytes);
+    }
+
+    void serialise(size_t from, size_t to, std::vector<uint8_t>& bytes)
+    {
+      hash_dirty_nodes();
+      Base::serialise(from, to, bytes);
+    }
+
+    size_t serialised_size()
+    {
+      hash_dirty_nodes();
+      return Base::serialised_size();
+    }
+
+    size_t serialised_size(size_t from, size_t to)
+    {
+      hash_dirty_nodes();
+      return Base::serialised_size(from, to);
+    }
+  };
+}
@@ -12,6 +12,7 @@
 #include "ccf/ds/logger.h"
 #include "ccf/entity_id.h"
 #include "ccf/pal/locking.h"
+#include "consensus/aft/raft_types.h"
 #include "crypto/key_exchange.h"
 #include "ds/serialized.h"
 #include "ds/state_machine.h"
@@ -159,11 +160,17 @@ namespace ccf
   // Note this assumes that the key exchange messages are reliably delivered,
   // else we switch keys without telling the peer that we did.
 
-  class Channel
+  class Channel : public std::enable_shared_from_this<Channel>
   {
   public:
     static std::chrono::microseconds min_gap_between_initiation_attempts;
 
+    // When batching, messages up to this size are sealed together with the
+    // other messages sent on the channel before the batch is flushed, and a
+    // batch is flushed at once when it reaches max_batch_size
+    static constexpr size_t max_batched_message_size = 16 * 1024;
+    static constexpr size_t max_batch_size = 64 * 1024;
+
   private:
     struct OutgoingMsg
     {
@@ -220,6 +227,21 @@ namespace ccf
     static constexpr size_t outgoing_forwarding_queue_size = 10;
     std::vector<OutgoingMsg> outgoing_forwarding_msgs;
 
+    // If batching is enabled, small messages sent on the established channel
+    // are appended here (type, size, then the message as it would otherwise
+    // be framed, with a blank GCM header), and sealed together as a single
+    // batched_msg once the tasks already queued on the sending thread have
+    // run
+    bool batching = false;
+    std::vector<uint8_t> outgoing_batch;
+    uint64_t outgoing_batch_count = 0;
+    bool batch_flush_scheduled = false;
+
+    struct FlushBatchMsg
+    {
+      std::shared_ptr<Channel> self;
+    };
+
     // Used to prevent replayed messages.
     // Set to the latest successfully received nonce.
     MsgNonce local_recv_nonce = {0};
@@ -310,6 +332,108 @@ namespace ccf
       return decrypt(header, aad, {}, empty_plaintext);
     }
 
+    bool is_batchable(
+      NodeMsgType type,
+      std::span<const uint8_t> aad,
+      std::span<const uint8_t> plain) const
+    {
+      if (
+        !batching || type == NodeMsgType::channel_msg ||
+        aad.size() + plain.size() > max_batched_message_size)
+      {
+        return false;
+      }
+
+      // The host affixes ledger entries to each AppendEntries, so these must
+      // remain individually framed
+      if (type == NodeMsgType::consensus_msg)
+      {
+        const uint8_t* data = aad.data();
+        size_t size = aad.size();
+        return size < sizeof(aft::RaftMsgType) ||
+          serialized::peek<aft::RaftMsgType>(data, size) !=
+          aft::raft_append_entries;
+      }
+
+      return true;
+    }
+
+    static void flush_batch_cb(
+      std::unique_ptr<::threading::Tmsg<FlushBatchMsg>> msg)
+    {
+      msg->data.self->flush_batch();
+    }
+
+    void append_to_batch(
+      NodeMsgType type,
+      std::span<const uint8_t> aad,
+      std::span<const uint8_t> plain)
+    {
+      static const GcmHdr blank_gcm_hdr;
+      const auto gcm_hdr_serialised = blank_gcm_hdr.serialise();
+
+      append_value(outgoing_batch, type);
+      append_value(
+        outgoing_batch, aad.size() + gcm_hdr_serialised.size() + plain.size());
+      outgoing_batch.insert(outgoing_batch.end(), aad.begin(), aad.end());
+      outgoing_batch.insert(
+        outgoing_batch.end(),
+        gcm_hdr_serialised.begin(),
+        gcm_hdr_serialised.end());
+      outgoing_batch.insert(outgoing_batch.end(), plain.begin(), plain.end());
+      ++outgoing_batch_count;
+
+      CHANNEL_SEND_TRACE(
+        "batched({}, {} bytes, {} bytes) ({} in batch)",
+        (size_t)type,
+        aad.size(),
+        plain.size(),
+        outgoing_batch_count);
+
+      if (outgoing_batch.size() >= max_batch_size)
+      {
+        flush_batch_unsafe();
+      }
+      else if (!batch_flush_scheduled)
+      {
+        batch_flush_scheduled = true;
+        auto msg =
+          std::make_unique<::threading::Tmsg<FlushBatchMsg>>(&flush_batch_cb);
+        msg->data.self = shared_from_this();
+        ::threading::ThreadMessaging::instance().add_task(
+          ccf::threading::get_current_thread_id(), std::move(msg));
+      }
+    }
+
+    void flush_batch_unsafe()
+    {
+      if (outgoing_batch.empty())
+      {
+        return;
+      }
+
+      if (send_key == nullptr)
+      {
+        // Channel was closed, or reached its hard message limit, since these
+        // messages were batched. Like any message sent on a closed channel,
+        // they are lost
+        CHANNEL_SEND_FAIL(
+          "Dropping {} batched messages - no send key",
+          outgoing_batch_count);
+      }
+      else
+      {
+        const uint64_t count = outgoing_batch_count;
+        seal_and_write(
+          NodeMsgType::batched_msg,
+          {reinterpret_cast<const uint8_t*>(&count), sizeof(count)},
+          outgoing_batch);
+      }
+
+      outgoing_batch.clear();
+      outgoing_batch_count = 0;
+    }
+
     void send_key_exchange_init()
     {
       std::vector<uint8_t> payload;
@@ -914,6 +1038,23 @@ namespace ccf
         }
       }
 
+      if (is_batchable(type, aad, plain))
+      {
+        append_to_batch(type, aad, plain);
+        return true;
+      }
+
+      // Preserve ordering with any messages already batched
+      flush_batch_unsafe();
+      seal_and_write(type, aad, plain);
+      return true;
+    }
+
+    void seal_and_write(
+      NodeMsgType type,
+      std::span<const uint8_t> aad,
+      std::span<const uint8_t> plain)
+    {
       auto nonce = send_nonce.fetch_add(1);
       WireNonce wire_nonce(nonce);
 
@@ -949,8 +1090,6 @@ namespace ccf
         node_outbound, to_host, peer_id.value(), type, self.value(), payload);
 
       check_message_limit();
-
-      return true;
     }
 
   public:
@@ -1107,11 +1246,68 @@ namespace ccf
       RINGBUFFER_WRITE_MESSAGE(close_node_outbound, to_host, peer_id.value());
       reset_key_exchange();
       outgoing_consensus_msg.reset();
+      outgoing_batch.clear();
+      outgoing_batch_count = 0;
 
       recv_key.reset();
       send_key.reset();
     }
 
+    void set_batching(bool batching_)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      batching = batching_;
+      if (!batching)
+      {
+        flush_batch_unsafe();
+      }
+    }
+
+    void flush_batch()
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      batch_flush_scheduled = false;
+      flush_batch_unsafe();
+    }
+
+    // Verifies and decrypts a batched_msg, returning the number of messages it
+    // contains and their concatenation
+    std::optional<std::pair<uint64_t, std::vector<uint8_t>>> recv_batch(
+      const uint8_t* data, size_t size)
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+
+      if (recv_key == nullptr)
+      {
+        LOG_INFO_FMT(
+          "Node channel with {} cannot receive batched messages: not "
+          "established a receive key, status={}",
+          peer_id,
+          status.value());
+        advance_connection_attempt();
+        return std::nullopt;
+      }
+
+      const uint8_t* aad = data;
+      const auto count = serialized::read<uint64_t>(data, size);
+
+      GcmHdr hdr;
+      hdr.deserialise(data, size);
+
+      std::vector<uint8_t> plain;
+      if (!decrypt(
+            hdr,
+            {aad, sizeof(count)},
+            std::span<const uint8_t>(data, size),
+            plain))
+      {
+        CHANNEL_RECV_FAIL("Failed to decrypt batched node messages");
+        return std::nullopt;
+      }
+
+      return std::make_pair(count, std::move(plain));
+    }
+
     bool recv_key_exchange_message(const uint8_t* data, size_t size)
     {
       std::lock_guard<ccf::pal::Mutex> guard(lock);
@@ -1371,7 +1371,8 @@ namespace ccf::historical
           }
         }
 
-        auto exec = store->deserialize({data, data + size}, public_only);
+        auto exec = store->deserialize(
+          ccf::kv::EntryView({data, size}), public_only);
         if (exec == nullptr)
         {
           result = ccf::kv::ApplyResult::FAIL;
@@ -10,6 +10,7 @@
 #include "crypto/openssl/cose_sign.h"
 #include "crypto/openssl/hash.h"
 #include "crypto/openssl/key_pair.h"
+#include "crypto/sha256_pairs.h"
 #include "ds/thread_messaging.h"
 #include "enclave/enclave_time.h"
 #include "endian.h"
@@ -26,6 +27,8 @@
 // merklecpp traces are off by default, even when CCF tracing is enabled
 // #include "merklecpp_trace.h"
 #include <merklecpp/merklecpp.h>
+// Included after merklecpp, so that it is configured as above
+#include "batched_merkle_tree.h"
 
 FMT_BEGIN_NAMESPACE
 template <>
@@ -256,7 +259,12 @@ namespace ccf
     ccf::crypto::openssl_sha256(block, out.bytes);
   }
 
-  using HistoryTree = merkle::TreeT<sha256_byte_size, ccf::sha256_history>;
+  // Nodes of the same height are hashed together, several at once where the
+  // CPU supports it (see sha256_pairs)
+  using HistoryTree = BatchedMerkleTreeT<
+    sha256_byte_size,
+    ccf::sha256_history,
+    ccf::crypto::sha256_pairs>;
 
   class Proof
   {
@@ -52,11 +52,14 @@ namespace ccf
         // iterator on the last used secret to access ledger secrets in constant
         // time.
         auto& last_used_secret_it_ = last_used_secret_it.value();
-        if (
+        while (
           std::next(last_used_secret_it_) != ledger_secrets.end() &&
           version >= std::next(last_used_secret_it_)->first)
         {
-          // Across a rekey, start using the next key
+          // Across a rekey, start using the next key. Transactions decrypted
+          // ahead of being applied (see ccf::kv::Store::prepare_deserialiser)
+          // do not advance this iterator, so several rekeys may be crossed
+          // at once.
           ++last_used_secret_it_;
         }
 
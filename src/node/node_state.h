@@ -93,7 +93,7 @@ namespace ccf
     pal::PlatformAttestationMeasurement node_measurement;
     ccf::StartupConfig config;
     std::optional<UVMEndorsements> snp_uvm_endorsements = std::nullopt;
-    std::vector<uint8_t> startup_snapshot;
+    SnapshotChain startup_snapshot;
     std::shared_ptr<QuoteEndorsementsClient> quote_endorsements_client =
       nullptr;
 
@@ -463,7 +463,7 @@ namespace ccf
     NodeCreateInfo create(
       StartType start_type_,
       ccf::StartupConfig&& config_,
-      std::vector<uint8_t>&& startup_snapshot_)
+      SnapshotChain&& startup_snapshot_)
     {
       std::lock_guard<pal::Mutex> guard(lock);
       sm.expect(NodeStartupState::initialized);
@@ -907,7 +907,7 @@ namespace ccf
 
       while (size > 0)
       {
-        auto entry = ::consensus::LedgerEnclave::get_entry(data, size);
+        auto entry = ::consensus::LedgerEnclave::get_entry_view(data, size);
 
         LOG_INFO_FMT(
           "Deserialising public ledger entry #{} [{} bytes]",
@@ -919,7 +919,8 @@ namespace ccf
         ccf::kv::ApplyResult result = ccf::kv::ApplyResult::FAIL;
         try
         {
-          auto r = network.tables->deserialize(entry, true);
+          auto r =
+            network.tables->deserialize(ccf::kv::EntryView(entry), true);
           result = r->apply();
           if (result == ccf::kv::ApplyResult::FAIL)
           {
@@ -1124,7 +1125,7 @@ namespace ccf
 
       while (size > 0)
       {
-        auto entry = ::consensus::LedgerEnclave::get_entry(data, size);
+        auto entry = ::consensus::LedgerEnclave::get_entry_view(data, size);
 
         LOG_INFO_FMT("Deserialising private ledger entry [{}]", entry.size());
 
@@ -1132,7 +1133,8 @@ namespace ccf
         ccf::kv::ApplyResult result = ccf::kv::ApplyResult::FAIL;
         try
         {
-          result = recovery_store->deserialize(entry)->apply();
+          result =
+            recovery_store->deserialize(ccf::kv::EntryView(entry))->apply();
           if (result == ccf::kv::ApplyResult::FAIL)
           {
             LOG_FAIL_FMT(
@@ -1625,12 +1627,33 @@ namespace ccf
       auto [msg_type, from, payload] =
         ringbuffer::read_message<node_inbound>(data, size);
 
-      auto payload_data = payload.data;
-      auto payload_size = payload.size;
+      recv_node_message(msg_type, from, payload.data, payload.size);
+    }
 
+    // pre_authenticated is set for the messages of a batch, which have been
+    // authenticated and decrypted along with it
+    void recv_node_message(
+      NodeMsgType msg_type,
+      const NodeId& from,
+      const uint8_t* payload_data,
+      size_t payload_size,
+      bool pre_authenticated = false)
+    {
       if (msg_type == NodeMsgType::forwarded_msg)
       {
-        cmd_forwarder->recv_message(from, payload_data, payload_size);
+        cmd_forwarder->recv_message(
+          from, payload_data, payload_size, pre_authenticated);
+      }
+      else if (msg_type == NodeMsgType::batched_msg)
+      {
+        // Each message in the batch is handled as if received individually
+        n2n_channels->recv_batched_messages(
+          from,
+          payload_data,
+          payload_size,
+          [this, &from](NodeMsgType type, const uint8_t* data, size_t size) {
+            recv_node_message(type, from, data, size, true);
+          });
       }
       else
       {
@@ -1657,7 +1680,8 @@ namespace ccf
 
           case consensus_msg:
           {
-            consensus->recv_message(from, payload_data, payload_size);
+            consensus->recv_message(
+              from, payload_data, payload_size, pre_authenticated);
             break;
           }
 
@@ -2647,7 +2671,10 @@ namespace ccf
         throw std::logic_error("Snapshotter already initialised");
       }
       snapshotter = std::make_shared<Snapshotter>(
-        writer_factory, network.tables, config.snapshot_tx_interval);
+        writer_factory,
+        network.tables,
+        config.snapshot_tx_interval,
+        config.snapshot_max_delta_chain_length);
     }
 
     void read_ledger_entries(::consensus::Index from, ::consensus::Index to)
@@ -2729,6 +2756,11 @@ namespace ccf
       n2n_channels->set_message_limit(message_limit);
     }
 
+    void set_n2n_message_batching(bool message_batching)
+    {
+      n2n_channels->set_message_batching(message_batching);
+    }
+
     void set_n2n_idle_timeout(std::chrono::milliseconds idle_timeout)
     {
       n2n_channels->set_idle_timeout(idle_timeout);
@@ -2787,11 +2819,6 @@ namespace ccf
       client->send_request(std::move(req));
     }
 
-    void write_snapshot(std::span<uint8_t> snapshot_buf, size_t request_id)
-    {
-      snapshotter->write_snapshot(snapshot_buf, request_id);
-    }
-
     virtual std::shared_ptr<ccf::kv::Store> get_store() override
     {
       return network.tables;
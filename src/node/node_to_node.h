@@ -8,6 +8,7 @@
 #include "node_types.h"
 
 #include <algorithm>
+#include <functional>
 #define FMT_HEADER_ONLY
 #include <fmt/format.h>
 
@@ -51,14 +52,23 @@ namespace ccf
     virtual bool send_authenticated(
       const NodeId& to, NodeMsgType type, const uint8_t* data, size_t size) = 0;
 
+    // If pre_authenticated, the message was received in a batch, which was
+    // authenticated as a whole, and is not verified again
     template <class T>
     const T& recv_authenticated(
-      const NodeId& from, const uint8_t*& data, size_t& size)
+      const NodeId& from,
+      const uint8_t*& data,
+      size_t& size,
+      bool pre_authenticated = false)
     {
       std::span<const uint8_t> ts(data, sizeof(T));
       auto& t = serialized::overlay<T>(data, size);
 
-      if (!recv_authenticated(from, ts, data, size))
+      if (pre_authenticated)
+      {
+        recv_pre_authenticated(data, size);
+      }
+      else if (!recv_authenticated(from, ts, data, size))
       {
         throw DroppedMessageException(from);
       }
@@ -93,9 +103,27 @@ namespace ccf
       const uint8_t*& data,
       size_t& size) = 0;
 
+    // Skips the header of a message received in a batch, leaving data pointing
+    // to its payload, which the batch's decryption has already authenticated
+    // (and decrypted)
+    virtual void recv_pre_authenticated(const uint8_t*& data, size_t& size) = 0;
+
     virtual bool recv_channel_message(
       const NodeId& from, const uint8_t* data, size_t size) = 0;
 
+    using BatchedMessageHandler =
+      std::function<void(NodeMsgType, const uint8_t*, size_t)>;
+
+    // Authenticates and decrypts a batched_msg, then passes each of the
+    // messages it contains, in order, to handler. Those messages must then be
+    // received with pre_authenticated set, since they carry no authentication
+    // of their own
+    virtual bool recv_batched_messages(
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      const BatchedMessageHandler& handler) = 0;
+
     virtual void initialize(
       const NodeId& self_id,
       const ccf::crypto::Pem& service_cert,
@@ -123,13 +151,24 @@ namespace ccf
       return send_encrypted(to, type, hdr_s, data);
     }
 
+    // If pre_authenticated, the message was received in a batch, which was
+    // decrypted as a whole, and its payload is already plaintext
     template <class T>
     std::pair<T, std::vector<uint8_t>> recv_encrypted(
-      const NodeId& from, const uint8_t*& data, size_t& size)
+      const NodeId& from,
+      const uint8_t*& data,
+      size_t& size,
+      bool pre_authenticated = false)
     {
       std::span<const uint8_t> ts(data, sizeof(T));
       auto t = serialized::read<T>(data, size);
 
+      if (pre_authenticated)
+      {
+        recv_pre_authenticated(data, size);
+        return std::make_pair(t, std::vector<uint8_t>(data, data + size));
+      }
+
       std::vector<uint8_t> plain = recv_encrypted(from, ts, data, size);
       return std::make_pair(t, plain);
     }
@@ -141,6 +180,7 @@ namespace ccf
       size_t size) = 0;
 
     virtual void set_message_limit(size_t message_limit) = 0;
+    virtual void set_message_batching(bool batching) = 0;
     virtual void set_idle_timeout(std::chrono::milliseconds idle_timeout) = 0;
 
     virtual void tick(std::chrono::milliseconds elapsed) = 0;
@@ -46,6 +46,10 @@ namespace ccf
     // configuration. Before that, no timeout applies
     std::optional<std::chrono::milliseconds> idle_timeout = std::nullopt;
 
+    // This is set during node startup, from the run-time configuration. Nodes
+    // can always receive batched messages, whether or not they send them
+    bool message_batching = false;
+
     std::shared_ptr<Channel> get_channel(const NodeId& peer_id)
     {
       CCF_ASSERT_FMT(
@@ -79,6 +83,7 @@ namespace ccf
         this_node->node_id,
         peer_id,
         message_limit.value());
+      channel->set_batching(message_batching);
       auto info = ChannelInfo{channel, std::chrono::milliseconds(0)};
       channels.try_emplace(peer_id, info);
       return channel;
@@ -129,6 +134,16 @@ namespace ccf
       message_limit = message_limit_;
     }
 
+    void set_message_batching(bool message_batching_) override
+    {
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      message_batching = message_batching_;
+      for (auto& [_, info] : channels)
+      {
+        info.channel->set_batching(message_batching);
+      }
+    }
+
     void set_idle_timeout(std::chrono::milliseconds idle_timeout_) override
     {
       idle_timeout = idle_timeout_;
@@ -258,6 +273,13 @@ namespace ccf
       return plain.value();
     }
 
+    void recv_pre_authenticated(const uint8_t*& data, size_t& size) override
+    {
+      // Blank, as written by the sender's batch
+      GcmHdr hdr;
+      hdr.deserialise(data, size);
+    }
+
     bool recv_channel_message(
       const NodeId& from, const uint8_t* data, size_t size) override
     {
@@ -270,6 +292,89 @@ namespace ccf
       return get_channel(from)->recv_key_exchange_message(data, size);
     }
 
+    bool recv_batched_messages(
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      const BatchedMessageHandler& handler) override
+    {
+      CCF_ASSERT_FMT(
+        this_node != nullptr,
+        "Calling recv_batched_messages (from {}) before channel manager is "
+        "initialized",
+        from);
+
+      auto channel = get_channel(from);
+      auto batch = channel->recv_batch(data, size);
+      if (!batch.has_value())
+      {
+        return false;
+      }
+
+      auto& [count, plain] = batch.value();
+      const uint8_t* msg_data = plain.data();
+      size_t msg_size = plain.size();
+
+      uint64_t received = 0;
+      try
+      {
+        while (msg_size > 0)
+        {
+          const auto type = serialized::read<NodeMsgType>(msg_data, msg_size);
+          const auto inner_size = serialized::read<size_t>(msg_data, msg_size);
+          if (inner_size > msg_size)
+          {
+            throw std::logic_error(fmt::format(
+              "Batched message of {} bytes exceeds remaining {} bytes",
+              inner_size,
+              msg_size));
+          }
+
+          if (type == NodeMsgType::batched_msg)
+          {
+            LOG_FAIL_FMT("Ignoring nested batch from {}", from);
+          }
+          else
+          {
+            try
+            {
+              handler(type, msg_data, inner_size);
+            }
+            catch (const DroppedMessageException& e)
+            {
+              LOG_INFO_FMT("Dropped batched message from {}", e.from);
+            }
+            catch (const std::exception& e)
+            {
+              LOG_FAIL_FMT(
+                "Exception handling batched message from {}: {}",
+                from,
+                e.what());
+            }
+          }
+
+          serialized::skip(msg_data, msg_size, inner_size);
+          ++received;
+        }
+      }
+      catch (const std::exception& e)
+      {
+        LOG_FAIL_FMT("Malformed message batch from {}: {}", from, e.what());
+      }
+
+      if (received != count)
+      {
+        LOG_FAIL_FMT(
+          "Received {} batched messages from {}, expected {}",
+          received,
+          from,
+          count);
+        return false;
+      }
+
+      return true;
+    }
+
     // NB: Following methods are only used by tests!
     bool recv_channel_message(const NodeId& from, std::vector<uint8_t>&& body)
     {
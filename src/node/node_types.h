@@ -19,11 +19,16 @@ namespace ccf
   {
     channel_msg = 0,
     consensus_msg,
-    forwarded_msg
+    forwarded_msg,
+    // Several consensus and forwarded messages, sealed together in a single
+    // frame by a channel with batching enabled
+    batched_msg
   };
-  // NB: The node-to-node channels assume only 2 types of messages exist, and
-  // treat them differently. Adding a new message type will likely need
-  // additional changes.
+  // NB: The node-to-node channels treat each type of message differently.
+  // Channel messages carry the key exchange, consensus messages are
+  // authenticated, forwarded messages are encrypted, and batched messages
+  // encrypt several of the latter two together. Adding a new message type will
+  // likely need additional changes.
 
   // Types of channel messages
   enum ChannelMsg : Node2NodeMsg
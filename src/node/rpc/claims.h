@@ -5,6 +5,8 @@
 #include "ccf/claims_digest.h"
 #include "ccf/ds/logger.h"
 
+#include <span>
+
 namespace ccf
 {
   static ClaimsDigest no_claims()
@@ -13,11 +15,12 @@ namespace ccf
   }
 
   static ccf::crypto::Sha256Hash entry_leaf(
-    const std::vector<uint8_t>& write_set,
+    std::span<const uint8_t> write_set,
     const std::optional<ccf::crypto::Sha256Hash>& commit_evidence_digest,
     const ClaimsDigest& claims_digest)
   {
-    ccf::crypto::Sha256Hash write_set_digest(write_set);
+    ccf::crypto::Sha256Hash write_set_digest(
+      write_set.data(), write_set.size());
 
     if (commit_evidence_digest.has_value())
     {
@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#pragma once
+
+#include "ds/ring_buffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace ccf
+{
+  // Transactions are executed optimistically, and re-executed when they
+  // conflict with a concurrently committed transaction. On hot maps (e.g.
+  // counters), immediately re-executing all conflicting transactions results
+  // in them repeatedly conflicting with each other. Instead, the re-execution
+  // of a transaction which conflicted on a given map takes that map's retry
+  // turn, so that retries contending on the same map are executed one at a
+  // time, while first attempts and retries on other maps still execute
+  // concurrently. A retry waiting for its turn backs off for a randomised
+  // delay, which grows exponentially with the number of times it waited.
+  // Waiting is bounded, so that a slow handler holding the turn of a hot map
+  // never stalls other worker threads indefinitely: past the bound, the retry
+  // is re-executed optimistically.
+  class ContentionManager
+  {
+  private:
+    // Backoff is at most 2^max_backoff_shift pauses (in the order of tens of
+    // microseconds)
+    static constexpr size_t max_backoff_shift = 10;
+
+    // Number of backoffs a retry waits for its turn before it is re-executed
+    // regardless (in the order of milliseconds)
+    static constexpr size_t max_turn_waits = 64;
+
+    // Maps are assigned to a fixed number of turns, so that the turn of a map
+    // never has to be created or destroyed. Maps sharing a turn only delay
+    // each other's retries, within the same bound.
+    static constexpr size_t turns_count = 64;
+    std::array<std::atomic<bool>, turns_count> retry_turns = {};
+
+    static uint64_t next_random()
+    {
+      // xorshift64, seeded differently on each thread so that transactions
+      // waiting for the same turn do not back off in lockstep
+      thread_local uint64_t state =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    }
+
+  public:
+    // Held while re-executing and committing a transaction which previously
+    // conflicted. Empty if the retry did not get its turn in time.
+    class RetryTurn
+    {
+    private:
+      std::atomic<bool>* turn = nullptr;
+
+    public:
+      RetryTurn() = default;
+      explicit RetryTurn(std::atomic<bool>* turn_) : turn(turn_) {}
+
+      RetryTurn(const RetryTurn&) = delete;
+      RetryTurn& operator=(const RetryTurn&) = delete;
+
+      RetryTurn(RetryTurn&& other) noexcept : turn(other.turn)
+      {
+        other.turn = nullptr;
+      }
+
+      RetryTurn& operator=(RetryTurn&& other) noexcept
+      {
+        release();
+        turn = other.turn;
+        other.turn = nullptr;
+        return *this;
+      }
+
+      ~RetryTurn()
+      {
+        release();
+      }
+
+      bool has_turn() const
+      {
+        return turn != nullptr;
+      }
+
+      void release()
+      {
+        if (turn != nullptr)
+        {
+          turn->store(false, std::memory_order_release);
+          turn = nullptr;
+        }
+      }
+    };
+
+    // Returns the number of pauses to back off for, after waiting waits times
+    static size_t get_backoff_pauses(size_t waits)
+    {
+      if (waits == 0)
+      {
+        return 0;
+      }
+
+      const auto shift = std::min(waits, max_backoff_shift);
+      const size_t max_pauses = size_t(1) << shift;
+      // Jittered, within [max_pauses / 2, max_pauses)
+      return max_pauses / 2 + next_random() % (max_pauses / 2);
+    }
+
+    static void backoff(size_t waits)
+    {
+      const auto pauses = get_backoff_pauses(waits);
+      for (size_t i = 0; i < pauses; ++i)
+      {
+        CCF_PAUSE();
+      }
+    }
+
+    // Waits for the retry turn of conflicting_map, before re-executing a
+    // transaction which has conflicted conflicts times
+    RetryTurn wait_for_retry_turn(
+      const std::string& conflicting_map, size_t conflicts)
+    {
+      auto& turn =
+        retry_turns[std::hash<std::string>{}(conflicting_map) % turns_count];
+      for (size_t waits = 0;; ++waits)
+      {
+        if (
+          !turn.load(std::memory_order_relaxed) &&
+          !turn.exchange(true, std::memory_order_acquire))
+        {
+          return RetryTurn(&turn);
+        }
+
+        if (waits >= max_turn_waits)
+        {
+          return RetryTurn();
+        }
+
+        // Transactions which conflicted more often back off for longer. The
+        // turn is held by a transaction being executed, which may share this
+        // core.
+        backoff(conflicts + waits);
+        std::this_thread::yield();
+      }
+    }
+  };
+}
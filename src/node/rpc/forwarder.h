@@ -191,7 +191,10 @@ namespace ccf
 
     template <typename TFwdHdr>
     std::shared_ptr<::http::HttpRpcContext> recv_forwarded_command(
-      const NodeId& from, const uint8_t* data, size_t size)
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false)
     {
       std::pair<TFwdHdr, std::vector<uint8_t>> r;
       try
@@ -199,7 +202,8 @@ namespace ccf
         LOG_TRACE_FMT("Receiving forwarded command of {} bytes", size);
         LOG_TRACE_FMT(" => {:02x}", fmt::join(data, data + size, ""));
 
-        r = n2n_channels->template recv_encrypted<TFwdHdr>(from, data, size);
+        r = n2n_channels->template recv_encrypted<TFwdHdr>(
+          from, data, size, pre_authenticated);
       }
       catch (const std::logic_error& err)
       {
@@ -279,7 +283,10 @@ namespace ccf
 
     template <typename TFwdHdr>
     std::optional<ForwardedResponseResult> recv_forwarded_response(
-      const NodeId& from, const uint8_t* data, size_t size)
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false)
     {
       std::pair<TFwdHdr, std::vector<uint8_t>> r;
       try
@@ -287,7 +294,8 @@ namespace ccf
         LOG_TRACE_FMT("Receiving response of {} bytes", size);
         LOG_TRACE_FMT(" => {:02x}", fmt::join(data, data + size, ""));
 
-        r = n2n_channels->template recv_encrypted<TFwdHdr>(from, data, size);
+        r = n2n_channels->template recv_encrypted<TFwdHdr>(
+          from, data, size, pre_authenticated);
       }
       catch (const std::logic_error& err)
       {
@@ -342,7 +350,13 @@ namespace ccf
       return fwd_handler;
     }
 
-    void recv_message(const ccf::NodeId& from, const uint8_t* data, size_t size)
+    // pre_authenticated is set for messages received in a batch, which was
+    // authenticated and decrypted as a whole
+    void recv_message(
+      const ccf::NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false)
     {
       try
       {
@@ -357,8 +371,8 @@ namespace ccf
         {
           case ForwardedMsg::forwarded_cmd_v1:
           {
-            auto ctx =
-              recv_forwarded_command<ForwardedHeader_v1>(from, data, size);
+            auto ctx = recv_forwarded_command<ForwardedHeader_v1>(
+              from, data, size, pre_authenticated);
 
             auto fwd_handler = get_forwarder_handler(ctx);
             if (fwd_handler == nullptr)
@@ -384,8 +398,8 @@ namespace ccf
 
           case ForwardedMsg::forwarded_cmd_v2:
           {
-            auto ctx =
-              recv_forwarded_command<ForwardedHeader_v2>(from, data, size);
+            auto ctx = recv_forwarded_command<ForwardedHeader_v2>(
+              from, data, size, pre_authenticated);
 
             auto fwd_handler = get_forwarder_handler(ctx);
             if (fwd_handler == nullptr)
@@ -417,7 +431,7 @@ namespace ccf
           case ForwardedMsg::forwarded_cmd_v3:
           {
             auto ctx = recv_forwarded_command<ForwardedCommandHeader_v3>(
-              from, data, size);
+              from, data, size, pre_authenticated);
 
             auto fwd_handler = get_forwarder_handler(ctx);
             if (fwd_handler == nullptr)
@@ -492,17 +506,17 @@ namespace ccf
             if (forwarded_msg == ForwardedMsg::forwarded_response_v3)
             {
               rep = recv_forwarded_response<ForwardedResponseHeader_v3>(
-                from, data, size);
+                from, data, size, pre_authenticated);
             }
             else if (forwarded_msg == ForwardedMsg::forwarded_response_v2)
             {
-              rep =
-                recv_forwarded_response<ForwardedHeader_v2>(from, data, size);
+              rep = recv_forwarded_response<ForwardedHeader_v2>(
+                from, data, size, pre_authenticated);
             }
             else
             {
-              rep =
-                recv_forwarded_response<ForwardedHeader_v1>(from, data, size);
+              rep = recv_forwarded_response<ForwardedHeader_v1>(
+                from, data, size, pre_authenticated);
             }
 
             if (!rep.has_value())
@@ -13,6 +13,7 @@
 #include "ccf/service/tables/nodes.h"
 #include "ccf/service/tables/service.h"
 #include "common/configuration.h"
+#include "contention_manager.h"
 #include "enclave/enclave_time.h"
 #include "enclave/rpc_handler.h"
 #include "forwarder.h"
@@ -25,6 +26,7 @@
 
 #define FMT_HEADER_ONLY
 
+#include <chrono>
 #include <fmt/format.h>
 #include <utility>
 #include <vector>
@@ -53,6 +55,8 @@ namespace ccf
     std::shared_ptr<NodeConfigurationSubsystem> node_configuration_subsystem =
       nullptr;
 
+    ContentionManager contention_manager;
+
     void update_consensus()
     {
       auto c = tables.get_consensus().get();
@@ -575,11 +579,15 @@ namespace ccf
     void process_command(std::shared_ptr<ccf::RpcContextImpl> ctx)
     {
       size_t attempts = 0;
+      size_t conflicts = 0;
+      std::optional<std::string> conflicting_map = std::nullopt;
+      std::chrono::microseconds auth_time{0};
       endpoints::EndpointDefinitionPtr endpoint = nullptr;
 
       const auto start_time = ccf::get_enclave_time();
 
-      process_command_inner(ctx, endpoint, attempts);
+      process_command_inner(
+        ctx, endpoint, attempts, conflicts, conflicting_map, auth_time);
 
       const auto end_time = ccf::get_enclave_time();
 
@@ -595,7 +603,10 @@ namespace ccf
         // than that, by rounding to milliseconds
         rce.exec_time = std::chrono::duration_cast<std::chrono::milliseconds>(
           end_time - start_time);
+        rce.auth_time = auth_time;
         rce.attempts = attempts;
+        rce.conflicts = conflicts;
+        rce.conflicting_map = std::move(conflicting_map);
 
         endpoints.handle_event_request_completed(rce);
       }
@@ -612,11 +623,25 @@ namespace ccf
     void process_command_inner(
       std::shared_ptr<ccf::RpcContextImpl> ctx,
       endpoints::EndpointDefinitionPtr& endpoint,
-      size_t& attempts)
+      size_t& attempts,
+      size_t& conflicts,
+      std::optional<std::string>& conflicting_map,
+      std::chrono::microseconds& auth_time)
     {
       constexpr auto max_attempts = 30;
       while (attempts < max_attempts)
       {
+        // Once a transaction has conflicted, it waits for the retry turn of
+        // the conflicting map before being re-executed, so that it does not
+        // keep conflicting with other retries on the same (hot) map. The turn
+        // is held until the end of this attempt.
+        ContentionManager::RetryTurn retry_turn;
+        if (conflicting_map.has_value())
+        {
+          retry_turn = contention_manager.wait_for_retry_turn(
+            conflicting_map.value(), conflicts);
+        }
+
         if (consensus != nullptr)
         {
           if (
@@ -720,8 +745,11 @@ namespace ccf
             }
           }
 
+          const auto auth_start = std::chrono::steady_clock::now();
           std::unique_ptr<AuthnIdentity> identity =
             get_authenticated_identity(ctx, *tx_p, endpoint);
+          auth_time += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - auth_start);
 
           auto args = ccf::EndpointContextImpl(ctx, std::move(tx_p));
           // NB: tx_p is no longer valid, and must be accessed from args, which
@@ -833,6 +861,8 @@ namespace ccf
 
             case ccf::kv::CommitResult::FAIL_CONFLICT:
             {
+              ++conflicts;
+              conflicting_map = tx.get_conflicting_map();
               break;
             }
 
@@ -6,6 +6,7 @@
 #include "ccf/common_endpoint_registry.h"
 #include "ccf/http_query.h"
 #include "ccf/js/core/context.h"
+#include "ccf/js/interpreter_cache_interface.h"
 #include "ccf/json_handler.h"
 #include "ccf/node/quote.h"
 #include "ccf/odata_error.h"
@@ -16,6 +17,7 @@
 #include "crypto/certs.h"
 #include "crypto/csr.h"
 #include "ds/std_formatters.h"
+#include "ds/thread_messaging.h"
 #include "frontend.h"
 #include "node/network_state.h"
 #include "node/rpc/jwt_management.h"
@@ -58,13 +60,26 @@ namespace ccf
   DECLARE_JSON_TYPE(GetQuotes::Out);
   DECLARE_JSON_REQUIRED_FIELDS(GetQuotes::Out, quotes);
 
+  struct ThreadMetrics
+  {
+    size_t queue_depth;
+    size_t tasks_run;
+    size_t tasks_stolen;
+  };
+
+  DECLARE_JSON_TYPE(ThreadMetrics);
+  DECLARE_JSON_REQUIRED_FIELDS(
+    ThreadMetrics, queue_depth, tasks_run, tasks_stolen);
+
   struct NodeMetrics
   {
     ccf::SessionMetrics sessions;
+    // Indexed by enclave thread ID
+    std::vector<ThreadMetrics> threads;
   };
 
   DECLARE_JSON_TYPE(NodeMetrics);
-  DECLARE_JSON_REQUIRED_FIELDS(NodeMetrics, sessions);
+  DECLARE_JSON_REQUIRED_FIELDS(NodeMetrics, sessions, threads);
 
   struct JavaScriptMetrics
   {
@@ -74,6 +89,8 @@ namespace ccf
     uint64_t max_stack_size;
     uint64_t max_execution_time;
     uint64_t max_cached_interpreters = 10;
+    // Indexed by enclave thread ID
+    std::vector<ccf::js::InterpreterCacheMetrics> interpreter_cache;
   };
 
   DECLARE_JSON_TYPE(JavaScriptMetrics);
@@ -84,7 +101,8 @@ namespace ccf
     max_heap_size,
     max_stack_size,
     max_execution_time,
-    max_cached_interpreters);
+    max_cached_interpreters,
+    interpreter_cache);
 
   struct JWTRefreshMetrics
   {
@@ -404,7 +422,7 @@ namespace ccf
       openapi_info.description =
         "This API provides public, uncredentialed access to service and node "
         "state.";
-      openapi_info.document_version = "4.11.0";
+      openapi_info.document_version = "4.16.0";
     }
 
     void init_handlers() override
@@ -1423,6 +1441,11 @@ namespace ccf
       auto node_metrics = [this](auto& args) {
         NodeMetrics nm;
         nm.sessions = node_operation.get_session_metrics();
+        for (const auto& m :
+             ::threading::ThreadMessaging::instance().get_metrics())
+        {
+          nm.threads.push_back({m.queue_depth, m.tasks_run, m.tasks_stolen});
+        }
 
         args.rpc_ctx->set_response_status(HTTP_STATUS_OK);
         args.rpc_ctx->set_response_header(
@@ -1457,6 +1480,13 @@ namespace ccf
         m.max_execution_time = options.max_execution_time_ms;
         m.max_cached_interpreters = options.max_cached_interpreters;
 
+        auto interpreter_cache =
+          context.get_subsystem<ccf::js::AbstractInterpreterCache>();
+        if (interpreter_cache != nullptr)
+        {
+          m.interpreter_cache = interpreter_cache->get_metrics();
+        }
+
         return m;
       };
 
@@ -6,6 +6,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT
 #include "ccf/app_interface.h"
 #include "ccf/ds/logger.h"
+#include "ccf/endpoint_metrics.h"
 #include "ccf/json_handler.h"
 #include "ccf/kv/map.h"
 #include "crypto/openssl/hash.h"
@@ -1473,11 +1474,10 @@ public:
   WaitPoint before_write;
   WaitPoint after_write;
 
-  struct Metrics
+  // Per-endpoint metrics, as an application would aggregate them
+  struct Metrics : public ccf::EndpointMetricsEntry
   {
-    size_t calls = 0;
-    size_t retries = 0;
-    size_t errors = 0;
+    std::string conflicting_map = "";
   };
 
   Metrics pausable_metrics;
@@ -1489,6 +1489,11 @@ public:
     {
       pausable_metrics.calls += 1;
       pausable_metrics.retries += event.attempts - 1;
+      pausable_metrics.conflicts += event.conflicts;
+      if (event.conflicting_map.has_value())
+      {
+        pausable_metrics.conflicting_map = event.conflicting_map.value();
+      }
 
       if (event.status / 100 == 4)
       {
@@ -1522,6 +1527,8 @@ public:
       j["calls"] = pausable_metrics.calls;
       j["retries"] = pausable_metrics.retries;
       j["errors"] = pausable_metrics.errors;
+      j["conflicts"] = pausable_metrics.conflicts;
+      j["conflicting_map"] = pausable_metrics.conflicting_map;
 
       ctx.rpc_ctx->set_response_body(j.dump(2));
       ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
@@ -1584,6 +1591,8 @@ TEST_CASE("Manual conflicts")
     ret.calls = body["calls"].get<size_t>();
     ret.retries = body["retries"].get<size_t>();
     ret.errors = body["errors"].get<size_t>();
+    ret.conflicts = body["conflicts"].get<size_t>();
+    ret.conflicting_map = body["conflicting_map"].get<std::string>();
     ccf::crypto::openssl_sha256_shutdown();
     return ret;
   };
@@ -1671,6 +1680,8 @@ TEST_CASE("Manual conflicts")
 
     REQUIRE(metrics_after.calls == metrics_before.calls + 1);
     REQUIRE(metrics_after.retries == metrics_before.retries + 1);
+    REQUIRE(metrics_after.conflicts == metrics_before.conflicts + 1);
+    REQUIRE(metrics_after.conflicting_map == TF::SRC);
   }
 
   {
@@ -1788,6 +1799,46 @@ TEST_CASE("Manual conflicts")
   }
 }
 
+TEST_CASE("Retry turns")
+{
+  ccf::ContentionManager contention_manager;
+  const std::string hot_map = "public:hot";
+
+  INFO("Retries on the same map take turns");
+  {
+    auto first = contention_manager.wait_for_retry_turn(hot_map, 1);
+    REQUIRE(first.has_turn());
+
+    // Waiting is bounded, after which the retry executes without a turn
+    auto second = contention_manager.wait_for_retry_turn(hot_map, 1);
+    REQUIRE_FALSE(second.has_turn());
+
+    first.release();
+    auto third = contention_manager.wait_for_retry_turn(hot_map, 1);
+    REQUIRE(third.has_turn());
+  }
+
+  INFO("Turn is released when the retry completes");
+  {
+    {
+      auto turn = contention_manager.wait_for_retry_turn(hot_map, 1);
+      REQUIRE(turn.has_turn());
+    }
+    auto turn = contention_manager.wait_for_retry_turn(hot_map, 1);
+    REQUIRE(turn.has_turn());
+  }
+
+  INFO("Conflicts are optional in endpoint metrics");
+  {
+    const auto j = nlohmann::json::parse(
+      R"({"path": "/p", "method": "GET", "calls": 1, "errors": 0, )"
+      R"("failures": 0, "retries": 0})");
+    const auto entry = j.get<ccf::EndpointMetricsEntry>();
+    REQUIRE(entry.calls == 1);
+    REQUIRE(entry.conflicts == 0);
+  }
+}
+
 int main(int argc, char** argv)
 {
   ccf::enclavetime::last_value =
@@ -27,9 +27,21 @@ namespace ccf
       Errors errors;
     };
 
+    // Totals over all TLS sessions
+    struct TLSWrites
+    {
+      // Plaintext sends, e.g. a response or an HTTP/2 frame
+      size_t sends;
+      size_t records;
+      // Messages carrying encrypted data to the host, and their total size
+      size_t host_messages;
+      size_t host_bytes;
+    };
+
     size_t active;
     size_t peak;
     std::map<std::string, PerInterface> interfaces;
+    TLSWrites tls_writes;
   };
 
   DECLARE_JSON_TYPE(SessionMetrics::Errors)
@@ -42,6 +54,10 @@ namespace ccf
   DECLARE_JSON_TYPE(SessionMetrics::PerInterface)
   DECLARE_JSON_REQUIRED_FIELDS(
     SessionMetrics::PerInterface, active, peak, soft_cap, hard_cap, errors)
+  DECLARE_JSON_TYPE(SessionMetrics::TLSWrites)
+  DECLARE_JSON_REQUIRED_FIELDS(
+    SessionMetrics::TLSWrites, sends, records, host_messages, host_bytes)
   DECLARE_JSON_TYPE(SessionMetrics)
-  DECLARE_JSON_REQUIRED_FIELDS(SessionMetrics, active, peak, interfaces)
+  DECLARE_JSON_REQUIRED_FIELDS(
+    SessionMetrics, active, peak, interfaces, tls_writes)
 }
\ No newline at end of file
@@ -15,9 +15,13 @@
 
 namespace ccf
 {
+  // Committed snapshots from which a node starts: a full snapshot followed by
+  // the delta snapshots chained to it (if any), in order
+  using SnapshotChain = std::vector<std::vector<uint8_t>>;
+
   struct StartupSnapshotInfo
   {
-    std::vector<uint8_t> raw;
+    SnapshotChain raw;
     ccf::kv::Version seqno;
 
     // Store used to verify a snapshot (either created fresh when a node joins
@@ -27,7 +31,7 @@ namespace ccf
 
     StartupSnapshotInfo(
       const std::shared_ptr<ccf::kv::Store>& store_,
-      std::vector<uint8_t>&& raw_,
+      SnapshotChain&& raw_,
       ccf::kv::Version seqno_) :
       raw(std::move(raw_)),
       seqno(seqno_),
@@ -35,13 +39,11 @@ namespace ccf
     {}
   };
 
-  static void deserialise_snapshot(
-    const std::shared_ptr<ccf::kv::Store>& store,
+  // Verifies the receipt of a snapshot (full or delta), and returns the size of
+  // the serialised store snapshot it covers
+  static size_t verify_snapshot(
     const std::vector<uint8_t>& snapshot,
-    ccf::kv::ConsensusHookPtrs& hooks,
-    std::vector<ccf::kv::Version>* view_history = nullptr,
-    bool public_only = false,
-    std::optional<std::vector<uint8_t>> prev_service_identity = std::nullopt)
+    const std::optional<std::vector<uint8_t>>& prev_service_identity)
   {
     const auto* data = snapshot.data();
     auto size = snapshot.size();
@@ -108,26 +110,47 @@ namespace ccf
       LOG_DEBUG_FMT("Previous service identity endorses snapshot signer");
     }
 
-    LOG_INFO_FMT(
-      "Deserialising snapshot (size: {}, public only: {})",
-      snapshot.size(),
-      public_only);
+    return store_snapshot_size;
+  }
 
-    auto rc = store->deserialise_snapshot(
-      snapshot.data(), store_snapshot_size, hooks, view_history, public_only);
-    if (rc != ccf::kv::ApplyResult::PASS)
+  static void deserialise_snapshot(
+    const std::shared_ptr<ccf::kv::Store>& store,
+    const SnapshotChain& snapshots,
+    ccf::kv::ConsensusHookPtrs& hooks,
+    std::vector<ccf::kv::Version>* view_history = nullptr,
+    bool public_only = false,
+    std::optional<std::vector<uint8_t>> prev_service_identity = std::nullopt)
+  {
+    // Each delta snapshot is only applied by the store on top of the snapshot
+    // whose digest it contains, i.e. the previous one in the chain. Since each
+    // digest is covered by the verified receipt of the snapshot containing
+    // it, so is the whole chain.
+    for (const auto& snapshot : snapshots)
     {
-      throw std::logic_error(fmt::format("Failed to apply snapshot: {}", rc));
-    }
+      auto store_snapshot_size =
+        verify_snapshot(snapshot, prev_service_identity);
 
-    LOG_INFO_FMT(
-      "Snapshot successfully deserialised at seqno {}",
-      store->current_version());
+      LOG_INFO_FMT(
+        "Deserialising snapshot (size: {}, public only: {})",
+        snapshot.size(),
+        public_only);
+
+      auto rc = store->deserialise_snapshot(
+        snapshot.data(), store_snapshot_size, hooks, view_history, public_only);
+      if (rc != ccf::kv::ApplyResult::PASS)
+      {
+        throw std::logic_error(fmt::format("Failed to apply snapshot: {}", rc));
+      }
+
+      LOG_INFO_FMT(
+        "Snapshot successfully deserialised at seqno {}",
+        store->current_version());
+    }
   };
 
   static std::unique_ptr<StartupSnapshotInfo> initialise_from_snapshot(
     const std::shared_ptr<ccf::kv::Store>& store,
-    std::vector<uint8_t>&& snapshot,
+    SnapshotChain&& snapshots,
     ccf::kv::ConsensusHookPtrs& hooks,
     std::vector<ccf::kv::Version>* view_history = nullptr,
     bool public_only = false,
@@ -136,13 +159,13 @@ namespace ccf
   {
     deserialise_snapshot(
       store,
-      snapshot,
+      snapshots,
       hooks,
       view_history,
       public_only,
       previous_service_identity);
     return std::make_unique<StartupSnapshotInfo>(
-      store, std::move(snapshot), store->current_version());
+      store, std::move(snapshots), store->current_version());
   }
 
   static std::vector<uint8_t> build_and_serialise_receipt(
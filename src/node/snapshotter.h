@@ -14,6 +14,7 @@
 #include "node/snapshot_serdes.h"
 #include "service/tables/snapshot_evidence.h"
 
+#include <atomic>
 #include <deque>
 #include <optional>
 
@@ -30,6 +31,22 @@ namespace ccf
     // snapshots are flushed on commit.
     static constexpr auto max_pending_snapshots_count = 5;
 
+    // Serialised snapshots are streamed to the host in chunks of (at most)
+    // this size, so that the host never holds more than one chunk in memory.
+    // Chunks are further capped so that each fits in a single message which
+    // can be written to the host without waiting (see get_chunk_size()).
+    static constexpr size_t default_snapshot_chunk_size = 128 * 1024;
+
+    // Size of the snapshot_chunk message, other than the chunk itself
+    static constexpr size_t snapshot_chunk_framing =
+      sizeof(::consensus::Index) + sizeof(size_t);
+
+    // Maps of a snapshot are only prepared concurrently (ahead of
+    // serialisation) while the total size of prepared map buffers stays
+    // under this threshold. Other maps are prepared, and their buffer
+    // released, one at a time as the snapshot is serialised.
+    static constexpr size_t max_prepared_snapshot_bytes = 64 * 1024 * 1024;
+
     ringbuffer::AbstractWriterFactory& writer_factory;
 
     ccf::pal::Mutex lock;
@@ -39,16 +56,40 @@ namespace ccf
     // Snapshots are never generated by default (e.g. during public recovery)
     size_t snapshot_tx_interval = max_tx_interval;
 
+    // Up to this many delta snapshots, each only containing the changes since
+    // the previous committed snapshot, are chained to a full snapshot. Delta
+    // snapshots are disabled if 0.
+    const size_t max_delta_chain_length;
+
+    const size_t snapshot_chunk_size;
+
+    // Committed snapshot on top of which the next delta snapshot is generated.
+    // Its (immutable) map snapshots are retained, which keeps alive the state
+    // overwritten since, so that only the changes are serialised.
+    struct DeltaBase
+    {
+      std::shared_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot;
+      ccf::crypto::Sha256Hash digest;
+      // Number of delta snapshots since the full snapshot, 0 if full
+      size_t chain_length;
+    };
+    std::shared_ptr<const DeltaBase> delta_base = nullptr;
+
     struct SnapshotInfo
     {
       ccf::kv::Version version;
       ccf::crypto::Sha256Hash write_set_digest;
       std::string commit_evidence;
       ccf::crypto::Sha256Hash snapshot_digest;
-      std::vector<uint8_t> serialised_snapshot;
+
+      // Only set if delta snapshots are enabled, to become the base of the
+      // next delta snapshot once this one is committed
+      std::shared_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot =
+        nullptr;
+      size_t delta_chain_length = 0;
 
       // Prevents the receipt from being passed to the host (on commit) in case
-      // host has not yet allocated memory for the snapshot.
+      // the snapshot has not yet been fully streamed to the host.
       bool is_stored = false;
 
       std::optional<::consensus::Index> evidence_idx = std::nullopt;
@@ -102,31 +143,209 @@ namespace ccf
       std::shared_ptr<Snapshotter> self;
       std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot;
       uint32_t generation_count;
+      // Full snapshot if not set
+      std::shared_ptr<const DeltaBase> base = nullptr;
     };
 
     static void snapshot_cb(std::unique_ptr<::threading::Tmsg<SnapshotMsg>> msg)
     {
       msg->data.self->snapshot_(
-        std::move(msg->data.snapshot), msg->data.generation_count);
+        std::move(msg->data.snapshot),
+        msg->data.generation_count,
+        msg->data.base);
+    }
+
+    // Shared by all the tasks preparing the maps of a snapshot concurrently.
+    // The last task to complete serialises the snapshot.
+    struct PreparingSnapshot
+    {
+      SnapshotMsg msg;
+      size_t tasks_count;
+      std::atomic<size_t> remaining_tasks;
+      std::atomic<size_t> prepared_bytes = 0;
+
+      PreparingSnapshot(SnapshotMsg&& msg_, size_t tasks_count_) :
+        msg(std::move(msg_)),
+        tasks_count(tasks_count_),
+        remaining_tasks(tasks_count_)
+      {}
+
+      bool reserve_prepared_bytes(size_t size)
+      {
+        if (
+          prepared_bytes.fetch_add(size) + size > max_prepared_snapshot_bytes)
+        {
+          prepared_bytes.fetch_sub(size);
+          return false;
+        }
+        return true;
+      }
+    };
+
+    struct PrepareMapsMsg
+    {
+      std::shared_ptr<PreparingSnapshot> preparing;
+      size_t first_map_idx;
+    };
+
+    static void prepare_maps_cb(
+      std::unique_ptr<::threading::Tmsg<PrepareMapsMsg>> msg)
+    {
+      auto& preparing = *msg->data.preparing;
+      auto& snapshot = preparing.msg.snapshot;
+      for (size_t i = msg->data.first_map_idx; i < snapshot->get_map_count();
+           i += preparing.tasks_count)
+      {
+        if (preparing.reserve_prepared_bytes(
+              snapshot->get_map_serialised_size(i)))
+        {
+          snapshot->prepare_map(i);
+        }
+      }
+
+      if (preparing.remaining_tasks.fetch_sub(1) == 1)
+      {
+        // Maps are always written to the snapshot in the same order, so the
+        // serialised snapshot does not depend on which task completes last
+        preparing.msg.self->snapshot_(
+          std::move(snapshot),
+          preparing.msg.generation_count,
+          preparing.msg.base);
+      }
+    }
+
+    struct StreamSnapshotMsg
+    {
+      std::shared_ptr<Snapshotter> self;
+      uint32_t generation_count;
+      ::consensus::Index snapshot_idx;
+      ::consensus::Index evidence_idx;
+      ::consensus::Index base_idx;
+      std::vector<uint8_t> serialised_snapshot;
+      bool begun = false;
+      size_t offset = 0;
+    };
+
+    static void stream_snapshot_cb(
+      std::unique_ptr<::threading::Tmsg<StreamSnapshotMsg>> msg)
+    {
+      auto self = msg->data.self;
+      if (!self->stream_snapshot(msg->data))
+      {
+        // Re-queued between chunks so that streaming a large snapshot never
+        // holds up the other tasks of this thread, nor blocks on a full
+        // ringbuffer
+        auto& tm = ::threading::ThreadMessaging::instance();
+        const auto tid = tm.get_execution_thread(msg->data.generation_count);
+        tm.add_task(tid, std::move(msg));
+      }
+    }
+
+    size_t get_chunk_size(const ringbuffer::WriterPtr& to_host) const
+    {
+      const auto max_message_size =
+        to_host->get_max_non_blocking_message_size();
+      if (max_message_size <= snapshot_chunk_framing)
+      {
+        throw std::logic_error(fmt::format(
+          "Cannot stream snapshot to host: maximum message size {} is too "
+          "small",
+          max_message_size));
+      }
+      return std::min(
+        snapshot_chunk_size, max_message_size - snapshot_chunk_framing);
+    }
+
+    // Writes (at most) the next message of the stream to the host. Returns
+    // true once the snapshot has been fully streamed (or abandoned).
+    bool stream_snapshot(StreamSnapshotMsg& stream)
+    {
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        if (!pending_snapshots.contains(stream.generation_count))
+        {
+          // Evidence was rolled back while the snapshot was streamed. The
+          // incomplete snapshot is never committed, and its file is removed
+          // by the host on restart.
+          LOG_DEBUG_FMT(
+            "Abandoned streaming of snapshot for seqno {} after {} bytes",
+            stream.snapshot_idx,
+            stream.offset);
+          return true;
+        }
+      }
+
+      auto to_host = writer_factory.create_writer_to_outside();
+      const auto& serialised_snapshot = stream.serialised_snapshot;
+      if (!stream.begun)
+      {
+        stream.begun = RINGBUFFER_TRY_WRITE_MESSAGE(
+          ::consensus::snapshot_begin,
+          to_host,
+          stream.snapshot_idx,
+          stream.evidence_idx,
+          serialised_snapshot.size(),
+          stream.base_idx);
+        return false;
+      }
+
+      if (stream.offset < serialised_snapshot.size())
+      {
+        const auto chunk_size = std::min(
+          get_chunk_size(to_host), serialised_snapshot.size() - stream.offset);
+        serializer::ByteRange chunk = {
+          serialised_snapshot.data() + stream.offset, chunk_size};
+        if (RINGBUFFER_TRY_WRITE_MESSAGE(
+              ::consensus::snapshot_chunk, to_host, stream.snapshot_idx, chunk))
+        {
+          stream.offset += chunk_size;
+        }
+        return false;
+      }
+
+      LOG_DEBUG_FMT(
+        "Streamed snapshot [{} bytes] for seqno {} to host, with evidence "
+        "seqno {}",
+        serialised_snapshot.size(),
+        stream.snapshot_idx,
+        stream.evidence_idx);
+
+      std::lock_guard<ccf::pal::Mutex> guard(lock);
+      auto search = pending_snapshots.find(stream.generation_count);
+      if (search != pending_snapshots.end())
+      {
+        search->second.is_stored = true;
+      }
+      return true;
     }
 
     void snapshot_(
       std::unique_ptr<ccf::kv::AbstractStore::AbstractSnapshot> snapshot,
-      uint32_t generation_count)
+      uint32_t generation_count,
+      const std::shared_ptr<const DeltaBase>& base)
     {
-      if (pending_snapshots.size() >= max_pending_snapshots_count)
       {
-        LOG_FAIL_FMT(
-          "Skipping new snapshot generation as {} snapshots are already "
-          "pending",
-          pending_snapshots.size());
-        return;
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        if (pending_snapshots.size() >= max_pending_snapshots_count)
+        {
+          LOG_FAIL_FMT(
+            "Skipping new snapshot generation as {} snapshots are already "
+            "pending",
+            pending_snapshots.size());
+          return;
+        }
       }
 
       auto snapshot_version = snapshot->get_version();
 
-      auto serialised_snapshot = store->serialise_snapshot(std::move(snapshot));
+      // The digest of the base is included in (and so bound to the evidence
+      // and receipt of) a delta snapshot
+      auto encryptor = store->get_encryptor();
+      auto serialised_snapshot = base != nullptr ?
+        snapshot->serialise_delta(encryptor, *base->snapshot, base->digest) :
+        snapshot->serialise(encryptor);
       auto serialised_snapshot_size = serialised_snapshot.size();
+      const auto base_idx = base != nullptr ? base->snapshot->get_version() : 0;
 
       auto tx = store->create_tx();
       auto evidence = tx.rw<SnapshotEvidence>(Tables::SNAPSHOT_EVIDENCE);
@@ -152,8 +371,18 @@ namespace ccf
       // transaction is committed. To allow for such scenario, the evidence
       // seqno is recorded via `record_snapshot_evidence_idx()` on a hook rather
       // than here.
-      pending_snapshots[generation_count] = {};
-      pending_snapshots[generation_count].version = snapshot_version;
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        auto& info = pending_snapshots[generation_count];
+        info = {};
+        info.version = snapshot_version;
+        if (max_delta_chain_length > 0)
+        {
+          info.snapshot = std::move(snapshot);
+          info.delta_chain_length =
+            base != nullptr ? base->chain_length + 1 : 0;
+        }
+      }
 
       auto rc =
         tx.commit(cd, false, nullptr, capture_ws_digest_and_commit_evidence);
@@ -168,29 +397,42 @@ namespace ccf
 
       auto evidence_version = tx.commit_version();
 
-      pending_snapshots[generation_count].commit_evidence = commit_evidence;
-      pending_snapshots[generation_count].write_set_digest = ws_digest;
-      pending_snapshots[generation_count].snapshot_digest = cd.value();
-      pending_snapshots[generation_count].serialised_snapshot =
-        std::move(serialised_snapshot);
-
-      auto to_host = writer_factory.create_writer_to_outside();
-      RINGBUFFER_WRITE_MESSAGE(
-        ::consensus::snapshot_allocate,
-        to_host,
-        snapshot_version,
-        evidence_version,
-        serialised_snapshot_size,
-        generation_count);
+      {
+        std::lock_guard<ccf::pal::Mutex> guard(lock);
+        auto search = pending_snapshots.find(generation_count);
+        if (search == pending_snapshots.end())
+        {
+          // Evidence was rolled back while it was being committed
+          return;
+        }
+        search->second.commit_evidence = commit_evidence;
+        search->second.write_set_digest = ws_digest;
+        search->second.snapshot_digest = cd.value();
+      }
 
       LOG_DEBUG_FMT(
-        "Request to allocate snapshot [{} bytes] for seqno {}, with evidence "
-        "seqno {}: {}, ws digest: {}",
+        "Serialised {} snapshot [{} bytes] for seqno {}, with evidence seqno "
+        "{}: {}, ws digest: {}",
+        base != nullptr ? fmt::format("delta (from {})", base_idx) : "full",
         serialised_snapshot_size,
         snapshot_version,
         evidence_version,
         cd.value(),
         ws_digest);
+
+      // The snapshot is only marked as stored (and so committable) once it
+      // has been fully streamed to the host
+      auto& tm = ::threading::ThreadMessaging::instance();
+      auto stream_msg = std::make_unique<::threading::Tmsg<StreamSnapshotMsg>>(
+        &stream_snapshot_cb);
+      stream_msg->data.self = shared_from_this();
+      stream_msg->data.generation_count = generation_count;
+      stream_msg->data.snapshot_idx = snapshot_version;
+      stream_msg->data.evidence_idx = evidence_version;
+      stream_msg->data.base_idx = base_idx;
+      stream_msg->data.serialised_snapshot = std::move(serialised_snapshot);
+      tm.add_task(
+        tm.get_execution_thread(generation_count), std::move(stream_msg));
     }
 
     void update_indices(::consensus::Index idx)
@@ -209,6 +451,14 @@ namespace ccf
           snapshot_info.is_stored && snapshot_info.evidence_idx.has_value() &&
           idx > snapshot_info.evidence_idx.value())
         {
+          if (snapshot_info.snapshot != nullptr)
+          {
+            delta_base = std::make_shared<DeltaBase>(DeltaBase{
+              std::move(snapshot_info.snapshot),
+              snapshot_info.snapshot_digest,
+              snapshot_info.delta_chain_length});
+          }
+
           auto serialised_receipt = build_and_serialise_receipt(
             snapshot_info.sig.value(),
             snapshot_info.tree.value(),
@@ -233,10 +483,14 @@ namespace ccf
     Snapshotter(
       ringbuffer::AbstractWriterFactory& writer_factory_,
       std::shared_ptr<ccf::kv::Store>& store_,
-      size_t snapshot_tx_interval_) :
+      size_t snapshot_tx_interval_,
+      size_t max_delta_chain_length_ = 0,
+      size_t snapshot_chunk_size_ = default_snapshot_chunk_size) :
       writer_factory(writer_factory_),
       store(store_),
-      snapshot_tx_interval(snapshot_tx_interval_)
+      snapshot_tx_interval(snapshot_tx_interval_),
+      max_delta_chain_length(max_delta_chain_length_),
+      snapshot_chunk_size(snapshot_chunk_size_)
     {
       next_snapshot_indices.push_back({initial_snapshot_idx, false, true});
     }
@@ -275,64 +529,6 @@ namespace ccf
       next_snapshot_indices.push_back({last_snapshot_idx, false, true});
     }
 
-    bool write_snapshot(
-      std::span<uint8_t> snapshot_buf, uint32_t generation_count)
-    {
-      std::lock_guard<ccf::pal::Mutex> guard(lock);
-
-      auto search = pending_snapshots.find(generation_count);
-      if (search == pending_snapshots.end())
-      {
-        LOG_FAIL_FMT(
-          "Could not find pending snapshot to write for generation count {}",
-          generation_count);
-        return false;
-      }
-
-      auto& pending_snapshot = search->second;
-      if (snapshot_buf.size() != pending_snapshot.serialised_snapshot.size())
-      {
-        // Unreliable host: allocated snapshot buffer is not of expected
-        // size. The pending snapshot is discarded to reduce enclave memory
-        // usage.
-        LOG_FAIL_FMT(
-          "Host allocated snapshot buffer [{} bytes] is not of expected "
-          "size [{} bytes]. Discarding snapshot for seqno {}",
-          snapshot_buf.size(),
-          pending_snapshot.serialised_snapshot.size(),
-          pending_snapshot.version);
-        pending_snapshots.erase(search);
-        return false;
-      }
-      else if (!ccf::pal::is_outside_enclave(
-                 snapshot_buf.data(), snapshot_buf.size()))
-      {
-        // Sanitise host-allocated buffer. Note that buffer alignment is not
-        // checked as the buffer is only written to and never read.
-        LOG_FAIL_FMT(
-          "Host allocated snapshot buffer is not outside enclave memory. "
-          "Discarding snapshot for seqno {}",
-          pending_snapshot.version);
-        pending_snapshots.erase(search);
-        return false;
-      }
-
-      ccf::pal::speculation_barrier();
-
-      std::copy(
-        pending_snapshot.serialised_snapshot.begin(),
-        pending_snapshot.serialised_snapshot.end(),
-        snapshot_buf.begin());
-      pending_snapshot.is_stored = true;
-
-      LOG_DEBUG_FMT(
-        "Successfully copied snapshot at seqno {} to host memory [{} "
-        "bytes]",
-        pending_snapshot.version,
-        pending_snapshot.serialised_snapshot.size());
-      return true;
-    }
-
     bool record_committable(::consensus::Index idx) override
     {
       // Returns true if the committable idx will require the generation of a
@@ -445,6 +641,19 @@ namespace ccf
       }
     }
 
+    std::shared_ptr<const DeltaBase> get_delta_base(::consensus::Index idx)
+    {
+      if (
+        delta_base == nullptr ||
+        delta_base->chain_length >= max_delta_chain_length ||
+        idx - delta_base->snapshot->get_version() >
+          ccf::kv::max_snapshot_delta_distance)
+      {
+        return nullptr;
+      }
+      return delta_base;
+    }
+
     void schedule_snapshot(::consensus::Index idx)
     {
       static uint32_t generation_count = 0;
@@ -452,8 +661,35 @@ namespace ccf
       msg->data.self = shared_from_this();
       msg->data.snapshot = store->snapshot_unsafe_maps(idx);
       msg->data.generation_count = generation_count++;
+      msg->data.base = get_delta_base(idx);
 
       auto& tm = ::threading::ThreadMessaging::instance();
+
+      // With multiple worker threads, the serialisation of the (immutable) map
+      // snapshots of a full snapshot is spread across workers before the
+      // snapshot is assembled. Delta snapshots only serialise the changes
+      // since their base, on a single thread.
+      const size_t workers_count = tm.thread_count() - 1;
+      const size_t tasks_count =
+        std::min(workers_count, msg->data.snapshot->get_map_count());
+      if (tasks_count > 1 && msg->data.base == nullptr)
+      {
+        auto preparing = std::make_shared<PreparingSnapshot>(
+          std::move(msg->data), tasks_count);
+        for (size_t i = 0; i < tasks_count; ++i)
+        {
+          auto prepare_msg =
+            std::make_unique<::threading::Tmsg<PrepareMapsMsg>>(
+              &prepare_maps_cb);
+          prepare_msg->data.preparing = preparing;
+          prepare_msg->data.first_map_idx = i;
+          tm.add_stealable_task(
+            tm.get_execution_thread(generation_count + i),
+            std::move(prepare_msg));
+        }
+        return;
+      }
+
       tm.add_task(tm.get_execution_thread(generation_count), std::move(msg));
     }
 
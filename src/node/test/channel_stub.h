@@ -35,7 +35,10 @@ namespace ccf
 
     template <class T>
     std::pair<T, std::vector<uint8_t>> recv_encrypted(
-      const NodeId& from, const uint8_t* data, size_t size)
+      const NodeId& from,
+      const uint8_t* data,
+      size_t size,
+      bool pre_authenticated = false)
     {
       T msg;
       return std::make_pair(msg, std::vector<uint8_t>(data, data + size));
@@ -1738,3 +1738,170 @@ TEST_CASE_FIXTURE(IORingbuffersFixture, "Timeout idle channels")
     REQUIRE_FALSE(channels2.have_channel(nid1));
   }
 }
+
+TEST_CASE_FIXTURE(IORingbuffersFixture, "Message batching")
+{
+  ::threading::ThreadMessaging::init(1);
+  auto& tm = ::threading::ThreadMessaging::instance();
+
+  auto network_kp = ccf::crypto::make_key_pair(default_curve);
+  auto service_cert = generate_self_signed_cert(network_kp, "CN=Network");
+
+  auto channel1_kp = ccf::crypto::make_key_pair(default_curve);
+  auto channel1_cert =
+    generate_endorsed_cert(channel1_kp, "CN=Node1", network_kp, service_cert);
+
+  auto channel2_kp = ccf::crypto::make_key_pair(default_curve);
+  auto channel2_cert =
+    generate_endorsed_cert(channel2_kp, "CN=Node2", network_kp, service_cert);
+
+  NodeToNodeChannelManager channels1(wf1), channels2(wf2);
+  channels1.initialize(nid1, service_cert, channel1_kp, channel1_cert);
+  channels1.set_message_batching(true);
+  channels2.initialize(nid2, service_cert, channel2_kp, channel2_cert);
+
+  // Runs any scheduled batch flushes, delivers channel messages, and returns
+  // all other messages sent by either node
+  auto exchange = [&]() {
+    std::vector<NodeOutboundMsg<MsgType>> sent;
+    while (true)
+    {
+      while (tm.run_one())
+        ;
+
+      auto msgs = get_all_msgs({&eio1, &eio2});
+      if (msgs.empty())
+      {
+        return sent;
+      }
+
+      for (auto& msg : msgs)
+      {
+        if (msg.type == NodeMsgType::channel_msg)
+        {
+          auto& n2n = (msg.from == nid1) ? channels2 : channels1;
+          n2n.recv_channel_message(msg.from, msg.data());
+        }
+        else
+        {
+          sent.push_back(msg);
+        }
+      }
+    }
+  };
+
+  auto make_msg = [](uint8_t i) {
+    MsgType msg;
+    msg.fill(i);
+    return msg;
+  };
+
+  // Receives a batch sent by node 1, returning the messages it contained
+  auto recv_batch = [&](const NodeOutboundMsg<MsgType>& batch) {
+    std::vector<MsgType> received;
+    const auto d = batch.data();
+    const auto ok = channels2.recv_batched_messages(
+      nid1,
+      d.data(),
+      d.size(),
+      [&](NodeMsgType type, const uint8_t* data, size_t size) {
+        REQUIRE(type == NodeMsgType::consensus_msg);
+
+        // Batched messages carry no authentication of their own
+        const uint8_t* unverified_data = data + msg_size;
+        size_t unverified_size = size - msg_size;
+        REQUIRE_FALSE(channels2.recv_authenticated(
+          nid1, {data, msg_size}, unverified_data, unverified_size));
+
+        ccf::NodeToNode& n2n = channels2;
+        received.push_back(
+          n2n.recv_authenticated<MsgType>(nid1, data, size, true));
+        REQUIRE(size == 0);
+      });
+    return std::make_pair(ok, received);
+  };
+
+  {
+    INFO("Establish channel");
+    const auto msg = make_msg(0x42);
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, msg.data(), msg.size()));
+    auto sent = exchange();
+    REQUIRE(sent.size() == 1);
+    REQUIRE(sent[0].type == NodeMsgType::batched_msg);
+    REQUIRE(recv_batch(sent[0]).second == std::vector<MsgType>{msg});
+  }
+
+  {
+    INFO("Small messages sent together are sealed in a single frame");
+    std::vector<MsgType> msgs;
+    for (uint8_t i = 1; i <= 5; ++i)
+    {
+      msgs.push_back(make_msg(i));
+      REQUIRE(channels1.send_authenticated(
+        nid2, NodeMsgType::consensus_msg, msgs.back().data(), msg_size));
+    }
+
+    REQUIRE(get_all_msgs({&eio1}).empty());
+
+    auto sent = exchange();
+    REQUIRE(sent.size() == 1);
+    REQUIRE(sent[0].type == NodeMsgType::batched_msg);
+
+    auto [ok, received] = recv_batch(sent[0]);
+    REQUIRE(ok);
+    REQUIRE(received == msgs);
+  }
+
+  {
+    INFO("A tampered batch is rejected as a whole");
+    const auto msg = make_msg(6);
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, msg.data(), msg.size()));
+    auto sent = exchange();
+    REQUIRE(sent.size() == 1);
+    sent[0].payload.back() ^= 1;
+
+    auto [ok, received] = recv_batch(sent[0]);
+    REQUIRE_FALSE(ok);
+    REQUIRE(received.empty());
+  }
+
+  {
+    INFO("AppendEntries are never batched, and flush earlier messages");
+    const auto msg = make_msg(7);
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, msg.data(), msg.size()));
+
+    auto ae = make_msg(8);
+    const auto ae_type = aft::raft_append_entries;
+    std::memcpy(ae.data(), &ae_type, sizeof(ae_type));
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, ae.data(), ae.size()));
+
+    auto sent = exchange();
+    REQUIRE(sent.size() == 2);
+    REQUIRE(sent[0].type == NodeMsgType::batched_msg);
+    REQUIRE(recv_batch(sent[0]).second == std::vector<MsgType>{msg});
+
+    REQUIRE(sent[1].type == NodeMsgType::consensus_msg);
+    REQUIRE(sent[1].authenticated_hdr == ae);
+    const auto* data = sent[1].payload.data();
+    auto size = sent[1].payload.size();
+    REQUIRE(channels2.recv_authenticated(
+      nid1, {ae.data(), ae.size()}, data, size));
+  }
+
+  {
+    INFO("Messages are sent individually once batching is disabled");
+    channels1.set_message_batching(false);
+    const auto msg = make_msg(9);
+    REQUIRE(channels1.send_authenticated(
+      nid2, NodeMsgType::consensus_msg, msg.data(), msg.size()));
+    auto sent = exchange();
+    REQUIRE(sent.size() == 1);
+    REQUIRE(sent[0].type == NodeMsgType::consensus_msg);
+  }
+
+  ::threading::ThreadMessaging::shutdown();
+}
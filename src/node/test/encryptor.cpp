@@ -273,6 +273,19 @@ TEST_CASE("KV encryption/decryption")
       ccf::kv::ApplyResult::PASS);
   }
 
+  INFO("Apply transaction borrowed from received buffer to backup store");
+  {
+    commit_one(primary_store, map);
+    const auto data = consensus->get_latest_data();
+    auto exec = backup_store.deserialize(ccf::kv::EntryView(*data));
+    REQUIRE(exec->apply() == ccf::kv::ApplyResult::PASS);
+
+    // The entry is not copied, either to be deserialised or to be written to
+    // the ledger
+    REQUIRE(exec->get_entry().data() == data->data());
+    REQUIRE(exec->get_entry().size() == data->size());
+  }
+
   INFO("Rekeys");
   {
     auto current_version = primary_store.current_version();
@@ -369,6 +382,106 @@ TEST_CASE("Backup catchup from many ledger secrets")
   }
 }
 
+TEST_CASE("Backup catchup with entries prepared ahead of application")
+{
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  StringString map("map");
+  ccf::kv::Store primary_store;
+  ccf::kv::Store backup_store;
+
+  auto primary_ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  primary_ledger_secrets->init();
+  primary_store.set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(primary_ledger_secrets));
+  primary_store.set_consensus(consensus);
+
+  auto backup_ledger_secrets = std::make_shared<ccf::LedgerSecrets>();
+  {
+    auto tx = primary_store.create_tx();
+    backup_ledger_secrets->init_from_map(primary_ledger_secrets->get(tx));
+  }
+  backup_store.set_encryptor(
+    std::make_shared<ccf::NodeEncryptor>(backup_ledger_secrets));
+
+  // The primary rekeys twice, and the backup only learns of the new secrets
+  // once it applies the transactions preceding them
+  std::vector<std::pair<ccf::kv::Version, ccf::LedgerSecretPtr>> rekeys;
+  commit_one(primary_store, map);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const auto rekey_version = primary_store.current_version() + 1;
+    auto new_ledger_secret = ccf::make_ledger_secret();
+    rekeys.emplace_back(rekey_version, new_ledger_secret);
+    primary_ledger_secrets->set_secret(
+      rekey_version, std::move(new_ledger_secret));
+    commit_one(primary_store, map);
+    commit_one(primary_store, map);
+  }
+
+  std::vector<std::unique_ptr<ccf::kv::AbstractExecutionWrapper>> entries;
+  for (const auto& entry : consensus->replica)
+  {
+    entries.push_back(backup_store.deserialize(*std::get<1>(entry)));
+  }
+  REQUIRE(entries.size() == 5);
+
+  INFO("Only entries encrypted with known secrets can be prepared");
+  {
+    REQUIRE(entries[0]->prepare());
+    for (size_t i = 1; i < entries.size(); ++i)
+    {
+      REQUIRE_FALSE(entries[i]->prepare());
+    }
+  }
+
+  INFO("Entries which could not be prepared are decrypted when applied");
+  {
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      // In practice, the backup is given the new secret by the local commit
+      // hook of the preceding transaction
+      const ccf::kv::Version entry_version = i + 1;
+      for (const auto& [rekey_version, secret] : rekeys)
+      {
+        if (rekey_version == entry_version)
+        {
+          backup_ledger_secrets->set_secret(
+            rekey_version, ccf::LedgerSecretPtr(secret));
+        }
+      }
+      REQUIRE(entries[i]->apply() == ccf::kv::ApplyResult::PASS);
+    }
+  }
+
+  INFO("Entries can be decrypted in order after crossing several rekeys");
+  {
+    ccf::kv::Store backup_store_2;
+    auto tx = primary_store.create_tx();
+    auto backup_ledger_secrets_2 = std::make_shared<ccf::LedgerSecrets>();
+    backup_ledger_secrets_2->init_from_map(primary_ledger_secrets->get(tx));
+    backup_store_2.set_encryptor(
+      std::make_shared<ccf::NodeEncryptor>(backup_ledger_secrets_2));
+
+    // The first entry is decrypted when applied, the others ahead of being
+    // applied
+    for (size_t i = 0; i < consensus->replica.size(); ++i)
+    {
+      auto entry =
+        backup_store_2.deserialize(*std::get<1>(consensus->replica[i]));
+      if (i != 0)
+      {
+        REQUIRE(entry->prepare());
+      }
+      REQUIRE(entry->apply() == ccf::kv::ApplyResult::PASS);
+    }
+
+    commit_one(primary_store, map);
+    REQUIRE(
+      backup_store_2.deserialize(*consensus->get_latest_data())->apply() ==
+      ccf::kv::ApplyResult::PASS);
+  }
+}
+
 TEST_CASE("KV integrity verification")
 {
   auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
@@ -196,6 +196,93 @@ static void serialised_size(picobench::state& s)
             << std::endl;
 }
 
+template <ccf::crypto::Sha256PairsBackend B>
+static void sha256_pairs_with(
+  size_t n,
+  const uint8_t* const* l,
+  const uint8_t* const* r,
+  uint8_t* const* out)
+{
+  ccf::crypto::sha256_pairs(B, n, l, r, out);
+}
+
+using UnbatchedTree = merkle::TreeT<ccf::sha256_byte_size, ccf::sha256_history>;
+
+template <ccf::crypto::Sha256PairsBackend B>
+using BatchedTree = ccf::BatchedMerkleTreeT<
+  ccf::sha256_byte_size,
+  ccf::sha256_history,
+  sha256_pairs_with<B>>;
+
+static constexpr auto OpenSSL = ccf::crypto::Sha256PairsBackend::OpenSSL;
+static constexpr auto SHA_NI = ccf::crypto::Sha256PairsBackend::SHA_NI;
+static constexpr auto AVX2 = ccf::crypto::Sha256PairsBackend::AVX2;
+
+template <class T>
+static bool supported()
+{
+  if constexpr (std::is_same_v<T, BatchedTree<SHA_NI>>)
+  {
+    return ccf::crypto::sha256_pairs_supported(SHA_NI);
+  }
+  if constexpr (std::is_same_v<T, BatchedTree<AVX2>>)
+  {
+    return ccf::crypto::sha256_pairs_supported(AVX2);
+  }
+  return true;
+}
+
+static vector<merkle::Hash> rand_leaves(size_t n)
+{
+  vector<merkle::Hash> leaves(n);
+  std::random_device r;
+  for (auto& leaf : leaves)
+  {
+    for (size_t j = 0; j < ccf::sha256_byte_size; j++)
+      leaf.bytes[j] = r();
+  }
+  return leaves;
+}
+
+// Appends the s.iterations() transactions since the last signature, and
+// computes the root to sign
+template <class T>
+static void root_at_signature(picobench::state& s)
+{
+  if (!supported<T>())
+    return;
+
+  T t(rand_leaves(1)[0]);
+  const auto leaves = rand_leaves(s.iterations());
+
+  s.start_timer();
+  for (const auto& leaf : leaves)
+    t.insert(leaf);
+  do_not_optimize(t.root());
+  s.stop_timer();
+}
+
+// Rebuilds the tree of a signature over s.iterations() transactions from its
+// serialised form, and extracts the path of one of them, as for a historical
+// receipt
+template <class T>
+static void receipt(picobench::state& s)
+{
+  if (!supported<T>())
+    return;
+
+  T t;
+  for (const auto& leaf : rand_leaves(s.iterations()))
+    t.insert(leaf);
+  vector<uint8_t> serialised;
+  t.serialise(serialised);
+
+  s.start_timer();
+  T deserialised(serialised);
+  do_not_optimize(deserialised.path(s.iterations() / 2));
+  s.stop_timer();
+}
+
 const std::vector<int> sizes = {1000, 10000};
 
 PICOBENCH_SUITE("append_retract");
@@ -208,6 +295,24 @@ PICOBENCH_SUITE("append_get_proof_verify_v");
 PICOBENCH(append_get_proof_verify_v).iterations(sizes).samples(10).baseline();
 PICOBENCH_SUITE("serialise_deserialise");
 PICOBENCH(serialise_deserialise).iterations(sizes).samples(10).baseline();
+PICOBENCH_SUITE("root_at_signature");
+auto root_unbatched = root_at_signature<UnbatchedTree>;
+PICOBENCH(root_unbatched).iterations(sizes).samples(10).baseline();
+auto root_openssl = root_at_signature<BatchedTree<OpenSSL>>;
+PICOBENCH(root_openssl).iterations(sizes).samples(10);
+auto root_sha_ni = root_at_signature<BatchedTree<SHA_NI>>;
+PICOBENCH(root_sha_ni).iterations(sizes).samples(10);
+auto root_avx2 = root_at_signature<BatchedTree<AVX2>>;
+PICOBENCH(root_avx2).iterations(sizes).samples(10);
+PICOBENCH_SUITE("receipt");
+auto receipt_unbatched = receipt<UnbatchedTree>;
+PICOBENCH(receipt_unbatched).iterations(sizes).samples(10).baseline();
+auto receipt_openssl = receipt<BatchedTree<OpenSSL>>;
+PICOBENCH(receipt_openssl).iterations(sizes).samples(10);
+auto receipt_sha_ni = receipt<BatchedTree<SHA_NI>>;
+PICOBENCH(receipt_sha_ni).iterations(sizes).samples(10);
+auto receipt_avx2 = receipt<BatchedTree<AVX2>>;
+PICOBENCH(receipt_avx2).iterations(sizes).samples(10);
 // Checks the size of serialised tree, timing results are irrelevant here
 // and since we run a single sample probably not that accurate anyway
 PICOBENCH_SUITE("serialised_size");
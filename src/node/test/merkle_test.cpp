@@ -180,6 +180,53 @@ TEST_CASE("First root")
   }
 }
 
+TEST_CASE("Batched hashing")
+{
+  // Hashes one node at a time
+  using UnbatchedTree =
+    merkle::TreeT<ccf::sha256_byte_size, ccf::sha256_history>;
+
+  ccf::HistoryTree batched;
+  UnbatchedTree unbatched;
+
+  const auto append = [&](size_t count) {
+    for (size_t i = 0; i < count; ++i)
+    {
+      const auto h = rand_hash();
+      batched.insert(merkle::Hash(h.h));
+      unbatched.insert(merkle::Hash(h.h));
+    }
+  };
+
+  append(1);
+  REQUIRE(batched.root() == unbatched.root());
+
+  for (size_t count : {1, 2, 3, 7, 8, 9, 100, 1000})
+  {
+    append(count);
+    REQUIRE(batched.root() == unbatched.root());
+
+    const auto index = batched.max_index() / 2;
+    REQUIRE(*batched.path(index) == *unbatched.path(index));
+    REQUIRE(*batched.past_root(index) == *unbatched.past_root(index));
+  }
+
+  batched.retract_to(batched.max_index() - 10);
+  unbatched.retract_to(unbatched.max_index() - 10);
+  append(10);
+  REQUIRE(batched.root() == unbatched.root());
+
+  batched.flush_to(batched.max_index() / 3);
+  unbatched.flush_to(unbatched.max_index() / 3);
+  append(100);
+  REQUIRE(batched.root() == unbatched.root());
+
+  std::vector<uint8_t> serialised;
+  batched.serialise(serialised);
+  ccf::HistoryTree deserialised(serialised);
+  REQUIRE(deserialised.root() == unbatched.root());
+}
+
 int main(int argc, char** argv)
 {
   ccf::crypto::openssl_sha256_init();
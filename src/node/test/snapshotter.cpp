@@ -5,6 +5,7 @@
 
 #include "ccf/ds/logger.h"
 #include "crypto/openssl/hash.h"
+#include "ds/oversized.h"
 #include "ds/ring_buffer.h"
 #include "kv/test/null_encryptor.h"
 #include "kv/test/stub_consensus.h"
@@ -20,7 +21,9 @@
 std::unique_ptr<threading::ThreadMessaging>
   threading::ThreadMessaging::singleton = nullptr;
 
-constexpr auto buffer_size = 1024 * 16;
+constexpr auto buffer_size = 1024 * 128;
+// Small chunks so that snapshots are streamed to the host in several chunks
+constexpr auto snapshot_chunk_size = 64;
 auto node_kp = ccf::crypto::make_key_pair();
 
 using StringString = ccf::kv::Map<std::string, std::string>;
@@ -33,7 +36,7 @@ auto read_ringbuffer_out(ringbuffer::Circuit& circuit)
     -1, [&idx](ringbuffer::Message m, const uint8_t* data, size_t size) {
       switch (m)
       {
-        case ::consensus::snapshot_allocate:
+        case ::consensus::snapshot_begin:
         case ::consensus::snapshot_commit:
         {
           auto idx_ = serialized::read<::consensus::Index>(data, size);
@@ -50,24 +53,42 @@ auto read_ringbuffer_out(ringbuffer::Circuit& circuit)
   return idx;
 }
 
-auto read_snapshot_allocate_out(ringbuffer::Circuit& circuit)
+// Reassembles a snapshot streamed by the enclave
+auto read_snapshot_out(
+  ringbuffer::Circuit& circuit, ::consensus::Index* base_idx = nullptr)
 {
-  std::optional<std::tuple<::consensus::Index, size_t, uint32_t>>
-    snapshot_allocate_out = std::nullopt;
+  std::optional<std::pair<::consensus::Index, std::vector<uint8_t>>>
+    snapshot_out = std::nullopt;
+  size_t expected_size = 0;
+  size_t chunk_count = 0;
   circuit.read_from_inside().read(
     -1,
-    [&snapshot_allocate_out](
+    [&snapshot_out, &expected_size, &chunk_count, base_idx](
       ringbuffer::Message m, const uint8_t* data, size_t size) {
       switch (m)
       {
-        case ::consensus::snapshot_allocate:
+        case ::consensus::snapshot_begin:
         {
+          REQUIRE_FALSE(snapshot_out.has_value());
+          auto [idx, evidence_idx, snapshot_size, base_idx_] =
+            ringbuffer::read_message<::consensus::snapshot_begin>(data, size);
+          expected_size = snapshot_size;
+          if (base_idx != nullptr)
+          {
+            *base_idx = base_idx_;
+          }
+          snapshot_out = {idx, {}};
+          break;
+        }
+        case ::consensus::snapshot_chunk:
+        {
+          REQUIRE(snapshot_out.has_value());
           auto idx = serialized::read<::consensus::Index>(data, size);
-          serialized::read<::consensus::Index>(data, size);
-          auto requested_size = serialized::read<size_t>(data, size);
-          auto generation_count = serialized::read<uint32_t>(data, size);
-
-          snapshot_allocate_out = {idx, requested_size, generation_count};
+          REQUIRE(idx == snapshot_out->first);
+          REQUIRE(size <= snapshot_chunk_size);
+          snapshot_out->second.insert(
+            snapshot_out->second.end(), data, data + size);
+          chunk_count++;
           break;
         }
         case ::consensus::snapshot_commit:
@@ -82,7 +103,24 @@ auto read_snapshot_allocate_out(ringbuffer::Circuit& circuit)
       }
     });
 
-  return snapshot_allocate_out;
+  if (snapshot_out.has_value())
+  {
+    REQUIRE(snapshot_out->second.size() == expected_size);
+    REQUIRE(
+      chunk_count ==
+      (expected_size + snapshot_chunk_size - 1) / snapshot_chunk_size);
+  }
+
+  return snapshot_out;
+}
+
+// Snapshots are streamed to the host by tasks that re-queue themselves after
+// each chunk
+void run_tasks()
+{
+  while (threading::ThreadMessaging::instance().run_one())
+  {
+  }
 }
 
 void issue_transactions(ccf::NetworkState& network, size_t tx_count)
@@ -161,7 +199,11 @@ TEST_CASE("Regular snapshotting")
   issue_transactions(network, snapshot_tx_interval);
 
   auto snapshotter = std::make_shared<ccf::Snapshotter>(
-    *writer_factory, network.tables, snapshot_tx_interval);
+    *writer_factory,
+    network.tables,
+    snapshot_tx_interval,
+    0 /* No delta snapshots */,
+    snapshot_chunk_size);
 
   size_t commit_idx = 0;
   size_t snapshot_idx = snapshot_tx_interval;
@@ -172,14 +214,14 @@ TEST_CASE("Regular snapshotting")
     REQUIRE_FALSE(record_signature(history, snapshotter, snapshot_idx - 1));
     commit_idx = snapshot_idx - 1;
     snapshotter->commit(commit_idx, true);
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
 
     REQUIRE_THROWS_AS(
       read_latest_snapshot_evidence(network.tables), std::logic_error);
     REQUIRE(read_ringbuffer_out(eio) == std::nullopt);
   }
 
-  INFO("Malicious host");
+  INFO("Generate snapshot whose evidence is rolled back");
   {
     REQUIRE(record_signature(history, snapshotter, snapshot_idx));
 
@@ -188,31 +230,14 @@ TEST_CASE("Regular snapshotting")
     commit_idx = snapshot_idx + 1;
     snapshotter->commit(commit_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-
-    // Incorrect generation count
-    {
-      auto snapshot = std::vector<uint8_t>(snapshot_size);
-      REQUIRE_FALSE(snapshotter->write_snapshot(snapshot, snapshot_count + 1));
-    }
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
 
-    // Incorrect size
-    {
-      auto snapshot = std::vector<uint8_t>(snapshot_size + 1);
-      REQUIRE_FALSE(snapshotter->write_snapshot(snapshot, snapshot_count));
-    }
-
-    // Even if snapshot is now valid, pending snapshot was previously
-    // discarded because of incorrect size
-    {
-      auto snapshot = std::vector<uint8_t>(snapshot_size);
-      REQUIRE_FALSE(snapshotter->write_snapshot(snapshot, snapshot_count));
-    }
+    // Evidence was never recorded, so the snapshot is discarded on rollback
+    snapshotter->rollback(commit_idx);
   }
 
   INFO("Generate first snapshot");
@@ -226,26 +251,18 @@ TEST_CASE("Regular snapshotting")
     commit_idx = snapshot_idx + 1;
     snapshotter->commit(commit_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
+    // Snapshot is large enough to be streamed in several chunks
+    REQUIRE(snapshot_msg->second.size() > snapshot_chunk_size);
 
-    // Commit before snapshot is stored has no effect
     issue_transactions(network, 1);
     record_snapshot_evidence(snapshotter, snapshot_idx, snapshot_evidence_idx);
     commit_idx = snapshot_idx + 2;
     REQUIRE_FALSE(record_signature(history, snapshotter, commit_idx));
-    snapshotter->commit(commit_idx, true);
-    REQUIRE(read_ringbuffer_out(eio) == std::nullopt);
-
-    // Correct size
-    auto snapshot = std::vector<uint8_t>(snapshot_size, 0x00);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
-    // Snapshot is successfully populated
-    REQUIRE(snapshot != std::vector<uint8_t>(snapshot_size, 0x00));
   }
 
   INFO("Commit first snapshot");
@@ -260,7 +277,7 @@ TEST_CASE("Regular snapshotting")
   {
     commit_idx = snapshot_idx + 2;
     snapshotter->commit(commit_idx, true);
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_ringbuffer_out(eio) == std::nullopt);
   }
 
@@ -275,14 +292,11 @@ TEST_CASE("Regular snapshotting")
     commit_idx = snapshot_idx;
     snapshotter->commit(commit_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-    auto snapshot = std::vector<uint8_t>(snapshot_size);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
   }
 
   INFO("Commit second snapshot");
@@ -323,7 +337,11 @@ TEST_CASE("Rollback before snapshot is committed")
   issue_transactions(network, snapshot_tx_interval);
 
   auto snapshotter = std::make_shared<ccf::Snapshotter>(
-    *writer_factory, network.tables, snapshot_tx_interval);
+    *writer_factory,
+    network.tables,
+    snapshot_tx_interval,
+    0 /* No delta snapshots */,
+    snapshot_chunk_size);
 
   size_t snapshot_idx = 0;
   size_t commit_idx = 0;
@@ -334,15 +352,12 @@ TEST_CASE("Rollback before snapshot is committed")
     REQUIRE(record_signature(history, snapshotter, snapshot_idx));
     snapshotter->commit(snapshot_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
 
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-    auto snapshot = std::vector<uint8_t>(snapshot_size);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
   }
 
   INFO("Rollback evidence and commit past it");
@@ -369,15 +384,11 @@ TEST_CASE("Rollback before snapshot is committed")
     REQUIRE(record_signature(history, snapshotter, snapshot_idx));
     snapshotter->commit(snapshot_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx_, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-    REQUIRE(snapshot_idx == snapshot_idx_);
-    auto snapshot = std::vector<uint8_t>(snapshot_size);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
 
     // Commit evidence
     issue_transactions(network, 1);
@@ -400,15 +411,11 @@ TEST_CASE("Rollback before snapshot is committed")
     REQUIRE_FALSE(record_signature(history, snapshotter, snapshot_idx));
     snapshotter->commit(snapshot_idx, true);
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx_, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-    REQUIRE(snapshot_idx == snapshot_idx_);
-    auto snapshot = std::vector<uint8_t>(snapshot_size);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
 
     REQUIRE(!network.tables->flag_enabled(
       ccf::kv::AbstractStore::Flag::SNAPSHOT_AT_NEXT_SIGNATURE));
@@ -423,7 +430,96 @@ TEST_CASE("Rollback before snapshot is committed")
       read_ringbuffer_out(eio) ==
       rb_msg({::consensus::snapshot_commit, snapshot_idx}));
 
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
+  }
+}
+
+TEST_CASE("Snapshot streaming does not block on full ringbuffer")
+{
+  ccf::logger::config::default_init();
+
+  ccf::NetworkState network;
+
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  auto history = std::make_shared<ccf::MerkleTxHistory>(
+    *network.tables.get(), ccf::kv::test::PrimaryNodeId, *node_kp);
+  network.tables->set_history(history);
+  network.tables->initialise_term(2);
+  network.tables->set_consensus(consensus);
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  network.tables->set_encryptor(encryptor);
+
+  // Outbound ringbuffer only fits a few chunks at a time
+  constexpr auto small_buffer_size = 512;
+  auto in_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+  auto out_buffer = std::make_unique<ringbuffer::TestBuffer>(small_buffer_size);
+  ringbuffer::Circuit eio(in_buffer->bd, out_buffer->bd);
+  std::unique_ptr<ringbuffer::WriterFactory> writer_factory =
+    std::make_unique<ringbuffer::WriterFactory>(eio);
+
+  size_t snapshot_tx_interval = 10;
+  issue_transactions(network, snapshot_tx_interval - 1);
+  {
+    // Snapshot is much larger than the ringbuffer
+    auto tx = network.tables->create_tx();
+    auto map = tx.rw<StringString>("public:map");
+    for (size_t i = 0; i < 64; ++i)
+    {
+      map->put(fmt::format("key {}", i), std::string(64, 'x'));
+    }
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+
+  auto snapshotter = std::make_shared<ccf::Snapshotter>(
+    *writer_factory,
+    network.tables,
+    snapshot_tx_interval,
+    0 /* No delta snapshots */,
+    snapshot_chunk_size);
+
+  size_t snapshot_idx = snapshot_tx_interval;
+  REQUIRE(record_signature(history, snapshotter, snapshot_idx));
+  snapshotter->commit(snapshot_idx, true);
+
+  INFO("Streaming task is re-queued while the ringbuffer is full");
+  {
+    auto& tm = threading::ThreadMessaging::instance();
+    for (size_t i = 0; i < 100; ++i)
+    {
+      REQUIRE(tm.run_one());
+    }
+  }
+
+  INFO("Streaming completes as the host reads from the ringbuffer");
+  {
+    std::optional<size_t> expected_size = std::nullopt;
+    std::vector<uint8_t> snapshot;
+    bool has_tasks = true;
+    while (has_tasks)
+    {
+      has_tasks = threading::ThreadMessaging::instance().run_one();
+      eio.read_from_inside().read(
+        -1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+          auto idx = serialized::read<::consensus::Index>(data, size);
+          REQUIRE(idx == snapshot_idx);
+          if (m == ::consensus::snapshot_begin)
+          {
+            REQUIRE_FALSE(expected_size.has_value());
+            serialized::read<::consensus::Index>(data, size);
+            expected_size = serialized::read<size_t>(data, size);
+          }
+          else
+          {
+            REQUIRE(m == ::consensus::snapshot_chunk);
+            REQUIRE(expected_size.has_value());
+            snapshot.insert(snapshot.end(), data, data + size);
+          }
+        });
+    }
+
+    REQUIRE(expected_size.has_value());
+    REQUIRE(snapshot.size() == expected_size.value());
+    REQUIRE(snapshot.size() > 4 * small_buffer_size);
   }
 }
 
@@ -456,7 +552,11 @@ TEST_CASE("Rekey ledger while snapshot is in progress")
   issue_transactions(network, snapshot_tx_interval);
 
   auto snapshotter = std::make_shared<ccf::Snapshotter>(
-    *writer_factory, network.tables, snapshot_tx_interval);
+    *writer_factory,
+    network.tables,
+    snapshot_tx_interval,
+    0 /* No delta snapshots */,
+    snapshot_chunk_size);
 
   size_t snapshot_idx = snapshot_tx_interval + 1;
 
@@ -489,15 +589,12 @@ TEST_CASE("Rekey ledger while snapshot is in progress")
 
   INFO("Finally, schedule snapshot creation");
   {
-    threading::ThreadMessaging::instance().run_one();
+    run_tasks();
     REQUIRE(read_latest_snapshot_evidence(network.tables) == snapshot_idx);
-    auto snapshot_allocate_msg = read_snapshot_allocate_out(eio);
-    REQUIRE(snapshot_allocate_msg.has_value());
-    auto [snapshot_idx_, snapshot_size, snapshot_count] =
-      snapshot_allocate_msg.value();
-    REQUIRE(snapshot_idx == snapshot_idx_);
-    auto snapshot = std::vector<uint8_t>(snapshot_size);
-    REQUIRE(snapshotter->write_snapshot(snapshot, snapshot_count));
+    auto snapshot_msg = read_snapshot_out(eio);
+    REQUIRE(snapshot_msg.has_value());
+    REQUIRE(snapshot_msg->first == snapshot_idx);
+    const auto& snapshot = snapshot_msg->second;
 
     // Snapshot can be deserialised to backup store
     ccf::NetworkState backup_network;
@@ -521,6 +618,235 @@ TEST_CASE("Rekey ledger while snapshot is in progress")
   }
 }
 
+TEST_CASE("Snapshot chunks fit in a single ringbuffer message fragment")
+{
+  ccf::NetworkState network;
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  auto history = std::make_shared<ccf::MerkleTxHistory>(
+    *network.tables.get(), ccf::kv::test::PrimaryNodeId, *node_kp);
+  network.tables->set_history(history);
+  network.tables->initialise_term(2);
+  network.tables->set_consensus(consensus);
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  network.tables->set_encryptor(encryptor);
+
+  auto in_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+  auto out_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+  ringbuffer::Circuit eio(in_buffer->bd, out_buffer->bd);
+  ringbuffer::WriterFactory basic_writer_factory(eio);
+
+  // Fragments much smaller than the default snapshot chunk size, as a node
+  // may be configured with, so that a chunk of the default size could only
+  // be written blocking, in several fragments
+  constexpr size_t max_fragment_size = 64;
+  oversized::WriterFactory writer_factory(
+    basic_writer_factory, {max_fragment_size, buffer_size / 4});
+
+  size_t snapshot_tx_interval = 10;
+  issue_transactions(network, snapshot_tx_interval);
+
+  auto snapshotter = std::make_shared<ccf::Snapshotter>(
+    writer_factory, network.tables, snapshot_tx_interval);
+
+  size_t snapshot_idx = snapshot_tx_interval;
+  REQUIRE(record_signature(history, snapshotter, snapshot_idx));
+  snapshotter->commit(snapshot_idx + 1, true);
+  run_tasks();
+
+  size_t expected_size = 0;
+  std::vector<uint8_t> snapshot;
+  size_t chunk_count = 0;
+  eio.read_from_inside().read(
+    -1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+      REQUIRE(size <= max_fragment_size);
+      switch (m)
+      {
+        case ::consensus::snapshot_begin:
+        {
+          auto [idx, evidence_idx, snapshot_size, base_idx] =
+            ringbuffer::read_message<::consensus::snapshot_begin>(data, size);
+          REQUIRE(idx == snapshot_idx);
+          REQUIRE(base_idx == 0);
+          expected_size = snapshot_size;
+          break;
+        }
+        case ::consensus::snapshot_chunk:
+        {
+          auto idx = serialized::read<::consensus::Index>(data, size);
+          REQUIRE(idx == snapshot_idx);
+          snapshot.insert(snapshot.end(), data, data + size);
+          chunk_count++;
+          break;
+        }
+        default:
+        {
+          REQUIRE(false);
+        }
+      }
+    });
+
+  REQUIRE(expected_size > max_fragment_size);
+  REQUIRE(snapshot.size() == expected_size);
+  REQUIRE(chunk_count > 1);
+}
+
+TEST_CASE("Delta snapshots chained to committed snapshots")
+{
+  ccf::NetworkState network;
+  auto consensus = std::make_shared<ccf::kv::test::StubConsensus>();
+  auto history = std::make_shared<ccf::MerkleTxHistory>(
+    *network.tables.get(), ccf::kv::test::PrimaryNodeId, *node_kp);
+  network.tables->set_history(history);
+  network.tables->initialise_term(2);
+  network.tables->set_consensus(consensus);
+  auto encryptor = std::make_shared<ccf::kv::NullTxEncryptor>();
+  network.tables->set_encryptor(encryptor);
+
+  auto in_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+  auto out_buffer = std::make_unique<ringbuffer::TestBuffer>(buffer_size);
+  ringbuffer::Circuit eio(in_buffer->bd, out_buffer->bd);
+  std::unique_ptr<ringbuffer::WriterFactory> writer_factory =
+    std::make_unique<ringbuffer::WriterFactory>(eio);
+
+  size_t snapshot_tx_interval = 10;
+  constexpr size_t max_delta_chain_length = 2;
+  {
+    // Large map which is not modified after the first snapshot
+    auto tx = network.tables->create_tx();
+    auto map = tx.rw<StringString>("public:large_map");
+    for (size_t i = 0; i < 64; ++i)
+    {
+      map->put(fmt::format("key {}", i), std::string(64, 'x'));
+    }
+    REQUIRE(tx.commit() == ccf::kv::CommitResult::SUCCESS);
+  }
+  issue_transactions(network, snapshot_tx_interval - 1);
+
+  auto snapshotter = std::make_shared<ccf::Snapshotter>(
+    *writer_factory,
+    network.tables,
+    snapshot_tx_interval,
+    max_delta_chain_length,
+    snapshot_chunk_size);
+
+  struct SnapshotOut
+  {
+    ::consensus::Index idx;
+    ::consensus::Index base_idx;
+    std::vector<uint8_t> data;
+  };
+  std::vector<SnapshotOut> snapshots;
+
+  INFO("Generate and commit snapshots");
+  {
+    for (size_t i = 1; i <= max_delta_chain_length + 2; ++i)
+    {
+      const size_t snapshot_idx = i * snapshot_tx_interval;
+      REQUIRE(record_signature(history, snapshotter, snapshot_idx));
+      snapshotter->commit(snapshot_idx, true);
+      run_tasks();
+
+      ::consensus::Index base_idx = 0;
+      auto snapshot_msg = read_snapshot_out(eio, &base_idx);
+      REQUIRE(snapshot_msg.has_value());
+      REQUIRE(snapshot_msg->first == snapshot_idx);
+      snapshots.push_back({snapshot_idx, base_idx, snapshot_msg->second});
+
+      issue_transactions(network, 1);
+      record_snapshot_evidence(snapshotter, snapshot_idx, snapshot_idx + 1);
+      const size_t commit_idx = snapshot_idx + 2;
+      REQUIRE_FALSE(record_signature(history, snapshotter, commit_idx));
+      snapshotter->commit(commit_idx, true);
+      REQUIRE(
+        read_ringbuffer_out(eio) ==
+        rb_msg({::consensus::snapshot_commit, snapshot_idx}));
+
+      issue_transactions(network, snapshot_tx_interval - 2);
+    }
+  }
+
+  INFO("Deltas are chained to the previous snapshot, up to the max length");
+  {
+    REQUIRE(snapshots[0].base_idx == 0);
+    REQUIRE(snapshots[1].base_idx == snapshots[0].idx);
+    REQUIRE(snapshots[2].base_idx == snapshots[1].idx);
+    REQUIRE(snapshots[3].base_idx == 0);
+
+    REQUIRE(snapshots[1].data.size() < snapshots[0].data.size());
+    REQUIRE(snapshots[2].data.size() < snapshots[0].data.size());
+  }
+
+  INFO("Delta snapshots contain the digest of their base");
+  {
+    for (size_t i = 1; i <= max_delta_chain_length; ++i)
+    {
+      const auto base_digest = ccf::crypto::Sha256Hash(snapshots[i - 1].data);
+      REQUIRE(
+        std::search(
+          snapshots[i].data.begin(),
+          snapshots[i].data.end(),
+          base_digest.h.begin(),
+          base_digest.h.end()) != snapshots[i].data.end());
+    }
+  }
+
+  auto make_store = []() {
+    // The serialised Merkle tree is not recorded by these tests, so the
+    // history of the snapshot is not checked
+    auto store = std::make_shared<ccf::kv::Store>();
+    auto history = std::make_shared<ccf::NullTxHistory>(
+      *store, ccf::kv::test::FirstBackupNodeId, *node_kp);
+    store->set_history(history);
+    store->set_encryptor(std::make_shared<ccf::kv::NullTxEncryptor>());
+    return store;
+  };
+
+  auto apply = [](
+                 const std::shared_ptr<ccf::kv::Store>& store,
+                 const std::vector<uint8_t>& snapshot) {
+    ccf::kv::ConsensusHookPtrs hooks;
+    std::vector<ccf::kv::Version> view_history;
+    return store->deserialise_snapshot(
+      snapshot.data(), snapshot.size(), hooks, &view_history);
+  };
+
+  INFO("Chain of snapshots can be applied in order");
+  {
+    auto store = make_store();
+    for (size_t i = 0; i <= max_delta_chain_length; ++i)
+    {
+      REQUIRE(apply(store, snapshots[i].data) == ccf::kv::ApplyResult::PASS);
+    }
+    REQUIRE(store->current_version() == snapshots[2].idx);
+
+    // Delta includes the evidence of the previous snapshot in the chain
+    auto tx = store->create_read_only_tx();
+    auto evidence =
+      tx.ro<ccf::SnapshotEvidence>(ccf::Tables::SNAPSHOT_EVIDENCE)->get();
+    REQUIRE(evidence.has_value());
+    REQUIRE(evidence->version == snapshots[1].idx);
+    REQUIRE(evidence->hash == ccf::crypto::Sha256Hash(snapshots[1].data));
+    REQUIRE(tx.ro<StringString>("public:large_map")->size() == 64);
+    auto map = tx.ro<StringString>("public:map");
+    REQUIRE(
+      map->get_version_of_previous_write("foo").value() == snapshots[2].idx);
+  }
+
+  INFO("Links of a chain cannot be skipped");
+  {
+    auto store = make_store();
+    REQUIRE(apply(store, snapshots[0].data) == ccf::kv::ApplyResult::PASS);
+    REQUIRE(apply(store, snapshots[2].data) == ccf::kv::ApplyResult::FAIL);
+  }
+
+  INFO("Full snapshot after the max chain length is self-contained");
+  {
+    auto store = make_store();
+    REQUIRE(apply(store, snapshots[3].data) == ccf::kv::ApplyResult::PASS);
+    REQUIRE(store->current_version() == snapshots[3].idx);
+  }
+}
+
 int main(int argc, char** argv)
 {
   threading::ThreadMessaging::init(1);
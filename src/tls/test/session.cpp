@@ -0,0 +1,282 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the Apache 2.0 License.
+#include "ccf/crypto/key_pair.h"
+#include "crypto/certs.h"
+#include "ds/ring_buffer.h"
+#include "enclave/tls_session.h"
+#include "tls/client.h"
+#include "tls/server.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <string>
+#include <thread>
+
+std::unique_ptr<threading::ThreadMessaging>
+  threading::ThreadMessaging::singleton = nullptr;
+
+using namespace std::literals;
+
+// Stands in for the host side of a session's ringbuffers
+struct Host
+{
+  std::unique_ptr<ringbuffer::TestBuffer> in;
+  std::unique_ptr<ringbuffer::TestBuffer> out;
+  ringbuffer::Circuit circuit;
+  ringbuffer::WriterFactory writer_factory;
+  size_t outbound_messages = 0;
+
+  Host(size_t size = 1 << 20) :
+    in(std::make_unique<ringbuffer::TestBuffer>(size)),
+    out(std::make_unique<ringbuffer::TestBuffer>(size)),
+    circuit(in->bd, out->bd),
+    writer_factory(circuit)
+  {}
+
+  // Returns the ciphertext written by the session
+  std::vector<uint8_t> drain()
+  {
+    std::vector<uint8_t> ciphertext;
+    circuit.read_from_inside().read(
+      -1, [&](ringbuffer::Message m, const uint8_t* data, size_t size) {
+        if (m == ::tcp::tcp_outbound)
+        {
+          auto [id, body] =
+            ringbuffer::read_message<::tcp::tcp_outbound>(data, size);
+          ciphertext.insert(ciphertext.end(), body.data, body.data + body.size);
+          ++outbound_messages;
+        }
+      });
+    return ciphertext;
+  }
+};
+
+static std::shared_ptr<::tls::Cert> make_cert(
+  const ccf::crypto::KeyPairPtr& ca_kp,
+  const ccf::crypto::Pem& ca_cert,
+  const std::string& name)
+{
+  const auto valid_from =
+    ccf::ds::to_x509_time_string(std::chrono::system_clock::now() - 24h);
+  auto kp = ccf::crypto::make_key_pair();
+  auto cert = ccf::crypto::create_endorsed_cert(
+    kp,
+    "CN=" + name,
+    {},
+    valid_from,
+    365,
+    ca_kp->private_key_pem(),
+    ca_cert);
+  return std::make_shared<::tls::Cert>(
+    std::make_shared<::tls::CA>(ca_cert.str()),
+    cert,
+    kp->private_key_pem(),
+    std::nullopt,
+    false);
+}
+
+// A server session, and the client session it is connected to, whose tasks
+// all run on the current thread
+struct SessionPair
+{
+  Host server_host;
+  Host client_host;
+  std::shared_ptr<ccf::TLSSession> server;
+  std::shared_ptr<ccf::TLSSession> client;
+  std::vector<uint8_t> received;
+
+  SessionPair(size_t server_host_size = 1 << 20) : server_host(server_host_size)
+  {
+    const auto valid_from =
+      ccf::ds::to_x509_time_string(std::chrono::system_clock::now() - 24h);
+    auto ca_kp = ccf::crypto::make_key_pair();
+    auto ca_cert = ccf::crypto::create_self_signed_cert(
+      ca_kp, "CN=issuer", {}, valid_from, 365);
+
+    server = std::make_shared<ccf::TLSSession>(
+      1,
+      server_host.writer_factory,
+      std::make_unique<::tls::Server>(make_cert(ca_kp, ca_cert, "server")));
+    client = std::make_shared<ccf::TLSSession>(
+      2,
+      client_host.writer_factory,
+      std::make_unique<::tls::Client>(make_cert(ca_kp, ca_cert, "client")));
+
+    // Starts the handshake
+    read_client();
+    while (
+      server->get_status() == ccf::handshake ||
+      client->get_status() == ccf::handshake)
+    {
+      exchange();
+    }
+  }
+
+  static void run_tasks()
+  {
+    auto& tm = ::threading::ThreadMessaging::instance();
+    while (tm.run_one(ccf::threading::get_current_thread_id()))
+    {
+    }
+  }
+
+  void read_client()
+  {
+    uint8_t buf[4096];
+    size_t n = 0;
+    do
+    {
+      n = client->read(buf, sizeof(buf));
+      received.insert(received.end(), buf, buf + n);
+    } while (n > 0);
+  }
+
+  // Delivers what each session has written to the host to the other
+  void exchange()
+  {
+    auto to_server = client_host.drain();
+    if (!to_server.empty())
+    {
+      server->recv_buffered(to_server.data(), to_server.size());
+    }
+    uint8_t buf[4096];
+    server->read(buf, sizeof(buf));
+
+    deliver_to_client();
+  }
+
+  // Returns false if the server had written nothing to the host
+  bool deliver_to_client()
+  {
+    auto to_client = server_host.drain();
+    if (to_client.empty())
+    {
+      return false;
+    }
+    client->recv_buffered(to_client.data(), to_client.size());
+    read_client();
+    return true;
+  }
+
+  void send(const std::string& s)
+  {
+    server->send_raw((const uint8_t*)s.data(), s.size());
+  }
+
+  std::string received_str() const
+  {
+    return std::string(received.begin(), received.end());
+  }
+};
+
+TEST_CASE("Sends are coalesced until the session's queued tasks have run")
+{
+  ::threading::ThreadMessaging::init(1);
+  {
+    SessionPair sessions;
+    SessionPair::run_tasks();
+    sessions.exchange();
+    const auto messages = sessions.server_host.outbound_messages;
+
+    std::string expected;
+    for (size_t i = 0; i < 10; ++i)
+    {
+      const auto response = fmt::format("response {}\n", i);
+      sessions.send(response);
+      expected += response;
+    }
+    REQUIRE_FALSE(sessions.deliver_to_client());
+
+    SessionPair::run_tasks();
+    REQUIRE(sessions.deliver_to_client());
+    REQUIRE(sessions.server_host.outbound_messages == messages + 1);
+    REQUIRE(sessions.received_str() == expected);
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
+
+TEST_CASE("Coalescing of sends is bounded")
+{
+  ::threading::ThreadMessaging::init(1);
+  {
+    SessionPair sessions;
+    SessionPair::run_tasks();
+    sessions.exchange();
+
+    INFO("By the number of sends");
+    for (size_t i = 1; i < ccf::TLSSession::max_coalesced_sends; ++i)
+    {
+      sessions.send("x");
+    }
+    REQUIRE_FALSE(sessions.deliver_to_client());
+    sessions.send("x");
+    REQUIRE(sessions.deliver_to_client());
+    REQUIRE(
+      sessions.received_str() ==
+      std::string(ccf::TLSSession::max_coalesced_sends, 'x'));
+    SessionPair::run_tasks();
+
+    INFO("By the time since the first pending send");
+    sessions.received.clear();
+    sessions.send("a");
+    std::this_thread::sleep_for(ccf::TLSSession::max_flush_delay);
+    sessions.send("b");
+    REQUIRE(sessions.deliver_to_client());
+    REQUIRE(sessions.received_str() == "ab");
+
+    INFO("By the size of a record");
+    sessions.received.clear();
+    const std::string large(ccf::TLSSession::max_record_plaintext_size, 'y');
+    sessions.send(large);
+    REQUIRE(sessions.deliver_to_client());
+    REQUIRE(sessions.received_str() == large);
+    SessionPair::run_tasks();
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
+
+TEST_CASE("Data sent before closing precedes the close notification")
+{
+  ::threading::ThreadMessaging::init(1);
+  {
+    INFO("Pending sends are flushed when closing");
+    SessionPair sessions;
+    SessionPair::run_tasks();
+    sessions.exchange();
+
+    sessions.send("bye");
+    sessions.server->close();
+    REQUIRE(sessions.deliver_to_client());
+    REQUIRE(sessions.received_str() == "bye");
+    REQUIRE(sessions.client->get_status() == ccf::closed);
+    SessionPair::run_tasks();
+  }
+
+  {
+    INFO("Closing waits for the host to take data it had no room for");
+    const size_t host_size = 512 * 1024;
+    SessionPair sessions(host_size);
+    SessionPair::run_tasks();
+    sessions.exchange();
+
+    const std::string large(2 * host_size, 'z');
+    sessions.send(large);
+    sessions.server->close();
+    REQUIRE(sessions.server->get_status() == ccf::closing);
+
+    // Closing is retried by a task which re-queues itself, until the host has
+    // made room, so tasks are run one at a time here
+    auto& tm = ::threading::ThreadMessaging::instance();
+    const auto tid = ccf::threading::get_current_thread_id();
+    size_t attempts = 0;
+    while (sessions.client->get_status() != ccf::closed && attempts++ < 100)
+    {
+      sessions.exchange();
+      tm.run_one(tid);
+    }
+    REQUIRE(sessions.received_str() == large);
+    REQUIRE(sessions.server->get_status() == ccf::closed);
+    REQUIRE(sessions.client->get_status() == ccf::closed);
+  }
+  ::threading::ThreadMessaging::shutdown();
+}
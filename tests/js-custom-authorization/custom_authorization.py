@@ -1195,6 +1195,8 @@ def test_reused_interpreter_behaviour(network, args):
         default_max_stack_size = body["max_stack_size"]
         default_max_execution_time = body["max_execution_time"]
         default_max_cached_interpreters = body["max_cached_interpreters"]
+        # Reported per worker thread
+        assert sum(t["hits"] for t in body["interpreter_cache"]) > 0, body
         network.consortium.set_js_runtime_options(
             primary,
             max_heap_bytes=default_max_heap_size,
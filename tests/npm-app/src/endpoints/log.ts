@@ -59,3 +59,64 @@ export function getAllLogItems(
     body: items,
   };
 }
+
+interface NamedLogEntry {
+  name: string;
+  msg: LogContent;
+}
+
+// Keyed by string, so that range visits entries in the order of their names
+const namedLogMap = ccfapp.typedKv(
+  "named_log",
+  ccfapp.string,
+  ccfapp.json<LogContent>(),
+);
+
+function parseQuery(query: string): Record<string, string> {
+  const params: Record<string, string> = {};
+  for (const param of query.split("&")) {
+    if (param.length > 0) {
+      const [key, value] = param.split("=");
+      params[key] = decodeURIComponent(value ?? "");
+    }
+  }
+  return params;
+}
+
+export function setNamedLogItems(
+  request: ccfapp.Request<Record<string, LogContent>>,
+): ccfapp.Response {
+  const items = request.body.json();
+  for (const name in items) {
+    namedLogMap.set(name, items[name]);
+  }
+  return {};
+}
+
+export function getManyNamedLogItems(
+  request: ccfapp.Request,
+): ccfapp.Response<Array<LogContent | null>> {
+  const names = parseQuery(request.query)["names"].split(",");
+  return {
+    body: namedLogMap
+      .getMany(names)
+      .map((msg) => (msg === undefined ? null : msg)),
+  };
+}
+
+export function getNamedLogItemsInRange(
+  request: ccfapp.Request,
+): ccfapp.Response<Array<NamedLogEntry>> {
+  const query = parseQuery(request.query);
+  let items: Array<NamedLogEntry> = [];
+  namedLogMap.range(
+    function (msg, name) {
+      items.push({ name: name, msg: msg });
+    },
+    query["from"],
+    query["to"],
+  );
+  return {
+    body: items,
+  };
+}
@@ -695,6 +695,26 @@ def test_npm_app(network, args):
         v3 = r.body.json()["version"]
         assert v3 == v1
 
+        r = c.post(
+            "/app/log/named", {"d": "Hallo!", "b": "Hola!", "a": "Ciao!", "c": "Hej!"}
+        )
+        assert r.status_code == http.HTTPStatus.OK, r.status_code
+
+        r = c.get("/app/log/named/many?names=c,e,a,c")
+        assert r.status_code == http.HTTPStatus.OK, r.status_code
+        assert r.body.json() == ["Hej!", None, "Ciao!", "Hej!"], r.body
+
+        r = c.get("/app/log/named/range")
+        assert r.status_code == http.HTTPStatus.OK, r.status_code
+        assert [item["name"] for item in r.body.json()] == ["a", "b", "c", "d"], r.body
+
+        r = c.get("/app/log/named/range?from=b&to=d")
+        assert r.status_code == http.HTTPStatus.OK, r.status_code
+        assert r.body.json() == [
+            {"name": "b", "msg": "Hola!"},
+            {"name": "c", "msg": "Hej!"},
+        ], r.body
+
         test_apply_writes(c)
 
         priv_key_pem, _ = infra.crypto.generate_rsa_keypair(2048)